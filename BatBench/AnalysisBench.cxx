@@ -0,0 +1,1098 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Microbenchmark of the TCDMSAnalysis algorithms. Every algorithm
+//             is configured the way EventBuilder configures it and its DoCalc
+//             is timed in isolation on a pool of realistic traces, for a list
+//             of trace lengths. Reports ns/pulse and heap allocations/pulse so
+//             that algorithm choices in the config files can be made on cost.
+//             Templates and filters are built from the SynthRawGen pulse and
+//             noise model, or read from a BatNoise filter file (-n).
+//
+//Usage: ./AnalysisBench [options]
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <stdint.h>
+
+//ROOT Libraries
+#include "TComplex.h"
+#include "TMath.h"
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+#include "CounterRNG.h"
+#include "PulseTools.h"
+#include "SprseMatrix.h"
+#include "TemplateDataManager.h"
+#include "FilterDataManager.h"
+
+//Analysis classes
+#include "BasicPulseCalc.h"
+#include "VarFreqRTFTWalkPhonon.h"
+#include "ConstFreqRTFTWalkPhonon.h"
+#include "RTFTWalkCharge.h"
+#include "PulseIntegral.h"
+#include "SingleExponentialFit.h"
+#include "WedgeFitPhonon.h"
+#include "InflectionTime.h"
+#include "PipeFitPhonon.h"
+#include "PSDIntegralPhonon.h"
+#include "OptimalFilterPhonon.h"
+#include "OptimalFilterPhonon1X2.h"
+#include "OptimalFilterPhononNS.h"
+#include "OptimalFilterCharge.h"
+#include "OptimalFilterChargeX.h"
+#include "OptimalFilterCharge2X2.h"
+#include "OptimalFilterNxN.h"
+#include "F5ChargeX.h"
+#include "VetoAnalysis.h"
+#include "ProcessingTimer.h"
+#include "CountingAllocator.h"   //operator new is replaced for the whole executable
+
+using namespace std;
+
+
+namespace {
+
+   //pulse and noise model of SynthRawGen (see SynthDataGenerator.cxx)
+   const double kPhononSampleRate = 625.e3;
+   const double kChargeSampleRate = 1.25e6;
+   const double kPhononRiseTime = 25.e-6;
+   const double kPhononFallTime = 250.e-6;
+   const double kPhononFastFallTime = 50.e-6;   //second component for OptimalFilterPhonon1X2
+   const double kChargeRiseTime = 1.e-6;
+   const double kChargeFallTime = 40.e-6;
+   const double kPhononBaseline = 4000.;
+   const double kChargeBaseline = 32768.;
+   const double kChargeToPhonon = 0.5;
+   const double kChargeCrossTalk = 0.1;         //cross-talk template relative to the direct one
+   const double kSaturation = 65535.;           //16 bit digitizer
+
+   //analysis settings, from the UserSettings defaults
+   const double kPhononPeakWindowMin = 200.e-6;
+   const double kPhononPeakWindowMax = 100.e-6;
+   const double kChargePeakWindowMin = 100.e-6;
+   const double kChargePeakWindowMax = 10.e-6;
+   const double kChargeZWindow = 2.e-6;
+   const double kChisqCutoff = 10.e3;
+   const double kTailFitStart = 800.e-6;
+   const double kTailFitEnd = 80.e-6;
+   const double kPhononCutoff = 50.e3;
+   const double kChargeCutoff = 200.e3;
+   const int    kButterOrder = 2;
+   const int    kPhononChannel = 2;              //channel index into the per-channel settings
+
+   const int kPoolSize = 32;                     //distinct traces per length, every 10th is noise only
+   const int kReferenceBins = 2048;              //trace length the bin valued settings are tuned for
+
+   uint64_t NowNs()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+   }
+
+   vector<string> SplitList(const string& list)
+   {
+      vector<string> items;
+      stringstream listStream(list);
+      string item;
+      while(getline(listStream, item, ','))
+	 if(!item.empty()) items.push_back(item);
+      return items;
+   }
+
+   //settings given in bins for 2048 bin traces, scaled to the trace length
+   int ScaleBins(int referenceBins, int nBins)
+   {
+      return max(1, (int)((int64_t)referenceBins*nBins/kReferenceBins));
+   }
+
+   //filters of one channel, in the conventions of NoiseBuilder / FilterDataManager
+   struct ChannelFilter {
+      double           sampleRate;
+      int              nBins;
+      int              preTrigger;      //bins
+      vector<double>   templateTime;
+      double           templateMax;
+      vector<TComplex> templateFFT;     //scaled by 1/sqrt(sampleRate)
+      vector<TComplex> optimalFilter;   //conj(templateFFT)/noiseFFTsq
+      vector<double>   noiseFFTsq;
+      double           normFFT;
+      double           sigToNoiseSq;
+      double           noiseRMS;        //time domain, from noiseFFTsq
+   };
+
+   struct BenchPulse {
+      bool           isNoise;
+      double         phononAmp;         //OF amplitude
+      double         qiAmp;
+      double         qoAmp;
+      vector<double> phononRaw;
+      vector<double> phononBS;
+      vector<double> qiRaw;
+      vector<double> qiBS;
+      vector<double> qoRaw;
+      vector<double> qoBS;
+      double         phononStd;
+      double         qiStd;
+      double         qoStd;
+      double         qiBaseline;
+      double         qoBaseline;
+   };
+
+   //everything the algorithms need for one trace length
+   struct BenchInputs {
+      ChannelFilter      phonon;
+      ChannelFilter      phononFast;
+      ChannelFilter      charge;        //QI and QO share the filter
+      ChannelFilter      chargeX;       //cross-talk template
+      vector<double>     qInverse;
+      SprseMatrix        covPD;
+      SprseMatrix        covBase;
+      int                phononBaselineMax;
+      int                chargeBaselineMax;
+      int                phononWin1;    //OF windows as EventBuilder computes them
+      int                phononWin2;
+      int                chargeWin1;
+      int                chargeWin2;
+      int                chargeXMin;
+      int                chargeXMax;
+      int                chargeZMin;
+      int                chargeZMax;
+      int                time10;        //template rise points, bins
+      int                time20;
+      int                time60;
+      vector<BenchPulse> pulses;
+   };
+
+   //accumulates the timed calls of one algorithm
+   struct DoCalcTimer {
+      DoCalcTimer() : nCalls(0), totalNs(0), nAllocations(0), startNs(0), startAllocations(0) {}
+
+      void Start()
+      {
+	 //heap allocations are counted only around the timed DoCalc calls
+	 startAllocations = ProcessingTimer::GetNAllocations();
+	 ProcessingTimer::SetCountAllocations(true);
+	 startNs = NowNs();
+      }
+      void Stop()
+      {
+	 uint64_t stopNs = NowNs();
+	 ProcessingTimer::SetCountAllocations(false);
+	 totalNs += stopNs - startNs;
+	 nAllocations += ProcessingTimer::GetNAllocations() - startAllocations;
+	 nCalls++;
+      }
+
+      uint64_t nCalls;
+      uint64_t totalNs;
+      uint64_t nAllocations;
+      uint64_t startNs;
+      uint64_t startAllocations;
+   };
+
+   //white + one pole low-pass filtered noise (SynthRawGen), as noiseFFTsq
+   vector<double> ColoredNoiseFFTsq(int nBins, double sampleRate, double white, double red, double corner)
+   {
+      double pole = exp(-2.*TMath::Pi()*corner/sampleRate);
+      vector<double> noiseFFTsq(nBins);
+      for(int binItr = 0; binItr < nBins; binItr++)
+      {
+	 TComplex denom = TComplex(1.,0.) - pole*TComplex::Exp(TComplex(0., -2.*TMath::Pi()*binItr/nBins));
+	 noiseFFTsq[binItr] = (white*white + red*red*(1. - pole*pole)/denom.Rho2())/sampleRate;
+      }
+      return noiseFFTsq;
+   }
+
+   //template FFT, optimal filter and normalizations the way NoiseBuilder computes them
+   void FillFilter(ChannelFilter& filter)
+   {
+      filter.nBins = filter.templateTime.size();
+      filter.templateMax = PulseTools::MaxADC(filter.templateTime);
+
+      filter.templateFFT.clear();
+      PulseTools::RealToComplexFFT(filter.templateTime, filter.templateFFT);
+      filter.templateFFT = PulseTools::pulseScale(filter.templateFFT, TComplex(1./sqrt(filter.sampleRate), 0.));
+
+      filter.optimalFilter.assign(filter.nBins, TComplex(0., 0.));
+      filter.sigToNoiseSq = 0.;
+      for(int binItr = 1; binItr < filter.nBins; binItr++)
+      {
+	 filter.optimalFilter[binItr] = TComplex::Conjugate(filter.templateFFT[binItr])/filter.noiseFFTsq[binItr];
+	 filter.sigToNoiseSq += filter.templateFFT[binItr].Rho2()/filter.noiseFFTsq[binItr];
+      }
+      filter.normFFT = filter.sigToNoiseSq/sqrt((double)filter.nBins);
+   }
+
+   void FillNoiseRMS(ChannelFilter& filter)
+   {
+      double variance = 0.;
+      for(int binItr = 1; binItr < filter.nBins; binItr++)
+	 variance += filter.noiseFFTsq[binItr]*filter.sampleRate;
+      filter.noiseRMS = sqrt(variance/filter.nBins);
+   }
+
+   //pulse start: first bin above 1% of the template maximum
+   int FindPreTrigger(const vector<double>& templateTime)
+   {
+      double threshold = 0.01*PulseTools::MaxADC(templateTime);
+      for(uint binItr = 0; binItr < templateTime.size(); binItr++)
+	 if(templateTime[binItr] > threshold) return binItr;
+      return templateTime.size()/4;
+   }
+
+   int FindRisePoint(const vector<double>& templateTime, int preTrigger, double fraction)
+   {
+      double threshold = fraction*PulseTools::MaxADC(templateTime);
+      for(uint binItr = preTrigger; binItr < templateTime.size(); binItr++)
+	 if(templateTime[binItr] >= threshold) return binItr;
+      return preTrigger;
+   }
+
+   ChannelFilter BuildModelFilter(const TemplateDataManager& templateData, int nBins, double sampleRate,
+				  double riseTime, double fallTime, const vector<double>& noiseFFTsq)
+   {
+      ChannelFilter filter;
+      filter.sampleRate = sampleRate;
+      filter.preTrigger = nBins/4;
+      filter.templateTime = templateData.GetDoubleExpForm(riseTime, fallTime, nBins, filter.preTrigger, sampleRate);
+
+      double peak = PulseTools::MaxADC(filter.templateTime);
+      if(peak > 0.)
+	 for(int binItr = 0; binItr < nBins; binItr++)
+	    filter.templateTime[binItr] /= peak;
+
+      filter.noiseFFTsq = noiseFFTsq;
+      FillFilter(filter);
+      FillNoiseRMS(filter);
+      return filter;
+   }
+
+   ChannelFilter ReadChannelFilter(const FilterDataManager& filterData, int detNum, const string& chanName)
+   {
+      ChannelFilter filter;
+      filter.sampleRate = filterData.GetSampleRate(detNum, chanName);
+      filter.templateTime = filterData.GetTemplateTime(detNum, chanName);
+      filter.nBins = filter.templateTime.size();
+      filter.preTrigger = FindPreTrigger(filter.templateTime);
+      filter.templateMax = filterData.GetTemplateMax(detNum, chanName);
+      filter.templateFFT = filterData.GetTemplateFFT(detNum, chanName);
+      filter.optimalFilter = filterData.GetTemplateConjNoiseFFT(detNum, chanName);
+      filter.noiseFFTsq = filterData.GetNoiseFFTsq(detNum, chanName);
+      filter.normFFT = filterData.GetNormFFT(detNum, chanName);
+      filter.sigToNoiseSq = filterData.GetSigToNoiseSq(detNum, chanName);
+
+      if((int)filter.noiseFFTsq.size() != filter.nBins || (int)filter.templateFFT.size() != filter.nBins)
+      {
+	 cerr <<"AnalysisBench: ERROR template and noise of " << chanName << " have different lengths" << endl;
+	 exit(1);
+      }
+      FillNoiseRMS(filter);
+      return filter;
+   }
+
+   //a template with the noise and sample rate of an existing filter
+   ChannelFilter DeriveFilter(const ChannelFilter& base, const vector<double>& templateTime)
+   {
+      ChannelFilter filter = base;
+      filter.templateTime = templateTime;
+      FillFilter(filter);
+      return filter;
+   }
+
+   //charge cross-talk inversion matrix as NoiseBuilder builds it (QI and QO share the filter)
+   vector<double> BuildQInverse(const ChannelFilter& charge, const ChannelFilter& chargeX)
+   {
+      double m00 = 0., m11 = 0., m01 = 0.;
+      for(int binItr = 1; binItr < charge.nBins; binItr++)
+      {
+	 double noise = charge.noiseFFTsq[binItr];
+	 m00 += (charge.templateFFT[binItr].Rho2() + chargeX.templateFFT[binItr].Rho2())/noise;
+	 m01 += 2.*(chargeX.templateFFT[binItr]*TComplex::Conjugate(charge.templateFFT[binItr])).Re()/noise;
+      }
+      m11 = m00;
+
+      double det = m00*m11 - m01*m01;
+      vector<double> qInverse(4);
+      qInverse[0] = m11/det;
+      qInverse[1] = -m01/det;
+      qInverse[2] = -m01/det;
+      qInverse[3] = m00/det;
+      return qInverse;
+   }
+
+   //diagonal stand-in for the OptimalFilterPhononNS covariance matrices
+   SprseMatrix DiagonalCovariance(const vector<double>& noiseFFTsq, double scale)
+   {
+      int nBins = noiseFFTsq.size();
+      blasSprseMat diagonal(nBins, nBins, nBins);
+      for(int binItr = 0; binItr < nBins; binItr++)
+	 diagonal(binItr, binItr) = complex<double>(scale*noiseFFTsq[binItr], 0.);
+
+      SprseMatrix covariance;
+      covariance = diagonal;
+      return covariance;
+   }
+
+   //gaussian noise with the spectrum of the filter: E|X_k|^2 = noiseFFTsq[k]*sampleRate
+   //in the symmetric FFT normalization of PulseTools
+   void AddNoise(CounterRNG& rng, const ChannelFilter& filter, vector<double>& trace)
+   {
+      int nBins = trace.size();
+      vector<TComplex> noiseFFT(nBins, TComplex(0., 0.));
+      for(int binItr = 1; binItr <= nBins/2; binItr++)
+      {
+	 double sigma = sqrt(filter.noiseFFTsq[binItr]*filter.sampleRate);
+	 if(2*binItr == nBins)
+	 {
+	    noiseFFT[binItr] = TComplex(rng.Gaus(0., sigma), 0.);
+	    continue;
+	 }
+	 double re = rng.Gaus(0., sigma/sqrt(2.));
+	 double im = rng.Gaus(0., sigma/sqrt(2.));
+	 noiseFFT[binItr] = TComplex(re, im);
+	 noiseFFT[nBins-binItr] = TComplex(re, -im);
+      }
+
+      vector<double> noise;
+      PulseTools::ComplexToRealIFFT(noiseFFT, noise);
+      for(int binItr = 0; binItr < nBins; binItr++)
+	 trace[binItr] += noise[binItr];
+   }
+
+   void BuildTrace(CounterRNG& rng, const ChannelFilter& filter, double baseline, int baselineMax,
+		   double amp, const ChannelFilter* crossTalk, double crossTalkAmp,
+		   vector<double>& raw, vector<double>& bs, double& std)
+   {
+      raw.assign(filter.nBins, baseline);
+      for(int binItr = 0; binItr < filter.nBins; binItr++)
+      {
+	 raw[binItr] += amp*filter.templateTime[binItr];
+	 if(crossTalk) raw[binItr] += crossTalkAmp*crossTalk->templateTime[binItr];
+      }
+      AddNoise(rng, filter, raw);
+
+      bs = PulseTools::BaselineSub(raw, 0, baselineMax);
+      std = PulseTools::Std(raw, 0, baselineMax);
+   }
+
+   //templates, windows and the trace pool; phonon and charge filters must be set
+   void BuildInputs(BenchInputs& inputs, double meanSNR, bool diagonalCovariance)
+   {
+      TemplateDataManager templateData;
+      ChannelFilter& phonon = inputs.phonon;
+      ChannelFilter& charge = inputs.charge;
+
+      //derived templates
+      vector<double> fastTemplate = templateData.GetDoubleExpForm(kPhononRiseTime, kPhononFastFallTime, phonon.nBins,
+								  phonon.preTrigger, phonon.sampleRate);
+      double fastPeak = PulseTools::MaxADC(fastTemplate);
+      for(uint binItr = 0; binItr < fastTemplate.size(); binItr++)
+	 fastTemplate[binItr] *= phonon.templateMax/fastPeak;
+      inputs.phononFast = DeriveFilter(phonon, fastTemplate);
+
+      vector<double> crossTalkTemplate = charge.templateTime;
+      for(uint binItr = 0; binItr < crossTalkTemplate.size(); binItr++)
+	 crossTalkTemplate[binItr] *= kChargeCrossTalk;
+      inputs.chargeX = DeriveFilter(charge, crossTalkTemplate);
+
+      inputs.qInverse = BuildQInverse(charge, inputs.chargeX);
+
+      //pulse dependent part small compared to the baseline noise at typical amplitudes
+      if(diagonalCovariance)
+      {
+	 inputs.covBase = DiagonalCovariance(phonon.noiseFFTsq, 1.);
+	 inputs.covPD = DiagonalCovariance(phonon.noiseFFTsq, 1.e-6);
+      }
+
+      //baseline range of BasicPulseCalc (400 of 2048 bins), kept before the pulse
+      inputs.phononBaselineMax = min(ScaleBins(400, phonon.nBins), phonon.preTrigger);
+      inputs.chargeBaselineMax = min(ScaleBins(400, charge.nBins), charge.preTrigger);
+
+      //OF windows
+      int postTriggerBins = phonon.nBins - phonon.preTrigger;
+      int windowMin = (int)floor(phonon.sampleRate*(phonon.preTrigger/phonon.sampleRate - kPhononPeakWindowMin));
+      int windowMax = (int)floor(phonon.sampleRate*(phonon.preTrigger/phonon.sampleRate + kPhononPeakWindowMax));
+      inputs.phononWin1 = windowMax - phonon.preTrigger;
+      inputs.phononWin2 = max(windowMin, 0) + postTriggerBins + 1;
+
+      postTriggerBins = charge.nBins - charge.preTrigger;
+      windowMin = (int)floor(charge.sampleRate*(charge.preTrigger/charge.sampleRate - kChargePeakWindowMin));
+      windowMax = (int)floor(charge.sampleRate*(charge.preTrigger/charge.sampleRate + kChargePeakWindowMax));
+      inputs.chargeWin1 = windowMax - charge.preTrigger;
+      inputs.chargeWin2 = max(windowMin, 0) + postTriggerBins + 1;
+
+      inputs.chargeXMin = (int)floor(-charge.sampleRate*kChargePeakWindowMin);
+      inputs.chargeXMax = (int)floor(charge.sampleRate*kChargePeakWindowMax);
+      inputs.chargeZMin = (int)floor(-charge.sampleRate*kChargeZWindow);
+      inputs.chargeZMax = (int)ceil(charge.sampleRate*kChargeZWindow);
+
+      inputs.time10 = FindRisePoint(phonon.templateTime, phonon.preTrigger, 0.1);
+      inputs.time20 = FindRisePoint(phonon.templateTime, phonon.preTrigger, 0.2);
+      inputs.time60 = FindRisePoint(phonon.templateTime, phonon.preTrigger, 0.6);
+
+      //trace pool: exponential amplitude spectrum, charge shared randomly between QI and QO
+      inputs.pulses.resize(kPoolSize);
+      for(int pulseItr = 0; pulseItr < kPoolSize; pulseItr++)
+      {
+	 BenchPulse& pulse = inputs.pulses[pulseItr];
+	 CounterRNG rng(phonon.nBins, pulseItr);
+
+	 pulse.isNoise = (pulseItr%10 == 9);
+	 double snr = (pulse.isNoise ? 0. : -meanSNR*log(rng.Uniform()));
+	 double share = rng.Uniform();
+	 pulse.phononAmp = snr*phonon.noiseRMS/phonon.templateMax;
+	 pulse.qiAmp = kChargeToPhonon*snr*share*charge.noiseRMS/charge.templateMax;
+	 pulse.qoAmp = kChargeToPhonon*snr*(1. - share)*charge.noiseRMS/charge.templateMax;
+
+	 CounterRNG phononRNG(phonon.nBins, pulseItr, 1);
+	 BuildTrace(phononRNG, phonon, kPhononBaseline, inputs.phononBaselineMax, pulse.phononAmp, NULL, 0.,
+		    pulse.phononRaw, pulse.phononBS, pulse.phononStd);
+
+	 CounterRNG qiRNG(phonon.nBins, pulseItr, 2);
+	 BuildTrace(qiRNG, charge, kChargeBaseline, inputs.chargeBaselineMax, pulse.qiAmp, &inputs.chargeX, pulse.qoAmp,
+		    pulse.qiRaw, pulse.qiBS, pulse.qiStd);
+
+	 CounterRNG qoRNG(phonon.nBins, pulseItr, 3);
+	 BuildTrace(qoRNG, charge, kChargeBaseline, inputs.chargeBaselineMax, pulse.qoAmp, &inputs.chargeX, pulse.qiAmp,
+		    pulse.qoRaw, pulse.qoBS, pulse.qoStd);
+
+	 pulse.qiBaseline = PulseTools::Baseline(pulse.qiRaw, 0, inputs.chargeBaselineMax);
+	 pulse.qoBaseline = PulseTools::Baseline(pulse.qoRaw, 0, inputs.chargeBaselineMax);
+      }
+   }
+
+
+   // ===== one function per algorithm: configure as EventBuilder does, time DoCalc only =====
+
+   void BenchBasicPulseCalc(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      BasicPulseCalc analysis("phonon");
+      analysis.SetSaturationVal((int)kSaturation);
+      analysis.SetMinADCVal(2);
+      analysis.SetBaselineRange(1, in.phononBaselineMax);
+      analysis.SetPostBaselineRange(ScaleBins(100, in.phonon.nBins));
+      analysis.SetGain(1.);
+      analysis.SetBias(1.);
+      analysis.SetPulseNorm(1.);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononRaw);
+      timer.Stop();
+   }
+
+   void BenchVarFreqRTFTWalkPhonon(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& phonon = in.phonon;
+      int channel = kPhononChannel;
+      vector<double> cutoff1(kPhononChannel + 1, 0.678);
+      vector<double> cutoff2(kPhononChannel + 1, 2981.);
+
+      VarFreqRTFTWalkPhonon analysis;
+      analysis.SetPeakWindowMin(max(0, phonon.preTrigger - (int)floor(phonon.sampleRate*kPhononPeakWindowMin)));
+      analysis.SetPeakWindowMax(phonon.nBins - ScaleBins(150, phonon.nBins));
+      analysis.SetSampleRate(phonon.sampleRate);
+      analysis.SetSensorType("phonon");
+      analysis.SetVariableFilterParameters(channel, cutoff1, cutoff2, kButterOrder, 6.e3, 200.e3, 1.,
+					   pulse.phononStd, pulse.phononAmp, phonon.templateMax, kPhononCutoff);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   void BenchConstFreqRTFTWalkPhonon(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& phonon = in.phonon;
+
+      ConstFreqRTFTWalkPhonon analysis;
+      analysis.SetPeakWindowMin(max(0, phonon.preTrigger - (int)floor(phonon.sampleRate*kPhononPeakWindowMin)));
+      analysis.SetPeakWindowMax(phonon.nBins - ScaleBins(150, phonon.nBins));
+      analysis.SetSampleRate(phonon.sampleRate);
+      analysis.SetSensorType("phonon");
+      analysis.SetFilterParameters(kPhononCutoff, kButterOrder);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS, "filtered");
+      timer.Stop();
+   }
+
+   void BenchRTFTWalkCharge(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+
+      RTFTWalkCharge analysis;
+      analysis.SetPeakWindowMin(max(0, charge.preTrigger - (int)floor(charge.sampleRate*40.e-6)));
+      analysis.SetSampleRate(charge.sampleRate);
+      analysis.SetSensorType("charge");
+      analysis.SetStd(pulse.qiStd);
+      analysis.SetFilterParameters(kChargeCutoff, kButterOrder);
+
+      timer.Start();
+      analysis.DoCalc(pulse.qiBS, "filtered");
+      timer.Stop();
+   }
+
+   void BenchPulseIntegral(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      PulseIntegral analysis;
+      analysis.SetFilterParameters(in.phonon.sampleRate, kPhononCutoff, kButterOrder);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS, "filtered");
+      timer.Stop();
+   }
+
+   void BenchSingleExponentialFit(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& phonon = in.phonon;
+
+      //tail fit window of DoTailFitPhonon, kept inside short traces
+      int windowMax = phonon.nBins - (int)(phonon.sampleRate*kTailFitEnd);
+      int windowMin = min(phonon.preTrigger + (int)floor(phonon.sampleRate*kTailFitStart),
+			  (phonon.preTrigger + windowMax)/2);
+      double meanEnd = PulseTools::Baseline(pulse.phononBS, phonon.nBins - ScaleBins(100, phonon.nBins),
+					    phonon.nBins - ScaleBins(50, phonon.nBins));
+
+      SingleExponentialFit analysis("TailFitPhonon");
+      analysis.InitializeFitParameters(pulse.phononBS[windowMin], -1./kPhononFallTime, meanEnd, pulse.phononStd);
+      analysis.SetSampleTime(1./phonon.sampleRate);
+      analysis.SetFitWindow(windowMin, windowMax);
+      analysis.SetFitParameterConstraintFlag(2, 2);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   //SetFitParameters filters the pulse and finds the fit range, so it is timed with DoCalc
+   void BenchWedgeFitPhonon(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      //not run on noise (EventBuilder skips it)
+      if(pulse.isNoise) return;
+
+      WedgeFitPhonon analysis;
+      double maxADC = PulseTools::MaxADC(pulse.phononBS);
+
+      timer.Start();
+      analysis.SetFitParameters(pulse.phononBS, in.phonon.sampleRate, kButterOrder, kPhononCutoff, pulse.phononStd,
+				maxADC, in.time10, in.time20, in.time60, 21, 1, 5, 0.2375);
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   void BenchInflectionTime(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      InflectionTime analysis;
+      analysis.SetInflectionWindow(ScaleBins(400, in.phonon.nBins), ScaleBins(1000, in.phonon.nBins));
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   //the fit windows are fixed in PipeFitPhonon for 2048 bin traces; InitializeParameters
+   //does the walk and start time searches, so it is timed with DoCalc
+   void BenchPipeFitPhonon(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      if(pulse.isNoise) return;
+
+      PipeFitPhonon analysis;
+      analysis.SetStartWindowMin(499);
+      analysis.SetStartWindowMax(549);
+      analysis.SetStartRMSMultiplier(2.0);
+      analysis.SetStartWalkMultiplier(0.05);
+      analysis.SetStartThreshCheck(200.);
+      analysis.SetMaxThreshCheck(1000.);
+      analysis.SetLargeRMSMult(4.0);
+      analysis.SetSmallRMSTest(6.0);
+      analysis.SetStartSmallDefault(499);
+
+      analysis.SetMaxADCBinStartDiff(30.);
+      analysis.SetMaxADCBinStartMult(3.0);
+      analysis.SetMaxADCBinStartAdd(50.);
+      analysis.SetMaxADCBinAdd(100.);
+
+      analysis.SetMidpointDefault(1599.);
+      analysis.SetFallFuncEnd(2039.);
+
+      analysis.SetRiseFuncA0Default(2000.);
+      analysis.SetRiseFuncT0Default(510.);
+      analysis.SetRiseFuncTauDefault(40.);
+      analysis.SetRiseFuncKappaDefault(150.);
+      analysis.SetRiseFuncA1Default(0.8);
+      analysis.SetRiseFuncPulseHeightMult(2.0);
+      analysis.SetRiseFuncStartBinDiff(2.0);
+      analysis.SetRiseFuncTauMult(0.5);
+      analysis.SetRiseFuncKappaMult(2.5);
+
+      analysis.SetFallFuncAfAdd(40.);
+      analysis.SetFallFuncTf1Start(150.);
+      analysis.SetFallFuncTf2Start(500.);
+      analysis.SetFallFuncTfrStart(0.007);
+      analysis.SetFallFuncStepSizeAdd1(20.);
+      analysis.SetFallFuncStepSizeAdd2(10.);
+
+      analysis.SetMaxTraceStartSat(-1000.);
+      analysis.SetMaxTraceDiffSat(30.);
+      analysis.SetPulseheightMaxSat(2000.);
+      analysis.SetNumberSatBins(120.);
+
+      vector<double> threshold(kPhononChannel + 4, 1000.);
+
+      timer.Start();
+      analysis.InitializeParameters(pulse.phononBS, threshold, kPhononChannel, pulse.phononStd);
+      analysis.DoCalc();
+      timer.Stop();
+   }
+
+   void BenchPSDIntegralPhonon(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      PSDIntegralPhonon analysis;
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS, in.phonon.sampleRate);
+      timer.Stop();
+   }
+
+   void BenchOptimalFilterPhonon(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& phonon = in.phonon;
+
+      OptimalFilterPhonon analysis;
+      analysis.LoadTemplates(phonon.templateFFT, phonon.optimalFilter);
+      analysis.LoadNormalizations(phonon.normFFT, phonon.sigToNoiseSq, phonon.noiseFFTsq);
+      analysis.LoadCutoffFreq(kChisqCutoff);
+      analysis.SetSampleTime(1./phonon.sampleRate);
+      analysis.SetWindows(in.phononWin1, in.phononWin2);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   void BenchOptimalFilterPhonon1X2(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& phonon = in.phonon;
+
+      OptimalFilterPhonon1X2 analysis;
+      analysis.SetSampleTime(1./phonon.sampleRate);
+      analysis.SetPxWindows(in.phononWin1, in.phononWin2);
+      analysis.LoadTemplates(phonon.templateTime, in.phononFast.templateTime, phonon.templateFFT, in.phononFast.templateFFT);
+      analysis.LoadNormalizations(phonon.noiseFFTsq);
+      analysis.SetDelayInterpolateFlag(1);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   void BenchOptimalFilterPhononNS(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& phonon = in.phonon;
+
+      OptimalFilterPhononNS analysis;
+      analysis.SetVerbosity(0);
+      analysis.LoadTemplates(phonon.templateFFT);
+      analysis.LoadNormalizations(phonon.normFFT, phonon.sigToNoiseSq, in.covPD, in.covBase);
+      analysis.SetSampleTime(1./phonon.sampleRate);
+      analysis.SetWindows(in.phononWin1, in.phononWin2);
+      analysis.SetChiWidth(0);
+      analysis.LoadThresholds(0., 0);
+      analysis.SetIsRandom(pulse.isNoise);
+      analysis.SetPrintRandom(false);
+      analysis.LoadOFParams(pulse.phononAmp, 0.);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononBS);
+      timer.Stop();
+   }
+
+   void BenchOptimalFilterCharge(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+
+      OptimalFilterCharge analysis;
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter);
+      analysis.LoadNormalizations(charge.normFFT, charge.sigToNoiseSq, charge.noiseFFTsq, charge.templateMax);
+      analysis.SetSampleTime(1./charge.sampleRate);
+      analysis.SetWindows(in.chargeWin1, in.chargeWin2);
+
+      timer.Start();
+      analysis.DoCalc(pulse.qiBS);
+      timer.Stop();
+   }
+
+   void BenchOptimalFilterChargeX(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+      const ChannelFilter& chargeX = in.chargeX;
+
+      OptimalFilterChargeX analysis;
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QI");
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QO");
+      analysis.LoadTemplates(chargeX.templateFFT, chargeX.optimalFilter, "QIX");
+      analysis.LoadTemplates(chargeX.templateFFT, chargeX.optimalFilter, "QOX");
+      analysis.LoadNormalizations(charge.normFFT, charge.sigToNoiseSq, charge.noiseFFTsq, charge.templateMax, "QI");
+      analysis.LoadNormalizations(charge.normFFT, charge.sigToNoiseSq, charge.noiseFFTsq, charge.templateMax, "QO");
+      analysis.LoadQInverse(in.qInverse);
+      analysis.SetSampleTime(1./charge.sampleRate);
+      analysis.SetQxWindows(in.chargeWin1, in.chargeWin2);
+      analysis.LoadChisqThresholds(999999., 999999.);
+      analysis.IsRandom(pulse.isNoise);
+      analysis.SetDelayInterpolateFlag(1);
+
+      timer.Start();
+      analysis.DoCalc(pulse.qiBS, pulse.qoBS);
+      timer.Stop();
+   }
+
+   void BenchOptimalFilterCharge2X2(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+      const ChannelFilter& chargeX = in.chargeX;
+
+      map<string, vector<double> > pulseMap;
+      pulseMap["QI"] = pulse.qiBS;
+      pulseMap["QO"] = pulse.qoBS;
+
+      OptimalFilterCharge2X2 analysis;
+      analysis.SetSampleTime(1./charge.sampleRate);
+      analysis.SetQxWindows(in.chargeWin1, in.chargeWin2);
+      analysis.SetQzWindows(in.chargeZMin, in.chargeZMax);
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QI");
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QO");
+      analysis.LoadTemplates(chargeX.templateFFT, chargeX.optimalFilter, "QIX");
+      analysis.LoadTemplates(chargeX.templateFFT, chargeX.optimalFilter, "QOX");
+      analysis.LoadNormalizations(charge.normFFT, charge.sigToNoiseSq, charge.noiseFFTsq, charge.templateMax, "QI");
+      analysis.LoadNormalizations(charge.normFFT, charge.sigToNoiseSq, charge.noiseFFTsq, charge.templateMax, "QO");
+      analysis.LoadQinverse(in.qInverse, "S");
+      analysis.SetDelayInterpolateFlag(1);
+      analysis.SetZdelayConstraintFlag(1);
+
+      timer.Start();
+      analysis.DoCalc(pulseMap);
+      timer.Stop();
+   }
+
+   //OptimalFilterCharge2X2 of the processing settings (runs OptimalFilterNxN)
+   void BenchOptimalFilterNxN2X2(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+      const ChannelFilter& chargeX = in.chargeX;
+
+      map<string, vector<double> > pulseMap;
+      pulseMap["QI"] = pulse.qiBS;
+      pulseMap["QO"] = pulse.qoBS;
+
+      OptimalFilterNxN analysis;
+      analysis.SetSampleTime(1./charge.sampleRate);
+      analysis.SetXwindows(in.chargeXMin, in.chargeXMax, charge.nBins);
+      analysis.SetZwindows(in.chargeZMin, in.chargeZMax);
+      analysis.SetDelayInterpolateFlag(1);
+      analysis.SetZdelayConstraintFlag(1);
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QI");
+      analysis.LoadTemplates(chargeX.templateFFT, chargeX.optimalFilter, "QIX");
+      analysis.LoadNormalizations(charge.noiseFFTsq, charge.templateMax, "QI");
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QO");
+      analysis.LoadTemplates(chargeX.templateFFT, chargeX.optimalFilter, "QOX");
+      analysis.LoadNormalizations(charge.noiseFFTsq, charge.templateMax, "QO");
+      analysis.LoadWinverse(in.qInverse, "S");
+
+      timer.Start();
+      analysis.DoCalc(pulseMap);
+      timer.Stop();
+   }
+
+   //single charge channel (broken side, or OptimalFilterCharge of the processing settings)
+   void BenchOptimalFilterNxN1X1(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+
+      OptimalFilterNxN analysis("SingleChargePulse");
+      analysis.SetSampleTime(1./charge.sampleRate);
+      analysis.SetXwindows(in.chargeXMin, in.chargeXMax, charge.nBins);
+      analysis.LoadTemplates(charge.templateFFT, charge.optimalFilter, "QI");
+      analysis.LoadNormalizations(charge.sigToNoiseSq, charge.noiseFFTsq, charge.templateMax, "QI");
+      analysis.SetDelayInterpolateFlag(1);
+
+      timer.Start();
+      analysis.DoCalc(pulse.qiBS, "QI");
+      timer.Stop();
+   }
+
+   void BenchF5ChargeX(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      const ChannelFilter& charge = in.charge;
+      const ChannelFilter& chargeX = in.chargeX;
+
+      F5ChargeX analysis;
+      analysis.LoadTemplates(charge.templateTime, chargeX.templateTime, charge.templateTime, chargeX.templateTime,
+			     charge.templateMax, charge.templateMax);
+      analysis.SetSampleRate(charge.sampleRate);
+      analysis.SetGoodQStart(ScaleBins(400, charge.nBins));
+      analysis.SetGoodQEnd(ScaleBins(1000, charge.nBins));
+      analysis.SetNoiseQI(1.e-7);
+      analysis.SetNoiseQO(1.e-7);
+      analysis.SetTemplateStart(charge.preTrigger);
+      analysis.SetSaturationValue(kSaturation);
+      analysis.SetQIStd(pulse.qiStd);
+      analysis.SetQOStd(pulse.qoStd);
+      analysis.SetQIBaseline(pulse.qiBaseline);
+      analysis.SetQOBaseline(pulse.qoBaseline);
+      analysis.SetGainQI(1.);
+      analysis.SetGainQO(1.);
+      analysis.SetOFDelay(0.);
+
+      timer.Start();
+      analysis.DoCalc(pulse.qiRaw, pulse.qoRaw);
+      timer.Stop();
+   }
+
+   //veto settings are in bins of 0.2 us traces, the phonon raw trace stands in for the veto trace
+   void BenchVetoAnalysis(const BenchInputs& in, const BenchPulse& pulse, DoCalcTimer& timer)
+   {
+      VetoAnalysis analysis;
+      analysis.InitializeParameters();
+      analysis.SetVetoTriggerBin(min(max(in.phonon.preTrigger, 300), in.phonon.nBins - 1));
+      analysis.SetVetoSampleTime(0.2);
+      analysis.SetSlopeThresh(16.67);
+      analysis.SetVetoBinToVolts(2.44140625e-3);
+      analysis.SetPreTime(-999999.);
+      analysis.SetBaselineRange((int)kPhononBaseline - 500, (int)kPhononBaseline + 500);
+      analysis.SetTriggerOffset(1.0);
+
+      timer.Start();
+      analysis.DoCalc(pulse.phononRaw);
+      timer.Stop();
+   }
+
+
+   typedef void (*BenchFunction)(const BenchInputs&, const BenchPulse&, DoCalcTimer&);
+
+   struct AlgorithmBench {
+      const char*   name;
+      BenchFunction run;
+      bool          isCharge;     //trace length reported is the charge one
+      int           onlyBins;     //0 = any trace length
+   };
+
+   const AlgorithmBench kAlgorithms[] = {
+      { "BasicPulseCalc",          BenchBasicPulseCalc,          false, 0 },
+      { "VarFreqRTFTWalkPhonon",   BenchVarFreqRTFTWalkPhonon,   false, 0 },
+      { "ConstFreqRTFTWalkPhonon", BenchConstFreqRTFTWalkPhonon, false, 0 },
+      { "RTFTWalkCharge",          BenchRTFTWalkCharge,          true,  0 },
+      { "PulseIntegral",           BenchPulseIntegral,           false, 0 },
+      { "SingleExponentialFit",    BenchSingleExponentialFit,    false, 0 },
+      { "WedgeFitPhonon",          BenchWedgeFitPhonon,          false, 0 },
+      { "InflectionTime",          BenchInflectionTime,          false, 0 },
+      { "PipeFitPhonon",           BenchPipeFitPhonon,           false, kReferenceBins },
+      { "PSDIntegralPhonon",       BenchPSDIntegralPhonon,       false, 0 },
+      { "OptimalFilterPhonon",     BenchOptimalFilterPhonon,     false, 0 },
+      { "OptimalFilterPhonon1X2",  BenchOptimalFilterPhonon1X2,  false, 0 },
+      { "OptimalFilterPhononNS",   BenchOptimalFilterPhononNS,   false, 0 },
+      { "OptimalFilterCharge",     BenchOptimalFilterCharge,     true,  0 },
+      { "OptimalFilterChargeX",    BenchOptimalFilterChargeX,    true,  0 },
+      { "OptimalFilterCharge2X2",  BenchOptimalFilterCharge2X2,  true,  0 },
+      { "OptimalFilterNxN2X2",     BenchOptimalFilterNxN2X2,     true,  0 },
+      { "OptimalFilterNxN1X1",     BenchOptimalFilterNxN1X1,     true,  0 },
+      { "F5ChargeX",               BenchF5ChargeX,               true,  0 },
+      { "VetoAnalysis",            BenchVetoAnalysis,            false, 0 }
+   };
+   const int kNAlgorithms = sizeof(kAlgorithms)/sizeof(kAlgorithms[0]);
+
+   struct BenchResult {
+      string   algorithm;
+      int      nBins;
+      uint64_t nCalls;
+      double   nsPerPulse;
+      double   allocationsPerPulse;
+   };
+
+   //one untimed call first (FFT plans, static tables), then nPulses calls cycling through the pool
+   void RunBenchmarks(const BenchInputs& inputs, const vector<string>& algorithms, int nPulses,
+		      vector<BenchResult>& results)
+   {
+      for(int algoItr = 0; algoItr < kNAlgorithms; algoItr++)
+      {
+	 const AlgorithmBench& bench = kAlgorithms[algoItr];
+	 if(!algorithms.empty() && find(algorithms.begin(), algorithms.end(), bench.name) == algorithms.end())
+	    continue;
+
+	 int nBins = (bench.isCharge ? inputs.charge.nBins : inputs.phonon.nBins);
+	 if(bench.onlyBins > 0 && nBins != bench.onlyBins)
+	 {
+	    cout << setw(26) << bench.name << setw(8) << nBins << "   skipped (only " << bench.onlyBins << " bins)" << endl;
+	    continue;
+	 }
+
+	 DoCalcTimer warmUp;
+	 bench.run(inputs, inputs.pulses[0], warmUp);
+
+	 DoCalcTimer timer;
+	 for(int pulseItr = 0; pulseItr < nPulses; pulseItr++)
+	    bench.run(inputs, inputs.pulses[pulseItr%inputs.pulses.size()], timer);
+
+	 BenchResult result;
+	 result.algorithm = bench.name;
+	 result.nBins = nBins;
+	 result.nCalls = timer.nCalls;
+	 result.nsPerPulse = (timer.nCalls > 0 ? double(timer.totalNs)/timer.nCalls : 0.);
+	 result.allocationsPerPulse = (timer.nCalls > 0 ? double(timer.nAllocations)/timer.nCalls : 0.);
+	 results.push_back(result);
+
+	 cout << setw(26) << result.algorithm << setw(8) << result.nBins << setw(8) << result.nCalls
+	      << setw(14) << fixed << setprecision(0) << result.nsPerPulse
+	      << setw(14) << setprecision(1) << result.allocationsPerPulse << endl;
+      }
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("AnalysisBench [<options>]");
+   cmd.AddCommandSwitch('l',"lengths","Comma separated trace lengths in bins (default 512,1024,...,32768)","list");
+   cmd.AddCommandSwitch('N',"npulses","Timed DoCalc calls per algorithm and length (default 500)","n");
+   cmd.AddCommandSwitch('a',"algorithms","Comma separated algorithms to run (default all)","list");
+   cmd.AddCommandSwitch('o',"csv","CSV file for the results","file");
+   cmd.AddCommandSwitch('A',"snr","Mean pulse amplitude in units of the baseline noise rms (default 30)","sigma");
+   cmd.AddCommandSwitch(' ',"white","White noise sigma in ADC (default 3)","adc");
+   cmd.AddCommandSwitch(' ',"red","Low-pass filtered noise sigma in ADC (default 6)","adc");
+   cmd.AddCommandSwitch(' ',"corner","Corner frequency of the filtered noise in Hz (default 2000)","hz");
+   cmd.AddCommandSwitch('n',"noisefile","BatNoise filter file to take templates and noise from","file");
+   cmd.AddCommandSwitch('D',"det","Detector number in the filter file (default 1)","n");
+   cmd.AddCommandSwitch('P',"phonon","Phonon channel in the filter file (default PAS1)","chan");
+   cmd.AddCommandSwitch('Q',"charge","Charge channel in the filter file (default QIS1)","chan");
+   cmd.AddCommandSwitch(' ',"cov","Read the OptimalFilterPhononNS covariance matrices from the filter file");
+   cmd.AddCommandSwitch('s',"seed","Random seed (default 0)","seed");
+   if(cmd.ProcessCommandLine(argc, argv) != 0)
+      cmd.PrintSwitches();
+
+   int nPulses = (cmd.GetNCallsToOption("npulses") > 0 ? atoi(cmd.GetArgumentCall("npulses")) : 500);
+   double meanSNR = (cmd.GetNCallsToOption("snr") > 0 ? atof(cmd.GetArgumentCall("snr")) : 30.);
+   double white = (cmd.GetNCallsToOption("white") > 0 ? atof(cmd.GetArgumentCall("white")) : 3.);
+   double red = (cmd.GetNCallsToOption("red") > 0 ? atof(cmd.GetArgumentCall("red")) : 6.);
+   double corner = (cmd.GetNCallsToOption("corner") > 0 ? atof(cmd.GetArgumentCall("corner")) : 2000.);
+   if(cmd.GetNCallsToOption("seed") > 0)
+      CounterRNG::SetGlobalSeed(strtoul(cmd.GetArgumentCall("seed"), NULL, 10));
+
+   vector<string> algorithms;
+   if(cmd.GetNCallsToOption("algorithms") > 0)
+      algorithms = SplitList(cmd.GetArgumentCall("algorithms"));
+   for(uint nameItr = 0; nameItr < algorithms.size(); nameItr++)
+   {
+      bool known = false;
+      for(int algoItr = 0; algoItr < kNAlgorithms; algoItr++)
+	 if(algorithms[nameItr] == kAlgorithms[algoItr].name) known = true;
+      if(!known)
+      {
+	 cerr <<"AnalysisBench: ERROR unknown algorithm " << algorithms[nameItr] << ", available:";
+	 for(int algoItr = 0; algoItr < kNAlgorithms; algoItr++)
+	    cerr << " " << kAlgorithms[algoItr].name;
+	 cerr << endl;
+	 exit(1);
+      }
+   }
+
+   if(nPulses < 1)
+   {
+      cerr <<"AnalysisBench: ERROR --npulses must be at least 1" << endl;
+      exit(1);
+   }
+
+   cout <<"AnalysisBench: " << nPulses << " DoCalc calls per algorithm and length, version " << __CB_GIT_VERSION << endl;
+   cout << setw(26) << "algorithm" << setw(8) << "bins" << setw(8) << "calls"
+	<< setw(14) << "ns/pulse" << setw(14) << "allocs/pulse" << endl;
+
+   vector<BenchResult> results;
+
+   if(cmd.GetNCallsToOption("noisefile") > 0)
+   {
+      //templates and filters of one detector, at the length they were built for
+      string noiseFile = cmd.GetArgumentCall("noisefile");
+      int detNum = (cmd.GetNCallsToOption("det") > 0 ? atoi(cmd.GetArgumentCall("det")) : 1);
+      string phononChan = (cmd.GetNCallsToOption("phonon") > 0 ? cmd.GetArgumentCall("phonon") : "PAS1");
+      string chargeChan = (cmd.GetNCallsToOption("charge") > 0 ? cmd.GetArgumentCall("charge") : "QIS1");
+      if(cmd.GetNCallsToOption("lengths") > 0)
+	 cout <<"AnalysisBench: --lengths ignored, the filter file fixes the trace lengths" << endl;
+
+      FilterDataManager filterData;
+      filterData.ReadFile(noiseFile);
+
+      BenchInputs inputs;
+      inputs.phonon = ReadChannelFilter(filterData, detNum, phononChan);
+      inputs.charge = ReadChannelFilter(filterData, detNum, chargeChan);
+
+      bool readCovariance = (cmd.GetNCallsToOption("cov") > 0);
+      BuildInputs(inputs, meanSNR, !readCovariance);
+      if(readCovariance)
+      {
+	 inputs.covPD = filterData.GetCOV_PD(detNum, phononChan);
+	 inputs.covBase = filterData.GetCOV_BASE_HIST(detNum, phononChan);
+      }
+
+      RunBenchmarks(inputs, algorithms, nPulses, results);
+   }
+   else
+   {
+      vector<string> lengthList = SplitList(cmd.GetNCallsToOption("lengths") > 0 ? cmd.GetArgumentCall("lengths") :
+					    "512,1024,2048,4096,8192,16384,32768");
+      TemplateDataManager templateData;
+
+      for(uint lengthItr = 0; lengthItr < lengthList.size(); lengthItr++)
+      {
+	 int nBins = atoi(lengthList[lengthItr].c_str());
+	 if(nBins < 512 || nBins%2)
+	 {
+	    cerr <<"AnalysisBench: ERROR trace lengths must be even and at least 512 bins" << endl;
+	    exit(1);
+	 }
+
+	 BenchInputs inputs;
+	 inputs.phonon = BuildModelFilter(templateData, nBins, kPhononSampleRate, kPhononRiseTime, kPhononFallTime,
+					  ColoredNoiseFFTsq(nBins, kPhononSampleRate, white, red, corner));
+	 inputs.charge = BuildModelFilter(templateData, nBins, kChargeSampleRate, kChargeRiseTime, kChargeFallTime,
+					  ColoredNoiseFFTsq(nBins, kChargeSampleRate, white, red, corner));
+	 BuildInputs(inputs, meanSNR, true);
+
+	 RunBenchmarks(inputs, algorithms, nPulses, results);
+      }
+   }
+
+   if(cmd.GetNCallsToOption("csv") > 0)
+   {
+      string csvFile = cmd.GetArgumentCall("csv");
+      ofstream csv(csvFile.c_str());
+      if(!csv)
+      {
+	 cerr <<"AnalysisBench: ERROR cannot open " << csvFile << endl;
+	 exit(1);
+      }
+      csv << "algorithm,nBins,nCalls,nsPerPulse,allocsPerPulse,version" << endl;
+      for(uint resultItr = 0; resultItr < results.size(); resultItr++)
+	 csv << results[resultItr].algorithm << "," << results[resultItr].nBins << "," << results[resultItr].nCalls << ","
+	     << results[resultItr].nsPerPulse << "," << results[resultItr].allocationsPerPulse << ","
+	     << __CB_GIT_VERSION << endl;
+      cout <<"\nAnalysisBench: results written to " << csvFile << endl;
+   }
+
+   return 0;
+}
@@ -0,0 +1,457 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Throughput benchmark of the processing stages. Runs each
+//             requested stage (BatNoise, BatRoot, BatCalib, ...) as a child
+//             process on one series/dump, measures the wall time and the peak
+//             resident memory of the child, and reports events/s and MB/s of
+//             uncompressed raw data. Every run is appended as one line to a
+//             CSV history file so that changes can be compared to a baseline.
+//             Raw data are typically written with SynthRawGen. With --vary the
+//             stages are run once per combination of processing parameter
+//             values, e.g. to compare output compression settings.
+//
+//Usage: ./BatBench [options] series dump nevents
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include "zlib.h"
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+#include "MidasStructs.h"
+
+using namespace std;
+
+
+namespace {
+
+   struct RawFileInfo {
+      string   path;
+      uint64_t nEvents;
+      uint64_t uncompressedBytes;
+   };
+
+   struct StageResult {
+      string stage;
+      string tag;
+      double wallSec;
+      double maxRSSMB;
+      double outputMB;
+      int    exitCode;
+   };
+
+   //one processing parameter and the values to run with (--vary NAME=v1,v2,...)
+   struct Variation {
+      string         name;
+      vector<string> values;
+   };
+
+   double NowSec()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec*1.e-9;
+   }
+
+   vector<string> SplitList(const string& list)
+   {
+      vector<string> items;
+      stringstream listStream(list);
+      string item;
+      while(getline(listStream, item, ','))
+	 if(!item.empty()) items.push_back(item);
+      return items;
+   }
+
+   //raw file as BatRoot looks for it: <series>_F<dump>(.gz|.mid|.mid.gz) in rawDir
+   string FindRawFile(const string& rawDir, const string& series, const string& dump)
+   {
+      ostringstream baseName;
+      baseName << series << "_F" << setw(4) << setfill('0') << dump;
+
+      const char* extensions[] = { ".gz", ".mid.gz", ".mid", "" };
+      for(int extItr = 0; extItr < 4; extItr++)
+      {
+	 string path = rawDir + "/" + baseName.str() + extensions[extItr];
+	 if(access(path.c_str(), R_OK) == 0) return path;
+      }
+      return "";
+   }
+
+   //walks the event headers once: number of events and uncompressed size
+   bool ScanRawFile(const string& path, RawFileInfo& info)
+   {
+      info.path = path;
+      info.nEvents = 0;
+      info.uncompressedBytes = 0;
+
+      gzFile rawFile = gzopen(path.c_str(), "rb");
+      if(rawFile == NULL) return false;
+      gzbuffer(rawFile, 1024*1024);
+
+      uint32_t fileHeader[2];
+      if(gzread(rawFile, fileHeader, sizeof(fileHeader)) != (int)sizeof(fileHeader))
+      {
+	 gzclose(rawFile);
+	 return false;
+      }
+
+      if(fileHeader[0] == 0x01020304)
+      {
+	 //Soudan: optional detector config record, then [event header, length] + data
+	 uint32_t header[2];
+	 while(gzread(rawFile, header, sizeof(header)) == (int)sizeof(header))
+	 {
+	    if(header[0] >> 16 == 0xa980) info.nEvents++;
+	    if(gzseek(rawFile, header[1], SEEK_CUR) < 0) break;
+	 }
+      }
+      else
+      {
+	 //midas: every event except begin / end of run
+	 gzrewind(rawFile);
+	 TMidas_EVENT_HEADER header;
+	 while(gzread(rawFile, &header, sizeof(header)) == (int)sizeof(header))
+	 {
+	    if(header.fEventId != 0x8000 && header.fEventId != 0x8001) info.nEvents++;
+	    if(gzseek(rawFile, header.fDataSize, SEEK_CUR) < 0) break;
+	 }
+      }
+
+      info.uncompressedBytes = gztell(rawFile);
+      gzclose(rawFile);
+      return true;
+   }
+
+   //runs one stage with the BatRoot-style command line, output goes to the terminal
+   StageResult RunStage(const string& binDir, const string& stage, const vector<string>& stageArgs)
+   {
+      StageResult result;
+      result.stage = stage;
+      result.wallSec = 0.;
+      result.maxRSSMB = 0.;
+      result.outputMB = 0.;
+      result.exitCode = -1;
+
+      string executable = (binDir.empty() ? stage : binDir + "/" + stage);
+
+      vector<char*> argv;
+      argv.push_back(const_cast<char*>(executable.c_str()));
+      for(uint argItr = 0; argItr < stageArgs.size(); argItr++)
+	 argv.push_back(const_cast<char*>(stageArgs[argItr].c_str()));
+      argv.push_back(NULL);
+
+      double startSec = NowSec();
+      pid_t pid = fork();
+      if(pid < 0)
+      {
+	 cerr <<"BatBench: ERROR could not fork for " << stage << endl;
+	 return result;
+      }
+      if(pid == 0)
+      {
+	 execvp(argv[0], &argv[0]);
+	 cerr <<"BatBench: ERROR could not run " << executable << ": " << strerror(errno) << endl;
+	 _exit(127);
+      }
+
+      int status = 0;
+      struct rusage usage;
+      memset(&usage, 0, sizeof(usage));
+      if(wait4(pid, &status, 0, &usage) < 0)
+      {
+	 cerr <<"BatBench: ERROR waiting for " << stage << endl;
+	 return result;
+      }
+
+      result.wallSec = NowSec() - startSec;
+      result.maxRSSMB = usage.ru_maxrss/1024.;   //kB on linux
+      result.exitCode = (WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status));
+      return result;
+   }
+
+   //size of the .root files written to outDir since startTime (the RQ output of the stage)
+   double NewOutputMB(const string& outDir, time_t startTime)
+   {
+      double outputMB = 0.;
+      DIR* dir = opendir(outDir.c_str());
+      if(dir == NULL) return 0.;
+      struct dirent* entry;
+      while((entry = readdir(dir)) != NULL)
+      {
+	 string name = entry->d_name;
+	 if(name.size() < 5 || name.compare(name.size()-5, 5, ".root") != 0) continue;
+	 struct stat fileStat;
+	 if(stat((outDir + "/" + name).c_str(), &fileStat) == 0 && fileStat.st_mtime >= startTime)
+	    outputMB += fileStat.st_size/1.e6;
+      }
+      closedir(dir);
+      return outputMB;
+   }
+
+   //processing directory as BatRoot looks it up
+   string ProcessingDir()
+   {
+      if(getenv("BATROOT_PROC")) return getenv("BATROOT_PROC");
+      return string(getenv("CDMSBATSDIR") ? getenv("CDMSBATSDIR") : "./") + "/UserSettings/BatRootSettings/processing";
+   }
+
+   //copy of the processing file with the parameters set: an existing "PARAMETER_<type> NAME = ..."
+   //line gets the new value, otherwise the parameter is appended
+   bool WriteVariantOptions(const string& baseFile, const string& variantFile,
+			    const vector< pair<string,string> >& parameters)
+   {
+      ifstream in(baseFile.c_str());
+      ofstream out(variantFile.c_str());
+      if(!in || !out) return false;
+
+      vector<bool> found(parameters.size(), false);
+      string line;
+      while(getline(in, line))
+      {
+	 stringstream lineStream(line);
+	 string keyType, key;
+	 lineStream >> keyType >> key;
+	 for(uint parItr = 0; parItr < parameters.size(); parItr++)
+	    if(keyType.compare(0, 10, "PARAMETER_") == 0 && key == parameters[parItr].first)
+	    {
+	       line = keyType + "\t" + key + "\t=\t" + parameters[parItr].second;
+	       found[parItr] = true;
+	    }
+	 out << line << endl;
+      }
+
+      out << "\n# BatBench variant" << endl;
+      for(uint parItr = 0; parItr < parameters.size(); parItr++)
+      {
+	 if(found[parItr]) continue;
+	 const string& value = parameters[parItr].second;
+	 const char* keyType = "PARAMETER_STRING";
+	 char* end;
+	 strtol(value.c_str(), &end, 10);
+	 if(*end == 0) keyType = "PARAMETER_INTEGER";
+	 else
+	 {
+	    strtod(value.c_str(), &end);
+	    if(*end == 0) keyType = "PARAMETER_DOUBLE";
+	 }
+	 out << keyType << "\t" << parameters[parItr].first << "\t=\t" << value << endl;
+      }
+      return true;
+   }
+
+   string CurrentDate()
+   {
+      time_t now = time(NULL);
+      char buffer[32];
+      strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+      return buffer;
+   }
+
+   string HostName()
+   {
+      char buffer[256];
+      if(gethostname(buffer, sizeof(buffer)) != 0) return "unknown";
+      buffer[sizeof(buffer)-1] = 0;
+      return buffer;
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("BatBench [<options>] <series> <dump> <nevents>");
+   cmd.AddCommandSwitch('S',"stages","Comma separated stages to run (default BatNoise,BatRoot)","list");
+   cmd.AddCommandSwitch('o',"options","Processing options file passed to every stage","file");
+   cmd.AddCommandSwitch('c',"config","Analysis config file passed to every stage","file");
+   cmd.AddCommandSwitch('b',"bindir","Directory of the stage executables (default: PATH)","dir");
+   cmd.AddCommandSwitch('H',"history","CSV history file to append to (default BatBench_history.csv)","file");
+   cmd.AddCommandSwitch('t',"tag","Label stored with the results, e.g. the change being measured","tag");
+   cmd.AddCommandSwitch('V',"vary","Run once per value of a processing parameter (repeatable, all combinations)","NAME=v1,v2");
+   if(cmd.ProcessCommandLine(argc, argv) != 3)
+      cmd.PrintSwitches();
+
+   string series = cmd.GetCommandArg(0);
+   string dump = cmd.GetCommandArg(1);
+   long nEventsRequested = atol(cmd.GetCommandArg(2));
+
+   vector<string> stages = SplitList(cmd.GetNCallsToOption("stages") > 0 ? cmd.GetArgumentCall("stages") : "BatNoise,BatRoot");
+   string binDir = (cmd.GetNCallsToOption("bindir") > 0 ? cmd.GetArgumentCall("bindir") : "");
+   string historyFile = (cmd.GetNCallsToOption("history") > 0 ? cmd.GetArgumentCall("history") : "BatBench_history.csv");
+   string tag = (cmd.GetNCallsToOption("tag") > 0 ? cmd.GetArgumentCall("tag") : "");
+
+   //raw input, for the event count and the byte rate
+   string rawDir = (getenv("BATROOT_RAWDATA") ? getenv("BATROOT_RAWDATA") : ".");
+   string rawPath = FindRawFile(rawDir, series, dump);
+   RawFileInfo rawInfo;
+   if(rawPath.empty() || !ScanRawFile(rawPath, rawInfo))
+   {
+      cerr <<"BatBench: ERROR cannot find or read raw file for " << series << " dump " << dump
+	   <<" in " << rawDir << " (BATROOT_RAWDATA)" << endl;
+      exit(1);
+   }
+
+   //nevents <= 0 means the whole file
+   uint64_t nEvents = rawInfo.nEvents;
+   if(nEventsRequested > 0 && (uint64_t)nEventsRequested < nEvents) nEvents = nEventsRequested;
+   double rawMB = rawInfo.uncompressedBytes/1.e6*(rawInfo.nEvents > 0 ? double(nEvents)/rawInfo.nEvents : 0.);
+
+   cout <<"BatBench: " << rawInfo.path << ": " << rawInfo.nEvents << " events, "
+	<< rawInfo.uncompressedBytes/1.e6 << " MB uncompressed, benchmarking " << nEvents << " events" << endl;
+
+   //stage command line: series dump nevents [processingOptions [analysisConfig]]
+   vector<string> stageArgs;
+   stageArgs.push_back(series);
+   stageArgs.push_back(dump);
+   ostringstream nEventsArg;
+   nEventsArg << nEvents;
+   stageArgs.push_back(nEventsArg.str());
+   if(cmd.GetNCallsToOption("options") > 0)
+      stageArgs.push_back(cmd.GetArgumentCall("options"));
+   if(cmd.GetNCallsToOption("config") > 0)
+   {
+      if(cmd.GetNCallsToOption("options") == 0)
+      {
+	 cerr <<"BatBench: ERROR --config needs --options (positional stage arguments)" << endl;
+	 exit(1);
+      }
+      stageArgs.push_back(cmd.GetArgumentCall("config"));
+   }
+
+   //--vary: every combination of the values, each run with its own copy of the processing file
+   vector<Variation> variations;
+   for(int varyItr = 0; varyItr < cmd.GetNCallsToOption("vary"); varyItr++)
+   {
+      string vary = cmd.GetArgumentCall("vary", varyItr);
+      size_t equals = vary.find('=');
+      Variation variation;
+      if(equals != string::npos)
+      {
+	 variation.name = vary.substr(0, equals);
+	 variation.values = SplitList(vary.substr(equals+1));
+      }
+      if(variation.name.empty() || variation.values.empty())
+      {
+	 cerr <<"BatBench: ERROR --vary expects NAME=value1,value2,... got " << vary << endl;
+	 exit(1);
+      }
+      variations.push_back(variation);
+   }
+   if(!variations.empty() && cmd.GetNCallsToOption("options") == 0)
+   {
+      cerr <<"BatBench: ERROR --vary needs the --options processing file to vary" << endl;
+      exit(1);
+   }
+
+   uint nVariants = 1;
+   for(uint varItr = 0; varItr < variations.size(); varItr++)
+      nVariants *= variations[varItr].values.size();
+
+   string rqDir = (getenv("BATROOT_RQDATA") ? getenv("BATROOT_RQDATA") : ".");
+   vector<StageResult> results;
+   for(uint variantItr = 0; variantItr < nVariants; variantItr++)
+   {
+      vector<string> variantArgs = stageArgs;
+      string variantTag = tag;
+      string variantFile;
+      if(!variations.empty())
+      {
+	 vector< pair<string,string> > parameters;
+	 uint index = variantItr;
+	 for(uint varItr = 0; varItr < variations.size(); varItr++)
+	 {
+	    const Variation& variation = variations[varItr];
+	    parameters.push_back(make_pair(variation.name, variation.values[index % variation.values.size()]));
+	    index /= variation.values.size();
+	    variantTag += (variantTag.empty() ? "" : " ") + variation.name + "=" + parameters.back().second;
+	 }
+
+	 //the stages only take a file name in the processing directory
+	 ostringstream variantName;
+	 variantName << ".BatBench_" << getpid() << "_" << variantItr << "_" << stageArgs[3];
+	 variantFile = ProcessingDir() + "/" + variantName.str();
+	 if(!WriteVariantOptions(ProcessingDir() + "/" + stageArgs[3], variantFile, parameters))
+	 {
+	    cerr <<"BatBench: ERROR cannot write " << variantFile << " from " << stageArgs[3]
+		 <<" in " << ProcessingDir() << endl;
+	    exit(1);
+	 }
+	 variantArgs[3] = variantName.str();
+      }
+
+      for(uint stageItr = 0; stageItr < stages.size(); stageItr++)
+      {
+	 cout <<"\nBatBench: ===== running " << stages[stageItr]
+	      << (variations.empty() ? "" : " (" + variantTag + ")") << " =====" << endl;
+	 time_t startTime = time(NULL);
+	 StageResult result = RunStage(binDir, stages[stageItr], variantArgs);
+	 result.tag = variantTag;
+	 result.outputMB = NewOutputMB(rqDir, startTime);
+	 results.push_back(result);
+      }
+
+      if(!variantFile.empty()) unlink(variantFile.c_str());
+   }
+
+   //summary, and one history line per stage
+   bool newHistory = (access(historyFile.c_str(), F_OK) != 0);
+   ofstream history(historyFile.c_str(), ios::app);
+   if(!history)
+   {
+      cerr <<"BatBench: ERROR cannot open history file " << historyFile << endl;
+      exit(1);
+   }
+   if(newHistory)
+      history << "date,host,tag,version,stage,series,dump,nEvents,rawMB,wallSec,eventsPerSec,MBPerSec,maxRSSMB,exitCode,outputMB" << endl;
+
+   string date = CurrentDate();
+   string host = HostName();
+   bool allGood = true;
+
+   cout <<"\nBatBench summary (" << tag << ")" << endl;
+   cout << setw(12) << "stage" << setw(12) << "wall [s]" << setw(12) << "events/s"
+	<< setw(12) << "MB/s" << setw(14) << "peak RSS [MB]" << setw(8) << "exit"
+	<< setw(12) << "out [MB]" << (variations.empty() ? "" : "  variant") << endl;
+
+   for(uint resultItr = 0; resultItr < results.size(); resultItr++)
+   {
+      const StageResult& result = results[resultItr];
+      double eventsPerSec = (result.wallSec > 0. ? nEvents/result.wallSec : 0.);
+      double mbPerSec = (result.wallSec > 0. ? rawMB/result.wallSec : 0.);
+      if(result.exitCode != 0) allGood = false;
+
+      cout << setw(12) << result.stage << setw(12) << fixed << setprecision(2) << result.wallSec
+	   << setw(12) << eventsPerSec << setw(12) << mbPerSec << setw(14) << result.maxRSSMB
+	   << setw(8) << result.exitCode << setw(12) << result.outputMB
+	   << (variations.empty() ? "" : "  " + result.tag) << endl;
+
+      history << date << "," << host << "," << result.tag << "," << __CB_GIT_VERSION << ","
+	      << result.stage << "," << series << "," << dump << "," << nEvents << ","
+	      << rawMB << "," << result.wallSec << "," << eventsPerSec << "," << mbPerSec << ","
+	      << result.maxRSSMB << "," << result.exitCode << "," << result.outputMB << endl;
+   }
+
+   cout <<"\nBatBench: results appended to " << historyFile << endl;
+
+   return (allGood ? 0 : 1);
+}
@@ -0,0 +1,188 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Decompression benchmark of the raw data backends (RawInflater,
+//             BatRoot/BatNoise RAW_INFLATE_BACKEND). Opens each file with
+//             each backend, reads it to the end in 1 MB chunks and reports
+//             the time, the MB/s of decompressed data and the number of gzip
+//             members. The crc32 of the data read is compared between the
+//             backends, so a backend which reads a file differently fails.
+//
+//Usage: ./InflateBench [options] file [file ...]
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+#include "RawInflater.h"
+
+#include "zlib.h"
+
+using namespace std;
+
+
+namespace {
+
+   struct Result {
+      string   backend;
+      double   openSec;     //best of the repeats
+      double   totalSec;    //open and read, best of the repeats
+      double   outMB;
+      int      nMembers;
+      uLong    crc;
+   };
+
+   double NowSec()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec*1.e-9;
+   }
+
+   vector<string> SplitList(const string& list)
+   {
+      vector<string> items;
+      stringstream listStream(list);
+      string item;
+      while(getline(listStream, item, ','))
+	 if(!item.empty()) items.push_back(item);
+      return items;
+   }
+
+   //one open and read of the whole file
+   void RunOnce(const string& fileName, const string& backend, int nThreads, Result& result, bool first)
+   {
+      vector<char> chunk(1024*1024);
+
+      double startSec = NowSec();
+      RawInflater* inflater = RawInflater::Create(backend, nThreads);
+      if(!inflater->Open(fileName))
+      {
+	 cerr <<"InflateBench: ERROR cannot read " << fileName << " with " << backend << endl;
+	 exit(1);
+      }
+      double openSec = NowSec() - startSec;
+
+      uLong crc = crc32(0L, Z_NULL, 0);
+      double nBytes = 0.;
+      int readCheck;
+      while((readCheck = inflater->Read(&chunk[0], chunk.size())) > 0)
+      {
+	 crc = crc32(crc, (const Bytef*)&chunk[0], readCheck);
+	 nBytes += readCheck;
+      }
+      if(readCheck < 0)
+      {
+	 cerr <<"InflateBench: ERROR reading " << fileName << " with " << backend << endl;
+	 exit(1);
+      }
+      double totalSec = NowSec() - startSec;
+
+      LibdeflateInflater* libdeflate = dynamic_cast<LibdeflateInflater*>(inflater);
+      result.nMembers = (libdeflate != NULL ? libdeflate->GetNMembers() : -1);
+      delete inflater;
+
+      if(first || totalSec < result.totalSec)
+      {
+	 result.openSec = openSec;
+	 result.totalSec = totalSec;
+      }
+      result.outMB = nBytes/1.e6;
+      result.crc = crc;
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("InflateBench [<options>] <raw file> [<raw file> ...]");
+   cmd.AddCommandSwitch('b',"backends","Comma separated backends (default zlib,libdeflate if built with it)","list");
+   cmd.AddCommandSwitch('t',"threads","Decode threads of libdeflate (default 0 = number of cpus)","n");
+   cmd.AddCommandSwitch('r',"repeats","Runs per file and backend, the fastest is reported (default 3)","n");
+   cmd.AddCommandSwitch('o',"csv","CSV file to append the results to","file");
+   if(cmd.ProcessCommandLine(argc, argv) < 1)
+      cmd.PrintSwitches();
+
+   string defaultBackends = (RawInflater::IsAvailable("libdeflate") ? "zlib,libdeflate" : "zlib");
+   vector<string> backends = SplitList(cmd.GetNCallsToOption("backends") > 0 ? cmd.GetArgumentCall("backends") : defaultBackends);
+   int nThreads = (cmd.GetNCallsToOption("threads") > 0 ? atoi(cmd.GetArgumentCall("threads")) : 0);
+   int nRepeats = (cmd.GetNCallsToOption("repeats") > 0 ? atoi(cmd.GetArgumentCall("repeats")) : 3);
+   if(nRepeats < 1) nRepeats = 1;
+
+   for(uint backItr = 0; backItr < backends.size(); backItr++)
+      if(!RawInflater::IsAvailable(backends[backItr]))
+      {
+	 cerr <<"InflateBench: ERROR backend " << backends[backItr] << " is not available in this build" << endl;
+	 exit(1);
+      }
+
+   ofstream csv;
+   if(cmd.GetNCallsToOption("csv") > 0)
+   {
+      string csvFile = cmd.GetArgumentCall("csv");
+      bool newFile = (access(csvFile.c_str(), F_OK) != 0);
+      csv.open(csvFile.c_str(), ios::app);
+      if(!csv)
+      {
+	 cerr <<"InflateBench: ERROR cannot open " << csvFile << endl;
+	 exit(1);
+      }
+      if(newFile)
+	 csv << "file,backend,threads,nMembers,outMB,openSec,totalSec,MBperSec,version" << endl;
+   }
+
+   bool allMatch = true;
+   for(int fileItr = 0; fileItr < cmd.GetNCommandArgs(); fileItr++)
+   {
+      string fileName = cmd.GetCommandArg(fileItr);
+
+      vector<Result> results(backends.size());
+      for(uint backItr = 0; backItr < backends.size(); backItr++)
+      {
+	 results[backItr].backend = backends[backItr];
+	 for(int repItr = 0; repItr < nRepeats; repItr++)
+	    RunOnce(fileName, backends[backItr], nThreads, results[backItr], repItr == 0);
+      }
+
+      cout <<"\nInflateBench: " << fileName << endl;
+      cout << setw(12) << "backend" << setw(10) << "members" << setw(12) << "size [MB]" << setw(12) << "open [s]"
+	   << setw(12) << "total [s]" << setw(10) << "MB/s" << setw(12) << "crc32" << endl;
+      for(uint backItr = 0; backItr < results.size(); backItr++)
+      {
+	 const Result& result = results[backItr];
+	 double rate = result.outMB/max(result.totalSec, 1.e-9);
+	 bool match = (result.crc == results[0].crc && result.outMB == results[0].outMB);
+	 allMatch = allMatch && match;
+	 cout << setw(12) << result.backend << setw(10);
+	 if(result.nMembers >= 0) cout << result.nMembers;
+	 else cout << "-";
+	 cout << fixed << setprecision(3) << setw(12) << result.outMB << setw(12) << result.openSec
+	      << setw(12) << result.totalSec << setw(10) << setprecision(1) << rate
+	      << setw(12) << hex << result.crc << dec << (match ? "" : "  MISMATCH") << endl;
+
+	 if(csv.is_open())
+	    csv << fileName << "," << result.backend << "," << nThreads << "," << result.nMembers << ","
+		<< result.outMB << "," << result.openSec << "," << result.totalSec << "," << rate << ","
+		<< __CB_GIT_VERSION << endl;
+      }
+   }
+
+   if(!allMatch)
+   {
+      cerr <<"InflateBench: ERROR the backends read different data" << endl;
+      return 1;
+   }
+   return 0;
+}
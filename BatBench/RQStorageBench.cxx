@@ -0,0 +1,345 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Storage benchmark of the RQ precision policy. Rewrites the rqDir
+//             trees of a BatRoot output file twice, once with every RQ as a
+//             double (the default layout) and once with the storage types of
+//             a precision file (RQPrecisionPolicy), and reports for both the
+//             file size, the write time, the time to read all RQs and the
+//             time to read a few selected RQs. For the policy it also lists
+//             the RQs with the largest relative loss of precision.
+//
+//Usage: ./RQStorageBench [options] file
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//ROOT Libraries
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TClass.h"
+#include "TKey.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include "TError.h"
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+#include "RQPrecisionPolicy.h"
+
+using namespace std;
+
+
+namespace {
+
+   //sum of everything read, so that the reads are not optimized away
+   volatile double gChecksum = 0.;
+
+   //one RQ of one tree as it is copied
+   struct Column {
+      string      name;
+      TLeaf*      inLeaf;
+      RQPrecision precision;
+      RQValue     value;
+      double      maxRelLoss;
+      double      maxAbsLoss;
+   };
+
+   struct Variant {
+      string name;
+      string fileName;
+      double fileMB;
+      double writeSec;
+      double readAllSec;
+      double readSelectedSec;
+      long   nEntries;
+   };
+
+   double NowSec()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec*1.e-9;
+   }
+
+   vector<string> SplitList(const string& list)
+   {
+      vector<string> items;
+      stringstream listStream(list);
+      string item;
+      while(getline(listStream, item, ','))
+	 if(!item.empty()) items.push_back(item);
+      return items;
+   }
+
+   double FileMB(const string& fileName)
+   {
+      struct stat fileStat;
+      return (stat(fileName.c_str(), &fileStat) == 0 ? fileStat.st_size/1.e6 : 0.);
+   }
+
+   vector<string> ListTrees(TDirectory* dir)
+   {
+      set<string> names;
+      TIter next(dir->GetListOfKeys());
+      TKey* key;
+      while((key = (TKey*)next()))
+      {
+	 TClass* keyClass = TClass::GetClass(key->GetClassName());
+	 if(keyClass != NULL && keyClass->InheritsFrom(TTree::Class()))
+	    names.insert(key->GetName());
+      }
+      return vector<string>(names.begin(), names.end());
+   }
+
+   //copies all rqDir trees, every leaf converted as the policy says
+   void WriteVariant(TDirectory* inDir, const vector<string>& treeNames, const RQPrecisionPolicy& policy,
+		     int compression, Variant& variant, vector<Column>& lossColumns)
+   {
+      double startSec = NowSec();
+      TFile* outFile = TFile::Open(variant.fileName.c_str(), "recreate");
+      if(outFile == NULL || outFile->IsZombie())
+      {
+	 cerr <<"RQStorageBench: ERROR cannot create " << variant.fileName << endl;
+	 exit(1);
+      }
+      outFile->SetCompressionSettings(compression);
+      TDirectory* outDir = outFile->mkdir("rqDir");
+
+      variant.nEntries = 0;
+      double lossSec = 0.;   //not part of the write time
+      for(uint treeItr = 0; treeItr < treeNames.size(); treeItr++)
+      {
+	 TTree* inTree = (TTree*)inDir->Get(treeNames[treeItr].c_str());
+	 outDir->cd();
+	 TTree* outTree = new TTree(inTree->GetName(), inTree->GetTitle());
+
+	 TObjArray* leaves = inTree->GetListOfLeaves();
+	 vector<Column> columns(leaves->GetEntriesFast());
+	 for(uint colItr = 0; colItr < columns.size(); colItr++)
+	 {
+	    Column& column = columns[colItr];
+	    column.inLeaf = (TLeaf*)leaves->At(colItr);
+	    column.name = treeNames[treeItr] + "/" + column.inLeaf->GetName();
+	    column.precision = policy.GetPrecision(treeNames[treeItr], column.inLeaf->GetName());
+	    column.maxRelLoss = column.maxAbsLoss = 0.;
+	    outTree->Branch(column.inLeaf->GetName(), &column.value,
+			    (string(column.inLeaf->GetName()) + "/" + column.precision.GetLeafType()).c_str());
+	 }
+
+	 for(long entry = 0; entry < inTree->GetEntries(); entry++)
+	 {
+	    inTree->GetEntry(entry);
+	    for(uint colItr = 0; colItr < columns.size(); colItr++)
+	       columns[colItr].precision.Convert(columns[colItr].inLeaf->GetValue(0), &columns[colItr].value);
+	    outTree->Fill();
+	 }
+	 variant.nEntries += inTree->GetEntries();
+
+	 outTree->Write();
+
+	 //precision loss: what is read back against the input
+	 double lossStartSec = NowSec();
+	 for(long entry = 0; entry < inTree->GetEntries(); entry++)
+	 {
+	    inTree->GetEntry(entry);
+	    outTree->GetEntry(entry);
+	    TObjArray* outLeaves = outTree->GetListOfLeaves();
+	    for(uint colItr = 0; colItr < columns.size(); colItr++)
+	    {
+	       double in = columns[colItr].inLeaf->GetValue(0);
+	       double out = ((TLeaf*)outLeaves->At(colItr))->GetValue(0);
+	       if(std::isnan(in) && std::isnan(out)) continue;
+	       double absLoss = fabs(in - out);
+	       double relLoss = (in != 0. ? absLoss/fabs(in) : absLoss);
+	       if(!(absLoss <= columns[colItr].maxAbsLoss)) columns[colItr].maxAbsLoss = absLoss;
+	       if(!(relLoss <= columns[colItr].maxRelLoss)) columns[colItr].maxRelLoss = relLoss;
+	    }
+	 }
+	 for(uint colItr = 0; colItr < columns.size(); colItr++)
+	    if(columns[colItr].precision.type != RQPrecision::kDouble)
+	       lossColumns.push_back(columns[colItr]);
+	 lossSec += NowSec() - lossStartSec;
+
+	 delete outTree;
+	 delete inTree;
+      }
+
+      outFile->Close();
+      delete outFile;
+      variant.writeSec = NowSec() - startSec - lossSec;
+      variant.fileMB = FileMB(variant.fileName);
+   }
+
+   //all RQs, or only those in selected (tree/RQ names or bare RQ names)
+   double ReadVariant(const Variant& variant, const vector<string>& treeNames, const vector<string>& selected)
+   {
+      double startSec = NowSec();
+      TFile* file = TFile::Open(variant.fileName.c_str(), "READ");
+      TDirectory* dir = file->GetDirectory("rqDir");
+
+      for(uint treeItr = 0; treeItr < treeNames.size(); treeItr++)
+      {
+	 TTree* tree = (TTree*)dir->Get(treeNames[treeItr].c_str());
+	 vector<TBranch*> branches;
+	 TObjArray* leaves = tree->GetListOfLeaves();
+	 for(int leafItr = 0; leafItr < leaves->GetEntriesFast(); leafItr++)
+	 {
+	    TLeaf* leaf = (TLeaf*)leaves->At(leafItr);
+	    string leafName = leaf->GetName();
+	    if(!selected.empty() &&
+	       find(selected.begin(), selected.end(), leafName) == selected.end() &&
+	       find(selected.begin(), selected.end(), treeNames[treeItr] + "/" + leafName) == selected.end())
+	       continue;
+	    branches.push_back(leaf->GetBranch());
+	 }
+	 if(branches.empty())
+	 {
+	    delete tree;
+	    continue;
+	 }
+
+	 tree->SetCacheSize(32*1024*1024);
+	 for(uint brItr = 0; brItr < branches.size(); brItr++)
+	    tree->AddBranchToCache(branches[brItr], true);
+	 tree->StopCacheLearningPhase();
+
+	 for(long entry = 0; entry < tree->GetEntries(); entry++)
+	    for(uint brItr = 0; brItr < branches.size(); brItr++)
+	    {
+	       branches[brItr]->GetEntry(entry);
+	       gChecksum += ((TLeaf*)branches[brItr]->GetListOfLeaves()->At(0))->GetValue(0);
+	    }
+	 delete tree;
+      }
+
+      file->Close();
+      delete file;
+      return NowSec() - startSec;
+   }
+
+   bool ByRelLoss(const Column& a, const Column& b)
+   {
+      return a.maxRelLoss > b.maxRelLoss;
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("RQStorageBench [<options>] <BatRoot output file>");
+   cmd.AddCommandSwitch('p',"precision","Precision file (default rqPrecision.Default)","file");
+   cmd.AddCommandSwitch('r',"read","Comma separated RQs for the selective read (default PTOFamps,PTOFchisq,PTOFdelay)","list");
+   cmd.AddCommandSwitch('z',"compression","ROOT compression settings of the copies (default 101)","n");
+   cmd.AddCommandSwitch('d',"dir","Directory for the copies (default .)","dir");
+   cmd.AddCommandSwitch('n',"nworst","Number of RQs with the largest precision loss to list (default 20)","n");
+   cmd.AddCommandSwitch('o',"csv","CSV file to append the results to","file");
+   cmd.AddCommandSwitch('k',"keep","Keep the copies");
+   if(cmd.ProcessCommandLine(argc, argv) != 1)
+      cmd.PrintSwitches();
+
+   string inFileName = cmd.GetCommandArg(0);
+   string precisionFile = (cmd.GetNCallsToOption("precision") > 0 ? cmd.GetArgumentCall("precision") : "rqPrecision.Default");
+   vector<string> selected = SplitList(cmd.GetNCallsToOption("read") > 0 ? cmd.GetArgumentCall("read") : "PTOFamps,PTOFchisq,PTOFdelay");
+   int compression = (cmd.GetNCallsToOption("compression") > 0 ? atoi(cmd.GetArgumentCall("compression")) : 101);
+   string outDir = (cmd.GetNCallsToOption("dir") > 0 ? cmd.GetArgumentCall("dir") : ".");
+   uint nWorst = (cmd.GetNCallsToOption("nworst") > 0 ? atoi(cmd.GetArgumentCall("nworst")) : 20);
+
+   gErrorIgnoreLevel = kError;
+
+   TFile* inFile = TFile::Open(inFileName.c_str(), "READ");
+   if(inFile == NULL || inFile->IsZombie() || inFile->GetDirectory("rqDir") == NULL)
+   {
+      cerr <<"RQStorageBench: ERROR cannot read rqDir of " << inFileName << endl;
+      exit(1);
+   }
+   TDirectory* inDir = inFile->GetDirectory("rqDir");
+   vector<string> treeNames = ListTrees(inDir);
+
+   RQPrecisionPolicy doublePolicy;
+   RQPrecisionPolicy policy;
+   policy.ReadFile(precisionFile);
+
+   Variant variants[2];
+   variants[0].name = "double";
+   variants[1].name = "policy";
+   vector<Column> lossColumns;
+   for(int varItr = 0; varItr < 2; varItr++)
+   {
+      variants[varItr].fileName = outDir + "/RQStorageBench_" + variants[varItr].name + ".root";
+      vector<Column> ignored;
+      WriteVariant(inDir, treeNames, (varItr == 0 ? doublePolicy : policy), compression, variants[varItr],
+		   (varItr == 0 ? ignored : lossColumns));
+   }
+   inFile->Close();
+
+   //read twice and keep the second, so that both variants come from the page cache
+   for(int varItr = 0; varItr < 2; varItr++)
+   {
+      ReadVariant(variants[varItr], treeNames, vector<string>());
+      variants[varItr].readAllSec = ReadVariant(variants[varItr], treeNames, vector<string>());
+      variants[varItr].readSelectedSec = ReadVariant(variants[varItr], treeNames, selected);
+   }
+
+   cout <<"\nRQStorageBench: " << inFileName << ", " << treeNames.size() << " trees, "
+	<< variants[0].nEntries << " tree entries, precision file " << policy.GetFileName() << endl;
+   cout << setw(10) << "variant" << setw(12) << "size [MB]" << setw(12) << "write [s]"
+	<< setw(14) << "read all [s]" << setw(14) << "read sel [s]" << setw(10) << "size" << endl;
+   for(int varItr = 0; varItr < 2; varItr++)
+      cout << setw(10) << variants[varItr].name << fixed << setprecision(3)
+	   << setw(12) << variants[varItr].fileMB << setw(12) << variants[varItr].writeSec
+	   << setw(14) << variants[varItr].readAllSec << setw(14) << variants[varItr].readSelectedSec
+	   << setw(9) << setprecision(1) << 100.*variants[varItr].fileMB/max(variants[0].fileMB, 1.e-9) << "%" << endl;
+
+   sort(lossColumns.begin(), lossColumns.end(), ByRelLoss);
+   cout <<"\nLargest precision loss (of " << lossColumns.size() << " converted RQs):" << endl;
+   cout << left << setw(40) << "RQ" << right << setw(24) << "type" << setw(14) << "max |A-B|"
+	<< setw(14) << "max rel" << endl;
+   cout << scientific << setprecision(3);
+   for(uint colItr = 0; colItr < lossColumns.size() && colItr < nWorst; colItr++)
+      cout << left << setw(40) << lossColumns[colItr].name << right
+	   << setw(24) << RQPrecision::GetTypeName(lossColumns[colItr].precision.type)
+	   << setw(14) << lossColumns[colItr].maxAbsLoss << setw(14) << lossColumns[colItr].maxRelLoss << endl;
+
+   if(cmd.GetNCallsToOption("csv") > 0)
+   {
+      string csvFile = cmd.GetArgumentCall("csv");
+      bool newFile = (access(csvFile.c_str(), F_OK) != 0);
+      ofstream csv(csvFile.c_str(), ios::app);
+      if(!csv)
+      {
+	 cerr <<"RQStorageBench: ERROR cannot open " << csvFile << endl;
+	 exit(1);
+      }
+      if(newFile)
+	 csv << "file,precisionFile,compression,variant,fileMB,writeSec,readAllSec,readSelectedSec,version" << endl;
+      for(int varItr = 0; varItr < 2; varItr++)
+	 csv << inFileName << "," << policy.GetFileName() << "," << compression << "," << variants[varItr].name << ","
+	     << variants[varItr].fileMB << "," << variants[varItr].writeSec << "," << variants[varItr].readAllSec << ","
+	     << variants[varItr].readSelectedSec << "," << __CB_GIT_VERSION << endl;
+   }
+
+   if(cmd.GetNCallsToOption("keep") == 0)
+      for(int varItr = 0; varItr < 2; varItr++)
+	 unlink(variants[varItr].fileName.c_str());
+
+   return 0;
+}
@@ -0,0 +1,473 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: SynthDataGenerator
+//Description:  Synthetic Soudan / midas raw data files for benchmarking (see header file)
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SynthDataGenerator.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+#include "BatRootTypes.h"
+#include "MidasStructs.h"
+#include "CounterRNG.h"
+#include "TemplateDataManager.h"
+
+
+namespace {
+
+   //double exponential shapes, in seconds
+   const double kPhononRiseTime = 25.e-6;
+   const double kPhononFallTime = 250.e-6;
+   const double kChargeRiseTime = 1.e-6;
+   const double kChargeFallTime = 40.e-6;
+
+   //Soudan digitizers; midas data are read with a fixed 800 ns (see MidasEventData::HandleBankData)
+   const uint32_t kSoudanPhononDt = 1600;
+   const uint32_t kSoudanChargeDt = 800;
+   const uint32_t kMidasDt        = 800;
+
+   const double kPhononBaseline = 4000.;
+   const double kChargeBaseline = 32768.;
+   const double kChargeToPhonon = 0.5;     //charge amplitude relative to phonon
+
+   const uint32_t kFirstEventTime = 1400000000; //unix time of the first event
+
+   //midas
+   const uint16_t kMidasBeginRunId  = 0x8000;
+   const uint16_t kMidasEndRunId    = 0x8001;
+   const uint16_t kMidasDataId      = 1;
+   const uint32_t kMidasBank32Flags = (1<<4) | 1;
+   const uint32_t kMidasTidDword    = 6;
+   const uint32_t kMidasFormatVersion  = 1;
+   const uint32_t kMidasDcrcVersion    = 40;   //RevD, 4 charge channels
+   const uint32_t kMidasTriggerWords   = 13;
+   const uint32_t kMidasPhysicsTrigger = 0;
+   const uint32_t kMidasRandomTrigger  = 3;    //in-run random, read back as category 1
+
+   //CounterRNG keys: detNum 0 is never a real detector and is used for event level draws,
+   //the overlay slot holds the channel index (fNChannels for the amplitude draws)
+   const uint32_t kEventLevelDet = 0;
+
+   uint16_t ToADC(double value)
+   {
+      if(value < 0.) return 0;
+      if(value > 65535.) return 65535;
+      return (uint16_t)(value + 0.5);
+   }
+
+}
+
+
+SynthDataGenerator::SynthDataGenerator(RawFormat format) :
+   fFormat(format),
+   fDetType(format == kMidas ? BatRootTypes::kiZIPSNOlab : BatRootTypes::kiZIPSoudan),
+   fNChannels(format == kMidas ? BatRootTypes::kiZIPSNOlabNAllChan : BatRootTypes::kiZIPSoudanNAllChan),
+   fNDetectors(1),
+   fPhononBins(4096),
+   fChargeBins(4096),
+   fEventRate(1.),
+   fRandomFraction(0.1),
+   fMeanAmplitude(200.),
+   fWhiteSigma(3.),
+   fRedSigma(6.),
+   fCornerFreq(2000.),
+   fCompressionLevel(6),
+   fSeriesNumber(0),
+   fFirstEvent(1),
+   fBytesWritten(0)
+{
+}
+
+
+// ================  Output file ==============================
+
+string SynthDataGenerator::WriteFile(const string& outDir, const string& series, int dump, int nEvents)
+{
+   //series number as stored in the admin record: digits of the series name
+   string seriesDigits;
+   for(uint charItr = 0; charItr < series.size(); charItr++)
+      if(isdigit(series[charItr])) seriesDigits += series[charItr];
+   fSeriesNumber = strtoull(seriesDigits.c_str(), NULL, 10);
+
+   //file name as BatRoot builds it (FILEINDEX_PREFIX = F)
+   ostringstream pathStream;
+   pathStream << outDir;
+   if(!outDir.empty() && outDir[outDir.size()-1] != '/') pathStream << "/";
+   pathStream << series << "_F" << setw(4) << setfill('0') << dump
+	      << (fFormat == kMidas ? ".mid.gz" : ".gz");
+   string path = pathStream.str();
+
+   ostringstream mode;
+   mode << "wb" << fCompressionLevel;
+   gzFile outFile = gzopen(path.c_str(), mode.str().c_str());
+   if(outFile == NULL)
+   {
+      cerr <<"SynthDataGenerator::WriteFile ERROR: cannot open " << path << " for writing" << endl;
+      exit(1);
+   }
+
+   BuildChannelShapes();
+   fBytesWritten = 0;
+
+   //event numbers follow the standard dump*10000 scaling
+   fFirstEvent = dump*10000 + 1;
+
+   if(fFormat == kMidas)
+      WriteMidasFile(outFile, nEvents);
+   else
+      WriteSoudanFile(outFile, nEvents);
+
+   if(gzclose(outFile) != Z_OK)
+   {
+      cerr <<"SynthDataGenerator::WriteFile ERROR: problem closing " << path << endl;
+      exit(1);
+   }
+
+   return path;
+}
+
+
+void SynthDataGenerator::Write(gzFile outFile, const void* data, uint32_t nBytes)
+{
+   if(nBytes == 0) return;
+
+   if(gzwrite(outFile, data, nBytes) != (int)nBytes)
+   {
+      cerr <<"SynthDataGenerator::Write ERROR: problem writing output file" << endl;
+      exit(1);
+   }
+   fBytesWritten += nBytes;
+}
+
+
+// ================  Traces ==============================
+
+void SynthDataGenerator::BuildChannelShapes()
+{
+   TemplateDataManager templateData;
+
+   fShapes.clear();
+   for(int chan = 0; chan < fNChannels; chan++)
+   {
+      const string& chanName = (fFormat == kMidas ? BatRootTypes::kiZIPSNOlabChannelNames[chan] :
+				BatRootTypes::kiZIPSoudanChannelNames[chan]);
+
+      ChannelShape shape;
+      shape.isCharge = (chanName[0] == 'Q');
+      shape.nBins = (shape.isCharge ? fChargeBins : fPhononBins);
+      shape.preTrigger = shape.nBins/4;
+      if(fFormat == kMidas)
+	 shape.sampleDt = kMidasDt;
+      else
+	 shape.sampleDt = (shape.isCharge ? kSoudanChargeDt : kSoudanPhononDt);
+      shape.baseline = (shape.isCharge ? kChargeBaseline : kPhononBaseline);
+      shape.polarity = (shape.isCharge ? -1. : 1.);
+
+      double sampleRate = 1.e9/shape.sampleDt;
+      shape.pulse = templateData.GetDoubleExpForm(shape.isCharge ? kChargeRiseTime : kPhononRiseTime,
+						  shape.isCharge ? kChargeFallTime : kPhononFallTime,
+						  shape.nBins, shape.preTrigger, sampleRate);
+
+      double peak = *max_element(shape.pulse.begin(), shape.pulse.end());
+      if(peak > 0.)
+	 for(uint binItr = 0; binItr < shape.pulse.size(); binItr++)
+	    shape.pulse[binItr] /= peak;
+
+      fShapes.push_back(shape);
+   }
+}
+
+
+bool SynthDataGenerator::IsRandomEvent(uint32_t event) const
+{
+   CounterRNG rng(fSeriesNumber, event, kEventLevelDet);
+   return rng.Uniform() < fRandomFraction;
+}
+
+
+uint32_t SynthDataGenerator::EventTime(uint32_t event) const
+{
+   return kFirstEventTime + (fEventRate > 0. ? (uint32_t)(event/fEventRate) : 0);
+}
+
+
+void SynthDataGenerator::DrawAmplitudes(int detNum, uint32_t event, vector<double>& amplitudes) const
+{
+   //exponential spectrum, energy shared randomly among the phonon (charge) channels
+   //so that each channel sees the full amplitude on average
+   CounterRNG rng(fSeriesNumber, event, detNum, fNChannels);
+   double amplitude = -fMeanAmplitude*log(rng.Uniform());
+
+   amplitudes.assign(fNChannels, 0.);
+   double phononSum = 0., chargeSum = 0.;
+   int nPhonon = 0, nCharge = 0;
+   for(int chan = 0; chan < fNChannels; chan++)
+   {
+      amplitudes[chan] = 0.5 + rng.Uniform();
+      if(fShapes[chan].isCharge) { chargeSum += amplitudes[chan]; nCharge++; }
+      else                       { phononSum += amplitudes[chan]; nPhonon++; }
+   }
+
+   for(int chan = 0; chan < fNChannels; chan++)
+   {
+      if(fShapes[chan].isCharge)
+	 amplitudes[chan] *= kChargeToPhonon*amplitude*nCharge/chargeSum;
+      else
+	 amplitudes[chan] *= amplitude*nPhonon/phononSum;
+   }
+}
+
+
+void SynthDataGenerator::BuildTrace(int detNum, int chan, uint32_t event, bool isRandom,
+				    const vector<double>& amplitudes, vector<uint16_t>& trace) const
+{
+   const ChannelShape& shape = fShapes[chan];
+   CounterRNG rng(fSeriesNumber, event, detNum, chan);
+
+   //colored noise: white + one-pole low-pass (stationary from the first bin)
+   double dt = shape.sampleDt*1.e-9;
+   double pole = exp(-2.*M_PI*fCornerFreq*dt);
+   double innovation = fRedSigma*sqrt(1. - pole*pole);
+   double red = rng.Gaus(0., fRedSigma);
+
+   double amplitude = (isRandom ? 0. : amplitudes[chan]*shape.polarity);
+
+   trace.resize(shape.nBins);
+   for(int binItr = 0; binItr < shape.nBins; binItr++)
+   {
+      red = pole*red + rng.Gaus(0., innovation);
+      double value = shape.baseline + red + rng.Gaus(0., fWhiteSigma);
+      if(amplitude != 0.) value += amplitude*shape.pulse[binItr];
+      trace[binItr] = ToADC(value);
+   }
+}
+
+
+// ================  Soudan format ==============================
+
+void SynthDataGenerator::WriteSoudanFile(gzFile outFile, int nEvents)
+{
+   //file header: endianness word, DAQ version
+   uint32_t fileHeader[2] = { 0x01020304, 1 };
+   Write(outFile, fileHeader, sizeof(fileHeader));
+
+   //detector config record, one sub-record per channel
+   vector<uint32_t> config;
+   for(int detNum = 1; detNum <= fNDetectors; detNum++)
+   {
+      for(int chan = 0; chan < fNChannels; chan++)
+      {
+	 const ChannelShape& shape = fShapes[chan];
+	 uint32_t detCode = fDetType*1000000 + detNum*1000 + chan;
+	 int32_t triggerTime = shape.preTrigger*shape.sampleDt;
+
+	 if(shape.isCharge)
+	 {
+	    config.push_back(BatRootTypes::kChargeConfigID);
+	    config.push_back(BatRootTypes::kChargeConfigRecordSize*BatRootTypes::kWordSize);
+	    config.push_back(detCode);
+	    config.push_back(1);                    //tower
+	    config.push_back(100);                  //driver gain x100
+	    config.push_back(2000000);              //bias, uV
+	    config.push_back(0);                    //offset, uV
+	    config.push_back(shape.sampleDt);       //ns
+	    config.push_back(triggerTime);          //ns
+	    config.push_back(shape.nBins);
+	 }
+	 else
+	 {
+	    config.push_back(BatRootTypes::kPhononConfigID);
+	    config.push_back(BatRootTypes::kPhononConfigRecordSize*BatRootTypes::kWordSize);
+	    config.push_back(detCode);
+	    config.push_back(1);                    //tower
+	    config.push_back(100);                  //driver gain x100
+	    config.push_back(2500);                 //qet bias, uA x100
+	    config.push_back(2000);                 //squid bias, uA x100
+	    config.push_back(10000);                //squid lock point, uV x100
+	    config.push_back(0);                    //offset, uV
+	    config.push_back(1);                    //feedback gain
+	    config.push_back(shape.sampleDt);       //ns
+	    config.push_back(triggerTime);          //ns
+	    config.push_back(shape.nBins);
+	 }
+      }
+   }
+   uint32_t configHeader[2] = { BatRootTypes::kDetectorConfigID, (uint32_t)(config.size()*BatRootTypes::kWordSize) };
+   Write(outFile, configHeader, sizeof(configHeader));
+   Write(outFile, &config[0], config.size()*BatRootTypes::kWordSize);
+
+   vector<uint32_t> eventWords;
+   vector<uint16_t> trace;
+   vector<double> amplitudes;
+
+   for(int evtItr = 0; evtItr < nEvents; evtItr++)
+   {
+      uint32_t event = fFirstEvent + evtItr;
+      bool isRandom = IsRandomEvent(event);
+
+      eventWords.clear();
+
+      //admin record (64 bit series)
+      eventWords.push_back(BatRootTypes::kAdminRecordID64);
+      eventWords.push_back(6*BatRootTypes::kWordSize);
+      eventWords.push_back(fSeriesNumber/10000);
+      eventWords.push_back(fSeriesNumber%10000);
+      eventWords.push_back(event);
+      eventWords.push_back(EventTime(evtItr));
+      eventWords.push_back(0);                     //time between
+      eventWords.push_back(0);                     //live time
+
+      for(int detNum = 1; detNum <= fNDetectors; detNum++)
+      {
+	 if(!isRandom) DrawAmplitudes(detNum, event, amplitudes);
+
+	 for(int chan = 0; chan < fNChannels; chan++)
+	 {
+	    BuildTrace(detNum, chan, event, isRandom, amplitudes, trace);
+
+	    //12 header words then two ADC values per word (first sample in the low half)
+	    uint32_t nPairs = trace.size()/2;
+	    eventWords.push_back(BatRootTypes::kPulseRecordExpandedCodeID);
+	    eventWords.push_back((12 + nPairs)*BatRootTypes::kWordSize);
+
+	    uint32_t pulseHeader[12] = { 0 };
+	    pulseHeader[4] = fDetType*1000000 + detNum*1000 + chan;
+	    pulseHeader[7] = fShapes[chan].preTrigger*fShapes[chan].sampleDt;
+	    pulseHeader[8] = fShapes[chan].sampleDt;
+	    pulseHeader[11] = 2*nPairs;
+	    eventWords.insert(eventWords.end(), pulseHeader, pulseHeader+12);
+
+	    for(uint32_t pairItr = 0; pairItr < nPairs; pairItr++)
+	       eventWords.push_back((uint32_t)trace[2*pairItr] | ((uint32_t)trace[2*pairItr+1] << 16));
+	 }
+      }
+
+      //event header: 0xa980, class, category (1 = random), type
+      uint32_t category = (isRandom ? 1 : 0);
+      uint32_t eventHeader[2] = { (0xa980u << 16) | (category << 8),
+				  (uint32_t)(eventWords.size()*BatRootTypes::kWordSize) };
+      Write(outFile, eventHeader, sizeof(eventHeader));
+      Write(outFile, &eventWords[0], eventWords.size()*BatRootTypes::kWordSize);
+   }
+}
+
+
+// ================  Midas format ==============================
+
+void SynthDataGenerator::WriteMidasEvent(gzFile outFile, uint16_t eventId, uint32_t serial, uint32_t timeStamp,
+					 const char* data, uint32_t dataSize)
+{
+   TMidas_EVENT_HEADER header;
+   header.fEventId = eventId;
+   header.fTriggerMask = 0;
+   header.fSerialNumber = serial;
+   header.fTimeStamp = timeStamp;
+   header.fDataSize = dataSize;
+
+   Write(outFile, &header, sizeof(header));
+   Write(outFile, data, dataSize);
+}
+
+
+void SynthDataGenerator::AppendMidasTrigger(uint32_t event, vector<uint32_t>& bank) const
+{
+   bool isRandom = IsRandomEvent(event);
+
+   //trigger block
+   bank.push_back(0x50000000);
+   bank.push_back(event);
+   bank.push_back(isRandom ? kMidasRandomTrigger : kMidasPhysicsTrigger);
+   bank.resize(bank.size() + kMidasTriggerWords - 3, 0);
+
+   bank.push_back(0x30000000 | fNDetectors);
+
+   vector<uint16_t> trace;
+   vector<double> amplitudes;
+
+   for(int detNum = 1; detNum <= fNDetectors; detNum++)
+   {
+      if(!isRandom) DrawAmplitudes(detNum, event, amplitudes);
+
+      //detector word, DCRC versions, two unused words, number of channels
+      bank.push_back(0x20000000 | (fDetType << 10) | ((detNum & 0xff) << 2));
+      bank.push_back(kMidasDcrcVersion);
+      bank.push_back(0);
+      bank.push_back(0);
+      bank.push_back(fNChannels);
+
+      int nCharge = 0;
+      for(int chan = 0; chan < fNChannels; chan++)
+	 if(fShapes[chan].isCharge) nCharge++;
+
+      for(int chan = 0; chan < fNChannels; chan++)
+      {
+	 const ChannelShape& shape = fShapes[chan];
+	 BuildTrace(detNum, chan, event, isRandom, amplitudes, trace);
+
+	 //charge channels are numbered first, phonon channel numbers start again at 0
+	 uint32_t channelType = (shape.isCharge ? 0 : 1);
+	 uint32_t channelNumber = (shape.isCharge ? chan : chan - nCharge);
+	 bank.push_back(0x10000000 | (channelNumber << 2) | channelType);
+	 bank.push_back(shape.preTrigger);
+	 bank.push_back(shape.nBins - shape.preTrigger);
+	 bank.push_back(0);                       //post-pulse samples
+	 bank.push_back(0);                       //unused
+
+	 for(uint32_t binItr = 0; binItr < trace.size(); binItr += 2)
+	 {
+	    uint32_t upper = (binItr+1 < trace.size() ? trace[binItr+1] : 0);
+	    bank.push_back((uint32_t)trace[binItr] | (upper << 16));
+	 }
+      }
+   }
+}
+
+
+void SynthDataGenerator::WriteMidasFile(gzFile outFile, int nEvents)
+{
+   uint32_t runNumber = fSeriesNumber%10000;
+
+   //begin of run: odb dump (the reader only prints it)
+   string odb = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<odb root=\"/\" filename=\"synthetic\"></odb>\n";
+   WriteMidasEvent(outFile, kMidasBeginRunId, runNumber, EventTime(0), odb.c_str(), odb.size()+1);
+
+   vector<uint32_t> bankData;
+   vector<char> eventData;
+
+   //one trigger per midas event, as written by the current readout
+   for(int evtItr = 0; evtItr < nEvents; evtItr++)
+   {
+      bankData.clear();
+      bankData.push_back(0x90000000 | (kMidasFormatVersion << 12) | 1);
+      AppendMidasTrigger(fFirstEvent + evtItr, bankData);
+
+      uint32_t bankBytes = bankData.size()*sizeof(uint32_t);
+      uint32_t paddedBytes = (bankBytes + 7) & ~7;
+
+      TMidas_BANK_HEADER bankHeader;
+      bankHeader.fDataSize = sizeof(TMidas_BANK32) + paddedBytes;
+      bankHeader.fFlags = kMidasBank32Flags;
+
+      TMidas_BANK32 bank;
+      memcpy(bank.fName, "SCD0", 4);
+      bank.fType = kMidasTidDword;
+      bank.fDataSize = bankBytes;
+
+      eventData.assign(sizeof(bankHeader) + sizeof(bank) + paddedBytes, 0);
+      memcpy(&eventData[0], &bankHeader, sizeof(bankHeader));
+      memcpy(&eventData[sizeof(bankHeader)], &bank, sizeof(bank));
+      memcpy(&eventData[sizeof(bankHeader) + sizeof(bank)], &bankData[0], bankBytes);
+
+      WriteMidasEvent(outFile, kMidasDataId, evtItr, EventTime(evtItr), &eventData[0], eventData.size());
+   }
+
+   string eor = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<odb root=\"/\" filename=\"synthetic\"></odb>\n";
+   WriteMidasEvent(outFile, kMidasEndRunId, runNumber, EventTime(nEvents), eor.c_str(), eor.size()+1);
+}
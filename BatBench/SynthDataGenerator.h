@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: SynthDataGenerator
+//Description:  Writes synthetic raw data files that RawDataReader reads like real data, so that the
+//processing chain can be benchmarked without access to the experiment's raw data. Two formats:
+//
+//   kSoudan  gzipped Soudan file: file header, detector config record, then one event record per
+//            event (Admin64 record + one 0x11 pulse record per channel), iZIP Soudan detectors (11)
+//   kMidas   gzipped midas file: BOR, one SCD0 BANK32 (RevD) event per trigger, EOR,
+//            SNOLAB iZIP detectors (700)
+//
+//Traces are baseline + colored noise (white + one-pole low-pass filtered gaussian noise), plus for
+//triggered events a double exponential pulse shape from TemplateDataManager::GetDoubleExpForm with
+//an exponential amplitude spectrum shared randomly among the channels. Random triggers (event
+//category 1) carry noise only. All draws come from CounterRNG keyed by (series, event, detector,
+//channel) so a file is reproducible bit for bit for a given seed.
+//
+//Usage:
+//   SynthDataGenerator generator(SynthDataGenerator::kSoudan);
+//   generator.SetNDetectors(5);
+//   string path = generator.WriteFile("./", "01150101_1200", 1, 1000);
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYNTHDATAGENERATOR_H
+#define SYNTHDATAGENERATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "zlib.h"
+
+using namespace std;
+
+
+class SynthDataGenerator
+{
+   public:
+
+      enum RawFormat {
+	 kSoudan = 0,
+	 kMidas  = 1
+      };
+
+      SynthDataGenerator(RawFormat format = kSoudan);
+
+      void SetNDetectors(int nDetectors) { fNDetectors = nDetectors; }
+      void SetTraceLength(int phononBins, int chargeBins) { fPhononBins = phononBins; fChargeBins = chargeBins; }
+      void SetEventRate(double rateHz) { fEventRate = rateHz; }                  //sets the event time stamps
+      void SetRandomFraction(double fraction) { fRandomFraction = fraction; }    //trigger mix
+      void SetMeanAmplitude(double adc) { fMeanAmplitude = adc; }                //exponential spectrum, ADC
+      void SetNoise(double whiteSigma, double redSigma, double cornerHz)
+      { fWhiteSigma = whiteSigma; fRedSigma = redSigma; fCornerFreq = cornerHz; }
+      void SetCompressionLevel(int level) { fCompressionLevel = level; }
+
+      //writes <outDir>/<series>_F<dump> (.gz or .mid.gz), returns the path
+      string WriteFile(const string& outDir, const string& series, int dump, int nEvents);
+
+      //bytes handed to zlib for the last file (uncompressed size)
+      uint64_t GetBytesWritten() const { return fBytesWritten; }
+
+   private:
+
+      struct ChannelShape {
+	 bool           isCharge;
+	 int            nBins;
+	 int            preTrigger;
+	 uint32_t       sampleDt;     //ns
+	 double         baseline;     //ADC
+	 double         polarity;
+	 vector<double> pulse;        //peak normalized to 1
+      };
+
+      void BuildChannelShapes();
+      void BuildTrace(int detNum, int chan, uint32_t event, bool isRandom, const vector<double>& amplitudes,
+		      vector<uint16_t>& trace) const;
+      void DrawAmplitudes(int detNum, uint32_t event, vector<double>& amplitudes) const;
+      bool IsRandomEvent(uint32_t event) const;
+      uint32_t EventTime(uint32_t event) const;
+
+      void WriteSoudanFile(gzFile outFile, int nEvents);
+      void WriteMidasFile(gzFile outFile, int nEvents);
+      void AppendMidasTrigger(uint32_t event, vector<uint32_t>& bank) const;
+      void WriteMidasEvent(gzFile outFile, uint16_t eventId, uint32_t serial, uint32_t timeStamp,
+			   const char* data, uint32_t dataSize);
+
+      void Write(gzFile outFile, const void* data, uint32_t nBytes);
+
+      RawFormat fFormat;
+      int       fDetType;
+      int       fNChannels;
+      int       fNDetectors;
+      int       fPhononBins;
+      int       fChargeBins;
+      double    fEventRate;
+      double    fRandomFraction;
+      double    fMeanAmplitude;
+      double    fWhiteSigma;
+      double    fRedSigma;
+      double    fCornerFreq;
+      int       fCompressionLevel;
+
+      uint64_t  fSeriesNumber;
+      uint32_t  fFirstEvent;
+      uint64_t  fBytesWritten;
+
+      vector<ChannelShape> fShapes;   //by channel index of the detector type
+};
+
+#endif /* SYNTHDATAGENERATOR_H */
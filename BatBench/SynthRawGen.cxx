@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Writes a synthetic raw data file (Soudan or midas format) that
+//             BatNoise / BatRoot read like real data, for benchmarking the
+//             processing chain (see SynthDataGenerator.h and the README)
+//
+//Usage: ./SynthRawGen [options] outdir series dump nevents
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+#include "CounterRNG.h"
+#include "SynthDataGenerator.h"
+
+using namespace std;
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("SynthRawGen [<options>] <outdir> <series> <dump> <nevents>");
+   cmd.AddCommandSwitch('f',"format","Raw data format: soudan (default) or midas","format");
+   cmd.AddCommandSwitch('d',"ndet","Number of detectors (default 1)","n");
+   cmd.AddCommandSwitch('p',"phononbins","Phonon trace length in bins (default 4096)","n");
+   cmd.AddCommandSwitch('q',"chargebins","Charge trace length in bins (default 4096)","n");
+   cmd.AddCommandSwitch('r',"rate","Event rate in Hz, sets the time stamps (default 1)","hz");
+   cmd.AddCommandSwitch('R',"randoms","Fraction of random triggers (default 0.1)","fraction");
+   cmd.AddCommandSwitch('a',"amplitude","Mean pulse amplitude in ADC (default 200)","adc");
+   cmd.AddCommandSwitch(' ',"white","White noise sigma in ADC (default 3)","adc");
+   cmd.AddCommandSwitch(' ',"red","Low-pass filtered noise sigma in ADC (default 6)","adc");
+   cmd.AddCommandSwitch(' ',"corner","Corner frequency of the filtered noise in Hz (default 2000)","hz");
+   cmd.AddCommandSwitch('z',"compression","gzip compression level 0-9 (default 6)","level");
+   cmd.AddCommandSwitch('s',"seed","Random seed (default 0)","seed");
+   if(cmd.ProcessCommandLine(argc, argv) != 4)
+      cmd.PrintSwitches();
+
+   string format = (cmd.GetNCallsToOption("format") > 0 ? cmd.GetArgumentCall("format") : "soudan");
+   if(format != "soudan" && format != "midas")
+   {
+      cerr <<"SynthRawGen: ERROR unknown format " << format << ", must be soudan or midas" << endl;
+      exit(1);
+   }
+
+   SynthDataGenerator generator(format == "midas" ? SynthDataGenerator::kMidas : SynthDataGenerator::kSoudan);
+
+   if(cmd.GetNCallsToOption("ndet") > 0)
+      generator.SetNDetectors(atoi(cmd.GetArgumentCall("ndet")));
+
+   int phononBins = (cmd.GetNCallsToOption("phononbins") > 0 ? atoi(cmd.GetArgumentCall("phononbins")) : 4096);
+   int chargeBins = (cmd.GetNCallsToOption("chargebins") > 0 ? atoi(cmd.GetArgumentCall("chargebins")) : 4096);
+   if(phononBins < 8 || chargeBins < 8 || phononBins%2 || chargeBins%2)
+   {
+      cerr <<"SynthRawGen: ERROR trace lengths must be even and at least 8 bins" << endl;
+      exit(1);
+   }
+   generator.SetTraceLength(phononBins, chargeBins);
+
+   if(cmd.GetNCallsToOption("rate") > 0)
+      generator.SetEventRate(atof(cmd.GetArgumentCall("rate")));
+   if(cmd.GetNCallsToOption("randoms") > 0)
+      generator.SetRandomFraction(atof(cmd.GetArgumentCall("randoms")));
+   if(cmd.GetNCallsToOption("amplitude") > 0)
+      generator.SetMeanAmplitude(atof(cmd.GetArgumentCall("amplitude")));
+
+   double white = (cmd.GetNCallsToOption("white") > 0 ? atof(cmd.GetArgumentCall("white")) : 3.);
+   double red = (cmd.GetNCallsToOption("red") > 0 ? atof(cmd.GetArgumentCall("red")) : 6.);
+   double corner = (cmd.GetNCallsToOption("corner") > 0 ? atof(cmd.GetArgumentCall("corner")) : 2000.);
+   generator.SetNoise(white, red, corner);
+
+   if(cmd.GetNCallsToOption("compression") > 0)
+      generator.SetCompressionLevel(atoi(cmd.GetArgumentCall("compression")));
+   if(cmd.GetNCallsToOption("seed") > 0)
+      CounterRNG::SetGlobalSeed(strtoul(cmd.GetArgumentCall("seed"), NULL, 10));
+
+   string outDir = cmd.GetCommandArg(0);
+   string series = cmd.GetCommandArg(1);
+   int dump = atoi(cmd.GetCommandArg(2));
+   int nEvents = atoi(cmd.GetCommandArg(3));
+
+   string path = generator.WriteFile(outDir, series, dump, nEvents);
+
+   cout <<"SynthRawGen: wrote " << nEvents << " events (" << generator.GetBytesWritten()/1.e6
+	<<" MB uncompressed) to " << path << endl;
+
+   return 0;
+}
@@ -0,0 +1,239 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Equivalence check of two BatNoise filter files, e.g. of the same
+//             series before and after a change to the noise code.  Compares
+//             every histogram (noise PSD's, optimal filters, templates, noise
+//             selection histograms, event lists, ...) of every directory bin by
+//             bin, with absolute, relative and ULP tolerances, prints the
+//             histograms out of tolerance with the largest differences and
+//             returns 1 if any histogram is out of tolerance or the files differ
+//             in structure.  The trees of infoDir and detectorConfigDir are
+//             compared with rqdiff.
+//
+//Usage: ./noisediff [options] fileA fileB
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+//ROOT Libraries
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TH1D.h"
+#include "TError.h"
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+
+using namespace std;
+
+
+namespace {
+
+   //a bin passes if it is within any of the tolerances; all zero = exact
+   struct Tolerance {
+      double absTol;
+      double relTol;
+      double ulpTol;
+   };
+
+   //one histogram, with the largest differences over its bins
+   struct HistoResult {
+      string   path;
+      int      nBins;
+      int      nDiffer;
+      int      nFail;
+      double   maxAbs;
+      double   maxRel;
+      double   maxUlp;
+      int      worstBin;
+      double   worstA;
+      double   worstB;
+   };
+
+   TFile* OpenInput(const string& fileName)
+   {
+      TFile* file = TFile::Open(fileName.c_str(), "READ");
+      if(!file || file->IsZombie())
+      {
+	 cerr <<"noisediff: ERROR cannot open " << fileName << endl;
+	 exit(1);
+      }
+      return file;
+   }
+
+   //distance in units in the last place: the doubles are mapped to integers
+   //ordered like the values, -0 and +0 are the same
+   double UlpDistance(double a, double b)
+   {
+      int64_t ia, ib;
+      memcpy(&ia, &a, sizeof(ia));
+      memcpy(&ib, &b, sizeof(ib));
+      if(ia < 0) ia = numeric_limits<int64_t>::min() - ia;
+      if(ib < 0) ib = numeric_limits<int64_t>::min() - ib;
+      return fabs(double(ia) - double(ib));
+   }
+
+   //all histograms below a directory, as paths relative to the file; the highest key
+   //cycle of a name comes first in the list of keys and is the one used
+   void ListHistograms(TDirectory* dir, const string& dirPath, vector<string>& histoPaths)
+   {
+      set<string> seen;
+      TKey* aKey;
+      TIter keysItr(dir->GetListOfKeys());
+      while ((aKey = (TKey *) keysItr()))
+      {
+	 string name = aKey->GetName();
+	 if(!seen.insert(name).second) continue;
+
+	 string path = (dirPath.empty() ? name : dirPath + "/" + name);
+	 if(!strcmp(aKey->GetClassName(),"TDirectoryFile"))
+	 {
+	    TDirectory* subDir = dir->GetDirectory(name.c_str());
+	    if(subDir != NULL) ListHistograms(subDir, path, histoPaths);
+	 }
+	 else if(!strncmp(aKey->GetClassName(),"TH1",3))
+	    histoPaths.push_back(path);
+      }
+   }
+
+   void CompareHistograms(const TH1& histoA, const TH1& histoB, const Tolerance& tolerance, HistoResult& result)
+   {
+      //the under- and overflow bins are compared too
+      for(int binItr = 0; binItr <= result.nBins+1; binItr++)
+      {
+	 double a = histoA.GetBinContent(binItr);
+	 double b = histoB.GetBinContent(binItr);
+	 if(a == b || (std::isnan(a) && std::isnan(b))) continue;
+
+	 result.nDiffer++;
+	 double absDiff = fabs(a - b);
+	 double relDiff = absDiff/max(fabs(a), fabs(b));
+	 double ulpDiff = UlpDistance(a, b);
+	 if(std::isnan(a) || std::isnan(b)) absDiff = relDiff = ulpDiff = HUGE_VAL;
+
+	 if(!(absDiff <= tolerance.absTol || relDiff <= tolerance.relTol || ulpDiff <= tolerance.ulpTol))
+	    result.nFail++;
+
+	 if(relDiff > result.maxRel || result.nDiffer == 1)
+	 {
+	    result.worstBin = binItr;
+	    result.worstA = a;
+	    result.worstB = b;
+	 }
+	 if(absDiff > result.maxAbs) result.maxAbs = absDiff;
+	 if(relDiff > result.maxRel) result.maxRel = relDiff;
+	 if(ulpDiff > result.maxUlp) result.maxUlp = ulpDiff;
+      }
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("noisediff [<options>] <fileA> <fileB>");
+   cmd.AddCommandSwitch('A',"abs","Absolute tolerance of a bin (default 0)","x");
+   cmd.AddCommandSwitch('R',"rel","Relative tolerance of a bin (default 0)","x");
+   cmd.AddCommandSwitch('U',"ulp","ULP tolerance of a bin (default 0)","n");
+   cmd.AddCommandSwitch('a',"all","Also print histograms which differ within the tolerance");
+   if(cmd.ProcessCommandLine(argc, argv) != 2)
+      cmd.PrintSwitches();
+
+   string fileNameA = cmd.GetCommandArg(0);
+   string fileNameB = cmd.GetCommandArg(1);
+   Tolerance tolerance;
+   tolerance.absTol = (cmd.GetNCallsToOption("abs") > 0 ? atof(cmd.GetArgumentCall("abs")) : 0.);
+   tolerance.relTol = (cmd.GetNCallsToOption("rel") > 0 ? atof(cmd.GetArgumentCall("rel")) : 0.);
+   tolerance.ulpTol = (cmd.GetNCallsToOption("ulp") > 0 ? atof(cmd.GetArgumentCall("ulp")) : 0.);
+   bool printAll = (cmd.GetNCallsToOption("all") > 0);
+
+   //missing dictionaries etc. are not our business here
+   gErrorIgnoreLevel = kError;
+
+   TFile* fileA = OpenInput(fileNameA);
+   TFile* fileB = OpenInput(fileNameB);
+
+   vector<string> pathsA, pathsB;
+   ListHistograms(fileA, "", pathsA);
+   ListHistograms(fileB, "", pathsB);
+   set<string> setA(pathsA.begin(), pathsA.end());
+
+   vector<string> structure;
+   for(uint pathItr = 0; pathItr < pathsB.size(); pathItr++)
+      if(setA.find(pathsB[pathItr]) == setA.end())
+	 structure.push_back(pathsB[pathItr] + " only in " + fileNameB);
+
+   vector<HistoResult> results;
+   for(uint pathItr = 0; pathItr < pathsA.size(); pathItr++)
+   {
+      const string& path = pathsA[pathItr];
+      TH1* histoA = dynamic_cast<TH1*>(fileA->Get(path.c_str()));
+      TH1* histoB = dynamic_cast<TH1*>(fileB->Get(path.c_str()));
+      if(histoB == NULL)
+	 structure.push_back(path + " only in " + fileNameA);
+      else if(histoA == NULL || histoA->GetNbinsX() != histoB->GetNbinsX())
+	 structure.push_back(path + " has a different number of bins");
+      else
+      {
+	 HistoResult result;
+	 result.path = path;
+	 result.nBins = histoA->GetNbinsX();
+	 result.nDiffer = result.nFail = 0;
+	 result.maxAbs = result.maxRel = result.maxUlp = 0.;
+	 result.worstBin = -1;
+	 result.worstA = result.worstB = 0.;
+	 CompareHistograms(*histoA, *histoB, tolerance, result);
+	 results.push_back(result);
+      }
+      delete histoA;
+      delete histoB;
+   }
+
+   fileA->Close();
+   fileB->Close();
+
+   //report
+   int nDiffer = 0, nFail = 0;
+   for(uint resItr = 0; resItr < results.size(); resItr++)
+   {
+      if(results[resItr].nDiffer > 0) nDiffer++;
+      if(results[resItr].nFail > 0) nFail++;
+   }
+
+   for(uint structItr = 0; structItr < structure.size(); structItr++)
+      cout <<"noisediff: STRUCTURE " << structure[structItr] << endl;
+
+   if(nFail > 0 || (printAll && nDiffer > 0))
+   {
+      cout << left << setw(40) << "histogram" << right << setw(10) << "nDiffer" << setw(10) << "nFail"
+	   << setw(14) << "maxAbs" << setw(14) << "maxRel" << setw(14) << "maxUlp"
+	   << "  largest relative difference" << endl;
+      for(uint resItr = 0; resItr < results.size(); resItr++)
+      {
+	 const HistoResult& result = results[resItr];
+	 if(result.nFail == 0 && !(printAll && result.nDiffer > 0)) continue;
+	 cout << left << setw(40) << result.path << right << setw(10) << result.nDiffer << setw(10) << result.nFail
+	      << setprecision(4) << setw(14) << result.maxAbs << setw(14) << result.maxRel << setw(14) << result.maxUlp
+	      << "  bin " << result.worstBin << ": " << setprecision(10) << result.worstA << " / " << result.worstB << endl;
+      }
+   }
+
+   cout <<"noisediff: " << results.size() << " histograms compared, " << nDiffer << " differ, "
+	<< nFail << " out of tolerance, " << structure.size() << " structural differences" << endl;
+
+   return (nFail > 0 || !structure.empty() ? 1 : 0);
+}
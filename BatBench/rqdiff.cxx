@@ -0,0 +1,699 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: RQ equivalence check of two BatRoot / BatCalib output files.
+//             Walks the trees of rqDir and rrqDir (or the directories given)
+//             branch by branch and compares every entry of both files, with
+//             per-RQ absolute, relative and ULP tolerances read from a
+//             tolerance file. Prints for each RQ with differences the number
+//             of differing and out-of-tolerance entries, the largest absolute,
+//             relative and ULP differences and the mean and rms of A-B, and
+//             returns 1 if any RQ is out of tolerance or the files differ in
+//             structure, so that it can gate changes to the processing.
+//             The RQs are spread over forked worker processes.
+//
+//Usage: ./rqdiff [options] fileA fileB
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+
+//ROOT Libraries
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TClass.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TLeafC.h"
+#include "TObjArray.h"
+#include "TError.h"
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+
+using namespace std;
+
+
+namespace {
+
+   //an entry passes if it is within any of the tolerances; all zero = exact
+   struct Tolerance {
+      double absTol;
+      double relTol;
+      double ulpTol;
+      bool   skip;
+   };
+
+   struct TolerancePattern {
+      string    pattern;
+      Tolerance tolerance;
+   };
+
+   //one leaf of one tree, with the statistics of A-B over all entries
+   struct RQResult {
+      string   dir;
+      string   tree;
+      string   leaf;
+      double   zipBytes;
+      long     nCompared;
+      long     nDiffer;
+      long     nFail;
+      double   maxAbs;
+      double   maxRel;
+      double   maxUlp;
+      double   sumDiff;
+      double   sumDiff2;
+      long     worstEntry;
+      double   worstA;
+      double   worstB;
+      string   note;
+   };
+
+   //all leaves of one tree a worker compares in one pass over the entries
+   struct TreeTask {
+      string      dir;
+      string      tree;
+      long        nEntries;
+      vector<int> results;
+   };
+
+   double NowSec()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec*1.e-9;
+   }
+
+   vector<string> SplitList(const string& list)
+   {
+      vector<string> items;
+      stringstream listStream(list);
+      string item;
+      while(getline(listStream, item, ','))
+	 if(!item.empty()) items.push_back(item);
+      return items;
+   }
+
+   //tolerance file: "<tree/leaf pattern> <abs> <rel> <ulp>" or "<pattern> skip",
+   //shell wildcards, the last matching line wins
+   vector<TolerancePattern> ReadTolerances(const string& fileName)
+   {
+      vector<TolerancePattern> patterns;
+      ifstream file(fileName.c_str());
+      if(!file)
+      {
+	 cerr <<"rqdiff: ERROR cannot open tolerance file " << fileName << endl;
+	 exit(1);
+      }
+
+      string line;
+      int lineNumber = 0;
+      while(getline(file, line))
+      {
+	 lineNumber++;
+	 size_t comment = line.find('#');
+	 if(comment != string::npos) line.erase(comment);
+
+	 stringstream lineStream(line);
+	 TolerancePattern entry;
+	 string first;
+	 if(!(lineStream >> entry.pattern)) continue;
+	 if(!(lineStream >> first))
+	 {
+	    cerr <<"rqdiff: ERROR " << fileName << ":" << lineNumber << ": missing tolerances" << endl;
+	    exit(1);
+	 }
+
+	 entry.tolerance.absTol = entry.tolerance.relTol = entry.tolerance.ulpTol = 0.;
+	 entry.tolerance.skip = (first == "skip");
+	 if(!entry.tolerance.skip)
+	 {
+	    entry.tolerance.absTol = atof(first.c_str());
+	    if(!(lineStream >> entry.tolerance.relTol >> entry.tolerance.ulpTol) ||
+	       entry.tolerance.absTol < 0. || entry.tolerance.relTol < 0. || entry.tolerance.ulpTol < 0.)
+	    {
+	       cerr <<"rqdiff: ERROR " << fileName << ":" << lineNumber
+		    <<": expected <pattern> <abs> <rel> <ulp> or <pattern> skip" << endl;
+	       exit(1);
+	    }
+	 }
+	 patterns.push_back(entry);
+      }
+      return patterns;
+   }
+
+   Tolerance FindTolerance(const vector<TolerancePattern>& patterns, const string& name)
+   {
+      Tolerance tolerance = { 0., 0., 0., false };
+      for(uint patItr = 0; patItr < patterns.size(); patItr++)
+	 if(fnmatch(patterns[patItr].pattern.c_str(), name.c_str(), 0) == 0)
+	    tolerance = patterns[patItr].tolerance;
+      return tolerance;
+   }
+
+   //distance in units in the last place: the floats are mapped to integers
+   //ordered like the values, -0 and +0 are the same
+   double UlpDistance(double a, double b, bool singlePrecision)
+   {
+      if(singlePrecision)
+      {
+	 float fa = a, fb = b;
+	 int32_t ia, ib;
+	 memcpy(&ia, &fa, sizeof(ia));
+	 memcpy(&ib, &fb, sizeof(ib));
+	 if(ia < 0) ia = numeric_limits<int32_t>::min() - ia;
+	 if(ib < 0) ib = numeric_limits<int32_t>::min() - ib;
+	 return fabs(double(ia) - double(ib));
+      }
+
+      int64_t ia, ib;
+      memcpy(&ia, &a, sizeof(ia));
+      memcpy(&ib, &b, sizeof(ib));
+      if(ia < 0) ia = numeric_limits<int64_t>::min() - ia;
+      if(ib < 0) ib = numeric_limits<int64_t>::min() - ib;
+      return fabs(double(ia) - double(ib));
+   }
+
+   void InitResult(RQResult& result)
+   {
+      result.zipBytes = 0.;
+      result.nCompared = result.nDiffer = result.nFail = 0;
+      result.maxAbs = result.maxRel = result.maxUlp = 0.;
+      result.sumDiff = result.sumDiff2 = 0.;
+      result.worstEntry = -1;
+      result.worstA = result.worstB = 0.;
+   }
+
+   //one element of one entry
+   void CompareValues(double a, double b, long entry, bool singlePrecision,
+		      const Tolerance& tolerance, RQResult& result)
+   {
+      result.nCompared++;
+
+      bool nanA = std::isnan(a), nanB = std::isnan(b);
+      if(nanA || nanB)
+      {
+	 if(nanA && nanB) return;
+	 result.nDiffer++;
+	 result.nFail++;
+	 if(result.worstEntry < 0 || !std::isinf(result.maxAbs))
+	 {
+	    result.maxAbs = result.maxRel = result.maxUlp = HUGE_VAL;
+	    result.worstEntry = entry;
+	    result.worstA = a;
+	    result.worstB = b;
+	 }
+	 return;
+      }
+      if(a == b) return;
+
+      double diff = a - b;
+      double absDiff = fabs(diff);
+      double relDiff = absDiff/max(fabs(a), fabs(b));
+      double ulpDiff = UlpDistance(a, b, singlePrecision);
+
+      result.nDiffer++;
+      if(!std::isinf(diff))
+      {
+	 result.sumDiff += diff;
+	 result.sumDiff2 += diff*diff;
+      }
+      if(!(absDiff <= tolerance.absTol || relDiff <= tolerance.relTol || ulpDiff <= tolerance.ulpTol))
+	 result.nFail++;
+
+      if(absDiff > result.maxAbs)
+      {
+	 result.maxAbs = absDiff;
+	 result.worstEntry = entry;
+	 result.worstA = a;
+	 result.worstB = b;
+      }
+      if(relDiff > result.maxRel) result.maxRel = relDiff;
+      if(ulpDiff > result.maxUlp) result.maxUlp = ulpDiff;
+   }
+
+   //all trees in one directory, highest cycle only
+   vector<string> ListTrees(TDirectory* dir)
+   {
+      set<string> names;
+      TIter next(dir->GetListOfKeys());
+      TKey* key;
+      while((key = (TKey*)next()))
+      {
+	 TClass* keyClass = TClass::GetClass(key->GetClassName());
+	 if(keyClass != NULL && keyClass->InheritsFrom(TTree::Class()))
+	    names.insert(key->GetName());
+      }
+      return vector<string>(names.begin(), names.end());
+   }
+
+   TFile* OpenFile(const string& fileName)
+   {
+      TFile* file = TFile::Open(fileName.c_str(), "READ");
+      if(file == NULL || file->IsZombie())
+      {
+	 cerr <<"rqdiff: ERROR cannot open " << fileName << endl;
+	 exit(1);
+      }
+      return file;
+   }
+
+   //structure of both files: trees and leaves in only one file are structural
+   //differences, everything else becomes one task per tree
+   void ScanFiles(const string& fileNameA, const string& fileNameB, const vector<string>& dirNames,
+		  const string& treePattern, const vector<TolerancePattern>& tolerances,
+		  vector<TreeTask>& tasks, vector<RQResult>& results, vector<string>& structure)
+   {
+      TFile* fileA = OpenFile(fileNameA);
+      TFile* fileB = OpenFile(fileNameB);
+
+      for(uint dirItr = 0; dirItr < dirNames.size(); dirItr++)
+      {
+	 const string& dirName = dirNames[dirItr];
+	 TDirectory* dirA = fileA->GetDirectory(dirName.c_str());
+	 TDirectory* dirB = fileB->GetDirectory(dirName.c_str());
+	 if(dirA == NULL && dirB == NULL) continue;
+	 if(dirA == NULL || dirB == NULL)
+	 {
+	    structure.push_back(dirName + ": only in " + (dirA ? "A" : "B"));
+	    continue;
+	 }
+
+	 vector<string> treesA = ListTrees(dirA);
+	 vector<string> treesB = ListTrees(dirB);
+	 set<string> treeSetB(treesB.begin(), treesB.end());
+	 for(uint treeItr = 0; treeItr < treesB.size(); treeItr++)
+	    if(find(treesA.begin(), treesA.end(), treesB[treeItr]) == treesA.end())
+	       structure.push_back(dirName + "/" + treesB[treeItr] + ": only in B");
+
+	 for(uint treeItr = 0; treeItr < treesA.size(); treeItr++)
+	 {
+	    const string& treeName = treesA[treeItr];
+	    if(!treePattern.empty() && fnmatch(treePattern.c_str(), treeName.c_str(), 0) != 0) continue;
+	    if(treeSetB.count(treeName) == 0)
+	    {
+	       structure.push_back(dirName + "/" + treeName + ": only in A");
+	       continue;
+	    }
+
+	    TTree* treeA = (TTree*)dirA->Get(treeName.c_str());
+	    TTree* treeB = (TTree*)dirB->Get(treeName.c_str());
+	    TreeTask task;
+	    task.dir = dirName;
+	    task.tree = treeName;
+	    task.nEntries = min(treeA->GetEntries(), treeB->GetEntries());
+	    if(treeA->GetEntries() != treeB->GetEntries())
+	    {
+	       ostringstream message;
+	       message << dirName << "/" << treeName << ": " << treeA->GetEntries() << " entries in A, "
+		       << treeB->GetEntries() << " in B, comparing the first " << task.nEntries;
+	       structure.push_back(message.str());
+	    }
+
+	    TObjArray* leavesA = treeA->GetListOfLeaves();
+	    TObjArray* leavesB = treeB->GetListOfLeaves();
+	    for(int leafItr = 0; leafItr < leavesB->GetEntriesFast(); leafItr++)
+	    {
+	       const char* leafName = leavesB->At(leafItr)->GetName();
+	       if(treeA->GetLeaf(leafName) == NULL)
+		  structure.push_back(dirName + "/" + treeName + "/" + leafName + ": only in B");
+	    }
+
+	    for(int leafItr = 0; leafItr < leavesA->GetEntriesFast(); leafItr++)
+	    {
+	       TLeaf* leafA = (TLeaf*)leavesA->At(leafItr);
+	       string leafName = leafA->GetName();
+	       TLeaf* leafB = treeB->GetLeaf(leafName.c_str());
+	       if(leafB == NULL)
+	       {
+		  structure.push_back(dirName + "/" + treeName + "/" + leafName + ": only in A");
+		  continue;
+	       }
+	       if(FindTolerance(tolerances, treeName + "/" + leafName).skip) continue;
+
+	       RQResult result;
+	       InitResult(result);
+	       result.dir = dirName;
+	       result.tree = treeName;
+	       result.leaf = leafName;
+	       result.zipBytes = leafA->GetBranch()->GetZipBytes() + leafB->GetBranch()->GetZipBytes();
+	       if(string(leafA->GetTypeName()) != leafB->GetTypeName())
+		  result.note = string("type ") + leafA->GetTypeName() + " in A, " + leafB->GetTypeName() + " in B";
+
+	       task.results.push_back(results.size());
+	       results.push_back(result);
+	    }
+	    if(!task.results.empty()) tasks.push_back(task);
+	 }
+      }
+
+      fileA->Close();
+      fileB->Close();
+      delete fileA;
+      delete fileB;
+   }
+
+   //one pass over the entries of one tree for all its leaves of this worker
+   void CompareTree(TFile* fileA, TFile* fileB, const TreeTask& task, const vector<int>& resultIndices,
+		    const vector<TolerancePattern>& tolerances, vector<RQResult>& results)
+   {
+      TTree* treeA = (TTree*)fileA->GetDirectory(task.dir.c_str())->Get(task.tree.c_str());
+      TTree* treeB = (TTree*)fileB->GetDirectory(task.dir.c_str())->Get(task.tree.c_str());
+
+      uint nLeaves = resultIndices.size();
+      vector<TLeaf*> leavesA(nLeaves), leavesB(nLeaves);
+      vector<TLeafC*> stringLeavesA(nLeaves), stringLeavesB(nLeaves);
+      vector<Tolerance> leafTolerances(nLeaves);
+      vector<bool> singlePrecision(nLeaves);
+
+      //only the baskets of these branches are read, in large vectored reads
+      treeA->SetCacheSize(32*1024*1024);
+      treeB->SetCacheSize(32*1024*1024);
+      for(uint leafItr = 0; leafItr < nLeaves; leafItr++)
+      {
+	 RQResult& result = results[resultIndices[leafItr]];
+	 leavesA[leafItr] = treeA->GetLeaf(result.leaf.c_str());
+	 leavesB[leafItr] = treeB->GetLeaf(result.leaf.c_str());
+	 stringLeavesA[leafItr] = dynamic_cast<TLeafC*>(leavesA[leafItr]);
+	 stringLeavesB[leafItr] = dynamic_cast<TLeafC*>(leavesB[leafItr]);
+	 leafTolerances[leafItr] = FindTolerance(tolerances, result.tree + "/" + result.leaf);
+	 singlePrecision[leafItr] = (string(leavesA[leafItr]->GetTypeName()) == "Float_t" &&
+				     string(leavesB[leafItr]->GetTypeName()) == "Float_t");
+	 treeA->AddBranchToCache(leavesA[leafItr]->GetBranch(), true);
+	 treeB->AddBranchToCache(leavesB[leafItr]->GetBranch(), true);
+      }
+      treeA->StopCacheLearningPhase();
+      treeB->StopCacheLearningPhase();
+
+      for(long entry = 0; entry < task.nEntries; entry++)
+      {
+	 for(uint leafItr = 0; leafItr < nLeaves; leafItr++)
+	 {
+	    RQResult& result = results[resultIndices[leafItr]];
+	    TLeaf* leafA = leavesA[leafItr];
+	    TLeaf* leafB = leavesB[leafItr];
+	    leafA->GetBranch()->GetEntry(entry);
+	    leafB->GetBranch()->GetEntry(entry);
+
+	    if(stringLeavesA[leafItr] != NULL || stringLeavesB[leafItr] != NULL)
+	    {
+	       result.nCompared++;
+	       string valueA = (stringLeavesA[leafItr] ? stringLeavesA[leafItr]->GetValueString() : "");
+	       string valueB = (stringLeavesB[leafItr] ? stringLeavesB[leafItr]->GetValueString() : "");
+	       if(valueA != valueB)
+	       {
+		  result.nDiffer++;
+		  result.nFail++;
+		  if(result.worstEntry < 0) result.worstEntry = entry;
+	       }
+	       continue;
+	    }
+
+	    int lenA = leafA->GetLen(), lenB = leafB->GetLen();
+	    if(lenA != lenB && result.note.empty())
+	    {
+	       ostringstream message;
+	       message << "length " << lenA << " in A, " << lenB << " in B at entry " << entry;
+	       result.note = message.str();
+	    }
+	    for(int elemItr = 0; elemItr < min(lenA, lenB); elemItr++)
+	       CompareValues(leafA->GetValue(elemItr), leafB->GetValue(elemItr), entry,
+			     singlePrecision[leafItr], leafTolerances[leafItr], result);
+	 }
+      }
+
+      delete treeA;
+      delete treeB;
+   }
+
+   //worker: the leaves with index % nWorkers == workerItr
+   void RunWorker(const string& fileNameA, const string& fileNameB, const vector<TreeTask>& tasks,
+		  const vector<int>& workerOfResult, int workerItr,
+		  const vector<TolerancePattern>& tolerances, vector<RQResult>& results)
+   {
+      TFile* fileA = OpenFile(fileNameA);
+      TFile* fileB = OpenFile(fileNameB);
+
+      for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+      {
+	 vector<int> resultIndices;
+	 for(uint resItr = 0; resItr < tasks[taskItr].results.size(); resItr++)
+	    if(workerOfResult[tasks[taskItr].results[resItr]] == workerItr)
+	       resultIndices.push_back(tasks[taskItr].results[resItr]);
+	 if(!resultIndices.empty())
+	    CompareTree(fileA, fileB, tasks[taskItr], resultIndices, tolerances, results);
+      }
+
+      fileA->Close();
+      fileB->Close();
+      delete fileA;
+      delete fileB;
+   }
+
+   //results travel from the workers as one text line per leaf
+   void WriteResult(FILE* out, int index, const RQResult& result)
+   {
+      fprintf(out, "%d %ld %ld %ld %.17g %.17g %.17g %.17g %.17g %ld %.17g %.17g %s\n",
+	      index, result.nCompared, result.nDiffer, result.nFail, result.maxAbs, result.maxRel,
+	      result.maxUlp, result.sumDiff, result.sumDiff2, result.worstEntry, result.worstA,
+	      result.worstB, result.note.c_str());
+   }
+
+   bool ReadResults(FILE* in, vector<RQResult>& results)
+   {
+      char line[4096];
+      while(fgets(line, sizeof(line), in))
+      {
+	 int index, nChars = 0;
+	 RQResult tmp;
+	 if(sscanf(line, "%d %ld %ld %ld %lg %lg %lg %lg %lg %ld %lg %lg %n",
+		   &index, &tmp.nCompared, &tmp.nDiffer, &tmp.nFail, &tmp.maxAbs, &tmp.maxRel,
+		   &tmp.maxUlp, &tmp.sumDiff, &tmp.sumDiff2, &tmp.worstEntry, &tmp.worstA,
+		   &tmp.worstB, &nChars) < 12 || index < 0 || index >= (int)results.size())
+	    return false;
+
+	 RQResult& result = results[index];
+	 result.nCompared = tmp.nCompared;
+	 result.nDiffer = tmp.nDiffer;
+	 result.nFail = tmp.nFail;
+	 result.maxAbs = tmp.maxAbs;
+	 result.maxRel = tmp.maxRel;
+	 result.maxUlp = tmp.maxUlp;
+	 result.sumDiff = tmp.sumDiff;
+	 result.sumDiff2 = tmp.sumDiff2;
+	 result.worstEntry = tmp.worstEntry;
+	 result.worstA = tmp.worstA;
+	 result.worstB = tmp.worstB;
+	 string note = line + nChars;
+	 if(!note.empty() && note[note.size()-1] == '\n') note.erase(note.size()-1);
+	 if(!note.empty()) result.note = note;
+      }
+      return true;
+   }
+
+   //leaves go to the worker with the fewest compressed bytes so far, largest first
+   vector<int> AssignWorkers(const vector<RQResult>& results, int nWorkers)
+   {
+      multimap<double, int> bySize;
+      for(uint resItr = 0; resItr < results.size(); resItr++)
+	 bySize.insert(make_pair(-results[resItr].zipBytes, (int)resItr));
+
+      vector<int> workerOfResult(results.size(), 0);
+      vector<double> load(nWorkers, 0.);
+      for(multimap<double, int>::const_iterator itr = bySize.begin(); itr != bySize.end(); ++itr)
+      {
+	 int worker = min_element(load.begin(), load.end()) - load.begin();
+	 workerOfResult[itr->second] = worker;
+	 load[worker] -= itr->first;
+      }
+      return workerOfResult;
+   }
+
+   void PrintResult(const RQResult& result, int nPrecision)
+   {
+      double mean = (result.nDiffer > 0 ? result.sumDiff/result.nCompared : 0.);
+      double rms = (result.nDiffer > 0 ? sqrt(result.sumDiff2/result.nCompared) : 0.);
+      cout << left << setw(40) << (result.dir + "/" + result.tree + "/" + result.leaf) << right
+	   << setw(10) << result.nDiffer << setw(10) << result.nFail
+	   << setprecision(nPrecision) << scientific
+	   << setw(14) << result.maxAbs << setw(14) << result.maxRel << setw(14) << result.maxUlp
+	   << setw(14) << mean << setw(14) << rms;
+      if(result.worstEntry >= 0)
+	 cout << "  entry " << result.worstEntry << ": " << setprecision(17) << result.worstA
+	      << " vs " << result.worstB;
+      if(!result.note.empty())
+	 cout << "  (" << result.note << ")";
+      cout << endl;
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("rqdiff [<options>] <fileA> <fileB>");
+   cmd.AddCommandSwitch('c',"tolerances","Tolerance file (default: exact comparison)","file");
+   cmd.AddCommandSwitch('d',"dirs","Comma separated directories to compare (default rqDir,rrqDir)","list");
+   cmd.AddCommandSwitch('t',"trees","Only compare trees matching this pattern, e.g. 'zip*'","pattern");
+   cmd.AddCommandSwitch('j',"jobs","Number of worker processes (default: number of cpus)","n");
+   cmd.AddCommandSwitch('o',"csv","CSV file with the statistics of every RQ","file");
+   cmd.AddCommandSwitch('a',"all","Also print RQs which differ within their tolerance");
+   if(cmd.ProcessCommandLine(argc, argv) != 2)
+      cmd.PrintSwitches();
+
+   string fileNameA = cmd.GetCommandArg(0);
+   string fileNameB = cmd.GetCommandArg(1);
+   vector<string> dirNames = SplitList(cmd.GetNCallsToOption("dirs") > 0 ? cmd.GetArgumentCall("dirs") : "rqDir,rrqDir");
+   string treePattern = (cmd.GetNCallsToOption("trees") > 0 ? cmd.GetArgumentCall("trees") : "");
+   int nWorkers = (cmd.GetNCallsToOption("jobs") > 0 ? atoi(cmd.GetArgumentCall("jobs")) : sysconf(_SC_NPROCESSORS_ONLN));
+   bool printAll = (cmd.GetNCallsToOption("all") > 0);
+   if(nWorkers < 1) nWorkers = 1;
+
+   vector<TolerancePattern> tolerances;
+   if(cmd.GetNCallsToOption("tolerances") > 0)
+      tolerances = ReadTolerances(cmd.GetArgumentCall("tolerances"));
+
+   //missing dictionaries etc. are not our business here
+   gErrorIgnoreLevel = kError;
+
+   double startSec = NowSec();
+   vector<TreeTask> tasks;
+   vector<RQResult> results;
+   vector<string> structure;
+   ScanFiles(fileNameA, fileNameB, dirNames, treePattern, tolerances, tasks, results, structure);
+
+   if(nWorkers > (int)results.size()) nWorkers = max((int)results.size(), 1);
+   vector<int> workerOfResult = AssignWorkers(results, nWorkers);
+
+   if(nWorkers == 1)
+      RunWorker(fileNameA, fileNameB, tasks, workerOfResult, 0, tolerances, results);
+   else
+   {
+      //ROOT I/O is not thread safe per file: every worker is a process with its own files
+      vector<FILE*> outputs(nWorkers);
+      vector<pid_t> pids(nWorkers);
+      cout.flush();
+      for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+      {
+	 outputs[workerItr] = tmpfile();
+	 if(outputs[workerItr] == NULL)
+	 {
+	    cerr <<"rqdiff: ERROR cannot create temporary file" << endl;
+	    exit(1);
+	 }
+	 pids[workerItr] = fork();
+	 if(pids[workerItr] < 0)
+	 {
+	    cerr <<"rqdiff: ERROR could not fork worker " << workerItr << endl;
+	    exit(1);
+	 }
+	 if(pids[workerItr] == 0)
+	 {
+	    RunWorker(fileNameA, fileNameB, tasks, workerOfResult, workerItr, tolerances, results);
+	    for(uint resItr = 0; resItr < results.size(); resItr++)
+	       if(workerOfResult[resItr] == workerItr)
+		  WriteResult(outputs[workerItr], resItr, results[resItr]);
+	    _exit(fflush(outputs[workerItr]) == 0 ? 0 : 1);
+	 }
+      }
+
+      for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+      {
+	 int status = 0;
+	 if(waitpid(pids[workerItr], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	 {
+	    cerr <<"rqdiff: ERROR worker " << workerItr << " failed" << endl;
+	    exit(1);
+	 }
+	 rewind(outputs[workerItr]);
+	 if(!ReadResults(outputs[workerItr], results))
+	 {
+	    cerr <<"rqdiff: ERROR cannot read the results of worker " << workerItr << endl;
+	    exit(1);
+	 }
+	 fclose(outputs[workerItr]);
+      }
+   }
+   double wallSec = NowSec() - startSec;
+
+   //report
+   long nDiffer = 0, nFail = 0;
+   for(uint resItr = 0; resItr < results.size(); resItr++)
+   {
+      if(results[resItr].nDiffer > 0) nDiffer++;
+      if(results[resItr].nFail > 0 || !results[resItr].note.empty()) nFail++;
+   }
+
+   for(uint structItr = 0; structItr < structure.size(); structItr++)
+      cout <<"rqdiff: STRUCTURE " << structure[structItr] << endl;
+
+   if(nFail > 0 || (printAll && nDiffer > 0))
+   {
+      cout << left << setw(40) << "RQ" << right << setw(10) << "nDiffer" << setw(10) << "nFail"
+	   << setw(14) << "maxAbs" << setw(14) << "maxRel" << setw(14) << "maxUlp"
+	   << setw(14) << "mean(A-B)" << setw(14) << "rms(A-B)" << "  largest difference" << endl;
+      for(uint resItr = 0; resItr < results.size(); resItr++)
+      {
+	 const RQResult& result = results[resItr];
+	 if(result.nFail > 0 || !result.note.empty() || (printAll && result.nDiffer > 0))
+	    PrintResult(result, 3);
+      }
+   }
+
+   if(cmd.GetNCallsToOption("csv") > 0)
+   {
+      string csvFile = cmd.GetArgumentCall("csv");
+      ofstream csv(csvFile.c_str());
+      if(!csv)
+      {
+	 cerr <<"rqdiff: ERROR cannot open " << csvFile << endl;
+	 exit(1);
+      }
+      csv << "dir,tree,rq,nCompared,nDiffer,nFail,maxAbs,maxRel,maxUlp,meanDiff,rmsDiff,worstEntry,worstA,worstB" << endl;
+      csv << setprecision(17);
+      for(uint resItr = 0; resItr < results.size(); resItr++)
+      {
+	 const RQResult& result = results[resItr];
+	 double n = (result.nCompared > 0 ? result.nCompared : 1);
+	 csv << result.dir << "," << result.tree << "," << result.leaf << "," << result.nCompared << ","
+	     << result.nDiffer << "," << result.nFail << "," << result.maxAbs << "," << result.maxRel << ","
+	     << result.maxUlp << "," << result.sumDiff/n << "," << sqrt(result.sumDiff2/n) << ","
+	     << result.worstEntry << "," << result.worstA << "," << result.worstB << endl;
+      }
+   }
+
+   struct stat statA, statB;
+   double fileMB = 0.;
+   if(stat(fileNameA.c_str(), &statA) == 0 && stat(fileNameB.c_str(), &statB) == 0)
+      fileMB = (statA.st_size + statB.st_size)/1.e6;
+
+   cout <<"rqdiff: " << results.size() << " RQs in " << tasks.size() << " trees compared, "
+	<< nDiffer << " differ, " << nFail << " out of tolerance, " << structure.size()
+	<<" structural differences (" << fixed << setprecision(2) << wallSec << " s, "
+	<< (wallSec > 0. ? fileMB/wallSec : 0.) << " MB/s, " << nWorkers << " workers)" << endl;
+
+   return (nFail == 0 && structure.empty() ? 0 : 1);
+}
@@ -9,6 +9,9 @@
 //
 //Modifications:
 //
+//Oct. 2026 - Activate reads RQs which are not stored as double (OUTPUT_PRECISION_FILE in BatRoot)
+//            through their leaves, converted to double in ReadNextEntry.
+//
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
@@ -35,6 +38,7 @@ BatCalibIOManager::BatCalibIOManager(const UserDataManager& myUserData, const st
     fFileWriter(NULL),
     fOptions(myUserData),
     fActiveReadTree(NULL),
+    fConvertedTreeNumber(-1),
     fOutputRRQTree(NULL)
 {
 
@@ -459,6 +463,7 @@ void BatCalibIOManager::DeleteActiveTree()
     }
 
     fActiveBranchMap.clear();
+    fConvertedLeafMap.clear();
 
 //   cout <<"Done cleaning out the active branch map!" << endl;
 
@@ -490,6 +495,27 @@ void BatCalibIOManager::AddFriendTree(const string& dir, const string& treename)
 void BatCalibIOManager::ReadNextEntry(int eventCtr)
 {
    fActiveReadTree->GetEntry(eventCtr);
+
+   //RQs which are not double in the file: the leaves belong to the current tree of the chain
+   if(!fConvertedLeafMap.empty())
+   {
+      bool newTree = (fActiveReadTree->GetTreeNumber() != fConvertedTreeNumber);
+      fConvertedTreeNumber = fActiveReadTree->GetTreeNumber();
+
+      for(map<string, TLeaf*>::iterator leafItr = fConvertedLeafMap.begin(); leafItr != fConvertedLeafMap.end(); ++leafItr)
+      {
+	 if(newTree)
+	    leafItr->second = fActiveReadTree->GetLeaf(leafItr->first.c_str());
+
+	 if(leafItr->second == NULL)
+	 {
+	    cerr <<"BatCalibIOManager::ReadNextEntry ERROR! " << leafItr->first << " does not exist in "
+		 << fActiveReadTree->GetCurrentFile()->GetName() << endl;
+	    exit(1);
+	 }
+	 *(fActiveBranchMap[leafItr->first]) = leafItr->second->GetValue();
+      }
+   }
    
    return;
 }
@@ -586,16 +612,9 @@ int BatCalibIOManager::Activate(const string& varName)
       exit(1);
    }
        
-   //add the variable to the map 
-   fActiveBranchMap.insert(pair<string,double*>(varName, new double)); 
-   //cout <<"Activating branch: " << varName << endl;
-
-   //set the branch address to the map entry
-   map< string, double*>::iterator mapItr = fActiveBranchMap.find(varName);
-   fActiveReadTree->SetBranchAddress(varName.c_str(), mapItr->second);
-   
    //Check that the RQ exists and exit if not
-   if(fActiveReadTree->GetBranchStatus(varName.c_str()) != 1)
+   TLeaf* leaf = fActiveReadTree->GetLeaf(varName.c_str());
+   if(leaf == NULL || fActiveReadTree->GetBranchStatus(varName.c_str()) != 1)
    {
       cout <<"ERROR! BatCalibIOManager::Activate()  Attempting to read " << varName <<" but it does not exist in rq file! "
 	   <<"Check your options file before continuing!"
@@ -604,6 +623,24 @@ int BatCalibIOManager::Activate(const string& varName)
       exit(1);
    }
 
+   //add the variable to the map 
+   fActiveBranchMap.insert(pair<string,double*>(varName, new double)); 
+   //cout <<"Activating branch: " << varName << endl;
+
+   //double RQs are read straight into the map entry; RQs stored with another type
+   //(float, int, ... from OUTPUT_PRECISION_FILE) would not match the address and are
+   //converted from their leaf after each entry.  The type is the one of the first file
+   //of the chain, all files are expected to use the same precision policy.
+   map< string, double*>::iterator mapItr = fActiveBranchMap.find(varName);
+   string leafType = leaf->GetTypeName();
+   if(leafType == "Double_t" || leafType == "Double32_t")
+      fActiveReadTree->SetBranchAddress(varName.c_str(), mapItr->second);
+   else
+   {
+      fConvertedLeafMap[varName] = leaf;
+      fConvertedTreeNumber = fActiveReadTree->GetTreeNumber();
+   }
+
    return fActiveReadTree->GetBranchStatus(varName.c_str());
 }
 
@@ -20,6 +20,7 @@
 #include "TFile.h"
 #include "TTree.h"
 #include "TChain.h"
+#include "TLeaf.h"
 
 #include "UserDataManager.h"
 
@@ -90,6 +91,8 @@ class BatCalibIOManager
       //File Reading variables - FIXME the map below probably doesn't need to be a pointer to double
       TChain*               fActiveReadTree;
       map<string, double*>  fActiveBranchMap;  //only select branches within tree are active for reading
+      map<string, TLeaf*>   fConvertedLeafMap; //active branches which are not double in the file, see Activate
+      int                   fConvertedTreeNumber; //tree of the chain the leaves above belong to
 
       //The key = algorithm name, val = vector of 1's and 0's stating whether routine was on or off
       //val vector index = detNum - 1
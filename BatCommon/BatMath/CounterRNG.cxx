@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////// 
+//Class Name: CounterRNG 
+//Description: Counter-based random number generator (see header file)
+//
+//Modifications:
+//
+////////////////////////////////////////////////////////////////////////////////// 
+
+#include "CounterRNG.h"
+
+#include <cmath>
+
+
+uint32_t CounterRNG::fGlobalSeed = 0;
+
+namespace {
+
+   //Philox4x32 constants (Salmon et al., SC11)
+   const uint32_t kPhiloxM0 = 0xD2511F53;
+   const uint32_t kPhiloxM1 = 0xCD9E8D57;
+   const uint32_t kPhiloxW0 = 0x9E3779B9;
+   const uint32_t kPhiloxW1 = 0xBB67AE85;
+   const int      kPhiloxRounds = 10;
+
+   inline void MulHiLo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo)
+   {
+      uint64_t product = (uint64_t)a * b;
+      hi = (uint32_t)(product >> 32);
+      lo = (uint32_t)product;
+   }
+
+}
+
+
+CounterRNG::CounterRNG(uint64_t series, uint32_t event, uint32_t detNum, uint32_t overlay, uint32_t purpose) :
+   fBufferPos(4)
+{
+   fKey[0] = (uint32_t)series;
+   fKey[1] = (uint32_t)(series >> 32) ^ (fGlobalSeed * kPhiloxW1);
+
+   fCounter[0] = purpose << 24;   //low 24 bits: block index (4 draws per block)
+   fCounter[1] = event;
+   fCounter[2] = detNum;
+   fCounter[3] = overlay;
+}
+
+CounterRNG CounterRNG::FromSeed(uint32_t seed, uint32_t purpose)
+{
+   return CounterRNG(0, seed, 0, 0, purpose);
+}
+
+
+void CounterRNG::Generate()
+{
+   uint32_t ctr[4] = { fCounter[0], fCounter[1], fCounter[2], fCounter[3] };
+   uint32_t key[2] = { fKey[0], fKey[1] };
+
+   for(int roundItr = 0; roundItr < kPhiloxRounds; roundItr++)
+   {
+      uint32_t hi0, lo0, hi1, lo1;
+      MulHiLo(kPhiloxM0, ctr[0], hi0, lo0);
+      MulHiLo(kPhiloxM1, ctr[2], hi1, lo1);
+
+      uint32_t next[4] = { hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0 };
+      ctr[0] = next[0]; ctr[1] = next[1]; ctr[2] = next[2]; ctr[3] = next[3];
+
+      key[0] += kPhiloxW0;
+      key[1] += kPhiloxW1;
+   }
+
+   fBuffer[0] = ctr[0]; fBuffer[1] = ctr[1]; fBuffer[2] = ctr[2]; fBuffer[3] = ctr[3];
+   fBufferPos = 0;
+
+   //next block, purpose bits untouched
+   fCounter[0] = (fCounter[0] & 0xFF000000) | ((fCounter[0] + 1) & 0x00FFFFFF);
+}
+
+
+uint32_t CounterRNG::NextUInt()
+{
+   if(fBufferPos >= 4) Generate();
+   return fBuffer[fBufferPos++];
+}
+
+double CounterRNG::Uniform()
+{
+   //53-bit mantissa from two draws, shifted off zero
+   uint64_t bits = ((uint64_t)(NextUInt() >> 5) << 26) | (NextUInt() >> 6);
+   return (bits + 0.5) / 9007199254740992.;
+}
+
+double CounterRNG::Uniform(double low, double high)
+{
+   return low + (high - low) * Uniform();
+}
+
+uint32_t CounterRNG::Integer(uint32_t n)
+{
+   if(n == 0) return 0;
+   return (uint32_t)(Uniform() * n);
+}
+
+double CounterRNG::Gaus(double mean, double sigma)
+{
+   //Box-Muller, one value per call so the stream position stays simple
+   double u1 = Uniform();
+   double u2 = Uniform();
+   return mean + sigma * sqrt(-2. * log(u1)) * cos(2. * M_PI * u2);
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////// 
+//Class Name: CounterRNG 
+//Description: Counter-based random number generator (Philox4x32-10). The
+//             stream is a pure function of its key (series, event, detector,
+//             overlay, purpose) and of the draw index, so the same event gives
+//             the same draws whatever thread, job or order it is processed in,
+//             and different keys give independent streams. Nothing is shared
+//             between instances: make one where the draws are needed.
+//
+//Usage:
+//   CounterRNG rng(series, event, detNum, overlay, CounterRNG::kLibraryDraw);
+//   double x = rng.Uniform(-1, 1);
+//
+//Modifications:
+//
+////////////////////////////////////////////////////////////////////////////////// 
+
+#ifndef COUNTERRNG_H
+#define COUNTERRNG_H
+
+#include <stdint.h>
+
+
+class CounterRNG
+{
+   public:
+
+      //what the draws are used for; part of the key so different uses never overlap
+      enum StreamPurpose {
+	 kGeneric            = 0,
+	 kLibraryDraw        = 1,   //pulse library entry for simulation from pulses
+	 kFlatSpectrum       = 2,   //SimulateFromRandoms energies
+	 kPositionDependence = 3    //PulseTools::AddPositionDependence
+      };
+
+      CounterRNG(uint64_t series, uint32_t event, uint32_t detNum = 0, uint32_t overlay = 0, 
+		 uint32_t purpose = kGeneric);
+
+      //same generator for everything keyed by a plain seed (old "int seed" interfaces)
+      static CounterRNG FromSeed(uint32_t seed, uint32_t purpose = kGeneric);
+
+      //job-wide seed mixed into every key (default 0), e.g. to make a statistically
+      //independent copy of a whole production
+      static void     SetGlobalSeed(uint32_t seed) { fGlobalSeed = seed; }
+      static uint32_t GetGlobalSeed()              { return fGlobalSeed; }
+
+      uint32_t NextUInt();
+      double   Uniform();                        //(0,1)
+      double   Uniform(double low, double high);
+      uint32_t Integer(uint32_t n);              //[0,n)
+      double   Gaus(double mean = 0., double sigma = 1.);
+
+   private:
+
+      void Generate();
+
+      uint32_t fKey[2];
+      uint32_t fCounter[4];   //fCounter[0] is the block index within this stream
+      uint32_t fBuffer[4];
+      int      fBufferPos;
+
+      static uint32_t fGlobalSeed;
+};
+
+#endif /* COUNTERRNG_H */
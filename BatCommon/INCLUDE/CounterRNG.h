@@ -0,0 +1 @@
+../BatMath/CounterRNG.h
\ No newline at end of file
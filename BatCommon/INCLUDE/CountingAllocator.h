@@ -0,0 +1 @@
+../utilities/CountingAllocator.h
\ No newline at end of file
@@ -0,0 +1 @@
+../datareader/MidasEventSource.h
\ No newline at end of file
@@ -0,0 +1 @@
+../utilities/ProcessingTimer.h
\ No newline at end of file
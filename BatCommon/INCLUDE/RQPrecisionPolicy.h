@@ -0,0 +1 @@
+../utilities/RQPrecisionPolicy.h
\ No newline at end of file
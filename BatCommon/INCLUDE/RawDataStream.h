@@ -0,0 +1 @@
+../datareader/RawDataStream.h
\ No newline at end of file
@@ -0,0 +1 @@
+../datareader/RawInflater.h
\ No newline at end of file
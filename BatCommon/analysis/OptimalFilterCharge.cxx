@@ -83,6 +83,15 @@ void OptimalFilterCharge::ConstructRQList()
 
 //This is the main call for this analysis
 void OptimalFilterCharge::DoCalc(const vector<double>& aPulse)
+{
+   vector<TComplex> pulseFFT;
+   if(!aPulse.empty()) PulseTools::RealToComplexFFT(aPulse, pulseFFT);
+   DoCalc(aPulse, pulseFFT);
+   return;
+}
+
+//same, with the FFT of the pulse already computed, e.g. PulseData::GetBaselineSubNormPulseFFT()
+void OptimalFilterCharge::DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT)
 {
 //   cout <<"Hello from OptimalFilterCharge::DoCalc!" << endl;
 
@@ -123,7 +132,7 @@ void OptimalFilterCharge::DoCalc(const vector<double>& aPulse)
    vector<double> p_prod_ifftRe;
 
    //1. construct fitpulse fft's
-   PulseTools::RealToComplexFFT(aPulse, pulseFFT);
+   pulseFFT = aPulseFFT;
    double amp0 = 0.;
 
 
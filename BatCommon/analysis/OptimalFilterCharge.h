@@ -41,6 +41,7 @@ class OptimalFilterCharge : public TCDMSAnalysis
 
       //do the calculations
       void DoCalc(const vector<double>& aPulse);
+      void DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT); //aPulseFFT from PulseTools::RealToComplexFFT(aPulse)
 
       //Get functions
       double GetVolts()  const { return fVolts;  }
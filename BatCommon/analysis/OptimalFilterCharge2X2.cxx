@@ -13,6 +13,7 @@
 //  Modifications:
 //      B. Serfass (Jan. 8, 2013): modify structure to calculate charge 
 //                                 OF for both sides
+//      Oct. 2026: DoCalc with the pulse FFTs computed by the caller
 ////////////////////////////////////////////////////////////////////////////////// 
 
 #include <iostream>
@@ -285,6 +286,14 @@ void OptimalFilterCharge2X2::DoCalc(const vector<double>& aPulse1, const vector<
 
 /////////////////////////////////////////////////////////////////////////////////////
 void OptimalFilterCharge2X2::DoCalc(const map<string,vector<double> >& aPulseMap)
+{
+    DoCalc(aPulseMap, map<string,vector<TComplex> >());
+}
+
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+void OptimalFilterCharge2X2::DoCalc(const map<string,vector<double> >& aPulseMap, const map<string,vector<TComplex> >& aPulseFFTMap)
 {
 
     ////////////////////////////////////////////////////// 
@@ -379,12 +388,12 @@ void OptimalFilterCharge2X2::DoCalc(const map<string,vector<double> >& aPulseMap
     
     // PulseMap1
     map<string, map<int, double> >   ampChisqAllDelayMap1; 
-    ampChisqAllDelayMap1 = CalcOFallTimeShifts(aPulseMap1,fNoiseFFTSq,fOptimalFilter,fQinverse);
+    ampChisqAllDelayMap1 = CalcOFallTimeShifts(aPulseMap1,fNoiseFFTSq,fOptimalFilter,fQinverse,aPulseFFTMap);
     
     // PulseMap2 (if available)
     map<string, map<int, double> >   ampChisqAllDelayMap2; 
     if (!aPulseMap2.empty())
-      ampChisqAllDelayMap2 = CalcOFallTimeShifts(aPulseMap2,fNoiseFFTSq,fOptimalFilter,fQinverse);
+      ampChisqAllDelayMap2 = CalcOFallTimeShifts(aPulseMap2,fNoiseFFTSq,fOptimalFilter,fQinverse,aPulseFFTMap);
     
     
     
@@ -603,7 +612,8 @@ void OptimalFilterCharge2X2::DoCalc(const map<string,vector<double> >& aPulseMap
 map<string, map<int, double> >  OptimalFilterCharge2X2::CalcOFallTimeShifts(const map<string, vector<double> >& pulseMap, 
 									    const map<string, vector<double> >& noiseFFTSqMap,
 									    const map<string, vector<TComplex> >& optimalFilterMap,
-									    const map<string, double>& QinverseMap)
+									    const map<string, double>& QinverseMap,
+									    const map<string, vector<TComplex> >& pulseFFTMapIn)
 {
  
     ////////////////////////////////////////////////////////// 
@@ -659,9 +669,13 @@ map<string, map<int, double> >  OptimalFilterCharge2X2::CalcOFallTimeShifts(cons
       string chanName = pulseIter->first;
       vector<double> aPulse =  pulseIter->second;
       
-      // get FFT
+      // get FFT (from the caller if available)
       vector<TComplex> aPulseFFT;
-      PulseTools::RealToComplexFFT(aPulse, aPulseFFT);
+      map<string, vector<TComplex> >::const_iterator fftIter = pulseFFTMapIn.find(chanName);
+      if (fftIter != pulseFFTMapIn.end())
+	aPulseFFT = fftIter->second;
+      else
+	PulseTools::RealToComplexFFT(aPulse, aPulseFFT);
       
       // Normalize for proper unit (FIXME: will need to clean units...) 
       for(int binItr = 0; binItr < nBins; binItr++)
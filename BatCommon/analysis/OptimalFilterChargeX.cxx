@@ -146,6 +146,18 @@ void OptimalFilterChargeX::StoreAs(const string& chanType)
 
 //This is the main call for this analysis
 void OptimalFilterChargeX::DoCalc(const vector<double>& aPulseQI, const vector<double>& aPulseQO)
+{
+   vector<TComplex> pulseFFTQI;
+   vector<TComplex> pulseFFTQO;
+   if(!aPulseQI.empty()) PulseTools::RealToComplexFFT(aPulseQI, pulseFFTQI);
+   if(!aPulseQO.empty()) PulseTools::RealToComplexFFT(aPulseQO, pulseFFTQO);
+   DoCalc(aPulseQI, aPulseQO, pulseFFTQI, pulseFFTQO);
+   return;
+}
+
+//same, with the FFTs of the pulses already computed, e.g. PulseData::GetBaselineSubNormPulseFFT()
+void OptimalFilterChargeX::DoCalc(const vector<double>& aPulseQI, const vector<double>& aPulseQO,
+				  const vector<TComplex>& aPulseFFTQI, const vector<TComplex>& aPulseFFTQO)
 {
    //do your calculation here!
    int nBins = aPulseQI.size();
@@ -211,8 +223,8 @@ void OptimalFilterChargeX::DoCalc(const vector<double>& aPulseQI, const vector<d
    vector<double> qo_p_prod_ifftRe;
 
    //1. construct fitpulse fft's
-   PulseTools::RealToComplexFFT(aPulseQI, pulseFFTQI);
-   PulseTools::RealToComplexFFT(aPulseQO, pulseFFTQO);
+   pulseFFTQI = aPulseFFTQI;
+   pulseFFTQO = aPulseFFTQO;
 
    double amp0QI = 0.;
    double amp0QO = 0.;
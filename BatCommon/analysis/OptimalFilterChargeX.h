@@ -51,6 +51,8 @@ class OptimalFilterChargeX : public TCDMSAnalysis
 
       //do the calculations
       void DoCalc(const vector<double>& aPulseQI, const vector<double>& aPulseQO);
+      void DoCalc(const vector<double>& aPulseQI, const vector<double>& aPulseQO,
+		  const vector<TComplex>& aPulseFFTQI, const vector<TComplex>& aPulseFFTQO); //FFTs from PulseTools::RealToComplexFFT
 
       //define public functions here
       void StoreAs(const string& chanType);
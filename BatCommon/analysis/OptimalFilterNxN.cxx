@@ -11,7 +11,7 @@
 //  Creation Date:  Feb. 27, 2013
 //
 //  Modifications:
-//
+//      Oct. 2026: DoCalc with the pulse FFTs computed by the caller
 ////////////////////////////////////////////////////////////////////////////////// 
 
 #include <iostream>
@@ -475,6 +475,14 @@ void OptimalFilterNxN::DoCalc(const vector<double>& aPulse1, const vector<double
 
 /////////////////////////////////////////////////////////////////////////////////////
 void OptimalFilterNxN::DoCalc(const map<string,vector<double> >& aPulseMap)
+{
+    DoCalc(aPulseMap, map<string,vector<TComplex> >());
+}
+
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+void OptimalFilterNxN::DoCalc(const map<string,vector<double> >& aPulseMap, const map<string,vector<TComplex> >& aPulseFFTMap)
 {
 
     ////////////////////////////////////////////////////// 
@@ -563,12 +571,12 @@ void OptimalFilterNxN::DoCalc(const map<string,vector<double> >& aPulseMap)
     
     // PulseMap1
     map<string, map<int, double> >   ampChisqAllDelayMap1; 
-    ampChisqAllDelayMap1 = CalcOFallTimeShifts(aPulseMap1,fNoiseFFTSq,fOptimalFilter,fWinverse);
+    ampChisqAllDelayMap1 = CalcOFallTimeShifts(aPulseMap1,fNoiseFFTSq,fOptimalFilter,fWinverse,aPulseFFTMap);
     
     // PulseMap2 (if available)
     map<string, map<int, double> >   ampChisqAllDelayMap2; 
     if (!aPulseMap2.empty())
-      ampChisqAllDelayMap2 = CalcOFallTimeShifts(aPulseMap2,fNoiseFFTSq,fOptimalFilter,fWinverse);
+      ampChisqAllDelayMap2 = CalcOFallTimeShifts(aPulseMap2,fNoiseFFTSq,fOptimalFilter,fWinverse,aPulseFFTMap);
     
     
     
@@ -814,7 +822,8 @@ void OptimalFilterNxN::DoCalc(const map<string,vector<double> >& aPulseMap)
 map<string, map<int, double> >  OptimalFilterNxN::CalcOFallTimeShifts(const map<string, vector<double> >& pulseMap, 
 									    const map<string, vector<double> >& noiseFFTSqMap,
 									    const map<string, vector<TComplex> >& optimalFilterMap,
-									    const map<string, double>& QinverseMap)
+									    const map<string, double>& QinverseMap,
+									    const map<string, vector<TComplex> >& pulseFFTMapIn)
 {
  
     ////////////////////////////////////////////////////////// 
@@ -871,9 +880,13 @@ map<string, map<int, double> >  OptimalFilterNxN::CalcOFallTimeShifts(const map<
       string chanName = pulseIter->first;
       vector<double> aPulse =  pulseIter->second;
       
-      // get FFT
+      // get FFT (from the caller if available)
       vector<TComplex> aPulseFFT;
-      PulseTools::RealToComplexFFT(aPulse, aPulseFFT);
+      map<string, vector<TComplex> >::const_iterator fftIter = pulseFFTMapIn.find(chanName);
+      if (fftIter != pulseFFTMapIn.end())
+	aPulseFFT = fftIter->second;
+      else
+	PulseTools::RealToComplexFFT(aPulse, aPulseFFT);
       
       // Normalize for proper unit (FIXME: will need to clean units...) 
       for(int binItr = 0; binItr < nBins; binItr++)
@@ -38,6 +38,8 @@ public:
     
     // Calc functions
     void DoCalc(const map<string,vector<double> >& aPulseMap);
+    // pulse FFTs (PulseTools::RealToComplexFFT) by channel, channels missing from the map are transformed here
+    void DoCalc(const map<string,vector<double> >& aPulseMap, const map<string,vector<TComplex> >& aPulseFFTMap);
     
     // the above function can be also called using pulses direcly
     // rather than pulseMap. The default channel names are specified
@@ -131,7 +133,8 @@ private:
     map<string, map<int, double> >  CalcOFallTimeShifts(const map<string, vector<double> >& pulseMap, 
 							const map<string, vector<double> >& noiseFFTSqMap,
 							const map<string, vector<TComplex> >& optimalFilterMap,
-						        const map<string, double>& QinverseMap);	
+						        const map<string, double>& QinverseMap,
+							const map<string, vector<TComplex> >& pulseFFTMapIn);	
       
     int fDoDelayInterpolation;
     int fDoZdelayConstraint;
@@ -94,6 +94,15 @@ void OptimalFilterPhonon::ConstructRQList()
 
 //This is the main call 
 void OptimalFilterPhonon::DoCalc(const vector<double>& aPulse)
+{
+   vector<TComplex> pulseFFT;
+   if(!aPulse.empty()) PulseTools::RealToComplexFFT(aPulse, pulseFFT);
+   DoCalc(aPulse, pulseFFT);
+   return;
+}
+
+//same, with the FFT of the pulse already computed, e.g. PulseData::GetBaselineSubNormPulseFFT()
+void OptimalFilterPhonon::DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT)
 {
    //do your calculation here!
 
@@ -136,7 +145,7 @@ void OptimalFilterPhonon::DoCalc(const vector<double>& aPulse)
    //===== 1. construct fitpulse fft =====
 
    //PulseTools::RealToComplexFFT(fFakePulse, re_PulseFFT, im_PulseFFT); //for testing only
-   PulseTools::RealToComplexFFT(aPulse, pulseFFT);
+   pulseFFT = aPulseFFT;
    double amp0 = 0.;
 
    //===== 2. construct p_prod = sqrt(fdT) * pulse_fft * s*/J =====
@@ -42,6 +42,7 @@ class OptimalFilterPhonon : public TCDMSAnalysis
 
       //do the calculations
       void DoCalc(const vector<double>& aPulse); 
+      void DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT); //aPulseFFT from PulseTools::RealToComplexFFT(aPulse)
 
       //define public functions here
       double GeteV() const     { return fAmp; }
@@ -162,6 +162,15 @@ void OptimalFilterPhonon1X2::LoadNormalizations(const vector<double>& noiseFFTSq
 ////////////////////////////////////////////////////////
 //This is the main call for your analysis
 void OptimalFilterPhonon1X2::DoCalc(const vector<double>& aPulse)
+{
+    vector<TComplex> pulseFFT;
+    if(!aPulse.empty()) PulseTools::RealToComplexFFT(aPulse, pulseFFT);
+    DoCalc(aPulse, pulseFFT);
+    return;
+}
+
+//same, with the FFT of the pulse already computed, e.g. PulseData::GetBaselineSubNormPulseFFT()
+void OptimalFilterPhonon1X2::DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT)
 {
     int     nBins   = aPulse.size();
     double  inBins  = 1/(double)nBins;
@@ -219,7 +228,7 @@ void OptimalFilterPhonon1X2::DoCalc(const vector<double>& aPulse)
     templatesFFT.push_back(fResidualTemplateFFT);
     
     //Pulse FFT
-    PulseTools::RealToComplexFFT(aPulse,pulseFFT);
+    pulseFFT = aPulseFFT;
     
     for (int binItr = 0; binItr < nBins; binItr++)
     {
@@ -39,6 +39,7 @@ class OptimalFilterPhonon1X2 : public TCDMSAnalysis
 
     //Define functions
     void DoCalc(const vector<double>& aPulse);
+    void DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT); //aPulseFFT from PulseTools::RealToComplexFFT(aPulse)
     
     //Get functions
     double GetDelay() const { return fDelay; }
@@ -94,6 +94,15 @@ void OptimalFilterPhononNS::ConstructRQList()
 
 //This is the main call for your analysis
 void OptimalFilterPhononNS::DoCalc(const vector<double>& aPulse)
+{
+  vector<TComplex> pulseFFT;
+  if(!aPulse.empty()) PulseTools::RealToComplexFFT(aPulse, pulseFFT);
+  DoCalc(aPulse, pulseFFT);
+  return;
+}
+
+//same, with the FFT of the pulse already computed, e.g. PulseData::GetBaselineSubNormPulseFFT()
+void OptimalFilterPhononNS::DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT)
 {
 
   //check for null pulses
@@ -166,7 +175,7 @@ void OptimalFilterPhononNS::DoCalc(const vector<double>& aPulse)
    if(fDoNSFilter){
      //is it too slick to do it in the conditional?
      //seems more transparent now that I said that
-     if(!DoNSOF(aPulse,fDoInverseCalc,fDoDnCastCalc)){
+     if(!DoNSOF(aPulse,aPulseFFT,fDoInverseCalc,fDoDnCastCalc)){
         cerr <<"OptimalFilterPhononNS::DoCalc: ERROR! Optimal filter calculation failed!" << endl;
 	exit(1);
      }
@@ -280,7 +289,7 @@ void OptimalFilterPhononNS::LoadOFParams(const double& OFAmpsP, const double& OF
 
   return;
 }
-bool OptimalFilterPhononNS::DoNSOF(const vector<double> &aPulse, bool &DoInverseCalc,bool &DoDnCastCalc) 
+bool OptimalFilterPhononNS::DoNSOF(const vector<double> &aPulse, const vector<TComplex> &aPulseFFT, bool &DoInverseCalc,bool &DoDnCastCalc) 
 {
 
   //FIXME the implementation now only does the case where:
@@ -311,8 +320,7 @@ bool OptimalFilterPhononNS::DoNSOF(const vector<double> &aPulse, bool &DoInverse
   double fftscale = sqrt((double)nBins);
 
   //===== 1. construct fitpulse fft FIXME (generalize for downcasting) =====
-  PulseTools::RealToComplexFFT(aPulse, pulseFFT);
-  pulseFFT = PulseTools::pulseScale(pulseFFT,TComplex(sqrtdT,0));
+  pulseFFT = PulseTools::pulseScale(aPulseFFT,TComplex(sqrtdT,0));
 
   //FIXME slow, account for this in normalization
   //pulseFFT = PulseTools::pulseScale(pulseFFT,TComplex(sqrt((double)nBins),0));
@@ -58,6 +58,7 @@ class OptimalFilterPhononNS : public TCDMSAnalysis
 
       //do the calculations
       void DoCalc(const vector<double>& aPulse);
+      void DoCalc(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT); //aPulseFFT from PulseTools::RealToComplexFFT(aPulse)
 
       //define public functions here
       int GetVerbosity() const {return fVerbose; }
@@ -154,7 +155,7 @@ class OptimalFilterPhononNS : public TCDMSAnalysis
       vector<TComplex> fPulseTemplateFFT;
 
       //do actual calcuation in various situations (4 options total)
-      bool DoNSOF(const vector<double>& aPulse, bool &DoInverseCalc,bool &DoDnCastCalc); 
+      bool DoNSOF(const vector<double>& aPulse, const vector<TComplex>& aPulseFFT, bool &DoInverseCalc,bool &DoDnCastCalc); 
 
 
       //inefficient and will remove by absorbing things into CDMSBATS Vector object
@@ -1,6 +1,5 @@
 #include <iostream>
-
-#include "TRandom3.h"
+#include <algorithm>
 
 #include "SimulateFromRandoms.h"
 #include "PulseTools.h"
@@ -66,6 +65,13 @@ void SimulateFromRandoms::ConstructRQList()
 //implement an (adhoc) model of position dependence
 void SimulateFromRandoms::SimPTwFlatSpec(vector<double>& aPulse, double minE, double maxE, 
 					 double ptcal, const int seed)
+{
+  CounterRNG rng = CounterRNG::FromSeed(seed, CounterRNG::kFlatSpectrum);
+  SimPTwFlatSpec(aPulse, minE, maxE, ptcal, rng);
+}
+
+void SimulateFromRandoms::SimPTwFlatSpec(vector<double>& aPulse, double minE, double maxE, 
+					 double ptcal, CounterRNG& rng)
 {
   //check that PT template has been loaded
   if(fPTemplate.size() == 0)
@@ -84,8 +90,7 @@ void SimulateFromRandoms::SimPTwFlatSpec(vector<double>& aPulse, double minE, do
   }
 
   //Generate fake energy by sampling a flat spectrum from minE to maxE
-  TRandom3 rand(seed);
-  double roughAmpkev = rand.Uniform(minE, maxE); //in keV
+  double roughAmpkev = rng.Uniform(minE, maxE); //in keV
 
   double trueAmp = roughAmpkev/ptcal; //in BatRoot normalized units
   double trueDelay = 0.; 
@@ -9,6 +9,7 @@
 #include <map>
 
 #include "TCDMSAnalysis.h"
+#include "CounterRNG.h"
 
 using namespace std;
 
@@ -30,6 +31,8 @@ class SimulateFromRandoms : public TCDMSAnalysis
       //min and max E in keV
       void SimPTwFlatSpec(vector<double>& aPulse, double minE, double maxE, 
 			  double ptcal, const int seed=0); //dumb example
+      void SimPTwFlatSpec(vector<double>& aPulse, double minE, double maxE, 
+			  double ptcal, CounterRNG& rng);  //energies keyed by event (parallel safe)
       void SimPMonoenergetic(vector<double>& aPulse, double pulseE, 
 			     double ptcal);
       void SimQMonoenergetic(vector<double>& aPulse, map<string, double>& pulseE, 
@@ -32,7 +32,7 @@ class TCDMSAnalysis
       ~TCDMSAnalysis(); //destructor (not inherited)
 
       //Get functions
-      map<string,double>      GetRQList() const    { return fRQList; } 
+      const map<string,double>& GetRQList() const    { return fRQList; } 
       string                  GetClassName() const { return fClassName; }
       double                  GetRQVal(const string& rqName) const;
 
@@ -77,13 +77,13 @@ void AdminData::ConstructRQList()
 
 //it is the responsibility of the calling routine to ensure
 //the file ptr is positioned at the start of the admin data block 
-void AdminData::ReadRawDataRecord(gzFile& localRawDataPtr, uint32_t recordLength, uint32_t recordID,
+void AdminData::ReadRawDataRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, uint32_t recordID,
 				  bool dispflag)
 {
    //Extract the information in the data block
    uint32_t bufferLength = recordLength/BatRootTypes::kWordSize; //this better be an integer
    uint32_t buffer[bufferLength]; 
-   int readCheck = gzread(localRawDataPtr,(char*)buffer, bufferLength*sizeof(uint32_t));
+   int readCheck = localRawDataPtr.Read((char*)buffer, bufferLength*sizeof(uint32_t));
 
    if(readCheck < 0)
    {
@@ -15,6 +15,7 @@
 #define ADMINDATA_H
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <map>
 
 #include "EndianHelper.h"
@@ -37,7 +38,7 @@ class AdminData
 
       //For reading raw data
       void Reset();             //clears data members for next filling
-      void ReadRawDataRecord(gzFile& localRawDataPtr, uint32_t recordLength, uint32_t recordID, bool dispHeader);        
+      void ReadRawDataRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, uint32_t recordID, bool dispHeader);        
       
       //flipping bytes for opposite endianness
       void SetFlipBytes(bool flipCheck) { fFlipBytes = flipCheck; return; }
@@ -49,7 +50,7 @@ class AdminData
 
       //for querying RQ lists - provies read only access!
       void ConstructRQList();
-      map<string, double> GetRQList() const { return fRQList; }
+      const map<string, double>& GetRQList() const { return fRQList; }
 
    private:
        
@@ -11,10 +11,16 @@
 //
 // 10/2017 - NM: Added relevant code for detector type kExternalTriggerUMN
 // 1/2018 - NM: Added relevant code for detector type kUMN5Q
+// 10/2026 - GetChannelName, GetChannelIndexBySide/ByType now served from
+//           precomputed per-detector-type tables; the list-walking versions
+//           are kept as Calc* to build the tables and report errors
+// 10/2026 - GetChannelIndexBySide/ByType by channel number, without the name lookup
+// 10/2026 - tables in fixed slots per detector type, GetChannelName returns a reference
 //////////////////////////////////////////////////////////////////////// 
 ///////////////////////////////
 
 #include <iostream>
+#include <pthread.h>
 
 #include "BatRootTypes.h"
 #include "ChannelMapHelper.h"
@@ -24,7 +30,7 @@ using namespace std;
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-string ChannelMapHelper::GetChannelName(int detType, int channelNum) 
+string ChannelMapHelper::CalcChannelName(int detType, int channelNum) 
 {
   string tempString = "";
 
@@ -190,7 +196,7 @@ string ChannelMapHelper::GetChannelName(int detType, int channelNum)
 }
 
 
-string ChannelMapHelper::GetChannelName(uint32_t detCode)
+const string& ChannelMapHelper::GetChannelName(uint32_t detCode)
 {
   int detType = GetDetTypeFromCode(detCode);
   int chanNum = GetChannelNumFromCode(detCode);
@@ -911,7 +917,7 @@ string ChannelMapHelper::GetChannelNameBaseByType(string& chanType)
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-int ChannelMapHelper::GetChannelIndexBySide(int detType,string& chanName)
+int ChannelMapHelper::CalcChannelIndexBySide(int detType,string& chanName)
 { 
      
    // FLIPs, CDMSII ZIPs, mercedes ZIPs, dual endcap type
@@ -1274,7 +1280,7 @@ int ChannelMapHelper::GetChannelOverallIndexByType(int detType,string& chanName)
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
-int ChannelMapHelper::GetChannelIndexByType(int detType,string& chanName)
+int ChannelMapHelper::CalcChannelIndexByType(int detType,string& chanName)
 { 
 
    // FLIPs, CDMSII ZIPs, mercedes ZIPs, dual endcap type
@@ -1568,3 +1574,257 @@ bool ChannelMapHelper::IsPhysicalChannel(string& chanName)
 
    return IsPhysical;
 }
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Precomputed channel tables
+//
+// GetChannelName, GetChannelIndexByType/BySide and IsPhysicalChannel are called per pulse
+// (PulseData, EventBuilder, NoiseBuilder).  Rather than walking the name lists in
+// BatRootTypes each time, every detector type with a fixed channel list has a slot in a
+// static array of tables (GetTableSlot), each indexed by channel number and built once
+// from the lists above.  The names are returned by reference, so a lookup allocates
+// nothing.  Noise monitors have no table: their names are built by the original code once
+// per channel and kept.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+const string& ChannelMapHelper::GetChannelName(int detType, int channelNum) 
+{
+   const ChannelTable* table = FindTable(detType);
+
+   if(table != NULL && channelNum >= 0 && channelNum < (int)table->infoList.size())
+      return table->infoList[channelNum].name;
+
+   //noise monitors, or unknown combination (reported there)
+   return GetKeptChannelName(detType, channelNum);
+}
+
+
+const string& ChannelMapHelper::GetKeptChannelName(int detType, int channelNum)
+{
+   //entries of a map stay in place, so the references handed out remain valid
+   static map< pair<int,int>, string > keptNames;
+   static pthread_mutex_t keptNamesLock = PTHREAD_MUTEX_INITIALIZER;
+
+   pthread_mutex_lock(&keptNamesLock);
+   map< pair<int,int>, string >::iterator nameItr = keptNames.find(make_pair(detType, channelNum));
+   if(nameItr == keptNames.end())
+      nameItr = keptNames.insert(make_pair(make_pair(detType, channelNum), CalcChannelName(detType, channelNum))).first;
+   pthread_mutex_unlock(&keptNamesLock);
+
+   return nameItr->second;
+}
+
+
+int ChannelMapHelper::GetChannelIndexBySide(int detType,string& chanName)
+{ 
+   const ChannelInfo* info = FindChannelInfo(detType, chanName);
+   if(info != NULL && info->indexBySide >= 0)
+      return info->indexBySide;
+
+   //not a physical channel of this detector type - the original code reports the error
+   return CalcChannelIndexBySide(detType, chanName);
+}
+
+
+int ChannelMapHelper::GetChannelIndexByType(int detType,string& chanName)
+{ 
+   const ChannelInfo* info = FindChannelInfo(detType, chanName);
+   if(info != NULL && info->indexByType >= 0)
+      return info->indexByType;
+
+   //not a physical channel of this detector type - the original code reports the error
+   return CalcChannelIndexByType(detType, chanName);
+}
+
+
+int ChannelMapHelper::GetChannelIndexBySide(int detType, int channelNum)
+{ 
+   const ChannelTable* table = FindTable(detType);
+
+   if(table != NULL && channelNum >= 0 && channelNum < (int)table->infoList.size() &&
+      table->infoList[channelNum].indexBySide >= 0)
+      return table->infoList[channelNum].indexBySide;
+
+   //not a physical channel of this detector type - the original code reports the error
+   string chanName = GetChannelName(detType, channelNum);
+   return CalcChannelIndexBySide(detType, chanName);
+}
+
+
+int ChannelMapHelper::GetChannelIndexByType(int detType, int channelNum)
+{ 
+   const ChannelTable* table = FindTable(detType);
+
+   if(table != NULL && channelNum >= 0 && channelNum < (int)table->infoList.size() &&
+      table->infoList[channelNum].indexByType >= 0)
+      return table->infoList[channelNum].indexByType;
+
+   //not a physical channel of this detector type - the original code reports the error
+   string chanName = GetChannelName(detType, channelNum);
+   return CalcChannelIndexByType(detType, chanName);
+}
+
+
+bool ChannelMapHelper::IsPhysicalChannel(int detType, int channelNum)
+{
+   const ChannelTable* table = FindTable(detType);
+
+   if(table != NULL && channelNum >= 0 && channelNum < (int)table->infoList.size())
+      return table->infoList[channelNum].isPhysical;
+
+   string chanName = GetChannelName(detType, channelNum);
+   return IsPhysicalChannel(chanName);
+}
+
+
+bool ChannelMapHelper::HasChannelTable(int detType)
+{
+   return (GetTableSlot(detType) >= 0);
+}
+
+
+const ChannelInfo& ChannelMapHelper::GetChannelInfo(int detType, int channelNum)
+{
+   const ChannelTable* table = FindTable(detType);
+
+   if(table == NULL || channelNum < 0 || channelNum >= (int)table->infoList.size())
+   {
+      cout <<"ERROR!  ChannelMapHelper::GetChannelInfo - unknown combination of detectorType "<<detType
+	   <<" and channelNum "<<channelNum<<" passed to this function." << endl;
+      exit(1);
+   }
+
+   return table->infoList[channelNum];
+}
+
+
+const ChannelInfo* ChannelMapHelper::FindChannelInfo(int detType, const string& chanName)
+{
+   const ChannelTable* table = FindTable(detType);
+   if(table == NULL)
+      return NULL;
+
+   map<string, int>::const_iterator nameItr = table->nameToChannel.find(chanName);
+   if(nameItr == table->nameToChannel.end())
+      return NULL;
+
+   return &(table->infoList[nameItr->second]);
+}
+
+
+//every detector type with a fixed channel list (i.e. not veto or noise monitors) has a slot
+int ChannelMapHelper::GetTableSlot(int detType)
+{
+   switch(detType)
+   {
+      case BatRootTypes::kBLIPDetType:        return 0;
+      case BatRootTypes::kFLIPDetType:        return 1;
+      case BatRootTypes::kZIPDetType:         return 2;
+      case BatRootTypes::kMZIPDetType:        return 3;
+      case BatRootTypes::kDualEndcapDetType:  return 4;
+      case BatRootTypes::kEndcapDetType:      return 5;
+      case BatRootTypes::kiZIPSoudan:         return 6;
+      case BatRootTypes::kCDMSliteSoudanI:    return 7;
+      case BatRootTypes::kiZIPSNOlab:         return 8;
+      case BatRootTypes::kHVSNOlab:           return 9;
+      case BatRootTypes::kHVUMN:              return 10;
+      case BatRootTypes::kExternalTriggerUMN: return 11;
+      case BatRootTypes::kUMN5Q:              return 12;
+      default:                                return -1;
+   }
+}
+
+
+const ChannelMapHelper::ChannelTable* ChannelMapHelper::FindTable(int detType)
+{
+   int slot = GetTableSlot(detType);
+   return (slot >= 0 ? &(GetChannelTables()[slot]) : NULL);
+}
+
+
+const ChannelMapHelper::ChannelTable* ChannelMapHelper::GetChannelTables()
+{
+   //function-local static: built on first call, thread safe under C++11
+   static const vector<ChannelTable> tables = BuildChannelTables();
+   return &tables[0];
+}
+
+
+vector<ChannelMapHelper::ChannelTable> ChannelMapHelper::BuildChannelTables()
+{
+   const int detTypeList[] = { BatRootTypes::kBLIPDetType, BatRootTypes::kFLIPDetType, 
+			       BatRootTypes::kZIPDetType, BatRootTypes::kMZIPDetType, 
+			       BatRootTypes::kDualEndcapDetType, BatRootTypes::kEndcapDetType,
+			       BatRootTypes::kiZIPSoudan, BatRootTypes::kCDMSliteSoudanI,
+			       BatRootTypes::kiZIPSNOlab, BatRootTypes::kHVSNOlab, BatRootTypes::kHVUMN,
+			       BatRootTypes::kExternalTriggerUMN, BatRootTypes::kUMN5Q };
+   const int nDetTypes = sizeof(detTypeList)/sizeof(detTypeList[0]);
+
+   vector<ChannelTable> tables(kNTableSlots);
+   for(int typeCtr = 0; typeCtr < nDetTypes; typeCtr++)
+      BuildChannelTable(detTypeList[typeCtr], tables[GetTableSlot(detTypeList[typeCtr])]);
+
+   return tables;
+}
+
+
+void ChannelMapHelper::BuildChannelTable(int detType, ChannelTable& table)
+{
+   vector<string> phononList, chargeList;
+   FillPhononChannelList(detType, phononList);
+   FillChargeChannelList(detType, chargeList);
+
+   //the by-side ordering has its own lists only for the Soudan iZIP
+   vector<string> phononBySideList(phononList), chargeBySideList(chargeList);
+   if(detType == BatRootTypes::kiZIPSoudan)
+   {
+      phononBySideList.assign(BatRootTypes::kiZIPSoudanPhononChanBySide, 
+			      BatRootTypes::kiZIPSoudanPhononChanBySide + BatRootTypes::kiZIPSoudanNPhononChan);
+      chargeBySideList.assign(BatRootTypes::kiZIPSoudanChargeChanBySide, 
+			      BatRootTypes::kiZIPSoudanChargeChanBySide + BatRootTypes::kiZIPSoudanNChargeChan);
+   }
+
+   //physical channels followed by QT, PT, PS1, PS2
+   int nChannels = GetPS2Index(detType) + 1;
+   table.infoList.resize(nChannels);
+
+   for(int chanCtr = 0; chanCtr < nChannels; chanCtr++)
+   {
+      ChannelInfo& info = table.infoList[chanCtr];
+
+      info.channelNum  = chanCtr;
+      info.name        = CalcChannelName(detType, chanCtr);
+      info.isPhonon    = (info.name[0] == 'P');
+      info.isCharge    = (info.name[0] == 'Q');
+      info.isPhysical  = IsPhysicalChannel(info.name);
+      info.indexByType = -1;
+      info.indexBySide = -1;
+
+      if(info.isPhysical && info.isPhonon)
+      {
+	 info.indexByType = FindNameIndex(phononList, info.name);
+	 info.indexBySide = FindNameIndex(phononBySideList, info.name);
+      }
+      if(info.isPhysical && info.isCharge)
+      {
+	 info.indexByType = FindNameIndex(chargeList, info.name);
+	 info.indexBySide = FindNameIndex(chargeBySideList, info.name);
+      }
+
+      table.nameToChannel[info.name] = chanCtr;
+   }
+
+   return;
+}
+
+
+int ChannelMapHelper::FindNameIndex(const vector<string>& nameList, const string& chanName)
+{
+   for(uint nameCtr = 0; nameCtr < nameList.size(); nameCtr++)
+      if(nameList[nameCtr] == chanName)
+	 return nameCtr;
+
+   return -1;
+}
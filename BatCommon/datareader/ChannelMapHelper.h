@@ -9,6 +9,9 @@
 //
 //Modifications:
 //
+// 10/2026 - Added precomputed per-detector-type channel tables (ChannelInfo)
+//           so that the per-pulse lookups no longer walk the name lists
+// 10/2026 - GetChannelName returns a reference into the tables
 //////////////////////////////////////////////////////////////////////// 
 ///////////////////////////////
 
@@ -17,19 +20,33 @@
 
 #include "stdint.h"
 #include <vector>
+#include <string>
+#include <map>
 
 using namespace std;
 
+//!precomputed attributes of a single channel, keyed by (detType, channelNum)
+struct ChannelInfo
+{
+   int    channelNum;          //channel number as in the raw data format (also the overall index)
+   string name;                //channel name, e.g. "PAS1", "QI", "PT"
+   bool   isPhonon;
+   bool   isCharge;
+   bool   isPhysical;          //false for sums (QT/PT/PS1/PS2)
+   int    indexByType;         //index within phonon or charge grouping, -1 for non-physical channels
+   int    indexBySide;         //index within phonon or charge grouping by side, -1 for non-physical channels
+};
+
 //!very small helper class for raw data reading
 class ChannelMapHelper 
 {
    public:
 
      //get a channel name based on detector type and detector number
-     static string GetChannelName(int detType, int channelNum);
+     static const string& GetChannelName(int detType, int channelNum);
 
      //get a channel name based on detector code (which includes channel number)
-     static string GetChannelName(uint32_t detCode);
+     static const string& GetChannelName(uint32_t detCode);
 
      //fill the channel list based on the detector type - all channels, phonons and charge
      static void FillAllChannelList(int detType, vector<string>& channelNameList);
@@ -67,6 +84,8 @@ class ChannelMapHelper
      static string GetChannelType(const string& chanName);    //returns "phonon" or "charge"
      static int GetChannelIndexBySide(int detType,string& chanName); // return index 
      static int GetChannelIndexByType(int detType,string& chanName); // return index within charge or phonon grouping 
+     static int GetChannelIndexBySide(int detType, int channelNum); // same as above, from the channel table (per pulse)
+     static int GetChannelIndexByType(int detType, int channelNum);
      static int GetChannelOverallIndexByType(int detType,string& chanName); // return index within all channels grouping
 
 
@@ -76,9 +95,38 @@ class ChannelMapHelper
      static int GetPS2Index(int detType); //sum S2 phonon trace follows the QT,PT,S1 index (iZIP only)
 
      static bool IsPhysicalChannel(string& chanName); //does the channel correspond to a real channel on the physical detetor?
+     static bool IsPhysicalChannel(int detType, int channelNum); //same as above, from the channel table
+
+
+     //precomputed channel tables - integer keyed, names are only needed at the I/O boundary
+
+     static bool HasChannelTable(int detType); //false for veto, noise monitors and unknown types
+     static const ChannelInfo& GetChannelInfo(int detType, int channelNum); //exits on unknown combination
+     static const ChannelInfo* FindChannelInfo(int detType, const string& chanName); //NULL if not in the table
 
 
    private:
+
+     //per detector type: table indexed by channel number and name -> channel number lookup
+     struct ChannelTable
+     {
+        vector<ChannelInfo> infoList;
+        map<string, int>    nameToChannel;
+     };
+
+     static const int kNTableSlots = 13;
+     static int  GetTableSlot(int detType);                 //-1 for types without a table
+     static const ChannelTable* FindTable(int detType);     //NULL for types without a table
+     static const ChannelTable* GetChannelTables();         //kNTableSlots tables, built once on first use
+     static vector<ChannelTable> BuildChannelTables();
+     static const string& GetKeptChannelName(int detType, int channelNum); //types without a table
+     static void BuildChannelTable(int detType, ChannelTable& table);
+     static int  FindNameIndex(const vector<string>& nameList, const string& chanName);
+
+     //original list-walking implementations, used to build the tables and for error reporting
+     static string CalcChannelName(int detType, int channelNum);
+     static int CalcChannelIndexBySide(int detType,string& chanName);
+     static int CalcChannelIndexByType(int detType,string& chanName);
                  
 };
 
@@ -52,7 +52,7 @@ void DetectorConfigData::Reset()
 
 //it is the responsibility of the calling routine to ensure
 //the file ptr is positioned at the start of the configuration block
-void DetectorConfigData::ReadDetectorConfigRecord(gzFile& localRawDataPtr, 
+void DetectorConfigData::ReadDetectorConfigRecord(RawDataStream& localRawDataPtr, 
 						  uint32_t recordLength, bool debugOn)
 {
 
@@ -60,7 +60,7 @@ void DetectorConfigData::ReadDetectorConfigRecord(gzFile& localRawDataPtr,
   int32_t buffer[bufferLength];  //these are signed values
 
   //returns -1 for error, and 0 for end of file
-  int readCheck = gzread(localRawDataPtr, (char*)buffer, bufferLength*sizeof(uint32_t));
+  int readCheck = localRawDataPtr.Read((char*)buffer, bufferLength*sizeof(uint32_t));
 
   if(readCheck < 0)
   {
@@ -15,6 +15,7 @@
 #define DETECTORCONFIGDATA_H
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <map>
 #include <vector>
 
@@ -44,7 +45,7 @@ class DetectorConfigData
 
       //For reading raw data
       void Reset();             //clears data members for next filling
-      void ReadDetectorConfigRecord(gzFile& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
+      void ReadDetectorConfigRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
       
       //flipping bytes for opposite endianness
       void SetFlipBytes(bool flipCheck) { fFlipBytes = flipCheck; return; }
@@ -83,13 +83,13 @@ void GPSData::ConstructRQList()
 
 //it is the responsibility of the calling routine to ensure
 //the file ptr is positioned at the start of the GPS data block 
-void GPSData::ReadGPS(gzFile& localRawDataPtr, uint32_t recordLength, bool debugOn)
+void GPSData::ReadGPS(RawDataStream& localRawDataPtr, uint32_t recordLength, bool debugOn)
 {
 
    //Extract the information in the data block
    uint32_t bufferLength = recordLength/BatRootTypes::kWordSize; //this better be an integer
    uint32_t buffer[bufferLength]; 
-   int readCheck = gzread(localRawDataPtr,(char*)buffer, bufferLength*sizeof(uint32_t));
+   int readCheck = localRawDataPtr.Read((char*)buffer, bufferLength*sizeof(uint32_t));
 
    if(readCheck < 0)
    {
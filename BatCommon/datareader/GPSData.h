@@ -15,6 +15,7 @@
 #define GPSDATA_H
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <map>
 #include <vector>
 
@@ -34,14 +35,14 @@ class GPSData
 
       //For reading raw data
       void Reset();             //clears data members for next filling
-      void ReadGPS(gzFile& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
+      void ReadGPS(RawDataStream& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
       
       //flipping bytes for opposite endianness
       void SetFlipBytes(bool flipCheck) { fFlipBytes = flipCheck; return; }
 
       //for querying RQ lists - provies read only access!
       void ConstructRQList();
-      map<string, double> GetRQList() const { return fRQList; }
+      const map<string, double>& GetRQList() const { return fRQList; }
       
    private:
       
@@ -716,14 +716,14 @@ uint64_t HistoryData::GetVTPreMask()
 
 //it is the responsibility of the calling routine to ensure
 //the file ptr is positioned at the start of the history data block 
-void HistoryData::ReadSoudanHistoryRecord(gzFile& localRawDataPtr, uint32_t recordLength, 
+void HistoryData::ReadSoudanHistoryRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, 
 					  bool debugOn)
 {
    //Extract the information in the data block
    uint32_t bufferLength = recordLength/BatRootTypes::kWordSize; //this better be an integer
    //uint32_t buffer[bufferLength]; //<this isn't legal C++! Not sure how it compiled...
    std::vector<uint32_t> buffer(bufferLength);
-   int readCheck = gzread(localRawDataPtr,(char*)(&(buffer[0])), bufferLength*sizeof(uint32_t));
+   int readCheck = localRawDataPtr.Read((char*)(&(buffer[0])), bufferLength*sizeof(uint32_t));
 
    if(readCheck < 0)
    {
@@ -1215,13 +1215,13 @@ void HistoryData::ReadSoudanHistoryRecord(gzFile& localRawDataPtr, uint32_t reco
 
 //it is the responsibility of the calling routine to ensure
 //the file ptr is positioned at the start of the history data block 
-void HistoryData::ReadSUFHistoryRecord(gzFile& localRawDataPtr, uint32_t recordLength, 
+void HistoryData::ReadSUFHistoryRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, 
 					  bool debugOn)
 {
    //Extract the information in the data block
    uint32_t bufferLength = recordLength/BatRootTypes::kWordSize; //this better be an integer
    uint32_t buffer[bufferLength]; 
-   int readCheck = gzread(localRawDataPtr,(char*)buffer, bufferLength*sizeof(uint32_t));
+   int readCheck = localRawDataPtr.Read((char*)buffer, bufferLength*sizeof(uint32_t));
 
    if(readCheck < 0)
    {
@@ -47,6 +47,7 @@
 #define HISTORYDATA_H
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <map>
 #include <vector>
 
@@ -65,6 +66,7 @@ class HistoryData
       // ===== Get Data Members =====
 
       uint64_t GetEventTowerMask(const int towerNum); //get mask for that tower at time t=0
+      size_t   GetNEventTowerMasks() const { return fEventTriggerMasks.size(); } //zero if no history record was read
 
       bool IsEventQLowOrHigh(const int detNum, const int eventWindow); //true if qlow/high is triggered in window around event
       bool IsEventPLowOrHigh(const int detNum, const int eventWindow); //true if qlow/high is triggered in window around event
@@ -85,15 +87,15 @@ class HistoryData
       void Reset();             //clears data members for next filling
 
       //contents of the history record will specify which of these is called
-      void ReadSoudanHistoryRecord(gzFile& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
-      void ReadSUFHistoryRecord(gzFile& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
+      void ReadSoudanHistoryRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
+      void ReadSUFHistoryRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
       
       //flipping bytes for opposite endianness
       void SetFlipBytes(bool flipCheck) { fFlipBytes = flipCheck; return; }
 
       //for querying RQ lists - provies read only access!
       void ConstructRQList(const int nTowers);
-      map<string, double> GetRQList() const { return fRQList; }
+      const map<string, double>& GetRQList() const { return fRQList; }
       double GetRQVal(const string& rqName) const;
       
    private:
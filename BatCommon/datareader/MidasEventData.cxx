@@ -10,6 +10,8 @@
 //                     by reading midas events from a file or by reading
 //                     them from a midas shared memory buffer 
 //
+//  Oct. 2026: reused event buffer, one-pass bank index, triggers as spans
+//             into the buffer (see header)
 //
 ///////////////////////////////////////////////////////////////////////
 
@@ -38,7 +40,6 @@ MidasEventData::MidasEventData() :
   fData = NULL;
  
   fBanksN = 0;
-  fBankList = NULL;
 
   fEventHeader.fEventId      = 0;
   fEventHeader.fTriggerMask  = 0;
@@ -59,13 +60,15 @@ void MidasEventData::Copy(const MidasEventData& rhs)
 {
   fEventHeader = rhs.fEventHeader;
 
-  fData        = (char*)malloc(fEventHeader.fDataSize);
-  assert(fData);
-  memcpy(fData, rhs.fData, fEventHeader.fDataSize);
+  fDataBuffer  = rhs.fDataBuffer;
+  fData        = (rhs.fData ? &fDataBuffer[0] : NULL);
  
-  fBanksN      = rhs.fBanksN;
-  fBankList    = strdup(rhs.fBankList);
-  assert(fBankList);
+  // the index points into the data, so build it again on the copy
+  fBanksN      = 0;
+  fBankIndex.clear();
+  fBankList.clear();
+  if (fData && rhs.fBanksN > 0)
+    SetBankList();
 }
 
 MidasEventData::MidasEventData(const MidasEventData &rhs)
@@ -90,16 +93,12 @@ MidasEventData& MidasEventData::operator=(const MidasEventData &rhs)
 void MidasEventData::Clear()
 {
 
-  // clear bankList
-  if (fBankList)
-    free(fBankList);
-  
-  fBankList = NULL;
+  // clear bank index
+  fBankIndex.clear();
+  fBankList.clear();
   fBanksN = 0;
 
-  // clear record data
-  if (fData)
-    free(fData);
+  // clear record data (the buffer itself is kept for the next event)
   fData = NULL;
 
 
@@ -141,24 +140,41 @@ bool MidasEventData::IsGoodSize() const
 
 
 
-vector<PulseData> MidasEventData::GetPulseDataList(int triggerNumber)
+const MidasTriggerData* MidasEventData::GetTriggerData(int triggerNumber) const
 {
-  
-  vector<PulseData> pulseDataList;
   for(uint trigIt = 0; trigIt < fTriggerDataList.size(); trigIt++){
-    MidasTriggerData* triggerData = fTriggerDataList[trigIt];
-    if (triggerData->GetTriggerNumber()==triggerNumber-1) {
-      pulseDataList = triggerData->fPulseDataList;
-      break;
-    }
+    const MidasTriggerData* triggerData = fTriggerDataList[trigIt];
+    if (triggerData->GetTriggerNumber()==triggerNumber-1)
+      return triggerData;
     if(fverbosity>4)
-      cout << "MidasEventData::GetPulseDataList INFO looking for trigger " << triggerNumber 
+      cout << "MidasEventData::GetTriggerData INFO looking for trigger " << triggerNumber 
 	   << " and found " << triggerData->GetTriggerNumber() << endl;
   }
-  if(fdiagnosticPrints)
-    cout << "MidasEventData::GetPulseDataList INFO returning " << pulseDataList.size() << " pulses" << endl;
+  return NULL;
+}
+
+
+void MidasEventData::FillPulseDataList(int triggerNumber, vector<PulseData>& pulseDataList) const
+{
+  
+  const MidasTriggerData* triggerData = GetTriggerData(triggerNumber);
+  if (triggerData == NULL)
+    pulseDataList.clear();
+  else {
     
-  return pulseDataList;
+    // one slot per channel, decoded straight from the event buffer.  The PulseData
+    // of the previous trigger are reset and refilled, keeping their allocated vectors
+    const vector<MidasChannelSpan>& channelList = triggerData->GetChannelList();
+    pulseDataList.resize(channelList.size());
+    for(uint chanIt = 0; chanIt < channelList.size(); chanIt++){
+      const MidasChannelSpan& channel = channelList[chanIt];
+      pulseDataList[chanIt].Reset();
+      pulseDataList[chanIt].SetRawPulseRecord(channel.fDetCode, channel.fSamples, channel.fNSamples,
+					      channel.fSampleDt, 0); // no trigger T0 in the data
+    }
+  }
+  if(fdiagnosticPrints)
+    cout << "MidasEventData::FillPulseDataList INFO returning " << pulseDataList.size() << " pulses" << endl;
 }
 
 
@@ -176,7 +192,7 @@ int MidasEventData::GetEventCategory(int triggerNumber)
 }
   
 
-int MidasEventData::IsStaleTrigger(int triggerNumber)
+int MidasEventData::IsStaleTrigger(int triggerNumber) const
 {
 
   //check if valid request
@@ -185,16 +201,17 @@ int MidasEventData::IsStaleTrigger(int triggerNumber)
     return -1;
   }
     
-  // get pulse map for that trigger
-  vector<PulseData> pulselist =  GetPulseDataList(triggerNumber);
-  if(pulselist.size()==0)
+  // get channels of that trigger
+  const MidasTriggerData* triggerData = GetTriggerData(triggerNumber);
+  if(triggerData==NULL || triggerData->GetChannelList().size()==0)
     return 1;
      
   int stale = 1; //assume stale
-  //check to see if the pulse list actually contains data
-  for(uint i = 0; i < pulselist.size(); i++){
+  //check to see if the channels actually contain data
+  const vector<MidasChannelSpan>& channelList = triggerData->GetChannelList();
+  for(uint i = 0; i < channelList.size(); i++){
 			 
-    if((pulselist[i].GetRawPulse().size())>0){
+    if(channelList[i].fNSamples>0){
       stale = 0;
       break;
     }
@@ -211,7 +228,7 @@ int MidasEventData::IsStaleTrigger(int triggerNumber)
 // Read Data (from File)
 // =================================================================
 
-int MidasEventData::ReadEventHeader(gzFile& localRawDataPtr)
+int MidasEventData::ReadEventHeader(RawDataStream& localRawDataPtr)
 {
   
    // MidasEvent Header
@@ -220,7 +237,7 @@ int MidasEventData::ReadEventHeader(gzFile& localRawDataPtr)
    //          
   
    // Returns -1 for error, and 0 for end of file
-  int readCheck = gzread(localRawDataPtr, (char*)GetEventHeader(), sizeof(TMidas_EVENT_HEADER));
+  int readCheck = localRawDataPtr.Read((char*)GetEventHeader(), sizeof(TMidas_EVENT_HEADER));
   
   if (readCheck <0 || readCheck != sizeof(TMidas_EVENT_HEADER))
     {
@@ -253,10 +270,10 @@ int MidasEventData::ReadEventHeader(gzFile& localRawDataPtr)
 
 
 
-int MidasEventData::ReadDataRecord(gzFile& localRawDataPtr)
+int MidasEventData::ReadDataRecord(RawDataStream& localRawDataPtr)
 {
   // Read data
-  int readCheck = gzread(localRawDataPtr, GetData(), GetDataSize());
+  int readCheck = localRawDataPtr.Read(GetData(), GetDataSize());
   
   if (readCheck != (int)GetDataSize())
     {
@@ -300,6 +317,62 @@ int MidasEventData::ReadDataRecord(gzFile& localRawDataPtr)
 }
 
 
+// =================================================================
+// Read Data (Online / complete event from a MidasEventSource)
+// =================================================================
+
+// eventBuffer holds the event header followed by the event data. 
+// Returns 0 at end of run, -1 for a bad event, 1 otherwise
+int MidasEventData::ReadEventFromBuffer(const vector<char>& eventBuffer)
+{
+
+  if (eventBuffer.size() < sizeof(TMidas_EVENT_HEADER)) {
+    cerr <<"MidasEventData::ReadEventFromBuffer ERROR:  Event smaller than midas header!"<<endl;
+    return -1;
+  }
+
+  memcpy(GetEventHeader(), &eventBuffer[0], sizeof(TMidas_EVENT_HEADER));
+  
+  // check endianness 
+  uint32_t endian = 0x12345678;
+  bool DoByteSwap = *(char*)(&endian) != 0x78;
+  if (DoByteSwap) SwapBytesEventHeader();
+
+  if (!IsGoodSize() || eventBuffer.size() - sizeof(TMidas_EVENT_HEADER) < GetDataSize()) {
+    cerr <<"MidasEventData::ReadEventFromBuffer ERROR:  Wrong MidasEvent data size!"<<endl;
+    return -1;
+  }
+
+  // copy data (buffer is owned by the source and reused)
+  memcpy(GetData(), &eventBuffer[sizeof(TMidas_EVENT_HEADER)], GetDataSize());
+  SwapBytes(false);
+
+  fCurrentEventNumber++;
+
+  int eventId = fEventHeader.fEventId;
+
+  if ((eventId & 0xFFFF) == 0x8000) {// Begin Run
+
+    Print();
+
+  } else if ((eventId & 0xFFFF) == 0x8001) {   // End Run
+  
+    Print();
+    cout << "MidasEventData: Reached end of run!" << endl;
+    return 0;
+
+  } else {  // all other events
+
+    SetBankList();
+    HandleBankData();
+
+  }
+
+  return 1;
+}
+
+
+
 // =================================================================
 // Read Data (Online / SYSTEM BUFFER)
 // =================================================================
@@ -316,7 +389,7 @@ int MidasEventData::ReadEventOnline(TMidasControl* midas)
   if(fTriggerDataList.size()>0){
     for(int i =0; i < fTriggerDataList.size(); i++){
       MidasTriggerData *myTrigger = fTriggerDataList[i];
-      myTrigger->ClearPulseDataList();
+      myTrigger->ClearChannelList();
       delete myTrigger;
     }
   }
@@ -392,7 +465,7 @@ int MidasEventData::ReadEventOnline(TMidasControl* midas)
     
       // Get pulses
       memcpy(GetEventHeader(), pevent, sizeof(TMidas_EVENT_HEADER));
-      SetData(size, pevent+sizeof(TMidas_EVENT_HEADER));
+      SetData(size-sizeof(TMidas_EVENT_HEADER), pevent+sizeof(TMidas_EVENT_HEADER));
       SetBankList();
       
       // Store pulses in map
@@ -477,7 +550,6 @@ bool MidasEventData::HandleBankDataRevCPreBackport(const uint32_t* buffer)
   uint nbChannels  = 6;   // 6 channels only
   int detType = 4;  // Detector type
   uint32_t sampleDt = 800;
-  int32_t triggerT0 = 0;  
   // %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
   // Number of trigger
@@ -543,7 +615,7 @@ bool MidasEventData::HandleBankDataRevCPreBackport(const uint32_t* buffer)
         trg_number++; // incremente trigger number
         fTriggerDataList.push_back(fCurrentTriggerData);
 
-        if((fCurrentTriggerData->fPulseDataList).size()==0)
+        if((fCurrentTriggerData->fChannelList).size()==0)
           cerr << "MidasEventData::HandleBankDataRevCPreBackport ERROR (fatal): pushing back a trigger with zero size onto the trigger list" << endl;
       }
       fCurrentTriggerData = new MidasTriggerData(trg_src_tower,trg_src_dcrc,trg_word,trg_number);
@@ -589,16 +661,10 @@ bool MidasEventData::HandleBankDataRevCPreBackport(const uint32_t* buffer)
         isstale=true;
       }
      
-      // Now start loop over the samples.
+      // The samples, two per word, stay in the event buffer
       index++;
-      vector<double> pulseVect;
-      for(int j = 0; j < numberWords; j++){
-	double lower_sample = (double) (buffer[index] & 0xffff);
-	double upper_sample = (double) ((buffer[index] & 0xffff0000) >> 16);
-	pulseVect.push_back(lower_sample);
-	pulseVect.push_back(upper_sample);
-	index++;	
-      }      
+      const uint32_t* samples = &buffer[index];
+      index += numberWords;
 
       // Build detector code
       //very important to get this right!
@@ -607,22 +673,17 @@ bool MidasEventData::HandleBankDataRevCPreBackport(const uint32_t* buffer)
       //also look in BatRootType
       uint32_t detCode = (detType*1000000 + detNum*1000) + ichan;  // following CDMS numbering
       
-      // Store in Pulse Data
-      PulseData tempPulseData;
-      if(ichan<2)
-        sampleDt=400;
-
-      tempPulseData.SetRawPulseRecord(detCode, pulseVect, sampleDt, triggerT0);
-    
-      //set sample dt back for phonons
-      sampleDt=800;
-
-      // Add pulse data in TriggerData
-      (fCurrentTriggerData->fPulseDataList).push_back(tempPulseData);
+      // Add channel in TriggerData (decoded into PulseData by FillPulseDataList)
+      MidasChannelSpan channel;
+      channel.fDetCode = detCode;
+      channel.fSampleDt = (ichan<2 ? 400 : sampleDt);
+      channel.fSamples = samples;
+      channel.fNSamples = 2*numberWords;
+      (fCurrentTriggerData->fChannelList).push_back(channel);
     }
    
     if(fverbosity>3)
-      cout << "MidasEventData::HandleBankDataRevCPreBackport INFO size of fCurrentTriggerData is " << (fCurrentTriggerData->fPulseDataList).size() << endl;
+      cout << "MidasEventData::HandleBankDataRevCPreBackport INFO size of fCurrentTriggerData is " << (fCurrentTriggerData->fChannelList).size() << endl;
 
     if (isstale && fCurrentTriggerData!=NULL) {
       delete fCurrentTriggerData;
@@ -636,7 +697,7 @@ bool MidasEventData::HandleBankDataRevCPreBackport(const uint32_t* buffer)
      trg_number++; // incremente trigger number
      fTriggerDataList.push_back(fCurrentTriggerData);
 
-     if((fCurrentTriggerData->fPulseDataList).size()==0)
+     if((fCurrentTriggerData->fChannelList).size()==0)
        cerr << "MidasEventData::HandleBankDataRevCPreBackport ERROR (fatal): pushing back a trigger with zero size onto the trigger list" << endl;
   }
 
@@ -679,7 +740,6 @@ bool MidasEventData::HandleBankData(const uint32_t* buffer)
   // %%%%% FIXME FIXME FIXME  %%%%%
   // Lets hardcode a few parameters for now
   uint32_t sampleDt = 800; //in ns sec. different between phonon/charge
-  int32_t triggerT0 = 0;  
   // %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%  
   
 
@@ -849,50 +909,15 @@ bool MidasEventData::HandleBankData(const uint32_t* buffer)
       //to obtain the total waveform length.
       uint32_t nSamples = nPrePulseSamples + nOnPulseSamples + nPostPulseSamples;
      
-      //check if the number of samples is odd.
-      //if odd, then the last 16 bits of the last 32bit
-      //word will be 0s. these must be ignored/skipped.
-      //At the same time, the index variable must still be
-      //incremented.
-      int lgcOdd = nSamples%2;
-
-      //this needs to be a ceiling division by 2
-      //(e.g. if you have 7 samples, you need
-      //to loop 4 times)
+      //if the number of samples is odd, the upper 16 bits of the last
+      //32bit word are 0s and are not part of the pulse; the index still
+      //has to skip that word (ceiling division by 2).
       uint32_t nLoop = (nSamples+1)/2;
 
-      // Now start loop over the samples.
-      // wap: the two sections, dependent on even or
-      // odd samples, is clunky; but it prevents an
-      // if statement check for every index
+      // The samples stay in the event buffer
       index += 2;//wap: skip over extra words
-      vector<double> pulseVect;
-
- 
-      if(lgcOdd==0){     
-	for(uint32_t j = 0; j < nLoop; j++){
-	  double lower_sample = (double) (buffer[index] & 0xffff);
-	  double upper_sample = (double) ((buffer[index] & 0xffff0000) >> 16);
-	  pulseVect.push_back(lower_sample);
-	  pulseVect.push_back(upper_sample);
-	  index++;	
-	}      
-      }
-      else if(lgcOdd==1){
-	//notice the loop is to nLoop-1
-	for(uint32_t j = 0; j < nLoop-1; j++){
-	  double lower_sample = (double) (buffer[index] & 0xffff);	 
-	  double upper_sample = (double) ((buffer[index] & 0xffff0000) >> 16);	 
-	  pulseVect.push_back(lower_sample);
-	  pulseVect.push_back(upper_sample);
-	  index++;  
-	}
-	//the lower 16 bits of the last 32bit word are stored in
-	//the pulse vector.
-	double lower_sample = (double) (buffer[index] & 0xffff);       
-	pulseVect.push_back(lower_sample);
-	index++;
-      }
+      const uint32_t* samples = &buffer[index];
+      index += nLoop;
       
       int channelIndex = 0;
       
@@ -909,12 +934,13 @@ bool MidasEventData::HandleBankData(const uint32_t* buffer)
       // Build detector code
       uint32_t detCode = (detType*1000000 + detNum*1000) + channelIndex;  // following CDMS numbering
       
-      // Store in Pulse Data
-      PulseData tempPulseData;
-      tempPulseData.SetRawPulseRecord(detCode, pulseVect, sampleDt, triggerT0);
-      
-      // Add pulse data in TriggerData
-      (fCurrentTriggerData->fPulseDataList).push_back(tempPulseData);
+      // Add channel in TriggerData (decoded into PulseData by FillPulseDataList)
+      MidasChannelSpan channel;
+      channel.fDetCode = detCode;
+      channel.fSampleDt = sampleDt;
+      channel.fSamples = samples;
+      channel.fNSamples = nSamples;
+      (fCurrentTriggerData->fChannelList).push_back(channel);
     } //end loop over channels
     } //end loop over dets
   }
@@ -965,7 +991,7 @@ void MidasEventData::Print(const char *option) const
     }
   else
     {
-      printf("Banks: %s\n", fBankList);
+      printf("Banks: %s\n", fBankList.c_str());
 
       for (int i = 0; i < fBanksN * 4; i += 4)
 	{
@@ -1067,7 +1093,7 @@ static const unsigned TID_MAX = (sizeof(TID_SIZE)/sizeof(TID_SIZE[0]));
 
 int MidasEventData::FindBank(const char* name, int *bklen, int *bktype, void **pdata) const
 {
-  /// Find a data bank.
+  /// Find a data bank in the index built by SetBankList().
   /// \param [in] name Name of the data bank to look for.
   /// \param [out] bklen Number of array elements in this bank.
   /// \param [out] bktype Bank data type (MIDAS TID_xxx).
@@ -1075,71 +1101,17 @@ int MidasEventData::FindBank(const char* name, int *bklen, int *bktype, void **p
   /// \returns 1 if bank found, 0 otherwise.
   ///
 
-  const TMidas_BANK_HEADER *pbkh = (const TMidas_BANK_HEADER*)fData; 
-  TMidas_BANK *pbk;
-  //uint32_t dname;
-
-  if (((pbkh->fFlags & (1<<4)) > 0)) {
-#if 0
-    TMidas_BANK32 *pbk32;
-    pbk32 = (TMidas_BANK32 *) (pbkh + 1);
-    memcpy(&dname, name, 4);
-    do {
-      if (*((uint32_t *) pbk32->fName) == dname) {
-        *pdata = pbk32 + 1;
-        if (TID_SIZE[pbk32->fType & 0xFF] == 0)
-          *bklen = pbk32->fDataSize;
-        else
-          *bklen = pbk32->fDataSize / TID_SIZE[pbk32->fType & 0xFF];
-
-        *bktype = pbk32->fType;
-        return 1;
-      }
-      pbk32 = (TMidas_BANK32 *) ((char*) (pbk32 + 1) +
-                          (((pbk32->fDataSize)+7) & ~7));
-    } while ((char*) pbk32 < (char*) pbkh + pbkh->fDataSize + sizeof(TMidas_BANK_HEADER));
-#endif
-
-    TMidas_BANK32 *pbk32 = NULL;
-
-    while (1) {
-      IterateBank32(&pbk32, (char**)pdata);
-      //printf("looking for [%s] got [%s]\n", name, pbk32->fName);
-      if (pbk32 == NULL)
-	break;
-
-      if (name[0]==pbk32->fName[0] &&
-	  name[1]==pbk32->fName[1] &&
-	  name[2]==pbk32->fName[2] &&
-	  name[3]==pbk32->fName[3]) {
-	
-	if (TID_SIZE[pbk32->fType & 0xFF] == 0)
-	  *bklen = pbk32->fDataSize;
-	else
-	  *bklen = pbk32->fDataSize / TID_SIZE[pbk32->fType & 0xFF];
-	
-	*bktype = pbk32->fType;
-	return 1;
-      }
+  for (uint bankIt = 0; bankIt < fBankIndex.size(); bankIt++) {
+    const BankEntry& bank = fBankIndex[bankIt];
+    if (name[0]==bank.fName[0] &&
+	name[1]==bank.fName[1] &&
+	name[2]==bank.fName[2] &&
+	name[3]==bank.fName[3]) {
+      *pdata = bank.fData;
+      *bklen = bank.fLength;
+      *bktype = bank.fType;
+      return 1;
     }
-  } else {
-    pbk = (TMidas_BANK *) (pbkh + 1);
-    do {
-      if (name[0]==pbk->fName[0] &&
-	  name[1]==pbk->fName[1] &&
-	  name[2]==pbk->fName[2] &&
-	  name[3]==pbk->fName[3]) {
-        *pdata = pbk + 1;
-        if (TID_SIZE[pbk->fType & 0xFF] == 0)
-          *bklen = pbk->fDataSize;
-        else
-          *bklen = pbk->fDataSize / TID_SIZE[pbk->fType & 0xFF];
-
-        *bktype = pbk->fType;
-        return 1;
-      }
-      pbk = (TMidas_BANK *) ((char*) (pbk + 1) + (((pbk->fDataSize)+7) & ~7));
-    } while ((char*) pbk < (char*) pbkh + pbkh->fDataSize + sizeof(TMidas_BANK_HEADER));
   }
   //
   // bank not found
@@ -1148,38 +1120,36 @@ int MidasEventData::FindBank(const char* name, int *bklen, int *bktype, void **p
   return 0;
 }
 
-void MidasEventData::SetData(uint32_t size, char* data)
+void MidasEventData::SetData(uint32_t size, const char* data)
 {
   fEventHeader.fDataSize = size;
-  assert(IsGoodSize());
-  
-  if (!fData) 
-    AllocateData();
+  AllocateData();
  
-  fData = data;
+  // copied: the triggers point into the event data after the caller's buffer is gone
+  memcpy(fData, data, size);
   SwapBytes(false);
 }
 
 
 char* MidasEventData::GetData()
 {
-  if (!fData)
-    AllocateData();
+  AllocateData();
   return fData;
 }
 
 void MidasEventData::AllocateData()
 {
   assert(IsGoodSize());
-  fData = (char*)malloc(fEventHeader.fDataSize);
-  assert(fData);
+  if (fDataBuffer.size() < fEventHeader.fDataSize)
+    fDataBuffer.resize(fEventHeader.fDataSize);
+  fData = &fDataBuffer[0];
 }
 
 
 
 const char* MidasEventData::GetBankList() const
 {
-  return fBankList;
+  return fBankList.c_str();
 }
 
 int MidasEventData::SetBankList()
@@ -1187,44 +1157,51 @@ int MidasEventData::SetBankList()
   if (fEventHeader.fEventId <= 0)
     return 0;
 
-  if (fBankList)
+  if (!fBankIndex.empty())
     return fBanksN;
 
-  int listSize = 0;
-
   fBanksN = 0;
 
   TMidas_BANK32 *pmbk32 = NULL;
   TMidas_BANK *pmbk = NULL;
   char *pdata = NULL;
+  bool bank32 = IsBank32();
 
+  // one pass over the banks; FindBank then looks names up here
   while (1)
     {
-      if (fBanksN*4 >= listSize)
-	{
-	  listSize += 400;
-	  fBankList = (char*)realloc(fBankList, listSize);
-	}
-
-      if (IsBank32())
+      const char* name = NULL;
+      uint32_t type = 0;
+      uint32_t size = 0;
+      if (bank32)
 	{
 	  IterateBank32(&pmbk32, &pdata);
 	  if (pmbk32 == NULL)
 	    break;
-	  memcpy(fBankList+fBanksN*4, pmbk32->fName, 4);
-	  fBanksN++;
+	  name = pmbk32->fName;
+	  type = pmbk32->fType;
+	  size = pmbk32->fDataSize;
 	}
       else
 	{
 	  IterateBank(&pmbk, &pdata);
 	  if (pmbk == NULL)
 	    break;
-	  memcpy(fBankList+fBanksN*4, pmbk->fName, 4);
-	  fBanksN++;
+	  name = pmbk->fName;
+	  type = pmbk->fType;
+	  size = pmbk->fDataSize;
 	}
-    }
 
-  fBankList[fBanksN*4] = 0;
+      BankEntry bank;
+      memcpy(bank.fName, name, 4);
+      bank.fType = type;
+      unsigned tidSize = ((type & 0xFF) < TID_MAX ? TID_SIZE[type & 0xFF] : 0);
+      bank.fLength = (tidSize == 0 ? size : size / tidSize);
+      bank.fData = pdata;
+      fBankIndex.push_back(bank);
+      fBankList.append(name, 4);
+      fBanksN++;
+    }
 
   return fBanksN;
 }
@@ -1271,6 +1248,14 @@ int MidasEventData::IterateBank32(TMidas_BANK32 **pbk, char **pdata) const
     *pbk = (TMidas_BANK32 *) ((char*) (*pbk + 1) + length_adjusted);
   }
 
+  // past the last bank (checked first, so nothing after the event data is read)
+  if ((char*) *pbk >= (char*)event  + event->fDataSize + sizeof(TMidas_BANK_HEADER))
+    {
+      *pbk = NULL;
+      *pdata = NULL;
+      return 0;
+    }
+
   TMidas_BANK32 *bk4 = (TMidas_BANK32*)(((char*) *pbk) + 4);
 
   //printf("iterate bank32: pbk 0x%p, align %d, type %d %d, name [%s], next [%s], TID_MAX %d\n", *pbk, (int)( ((uint64_t)(*pbk))&7), (*pbk)->fType, bk4->fType, (*pbk)->fName, bk4->fName, TID_MAX);
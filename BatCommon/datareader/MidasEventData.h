@@ -10,6 +10,9 @@
 //                     by reading midas events from a file or by reading
 //                     them from a midas shared memory buffer 
 //
+//  Oct. 2026: the event data buffer is kept and reused from event to event, the
+//             banks are indexed in one pass when the event is read, and triggers
+//             hold spans into the buffer which FillPulseDataList decodes in place
 //
 ///////////////////////////////////////////////////////////////////////
 
@@ -19,8 +22,10 @@
 
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <vector>
 #include <map>
+#include <string>
 
 #include "MidasStructs.h"
 #include "MidasTriggerData.h"
@@ -61,13 +66,17 @@ class MidasEventData
   int GetEventCategory(int triggerNumber);
   
   int GetNbTriggers() const {return fNbTrigger;}; // Number of triggers
-  vector<PulseData> GetPulseDataList(int triggerNumber);
-  int IsStaleTrigger( int triggerNumber); //is this trigger stale, yuck!
+  // fills pulseDataList with one PulseData per channel of the trigger, decoded from the event buffer
+  void FillPulseDataList(int triggerNumber, vector<PulseData>& pulseDataList) const;
+  int IsStaleTrigger( int triggerNumber) const; //is this trigger stale, yuck!
 
   // Read event from file
-  int ReadEventHeader(gzFile& localRawDataPtr);
-  int ReadDataRecord(gzFile& localRawDataPtr);
+  int ReadEventHeader(RawDataStream& localRawDataPtr);
+  int ReadDataRecord(RawDataStream& localRawDataPtr);
   
+  // Read one complete event (header + data) delivered by a MidasEventSource
+  int ReadEventFromBuffer(const vector<char>& eventBuffer);
+
   // Read Event Online (only if Midas library available)
 #ifdef HAVE_MIDAS
   int ReadEventOnline(TMidasControl* midas);    
@@ -84,8 +93,9 @@ class MidasEventData
  
    // Data Banks / Helpers for event creation 
   char* GetData(); ///< return pointer to the data buffer
-  void AllocateData(); ///< allocate data buffer using the existing event header
-  void SetData(uint32_t dataSize, char* dataBuffer); ///< set an externally allocated data buffer
+  void AllocateData(); ///< size the reused data buffer to the existing event header
+  void SetData(uint32_t dataSize, const char* dataBuffer); ///< copy an external event into the data buffer
+  const MidasTriggerData* GetTriggerData(int triggerNumber) const;
   bool TriggerMatch(MidasTriggerData *triggerData,int trg_src_tower,int trg_src_dcrc,int trg_word);
   
   const char* GetBankList() const; ///< return a list of data banks
@@ -96,7 +106,7 @@ class MidasEventData
   int IterateBank(TMidas_BANK **, char **pdata) const; ///< iterate through 16-bit data banks
   int IterateBank32(TMidas_BANK32 **, char **pdata) const; ///< iterate through 32-bit data banks
   
-  int SetBankList(); ///< create the list of data banks, return number of banks
+  int SetBankList(); ///< index the data banks in one pass, return number of banks
 
   
   // save pulse data into PulseData vector
@@ -110,11 +120,21 @@ class MidasEventData
   int  SwapBytes(bool); ///< convert event data between little-endian (Linux-x86) and big endian (MacOS-PPC) 
   
 
+  // one data bank of the event, as found by SetBankList
+  struct BankEntry {
+    char  fName[4];
+    int   fType;     ///< MIDAS TID_xxx
+    int   fLength;   ///< number of array elements
+    void* fData;
+  };
+
   // Data member
   TMidas_EVENT_HEADER fEventHeader; ///< event header
-  char* fData;     ///< event data buffer
+  vector<char> fDataBuffer; ///< event data, kept for the next event (never shrinks)
+  char* fData;     ///< event data (in fDataBuffer), NULL until the event data is set
   int  fBanksN;    ///< number of banks in this event
-  char* fBankList; ///< list of bank names in this event
+  vector<BankEntry> fBankIndex; ///< banks of this event
+  string fBankList; ///< list of bank names in this event
  
   //verbosity and printing
   bool fdiagnosticPrints;
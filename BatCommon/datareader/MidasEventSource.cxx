@@ -0,0 +1,449 @@
+///////////////////////////////////////////////////////////////////////
+//
+//  Class Name:         MidasEventSource
+//
+//  Description:       Online sources of midas events (see header file)
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "MidasEventSource.h"
+
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+
+namespace {
+
+  const uint32_t kRingMagic   = 0x4d524e47; // "MRNG"
+  const uint32_t kRingVersion = 1;
+  const int      kPollSleepUs = 100;
+
+  double NowMs()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec*1000. + tv.tv_usec/1000.;
+  }
+
+  // shm_open wants a leading slash
+  string ShmName(const string& name)
+  {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+  }
+
+}
+
+
+
+// =================================================================
+// Factory
+// =================================================================
+
+MidasEventSource* MidasEventSource::Create(const string& sourceSpec)
+{
+  size_t sep = sourceSpec.find(':');
+  if (sep == string::npos)
+    return NULL;
+
+  string kind = sourceSpec.substr(0, sep);
+  string target = sourceSpec.substr(sep+1);
+
+  if (kind == "shm")
+    return new MidasShmRingSource(target);
+
+  if (kind == "tail")
+    return new MidasFileTailSource(target);
+
+  if (kind == "midas") {
+#ifdef HAVE_MIDAS
+    return new MidasBufferSource(target.empty() ? "SYSTEM" : target);
+#else
+    cerr << "MidasEventSource::Create ERROR: " << sourceSpec << " needs a build with HAVE_MIDAS" << endl;
+    return NULL;
+#endif
+  }
+
+  return NULL;
+}
+
+
+
+// =================================================================
+// Shared-memory ring
+// =================================================================
+
+MidasShmRing::MidasShmRing() :
+  fHeader(NULL),
+  fData(NULL),
+  fMappedSize(0)
+{
+}
+
+MidasShmRing::~MidasShmRing()
+{
+  Close(false);
+}
+
+
+bool MidasShmRing::Create(const string& name, uint64_t capacity)
+{
+  Close(false);
+
+  fName = ShmName(name);
+  shm_unlink(fName.c_str());
+
+  int fd = shm_open(fName.c_str(), O_CREAT | O_RDWR, 0666);
+  if (fd < 0) {
+    cerr << "MidasShmRing::Create ERROR: cannot create shared memory " << fName << endl;
+    return false;
+  }
+
+  fMappedSize = sizeof(RingHeader) + capacity;
+  if (ftruncate(fd, fMappedSize) != 0) {
+    cerr << "MidasShmRing::Create ERROR: cannot size shared memory " << fName << endl;
+    close(fd);
+    return false;
+  }
+
+  void* mapped = mmap(NULL, fMappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    cerr << "MidasShmRing::Create ERROR: cannot map shared memory " << fName << endl;
+    return false;
+  }
+
+  fHeader = (RingHeader*) mapped;
+  fData = (char*) mapped + sizeof(RingHeader);
+
+  fHeader->fCapacity = capacity;
+  fHeader->fWritePos = 0;
+  fHeader->fReadPos = 0;
+  fHeader->fProducerDone = 0;
+  fHeader->fVersion = kRingVersion;
+  __sync_synchronize();
+  fHeader->fMagic = kRingMagic; // written last: consumers check it before anything else
+
+  return true;
+}
+
+
+bool MidasShmRing::Attach(const string& name)
+{
+  Close(false);
+
+  fName = ShmName(name);
+  int fd = shm_open(fName.c_str(), O_RDWR, 0666);
+  if (fd < 0)
+    return false;
+
+  struct stat shmStat;
+  if (fstat(fd, &shmStat) != 0 || (size_t)shmStat.st_size < sizeof(RingHeader)) {
+    close(fd);
+    return false;
+  }
+
+  fMappedSize = shmStat.st_size;
+  void* mapped = mmap(NULL, fMappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    return false;
+
+  fHeader = (RingHeader*) mapped;
+  fData = (char*) mapped + sizeof(RingHeader);
+
+  __sync_synchronize();
+  if (fHeader->fMagic != kRingMagic || fHeader->fVersion != kRingVersion ||
+      sizeof(RingHeader) + fHeader->fCapacity > fMappedSize) {
+    Close(false);
+    return false;
+  }
+
+  return true;
+}
+
+
+void MidasShmRing::Close(bool unlink)
+{
+  if (fHeader)
+    munmap(fHeader, fMappedSize);
+
+  if (unlink && !fName.empty())
+    shm_unlink(fName.c_str());
+
+  fHeader = NULL;
+  fData = NULL;
+  fMappedSize = 0;
+}
+
+
+void MidasShmRing::CopyIn(uint64_t pos, const char* src, uint64_t size)
+{
+  uint64_t capacity = fHeader->fCapacity;
+  uint64_t offset = pos % capacity;
+  uint64_t firstPart = (size < capacity - offset) ? size : capacity - offset;
+
+  memcpy(fData + offset, src, firstPart);
+  if (firstPart < size)
+    memcpy(fData, src + firstPart, size - firstPart);
+}
+
+
+void MidasShmRing::CopyOut(uint64_t pos, char* dest, uint64_t size) const
+{
+  uint64_t capacity = fHeader->fCapacity;
+  uint64_t offset = pos % capacity;
+  uint64_t firstPart = (size < capacity - offset) ? size : capacity - offset;
+
+  memcpy(dest, fData + offset, firstPart);
+  if (firstPart < size)
+    memcpy(dest + firstPart, fData, size - firstPart);
+}
+
+
+bool MidasShmRing::Push(const char* event, uint32_t size, int timeoutMs)
+{
+  if (!fHeader)
+    return false;
+
+  uint64_t entrySize = sizeof(uint32_t) + (uint64_t)size;
+  if (entrySize > fHeader->fCapacity) {
+    cerr << "MidasShmRing::Push ERROR: event of " << size << " bytes larger than ring" << endl;
+    return false;
+  }
+
+  double deadline = NowMs() + timeoutMs;
+  while (1) {
+    __sync_synchronize();
+    uint64_t used = fHeader->fWritePos - fHeader->fReadPos;
+    if (fHeader->fCapacity - used >= entrySize)
+      break;
+    if (NowMs() >= deadline)
+      return false;
+    usleep(kPollSleepUs);
+  }
+
+  uint64_t writePos = fHeader->fWritePos;
+  CopyIn(writePos, (const char*)&size, sizeof(uint32_t));
+  CopyIn(writePos + sizeof(uint32_t), event, size);
+
+  // publish only after the entry is complete
+  __sync_synchronize();
+  fHeader->fWritePos = writePos + entrySize;
+
+  return true;
+}
+
+
+int MidasShmRing::Pop(vector<char>& eventBuffer, int timeoutMs)
+{
+  if (!fHeader)
+    return MidasEventSource::kSourceClosed;
+
+  double deadline = NowMs() + timeoutMs;
+  while (1) {
+    __sync_synchronize();
+    if (fHeader->fWritePos != fHeader->fReadPos)
+      break;
+    if (fHeader->fProducerDone)
+      return MidasEventSource::kSourceClosed;
+    if (NowMs() >= deadline)
+      return MidasEventSource::kNoEvent;
+    usleep(kPollSleepUs);
+  }
+
+  uint64_t readPos = fHeader->fReadPos;
+  uint32_t size = 0;
+  CopyOut(readPos, (char*)&size, sizeof(uint32_t));
+
+  eventBuffer.resize(size);
+  if (size > 0)
+    CopyOut(readPos + sizeof(uint32_t), &eventBuffer[0], size);
+
+  // release the slot only after the copy
+  __sync_synchronize();
+  fHeader->fReadPos = readPos + sizeof(uint32_t) + size;
+
+  return MidasEventSource::kEventReady;
+}
+
+
+void MidasShmRing::SetProducerDone()
+{
+  if (!fHeader)
+    return;
+
+  __sync_synchronize();
+  fHeader->fProducerDone = 1;
+}
+
+
+
+// =================================================================
+// Shared-memory ring source
+// =================================================================
+
+MidasShmRingSource::MidasShmRingSource(const string& ringName) :
+  fRingName(ringName)
+{
+}
+
+
+int MidasShmRingSource::ReceiveEvent(vector<char>& eventBuffer, int timeoutMs)
+{
+  // the producer may start after us: keep trying to attach within the timeout
+  if (!fRing.IsAttached()) {
+    double deadline = NowMs() + timeoutMs;
+    while (!fRing.Attach(fRingName)) {
+      if (NowMs() >= deadline)
+        return kNoEvent;
+      usleep(kPollSleepUs);
+    }
+    cout << "MidasShmRingSource: attached to ring " << fRingName << endl;
+    timeoutMs = (int)(deadline - NowMs());
+    if (timeoutMs < 0) timeoutMs = 0;
+  }
+
+  return fRing.Pop(eventBuffer, timeoutMs);
+}
+
+
+
+// =================================================================
+// File tail source
+// =================================================================
+
+MidasFileTailSource::MidasFileTailSource(const string& filePath) :
+  fFilePath(filePath),
+  fgzFilePtr(NULL)
+{
+}
+
+
+MidasFileTailSource::~MidasFileTailSource()
+{
+  if (fgzFilePtr)
+    gzclose(fgzFilePtr);
+}
+
+
+int MidasFileTailSource::ReceiveEvent(vector<char>& eventBuffer, int timeoutMs)
+{
+  double deadline = NowMs() + timeoutMs;
+
+  // file may not exist yet
+  while (!fgzFilePtr) {
+    fgzFilePtr = gzopen(fFilePath.c_str(), "rb");
+    if (fgzFilePtr)
+      break;
+    if (NowMs() >= deadline)
+      return kNoEvent;
+    usleep(kPollSleepUs);
+  }
+
+  // assemble header, then header + data, keeping partial reads for the next call
+  while (1) {
+    size_t needed = sizeof(TMidas_EVENT_HEADER);
+    if (fPending.size() >= needed) {
+      const TMidas_EVENT_HEADER* header = (const TMidas_EVENT_HEADER*) &fPending[0];
+      if (header->fDataSize == 0 || header->fDataSize > 500 * 1024 * 1024) {
+        cerr << "MidasFileTailSource ERROR: wrong midas event header size in " << fFilePath << endl;
+        return kSourceClosed;
+      }
+      needed += header->fDataSize;
+    }
+
+    if (fPending.size() == needed && needed > sizeof(TMidas_EVENT_HEADER)) {
+      eventBuffer.swap(fPending);
+      fPending.clear();
+      return kEventReady;
+    }
+
+    size_t offset = fPending.size();
+    fPending.resize(needed);
+    int readCheck = gzread(fgzFilePtr, &fPending[offset], needed - offset);
+    if (readCheck < 0) {
+      cerr << "MidasFileTailSource ERROR: problem reading " << fFilePath << endl;
+      return kSourceClosed;
+    }
+    fPending.resize(offset + readCheck);
+
+    if (fPending.size() < needed) {
+      // writer has not caught up: clear EOF so the next read sees new data
+      gzclearerr(fgzFilePtr);
+      if (NowMs() >= deadline)
+        return kNoEvent;
+      usleep(kPollSleepUs);
+    }
+  }
+}
+
+
+
+// =================================================================
+// Midas SYSTEM buffer source
+// =================================================================
+
+#ifdef HAVE_MIDAS
+
+TMidasControl* MidasEventSource::fgMidas = NULL;
+
+
+MidasBufferSource::MidasBufferSource(const string& bufferName) :
+  fBufferName(bufferName),
+  fRequestId(-1),
+  fNbEventsReceived(0)
+{
+}
+
+
+int MidasBufferSource::ReceiveEvent(vector<char>& eventBuffer, int timeoutMs)
+{
+  TMidasControl* midas = fgMidas;
+  if (midas == 0) {
+    cerr << "MidasBufferSource ERROR: No MIDAS instance available" << endl;
+    return kSourceClosed;
+  }
+
+  // reqister event requests (use callback, request only once)
+  if (fRequestId == -1)
+    fRequestId = midas->eventRequest(fBufferName.c_str(),1,-1,(1<<2),true);
+
+  if (fRequestId == -2) {
+    cerr << "MidasBufferSource ERROR: Problem with Midas Event request." << endl;
+    return kSourceClosed;
+  }
+
+  double eventLimit = midas->GetEventLimit();
+  if (eventLimit != 0 && fNbEventsReceived >= eventLimit)
+    return kSourceClosed;
+
+  const int maxEventSize = 25600000; //bytes
+  eventBuffer.resize(maxEventSize);
+
+  double deadline = NowMs() + timeoutMs;
+  while (1) {
+    int size = midas->receiveEvent(fRequestId, &eventBuffer[0], maxEventSize, true);
+
+    if (size > 0) {
+      eventBuffer.resize(size);
+      fNbEventsReceived++;
+      return kEventReady;
+    }
+    if (size < 0)
+      return kSourceClosed;
+
+    // nothing yet: check for shutdown, or run stopped by hand
+    if (!midas->poll(1) || midas->GetRunState() == 1)
+      return kSourceClosed;
+
+    if (NowMs() >= deadline)
+      return kNoEvent;
+  }
+}
+
+#endif
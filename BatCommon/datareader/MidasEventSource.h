@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////
+//
+//  Class Name:         MidasEventSource
+//
+//  Description:       Abstract source of complete midas events (event header + banks)
+//                     for online processing. ReceiveEvent never waits longer than the
+//                     requested timeout, so the processing loop is never blocked by
+//                     a quiet source. Implementations:
+//
+//                       MidasShmRingSource   local shared-memory ring (see MidasShmRing)
+//                       MidasFileTailSource  follows a .mid / .mid.gz file as it is written
+//                       MidasBufferSource    midas event buffer (only with HAVE_MIDAS)
+//
+//                     MidasEventSource::Create builds a source from a string such as
+//                     "shm:<ring name>", "tail:<file path>" or "midas:<buffer name>".
+//                     The midas sources use the instance given to SetMidasInstance
+//                     (RawDataReader::RegisterMidasInstance), which may come after Create.
+//
+///////////////////////////////////////////////////////////////////////
+
+
+#ifndef MIDASEVENTSOURCE_H
+#define MIDASEVENTSOURCE_H
+
+#include "zlib.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "MidasStructs.h"
+
+#ifdef HAVE_MIDAS
+#include "TMidasControl.h"
+#endif
+
+using namespace std;
+
+
+class MidasEventSource
+{
+ public:
+
+  enum SourceStatus {
+    kSourceClosed = -1,  // no more events will come
+    kNoEvent      =  0,  // nothing arrived within the timeout, try again later
+    kEventReady   =  1   // eventBuffer holds one complete midas event
+  };
+
+  virtual ~MidasEventSource() {}
+
+  // fills eventBuffer with one event (header + data), waits at most timeoutMs
+  virtual int ReceiveEvent(vector<char>& eventBuffer, int timeoutMs) = 0;
+  virtual string GetName() const = 0;
+
+  // "shm:<name>", "tail:<path>" or "midas:<buffer>", returns NULL for an unknown spec
+  static MidasEventSource* Create(const string& sourceSpec);
+
+#ifdef HAVE_MIDAS
+  static void SetMidasInstance(TMidasControl* midas) { fgMidas = midas; }
+
+ protected:
+
+  static TMidasControl* fgMidas;
+#endif
+};
+
+
+
+// Single-producer / single-consumer ring of midas events in POSIX shared memory.
+// Each entry is a uint32_t length followed by the event bytes; entries may wrap.
+class MidasShmRing
+{
+ public:
+
+  MidasShmRing();
+  ~MidasShmRing();
+
+  bool Create(const string& name, uint64_t capacity);  // producer side, replaces an existing ring
+  bool Attach(const string& name);                     // consumer side
+  void Close(bool unlink = false);
+
+  bool Push(const char* event, uint32_t size, int timeoutMs);
+  int  Pop(vector<char>& eventBuffer, int timeoutMs);  // returns a MidasEventSource::SourceStatus
+
+  void SetProducerDone();
+  bool IsAttached() const { return fHeader != NULL; }
+
+ private:
+
+  struct RingHeader {
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint64_t fCapacity;
+    volatile uint64_t fWritePos;     // total bytes ever written
+    volatile uint64_t fReadPos;      // total bytes ever read
+    volatile uint32_t fProducerDone;
+  };
+
+  void CopyIn(uint64_t pos, const char* src, uint64_t size);
+  void CopyOut(uint64_t pos, char* dest, uint64_t size) const;
+
+  RingHeader* fHeader;
+  char*       fData;
+  size_t      fMappedSize;
+  string      fName;
+};
+
+
+
+class MidasShmRingSource : public MidasEventSource
+{
+ public:
+
+  MidasShmRingSource(const string& ringName);
+
+  int ReceiveEvent(vector<char>& eventBuffer, int timeoutMs);
+  string GetName() const { return "shm:" + fRingName; }
+
+ private:
+
+  string       fRingName;
+  MidasShmRing fRing;
+};
+
+
+
+class MidasFileTailSource : public MidasEventSource
+{
+ public:
+
+  MidasFileTailSource(const string& filePath);
+  ~MidasFileTailSource();
+
+  int ReceiveEvent(vector<char>& eventBuffer, int timeoutMs);
+  string GetName() const { return "tail:" + fFilePath; }
+
+ private:
+
+  string       fFilePath;
+  gzFile       fgzFilePtr;
+  vector<char> fPending;  // bytes of the event currently being assembled
+};
+
+
+
+#ifdef HAVE_MIDAS
+class MidasBufferSource : public MidasEventSource
+{
+ public:
+
+  MidasBufferSource(const string& bufferName);
+
+  int ReceiveEvent(vector<char>& eventBuffer, int timeoutMs);
+  string GetName() const { return "midas:" + fBufferName; }
+
+ private:
+
+  string         fBufferName;
+  int            fRequestId;
+  int            fNbEventsReceived;
+};
+#endif
+
+
+#endif // MidasEventSource.h
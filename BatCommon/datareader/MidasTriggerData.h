@@ -8,6 +8,8 @@
 //  Description:       C++ class representing one trigger. Data members are filled 
 //                     by MidasEventData (pulses stores in vector<PulseData>
 //
+//  Oct. 2026: the channels are spans into the event buffer of MidasEventData
+//             (MidasChannelSpan), decoded into PulseData only when asked for
 //
 ///////////////////////////////////////////////////////////////////////
 
@@ -16,6 +18,16 @@
 #include "PulseData.h"
 
 
+// one channel of a trigger: its samples in the midas event buffer, 16-bit ADC
+// values packed two per word (low half first); only valid until the next event is read
+struct MidasChannelSpan {
+  uint32_t        fDetCode;
+  uint32_t        fSampleDt;
+  const uint32_t* fSamples;
+  uint32_t        fNSamples;
+};
+
+
 class MidasTriggerData {
 
   friend class MidasEventData;
@@ -43,9 +55,7 @@ public:
     fTriggerSourceDCRC = other.fTriggerSourceDCRC;
     fTriggerWord = other.fTriggerWord;
     fTriggerNumber = other.fTriggerNumber;
-    for(size_t i = 0; i<other.fPulseDataList.size(); i++){
-      fPulseDataList.push_back(other.fPulseDataList[i]);
-    }
+    fChannelList = other.fChannelList;
     cout << "making copy of MidasTriggerData" << endl;
     }
 
@@ -55,15 +65,17 @@ public:
       return *this;
     }
 
-  void ClearPulseDataList(){
-    fPulseDataList.clear();
+  void ClearChannelList(){
+    fChannelList.clear();
   }
 
-  const int GetTriggerSourceTower() {return fTriggerSourceTower;};
-  const int GetTriggerSourceDCRC(){ return fTriggerSourceDCRC;};
-  const int GetTriggerWord(){ return fTriggerWord;};
-  const int GetTriggerNumber(){ return fTriggerNumber;};
-  const int GetEventCategory(){ return fEventCategory;};
+  const vector<MidasChannelSpan>& GetChannelList() const { return fChannelList; }
+
+  int GetTriggerSourceTower() const {return fTriggerSourceTower;};
+  int GetTriggerSourceDCRC() const { return fTriggerSourceDCRC;};
+  int GetTriggerWord() const { return fTriggerWord;};
+  int GetTriggerNumber() const { return fTriggerNumber;};
+  int GetEventCategory() const { return fEventCategory;};
   
   void SetEventCategory(int category){ fEventCategory=category;};
 
@@ -80,8 +92,8 @@ private:
   // trigger Number
   int fTriggerNumber;
 
-  /// map with Pulse data
-  vector<PulseData>  fPulseDataList; 
+  /// channels of this trigger (spans into the event buffer)
+  vector<MidasChannelSpan>  fChannelList; 
 
   //some parameters
   uint32_t fEventCategory;
@@ -22,6 +22,7 @@
 #include "PulseData.h"
 #include "EndianHelper.h"
 #include "ChannelMapHelper.h"
+#include "PulseTools.h"
 
 using namespace std;
 
@@ -42,6 +43,7 @@ void PulseData::Reset()
    //All data members are reset/initialized here
 
    fFlipBytes = false;
+   fLazyUnpacking = false;
 
    // === Raw Data Quantities ===
 
@@ -65,12 +67,19 @@ void PulseData::Reset()
 
    //the pulse in its various forms
    fPulseVector.clear(); 
+   fPackedADC.clear();
    fBSPulseVector.clear(); 
    fBSNPulseVector.clear(); 
    fTestPulseVector.clear();
+   fBSNPulseFFT.clear();
+   fBSNPulseFFTValid = false;
  
    //clear the fitters too
    fAnalysisCollection.clear();
+
+   fKeptBSPulseVector.clear();
+   fKeptBSNPulseVector.clear();
+   fNKeptAnalyses = 0;
    return;
 }
 
@@ -81,6 +90,12 @@ void PulseData::Reset()
 
 //======================= non-inline Getters  ==============================
 
+const vector<double>& PulseData::GetRawPulse() const
+{
+   if(!fPackedADC.empty()) UnpackRawPulse();
+   return fPulseVector;
+}
+
 
 string PulseData::GetChannelName() const
 {
@@ -118,11 +133,69 @@ string PulseData::GetChannelType() const
    return tempString;
 }
 
+const vector<TComplex>& PulseData::GetBaselineSubNormPulseFFT() const
+{
+   if(!fBSNPulseFFTValid)
+   {
+      fBSNPulseFFT.clear();
+      PulseTools::RealToComplexFFT(fBSNPulseVector, fBSNPulseFFT);
+      fBSNPulseFFTValid = true;
+   }
+   return fBSNPulseFFT;
+}
+
+void PulseData::CalcBaselineSubNormPulseFFTs(const vector<PulseData>& pulseList)
+{
+   vector<const PulseData*> toTransform;
+   vector<const vector<double>*> pulses;
+   for(uint pulseItr = 0; pulseItr < pulseList.size(); pulseItr++)
+   {
+      const PulseData& aPulseData = pulseList[pulseItr];
+      if(aPulseData.fBSNPulseFFTValid || !aPulseData.fIsZip || aPulseData.fBSNPulseVector.empty())
+	 continue;
+      toTransform.push_back(&aPulseData);
+      pulses.push_back(&aPulseData.fBSNPulseVector);
+   }
+   if(pulses.empty()) return;
+
+   vector< vector<TComplex> > pulseFFTs;
+   PulseTools::RealToComplexFFT(pulses, pulseFFTs);
+
+   for(uint pulseItr = 0; pulseItr < toTransform.size(); pulseItr++)
+   {
+      toTransform[pulseItr]->fBSNPulseFFT.swap(pulseFFTs[pulseItr]);
+      toTransform[pulseItr]->fBSNPulseFFTValid = true;
+   }
+}
+
+void PulseData::SetBaselineSubNormPulse(const vector<double>& pulse)
+{
+   fBSNPulseVector = pulse;
+   fBSNPulseFFTValid = false;
+}
+
+//the random is normally kept before DoBasicPulseCalc, so the kept pulses are empty
+//and restoring them keeps the capacity of the vectors for the next overlay
+void PulseData::KeepForOverlays()
+{
+   fKeptBSPulseVector = fBSPulseVector;
+   fKeptBSNPulseVector = fBSNPulseVector;
+   fNKeptAnalyses = fAnalysisCollection.size();
+}
+
+void PulseData::RestoreForOverlay()
+{
+   fBSPulseVector.assign(fKeptBSPulseVector.begin(), fKeptBSPulseVector.end());
+   fBSNPulseVector.assign(fKeptBSNPulseVector.begin(), fKeptBSNPulseVector.end());
+   fBSNPulseFFTValid = false;
+   fAnalysisCollection.erase(fAnalysisCollection.begin() + fNKeptAnalyses, fAnalysisCollection.end());
+}
+
 //==========================================================================
 
 //it is the responsibility of the calling routine to ensure
 //the file ptr is positioned at the start of a trace data block 
-void PulseData::ReadRawPulseRecord(gzFile& localRawDataPtr, uint32_t recordLength, 
+void PulseData::ReadRawPulseRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, 
 				   uint32_t recordID, bool dispflag)
 {
    
@@ -130,7 +203,7 @@ void PulseData::ReadRawPulseRecord(gzFile& localRawDataPtr, uint32_t recordLengt
    //Extract the information in the data block
    uint32_t bufferLength = recordLength/BatRootTypes::kWordSize; //this better be an integer
    uint32_t buffer[bufferLength]; 
-   int readCheck = gzread(localRawDataPtr,(char*)buffer, bufferLength*sizeof(uint32_t));  
+   int readCheck = localRawDataPtr.Read((char*)buffer, bufferLength*sizeof(uint32_t));  
 
    if(readCheck < 0)
    {
@@ -167,23 +240,8 @@ void PulseData::ReadRawPulseBuffer(uint32_t* buffer, uint32_t recordLength,
     }
   
   
-  //In 2010, we switched to pulse record ID type 0x11 (from 0x10) to expand the
-  //detector code.   This allows for more channels and more detector types, which is
-  //needed to accomodate the iZIP design.
-  if(recordID == BatRootTypes::kPulseRecordID)
-    {
-      fDetChannel = detCodeHex%10;
-      fDetNum     = ((detCodeHex%1000) - fDetChannel)/10;
-      fDetType    = (detCodeHex - 10*fDetNum - fDetChannel) / 1000;  
-      fDetCode    = ChannelMapHelper::CalcDetCodeBase(fDetType, fDetNum) + fDetChannel; 
-    }   
-  else //for kPulseRecordExpandedCodeID
-    {
-      fDetChannel = detCodeHex%1000;
-      fDetNum     = ((detCodeHex%1000000) - fDetChannel)/1000;
-      fDetType    = (detCodeHex - 1000*fDetNum - fDetChannel) / 1000000;
-      fDetCode    = ChannelMapHelper::CalcDetCodeBase(fDetType, fDetNum) + fDetChannel; 
-    }
+  DecodeRawDetCode(buffer, recordID, fFlipBytes, fDetType, fDetNum, fDetChannel);
+  fDetCode = ChannelMapHelper::CalcDetCodeBase(fDetType, fDetNum) + fDetChannel; 
   
   // === channel type and name assignments according to the detector code - these are dictated by the raw data format! ===
   
@@ -193,18 +251,20 @@ void PulseData::ReadRawPulseBuffer(uint32_t* buffer, uint32_t recordLength,
     {
       fIsZip = true;    
       
-      //store the channel name for convenient access later - for ZIP pulses only!
-      fChannelName = ChannelMapHelper::GetChannelName(fDetType, fDetChannel);
-      
-      //store the channel type for convenient access later
-      if(fChannelName[0] == 'P')
+      //store the channel name and type for convenient access later - for ZIP pulses only!
+      //(known detector types come straight from the precomputed channel table)
+      if(ChannelMapHelper::HasChannelTable(fDetType))
 	{
-	  fIsPhonon = true;
+	  const ChannelInfo& chanInfo = ChannelMapHelper::GetChannelInfo(fDetType, fDetChannel);
+	  fChannelName = chanInfo.name;
+	  fIsPhonon = chanInfo.isPhonon;
+	  fIsCharge = chanInfo.isCharge;
 	}
-      
-      if(fChannelName[0] == 'Q')
+      else
 	{
-	  fIsCharge = true;
+	  fChannelName = ChannelMapHelper::GetChannelName(fDetType, fDetChannel);
+	  fIsPhonon = (fChannelName[0] == 'P');
+	  fIsCharge = (fChannelName[0] == 'Q');
 	}
       
     } else if (fDetType == BatRootTypes::kVetoDetType) {
@@ -228,24 +288,13 @@ void PulseData::ReadRawPulseBuffer(uint32_t* buffer, uint32_t recordLength,
   }
   
   
-  // ==== ADC values are paired to make one word, separate them now ===
+  // ==== ADC values are paired to make one word, separate them now (or at the first GetRawPulse) ===
   
-  for(int pairItr = 1; pairItr <= fNADCBins/2; pairItr++)
-    {
-      uint32_t twinBinValues = buffer[11+pairItr];
-      if(fFlipBytes) twinBinValues = EndianHelper::Swap4ByteWord(twinBinValues);
-      
-      uint16_t adc1 = twinBinValues & 0x0000ffff; 
-      uint16_t adc2 = (twinBinValues & 0xffff0000) >> 16;
-      
-      //       printf("word = %#x", twinBinValues);
-      //       printf(", adc1 = %#x", adc1);
-      //       printf(", adc2 = %#x", adc2);
-      // 	 cout <<", bins " << (pairItr*2)-2 <<" and " << (pairItr*2)-1 << endl;
-      
-      fPulseVector.push_back(adc1);
-      fPulseVector.push_back(adc2);
-    }
+  const uint32_t* adcWords = buffer + kRawPulseHeaderWords;
+  if(fLazyUnpacking)
+    fPackedADC.insert(fPackedADC.end(), adcWords, adcWords + fNADCBins/2);
+  else
+    UnpackADCWords(adcWords, fNADCBins/2);
   
   
   if(dispflag)
@@ -263,6 +312,57 @@ void PulseData::ReadRawPulseBuffer(uint32_t* buffer, uint32_t recordLength,
   
 }
 
+//In 2010, we switched to pulse record ID type 0x11 (from 0x10) to expand the
+//detector code.   This allows for more channels and more detector types, which is
+//needed to accomodate the iZIP design.
+void PulseData::DecodeRawDetCode(const uint32_t* buffer, uint32_t recordID, bool flipBytes,
+				 int& detType, int& detNum, int& detChannel)
+{
+  uint32_t detCodeHex = buffer[4];
+  if(flipBytes) detCodeHex = EndianHelper::Swap4ByteWord(detCodeHex);
+
+  if(recordID == BatRootTypes::kPulseRecordID)
+    {
+      detChannel = detCodeHex%10;
+      detNum     = ((detCodeHex%1000) - detChannel)/10;
+      detType    = (detCodeHex - 10*detNum - detChannel) / 1000;  
+    }   
+  else //for kPulseRecordExpandedCodeID
+    {
+      detChannel = detCodeHex%1000;
+      detNum     = ((detCodeHex%1000000) - detChannel)/1000;
+      detType    = (detCodeHex - 1000*detNum - detChannel) / 1000000;
+    }
+}
+
+//lazy mode: the packed words kept by ReadRawPulseBuffer become the raw pulse
+void PulseData::UnpackRawPulse() const
+{
+  UnpackADCWords(&fPackedADC[0], fPackedADC.size());
+  vector<uint32_t>().swap(fPackedADC);
+}
+
+void PulseData::UnpackADCWords(const uint32_t* words, uint32_t nWords) const
+{
+  fPulseVector.reserve(fPulseVector.size() + 2*nWords);
+  for(uint32_t pairItr = 0; pairItr < nWords; pairItr++)
+    {
+      uint32_t twinBinValues = words[pairItr];
+      if(fFlipBytes) twinBinValues = EndianHelper::Swap4ByteWord(twinBinValues);
+      
+      uint16_t adc1 = twinBinValues & 0x0000ffff; 
+      uint16_t adc2 = (twinBinValues & 0xffff0000) >> 16;
+      
+      //       printf("word = %#x", twinBinValues);
+      //       printf(", adc1 = %#x", adc1);
+      //       printf(", adc2 = %#x", adc2);
+      // 	 cout <<", bins " << (pairItr*2)-2 <<" and " << (pairItr*2)-1 << endl;
+      
+      fPulseVector.push_back(adc1);
+      fPulseVector.push_back(adc2);
+    }
+}
+
 
 
 
@@ -315,6 +415,8 @@ void PulseData::FlipADCRawPulse()
 {
   //This function should only be done before any calculates have been done on the pulse vector!
 
+  if(!fPackedADC.empty()) UnpackRawPulse();
+
   if((fBSPulseVector.size() != 0 || fBSNPulseVector.size() != 0 || fTestPulseVector.size() != 0) && 
       fPulseVector.size() != 0)
   {
@@ -351,7 +453,7 @@ void PulseData::SetRawPulseRecord(uint32_t detCode, const vector<double>& rawPul
 {
 
   // No modification allowed
-  if (!fPulseVector.empty()) {
+  if (!fPulseVector.empty() || !fPackedADC.empty()) {
     cerr << "PulseData::SetRawPulseRecord:  ERROR: No modification of existing PulseData object allowed. " << endl;
     exit(1);
   }
@@ -371,6 +473,36 @@ void PulseData::SetRawPulseRecord(uint32_t detCode, const vector<double>& rawPul
 }
 
 
+void PulseData::SetRawPulseRecord(uint32_t detCode, const uint32_t* packedSamples, uint32_t nSamples, uint32_t sampleDt, int32_t triggerT0)
+{
+
+  // No modification allowed
+  if (!fPulseVector.empty() || !fPackedADC.empty()) {
+    cerr << "PulseData::SetRawPulseRecord:  ERROR: No modification of existing PulseData object allowed. " << endl;
+    exit(1);
+  }
+
+
+  // Fill  Pulse Vector straight from the packed words
+  fPulseVector.resize(nSamples);
+  for(uint32_t j = 0; j+1 < nSamples; j += 2){
+    fPulseVector[j]   = (double) (packedSamples[j/2] & 0xffff);
+    fPulseVector[j+1] = (double) ((packedSamples[j/2] & 0xffff0000) >> 16);
+  }
+  if(nSamples%2 == 1)
+    fPulseVector[nSamples-1] = (double) (packedSamples[nSamples/2] & 0xffff);
+
+  // channel config (based on detCode)
+  SetChannelConfig(detCode);
+
+  // Digitizer information
+  fTriggerT0 = triggerT0;
+  fSampleDt = sampleDt;
+  fNADCBins = fPulseVector.size();
+
+}
+
+
 
 
 
@@ -389,7 +521,7 @@ void PulseData::StorePulseAnalysis(TCDMSAnalysis& analysisClass)
 }
 
 //provides read-only access!!
-TCDMSAnalysis PulseData::GetPulseAnalysis(const string& analysisName)
+TCDMSAnalysis PulseData::GetPulseAnalysis(const string& analysisName) const
 {
 
    //cout <<"Getting virtual analysis!" << endl;
@@ -421,7 +553,7 @@ TCDMSAnalysis PulseData::GetPulseAnalysis(const string& analysisName)
 
 
 
-bool PulseData::HasPulseAnalysis(const string& analysisName)
+bool PulseData::HasPulseAnalysis(const string& analysisName) const
 {
    bool found = false;
 
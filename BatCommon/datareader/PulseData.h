@@ -16,16 +16,28 @@
 // Update Dec 7, 2012 by B. Loer (bloer@fnal.gov):
 //  Read in timing information (dt and t0) from the raw data record
 //  @todo Standardize between this location and DetectorConfigManager
+//
+// Oct. 2026: cached FFT of the BSN pulse (GetBaselineSubNormPulseFFT), shared by the frequency
+//  domain analyses instead of each one transforming the pulse again
+// Oct. 2026: CalcBaselineSubNormPulseFFTs, batched FFT of all the pulses of a detector
+// Oct. 2026: SetRawPulseRecord from packed 16-bit samples (midas event buffer)
+// Oct. 2026: lazy unpacking of the ADC values (SetLazyUnpacking), DecodeRawDetCode for readers
+//  which skip the records of unselected detectors
+// Oct. 2026: GetAnalysisCollection by const reference, const analysis queries
+// Oct. 2026: KeepForOverlays/RestoreForOverlay, reuse of a random for several simulation overlays
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifndef PULSEDATA_H
 #define PULSEDATA_H
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <vector>
 #include <map>
 #include "stdint.h"
 
+#include "TComplex.h"
+
 #include "TCDMSAnalysis.h"
 
 using namespace std;
@@ -47,11 +59,19 @@ class PulseData
       void Reset(); //clears data members for next filling
 
       //Get pulse info (all const functions) - note GetBaselineSubPulse and GetBaselineSubNormPulse are being filled for veto pulses
-      const vector<double>& GetRawPulse() const             { return fPulseVector; }            
+      const vector<double>& GetRawPulse() const;  //unpacks the ADC values at the first call in lazy mode
       const vector<double>& GetBaselineSubPulse()     const { return fBSPulseVector; } //baseline subtracted            
       const vector<double>& GetBaselineSubNormPulse() const { return fBSNPulseVector; } //baseline subtracted AND normalized (only different from above when norm != 1)           
       const vector<double>& GetTestPulse() const            { return fTestPulseVector; }            
 
+      //FFT of GetBaselineSubNormPulse() as from PulseTools::RealToComplexFFT, computed at the first call
+      //and kept until the pulse changes; pass it to the analyses' DoCalc instead of transforming again
+      const vector<TComplex>& GetBaselineSubNormPulseFFT() const;
+
+      //fills the FFT cache of all non-empty zip pulses of the list in one batch (one FFTW plan per
+      //trace length, see PulseTools::RealToComplexFFT); pulses already cached are left alone
+      static void CalcBaselineSubNormPulseFFTs(const vector<PulseData>& pulseList);
+
       bool IsPhononPulse()      const  { return fIsPhonon; }
       bool IsChargePulse()      const  { return fIsCharge; }
       bool IsVetoPulse()        const  { return fIsVeto;   }
@@ -72,14 +92,26 @@ class PulseData
 
 
       //For raw data reading
-      void ReadRawPulseRecord(gzFile& localRawDataPtr, uint32_t recordLength, uint32_t recordID, bool dispflag);
+      void ReadRawPulseRecord(RawDataStream& localRawDataPtr, uint32_t recordLength, uint32_t recordID, bool dispflag);
       void ReadRawPulseBuffer(uint32_t* buffer, uint32_t recordLength, uint32_t recordID, bool dispflag);
       void SetFlipBytes(bool flipCheck) { fFlipBytes = flipCheck; return; }
+      //keep the packed ADC words read by ReadRawPulseBuffer and unpack them at the first GetRawPulse
+      void SetLazyUnpacking(bool lazy) { fLazyUnpacking = lazy; return; }
+
+      //words of the pulse record before the ADC values
+      static const int kRawPulseHeaderWords = 12;
+
+      //detector type, number and channel of a pulse record from its header words
+      static void DecodeRawDetCode(const uint32_t* buffer, uint32_t recordID, bool flipBytes,
+				   int& detType, int& detNum, int& detChannel);
 
 
       // Fill pulse data externally (only if empty, no modification allowed through this function)
       void SetRawPulseRecord(uint32_t detCode, const vector<double>& rawPulse, uint32_t sampleDt, int32_t triggerT0); 
 
+      // same, from nSamples 16-bit ADC values packed two per word, low half first (midas banks)
+      void SetRawPulseRecord(uint32_t detCode, const uint32_t* packedSamples, uint32_t nSamples, uint32_t sampleDt, int32_t triggerT0);
+
 
       // Allow modification of PulseData - these should be used with great caution!
       // These were implemented for raw data kludges, such as for CDMSliteRun1 and
@@ -91,14 +123,15 @@ class PulseData
     
 
       //public methods for querying RQLists - provides read only access!
-      TCDMSAnalysis GetPulseAnalysis(const string& analysisName);  
-      bool HasPulseAnalysis(const string& analysisName);  
-      vector<TCDMSAnalysis> GetAnalysisCollection()    { return fAnalysisCollection; } //could be slow?
+      TCDMSAnalysis GetPulseAnalysis(const string& analysisName) const;  
+      bool HasPulseAnalysis(const string& analysisName) const;  
+      const vector<TCDMSAnalysis>& GetAnalysisCollection() const { return fAnalysisCollection; }
       
 
    private:
 
       bool fFlipBytes; //initialized to false
+      bool fLazyUnpacking; //initialized to false
 
       // === From the Raw Data Files ===
       
@@ -123,11 +156,29 @@ class PulseData
       // === Calculated Quantities ===
       
       //the pulse
-      vector<double> fPulseVector;         //original
+      mutable vector<double> fPulseVector; //original (filled from fPackedADC at the first GetRawPulse in lazy mode)
       vector<double> fBSPulseVector;       //baseline subtracted (BS)
       vector<double> fBSNPulseVector;      //baseline subtracted AND normalized (BSN) - when norm = 1, this is the same as fBSPulseVector
       vector<double> fTestPulseVector;     //for debugging
 
+      mutable vector<uint32_t> fPackedADC;     //ADC pairs as in the record, until unpacked (lazy mode)
+      void UnpackRawPulse() const;
+      void UnpackADCWords(const uint32_t* words, uint32_t nWords) const;   //appends to fPulseVector
+
+      mutable vector<TComplex> fBSNPulseFFT;   //cache of GetBaselineSubNormPulseFFT
+      mutable bool fBSNPulseFFTValid;
+
+      //replaces the BSN pulse (e.g. with a simulated pulse added) and drops its cached FFT
+      void SetBaselineSubNormPulse(const vector<double>& pulse);
+
+      //single-pass simulation overlays: only what the analysis of an overlay changes (the BS and
+      //BSN pulses, the analyses) is kept and put back; the raw pulse is shared by all overlays
+      void KeepForOverlays();
+      void RestoreForOverlay();
+      vector<double> fKeptBSPulseVector;
+      vector<double> fKeptBSNPulseVector;
+      uint fNKeptAnalyses;
+
       //the analysis objects
       vector<TCDMSAnalysis> fAnalysisCollection;
 
@@ -15,6 +15,9 @@
 //May, 2013:  Adding ModifyRawData (B. Serfass)
 //Dec, 2013:  Adding Midas data reading (B. Serfass)
 //Jan. 2018:  Adding UMN5Q_R65 mappings
+//Oct. 2026:  Reading through RawDataStream (read-ahead decompression thread)
+//Oct. 2026:  Midas pulses are decoded in place into fListOfZipPulses (FillPulseDataList)
+//Oct. 2026:  Pulse records of unselected detectors are skipped after their header (ReadPulseRecord)
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -26,6 +29,7 @@
 
 #include "RawDataReader.h"
 #include "ChannelMapHelper.h"
+#include "ProcessingTimer.h"
 
 
 using namespace std;
@@ -45,7 +49,7 @@ RawDataReader::RawDataReader() :
    fReadVetoPulses(false),
    fReadNoiseMonitorPulses(false),
    fIsZipPulsesModified(false),	
-   fgzRawDataPtr(NULL),
+   fLazyPulseUnpacking(false),
    fByteCheckDone(false),
    fFlipBytes(false),
    fCurrentEventPosition(0),
@@ -62,7 +66,9 @@ RawDataReader::RawDataReader() :
    fMidasEventNumber(0),
    fCurrentEventNumber(0),
    fMidasSeriesNumber(0),
-   fgSystem(NULL)
+   fgSystem(NULL),
+   fEventSource(NULL),
+   fSourceTimeoutMs(0)
 {
   //cout <<"Constructing RawDataReader()" << endl;
 }
@@ -151,6 +157,16 @@ void RawDataReader::RegisterGUITSystem(TSystem* gSystem){
 }
 
 
+void RawDataReader::RegisterEventSource(MidasEventSource* source, int pollTimeoutMs)
+{
+  fIsMidasData = true;
+  fIsMidasOnline = true;
+  fEventSource = source;
+  fSourceTimeoutMs = pollTimeoutMs;
+  return;
+}
+
+
 #ifdef HAVE_MIDAS
 void RawDataReader::RegisterMidasInstance(TMidasControl* midas) 
 {
@@ -158,6 +174,7 @@ void RawDataReader::RegisterMidasInstance(TMidasControl* midas)
   fIsMidasOnline = true;
   fMidas = midas;
   fODB = midas;
+  MidasEventSource::SetMidasInstance(midas);  // for ONLINE_SOURCE = midas:<buffer>
   return;
 }
 
@@ -188,23 +205,17 @@ void RawDataReader::OpenRawDataFile(const string& inputRawDataDir, const string&
    fGotSeriesInfoFromFilename = ParseSeriesAndDumpFromRawPath();
 
    //first attempt to open assuming file has a .gz extension (gzipped file)
-   fgzRawDataPtr = gzopen((fRawDataPath+".gz").c_str(), "rb");   
-   
    //if failing to open with .gz, then try to open without .gz extension
-   if (fgzRawDataPtr == NULL) 
+   if (!fRawData.Open(fRawDataPath+".gz")) 
    {
-      fgzRawDataPtr = gzopen(fRawDataPath.c_str(), "rb");   
-
       //report the file that was opened
-      if(fgzRawDataPtr != NULL)  
+      if(fRawData.Open(fRawDataPath))  
       {
 	 cout <<"Opened raw file: " <<fRawDataPath << endl;
 	 return;
       }
-   }
    
-   //if it still fails then return an error
-   if(fgzRawDataPtr == NULL) {
+      //if it still fails then return an error
       cerr <<"RawDataReader::ERROR opening file " << fRawDataPath << endl;
       exit(1);
    }
@@ -219,7 +230,7 @@ void RawDataReader::OpenRawDataFile(const string& inputRawDataDir, const string&
 void RawDataReader::CloseRawDataFile()
 {  
 
-   gzclose(fgzRawDataPtr);   
+   fRawData.Close();   
    
    //Reset RawDataReader placeholders
    fCurrentEventPosition = 0;
@@ -243,7 +254,7 @@ void RawDataReader::ResetRawDataFile()
 {  
 
    //Go back to the beginning of the file
-   gzrewind(fgzRawDataPtr);   
+   fRawData.Rewind();   
   
    //Reset RawDataReader placeholders
    fCurrentEventPosition = 0;
@@ -280,14 +291,14 @@ void RawDataReader::ReadFileHeader(bool dispflag)
    const int nread = 2;
    uint32_t header[nread];
 
-   if(fgzRawDataPtr == NULL)  
+   if(!fRawData.IsOpen())  
    {
       cerr <<"RawDataReader::ERROR file not open!  Did you remember to call RawDataReader::OpenRawDataFile()?" << endl; 
       exit(1);
    }
 
    //returns -1 for error, and 0 for end of file
-   int readCheck = gzread(fgzRawDataPtr, (char*)header, nread*sizeof(uint32_t));
+   int readCheck = fRawData.Read((char*)header, nread*sizeof(uint32_t));
 
    if(readCheck < 0) {
       cerr <<"RawDataReader::ERROR reading File Header ! \n " << endl;
@@ -300,7 +311,7 @@ void RawDataReader::ReadFileHeader(bool dispflag)
    {
       uint32_t extraHeaderWord;
 
-      int extraCheck = gzread(fgzRawDataPtr, (char*)&extraHeaderWord, sizeof(uint32_t));
+      int extraCheck = fRawData.Read((char*)&extraHeaderWord, sizeof(uint32_t));
       printf("Detected older file type!  file header line3     : %#x \n", extraHeaderWord);  
    
       if(extraCheck < 0) {
@@ -317,7 +328,7 @@ void RawDataReader::ReadFileHeader(bool dispflag)
      fIsMidasData = true;
      
      //Go back to the beginning of the file
-     gzrewind(fgzRawDataPtr);  
+     fRawData.Rewind();  
      
 
      // Read Midas Event Header and 
@@ -340,7 +351,7 @@ void RawDataReader::ReadFileHeader(bool dispflag)
           fCurrentEventNumber += fMidasDumpNumber*10000 -1; //standard scaling
 
 	 // read file header data record
-	 int status = fMidasEvent.ReadDataRecord(fgzRawDataPtr);     
+	 int status = fMidasEvent.ReadDataRecord(fRawData);     
 	 if (status)
 	   return;
        } 
@@ -399,7 +410,7 @@ void RawDataReader::ReadFileHeader(bool dispflag)
    // --- read next word and check record type to see if its a detector config record ---
 
    uint32_t nextHeader[nread];
-   if( gzread(fgzRawDataPtr, (char*)nextHeader, nread*sizeof(uint32_t)) < 0 )
+   if( fRawData.Read((char*)nextHeader, nread*sizeof(uint32_t)) < 0 )
    {
      cerr <<"RawDataReader::ERROR reading File Header ! \n " << endl;
      exit(1);
@@ -421,11 +432,11 @@ void RawDataReader::ReadFileHeader(bool dispflag)
 
      if(fReadDetectorConfig) 
      {
-       fDetectorConfigPtr->ReadDetectorConfigRecord(fgzRawDataPtr, configRecordLength, dispflag);
+       fDetectorConfigPtr->ReadDetectorConfigRecord(fRawData, configRecordLength, dispflag);
      }
      else
      {
-       gzseek(fgzRawDataPtr, configRecordLength, SEEK_CUR);
+       fRawData.Seek(configRecordLength, SEEK_CUR);
      }
 
    }
@@ -440,7 +451,7 @@ void RawDataReader::ReadFileHeader(bool dispflag)
      }
 
      //rewind by one word if this is an older-style file (i.e. no DetectorConfigData record)
-     gzseek(fgzRawDataPtr, -nread*sizeof(uint32_t), SEEK_CUR);
+     fRawData.Seek(-nread*sizeof(uint32_t), SEEK_CUR);
 
    }
 
@@ -458,16 +469,16 @@ int RawDataReader::ReadEventHeader(bool dispflag)
    uint32_t header[2]; //store read values
 
    //If reading has already started, position pointer at the next event
-   if(fNextEventPosition != 0)   gzseek(fgzRawDataPtr, (fNextEventPosition-gztell(fgzRawDataPtr)), SEEK_CUR);
-//   if(fNextEventPosition != 0)   gzseek(fgzRawDataPtr, fNextEventPosition, SEEK_SET);
+   if(fNextEventPosition != 0)   fRawData.Seek((fNextEventPosition-fRawData.Tell()), SEEK_CUR);
+//   if(fNextEventPosition != 0)   fRawData.Seek(fNextEventPosition, SEEK_SET);
 
    if(dispflag)
    cout <<"RawDataReader::Reading Event Header at position: " 
-	<< gztell(fgzRawDataPtr)
+	<< fRawData.Tell()
 	<< endl;
    
    //returns -1 for error, and 0 for end of file
-   int readCheck = gzread(fgzRawDataPtr, (char*)header, nread*sizeof(uint32_t));
+   int readCheck = fRawData.Read((char*)header, nread*sizeof(uint32_t));
    if(readCheck < 0) {
       cerr <<"RawDataReader::ERROR reading Event Header ! \n" << endl;
       exit(1);
@@ -520,7 +531,7 @@ int RawDataReader::ReadEventHeader(bool dispflag)
    //storing info useful for navigating through the file
    if(fFlipBytes) header[1] = EndianHelper::Swap4ByteWord(header[1]);
    fEventLength = header[1]; //record length
-   fCurrentEventPosition = gztell(fgzRawDataPtr); //store the file ptr position for this event after reading event header
+   fCurrentEventPosition = fRawData.Tell(); //store the file ptr position for this event after reading event header
    fNextEventPosition = fCurrentEventPosition + fEventLength;
 
    fEventCategory = eventCategory; //for noise checks
@@ -543,7 +554,7 @@ int RawDataReader::ReadEventHeader(bool dispflag)
    }
 
    //If the read succeeded then get the current position
-   fNextRecordHeaderPosition = gztell(fgzRawDataPtr); //after reading eventheader, file is already at position to read next record
+   fNextRecordHeaderPosition = fRawData.Tell(); //after reading eventheader, file is already at position to read next record
      
    return readCheck;
 
@@ -564,12 +575,12 @@ int RawDataReader::ReadMidasEventHeader(bool dispflag)
 
 
    // Read MidasEvent Header
-   int readCheck = fMidasEvent.ReadEventHeader(fgzRawDataPtr);
+   int readCheck = fMidasEvent.ReadEventHeader(fRawData);
   
 
    // Store usefull quantities
    fEventLength = fMidasEvent.GetDataSize(); //record length
-   fCurrentEventPosition = gztell(fgzRawDataPtr); //store the file ptr position for this event after reading event header
+   fCurrentEventPosition = fRawData.Tell(); //store the file ptr position for this event after reading event header
    fNextEventPosition = fCurrentEventPosition + fEventLength;
 
    //FIXME I don't think this is where the trig mask should go, just event category [ANV] 
@@ -603,6 +614,9 @@ int RawDataReader::ReadMidasEventHeader(bool dispflag)
 //this method must now determine which it is before proceeding?
 int RawDataReader::ReadRawDataRecord()
 {   
+   PROCESSING_TIMER("ReadRawDataRecord", 0);
+   static const int bytesCounterId = ProcessingTimer::GetCounterId("BytesDecompressed");
+   z_off_t startPosition = (ProcessingTimer::IsEnabled() && fRawData.IsOpen()) ? fRawData.Tell() : 0;
   
    bool dispflag = false; 
    
@@ -642,19 +656,19 @@ int RawDataReader::ReadRawDataRecord()
 	 
 	 //Read Admin record
 	 if((recordID == BatRootTypes::kAdminRecordID || recordID == BatRootTypes::kAdminRecordID64 ) && fReadAdmin)   
-	   { fAdminPtr->ReadRawDataRecord(fgzRawDataPtr, recordLength, recordID, dispflag); } 
+	   { fAdminPtr->ReadRawDataRecord(fRawData, recordLength, recordID, dispflag); } 
 	 
 	 
 	 //Read History record
-	 if(recordID == BatRootTypes::kSoudanHistoryRecordID && fReadHistory) { fHistoryPtr->ReadSoudanHistoryRecord(fgzRawDataPtr, recordLength, dispflag); }
+	 if(recordID == BatRootTypes::kSoudanHistoryRecordID && fReadHistory) { fHistoryPtr->ReadSoudanHistoryRecord(fRawData, recordLength, dispflag); }
 	 
 	 
 	 //Read Trigger record
-	 if(recordID == BatRootTypes::kTriggerRecordID && fReadTrigger) { fTriggerPtr->ReadTrigger(fgzRawDataPtr, recordLength, dispflag); }
+	 if(recordID == BatRootTypes::kTriggerRecordID && fReadTrigger) { fTriggerPtr->ReadTrigger(fRawData, recordLength, dispflag); }
 	 
 	 
 	 //Read External record
-	 if(recordID == BatRootTypes::kExternalRecordID && fReadGPS) { fGPSPtr->ReadGPS(fgzRawDataPtr, recordLength, dispflag); }
+	 if(recordID == BatRootTypes::kExternalRecordID && fReadGPS) { fGPSPtr->ReadGPS(fRawData, recordLength, dispflag); }
 	 
 	 
 	 //Read Pulse records
@@ -663,9 +677,10 @@ int RawDataReader::ReadRawDataRecord()
 	   { 
 	     PulseData tempPulseData;
 	     tempPulseData.SetFlipBytes(fFlipBytes); 
+	     tempPulseData.SetLazyUnpacking(fLazyPulseUnpacking);
 	     
-	     
-	     tempPulseData.ReadRawPulseRecord(fgzRawDataPtr, recordLength, recordID, dispflag); //tempPulseData is filled now!
+	     //false if the detector is not selected: the rest of the record is skipped by GetNextRecordID
+	     if(!ReadPulseRecord(tempPulseData, recordLength, recordID, dispflag)) continue; //tempPulseData is filled now!
 	     
 	     if(tempPulseData.IsVetoPulse() && fReadVetoPulses) StorePulsesByDetCode(tempPulseData, zipListEndDetCode, vetoListEndDetCode);
 	     if(tempPulseData.IsZipPulse() && fReadZipPulses) StorePulsesByDetCode(tempPulseData, zipListEndDetCode, vetoListEndDetCode);      
@@ -728,11 +743,32 @@ int RawDataReader::ReadRawDataRecord()
                cout << "RawDataReader::ReadRawDataRecord: INFO Reading event header (eventStatus=" << eventStatus << ")" << endl;
 	     
 	     // Read Midas Event Data
-	     eventStatus = fMidasEvent.ReadDataRecord(fgzRawDataPtr);     
+	     eventStatus = fMidasEvent.ReadDataRecord(fRawData);     
 	     if (eventStatus==0) return eventStatus; 
              if(fdiagnosticPrints)
                cout << "RawDataReader::ReadRawDataRecord: INFO Reading raw data record (eventStatus=" << eventStatus << ")" << endl;
 	     	     
+	   } else if (fEventSource) {
+
+	     // never wait longer than the poll timeout: caller gets control back
+	     // (trigger counter is rewound so the next call reads a new event)
+	     int sourceStatus = fEventSource->ReceiveEvent(fOnlineEventBuffer, fSourceTimeoutMs);
+	     if (sourceStatus == MidasEventSource::kNoEvent) {
+	       fCurrentMidasEventTrigger = 0;
+	       return kNoEventAvailable;
+	     }
+	     if (sourceStatus == MidasEventSource::kSourceClosed)
+	       return 0;
+
+	     fMidasEvent.Clear();
+	     fMidasEvent.SetDiagnosticPrints(fdiagnosticPrints);
+	     fMidasEvent.SetVerbosity(fverbosity);
+
+	     eventStatus = fMidasEvent.ReadEventFromBuffer(fOnlineEventBuffer);
+	     ProcessingTimer::AddCount(bytesCounterId, fOnlineEventBuffer.size());
+	     if (eventStatus==0) return eventStatus;
+	     if (eventStatus==-1) continue;
+
 	   } else {
 	     
 #ifdef HAVE_MIDAS
@@ -781,7 +817,7 @@ int RawDataReader::ReadRawDataRecord()
 
        if(check==0){
          isRealZipPulse = 1;
-         fListOfZipPulses =  fMidasEvent.GetPulseDataList(fCurrentMidasEventTrigger);
+         fMidasEvent.FillPulseDataList(fCurrentMidasEventTrigger, fListOfZipPulses);
        }
        else if (check<0)
 	 break;
@@ -835,6 +871,10 @@ int RawDataReader::ReadRawDataRecord()
 
    }
    
+   //uncompressed bytes consumed from the file for this record
+   if(ProcessingTimer::IsEnabled() && fRawData.IsOpen())
+     ProcessingTimer::AddCount(bytesCounterId, fRawData.Tell() - startPosition);
+
    return eventStatus; 
 }
    
@@ -913,7 +953,7 @@ int RawDataReader::SkipRawEvents(const int nEventsToSkip)
 	   
 	   // TEMP: Reading full Midas Event Data (should be replaced by reading only bank 
 	   // header (=number of triggers)
-	   eventStatus = fMidasEvent.ReadDataRecord(fgzRawDataPtr);     
+	   eventStatus = fMidasEvent.ReadDataRecord(fRawData);     
 	   if (eventStatus==0) return eventStatus; 
 	   
 	  
@@ -994,17 +1034,17 @@ uint32_t RawDataReader::GetNextRecordID(bool dispflag)
    int tempFilePosition;
 
    //Position ptr at the start of the next block of data
-   if(dispflag) cout <<"GetNextRecordID::position of pointer before move is = " << gztell(fgzRawDataPtr) << endl;
+   if(dispflag) cout <<"GetNextRecordID::position of pointer before move is = " << fRawData.Tell() << endl;
 //   for(int tempItr=0; tempItr<1000; tempItr++)
    {
 //      cout <<"Seeking!! "<< tempItr << endl;
-      tempFilePosition = gzseek(fgzRawDataPtr, fNextRecordHeaderPosition - gztell(fgzRawDataPtr), SEEK_CUR); 
+      tempFilePosition = fRawData.Seek(fNextRecordHeaderPosition - fRawData.Tell(), SEEK_CUR); 
    }
 
-   if(dispflag) cout <<"GetNextRecordID::position of pointer after move = " << gztell(fgzRawDataPtr) << endl;  
+   if(dispflag) cout <<"GetNextRecordID::position of pointer after move = " << fRawData.Tell() << endl;  
    
    //Read header info for this block
-   int readCheck = gzread(fgzRawDataPtr, (char*)header, nread*sizeof(uint32_t));
+   int readCheck = fRawData.Read((char*)header, nread*sizeof(uint32_t));
    if(fFlipBytes)
    {
       header[0] = EndianHelper::Swap4ByteWord(header[0]); 
@@ -1032,6 +1072,44 @@ uint32_t RawDataReader::GetNextRecordID(bool dispflag)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+//Helper function for ReadRawDataRecord, reading the pulse record at the current position into
+//tempPulseData.  With a detector selection the header is read first, and a zip pulse of another
+//detector is left unread (returns false); GetNextRecordID seeks to the next record either way.
+bool RawDataReader::ReadPulseRecord(PulseData& tempPulseData, uint32_t recordLength, uint32_t recordID, bool dispflag)
+{
+   uint32_t recordWords = recordLength/BatRootTypes::kWordSize;
+   if(fRecordBuffer.size() < recordWords) fRecordBuffer.resize(recordWords);
+
+   uint32_t nWordsRead = 0;
+   if(!fSelectedDetectors.empty() && recordWords >= (uint32_t)PulseData::kRawPulseHeaderWords)
+   {
+      nWordsRead = PulseData::kRawPulseHeaderWords;
+      if(fRawData.Read((char*)&fRecordBuffer[0], nWordsRead*sizeof(uint32_t)) < 0)
+      {
+	 cerr <<"RawDataReader::ERROR reading pulse record header!" << endl;
+	 exit(1);
+      }
+
+      int detType, detNum, detChannel;
+      PulseData::DecodeRawDetCode(&fRecordBuffer[0], recordID, fFlipBytes, detType, detNum, detChannel);
+      if(detType != BatRootTypes::kVetoDetType && 
+	 detType != BatRootTypes::kMonitorNoiseFast && detType != BatRootTypes::kMonitorNoiseSlow &&
+	 fSelectedDetectors.find(detNum) == fSelectedDetectors.end())
+	 return false;
+   }
+
+   if(recordWords > nWordsRead &&
+      fRawData.Read((char*)&fRecordBuffer[nWordsRead], (recordWords-nWordsRead)*sizeof(uint32_t)) < 0)
+   {
+      cerr <<"RawDataReader::ERROR reading trace data block!" << endl;
+      exit(1);
+   }
+
+   tempPulseData.ReadRawPulseBuffer(&fRecordBuffer[0], recordLength, recordID, dispflag);
+   return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //Helper function for ReadRawDataRecord, storing pulses in order according to the detector code
 //The primary function of doing this is to ensure that all the pulses belonging to one detector
@@ -1126,7 +1204,7 @@ void RawDataReader::FillMapOfZipPulses()
    //cout << "RawDataReader::FillMapOfZipPulses(): filling " << fListOfZipPulses.size() << " pulses" << endl;
    for(uint pulseItr=0; pulseItr < fListOfZipPulses.size(); pulseItr++)
    {
-      PulseData aPulseData = fListOfZipPulses[pulseItr]; //makes a copy
+      const PulseData& aPulseData = fListOfZipPulses[pulseItr]; //copied once, into the map
       int detNum = aPulseData.GetDetectorNum();
 
       //retrive the vector of pulses for this zip, create new entry if it doesn't exist
@@ -12,15 +12,22 @@
 //
 //Modifications:
 //Nov. 22, 2010 - Adding DetectorConfigData 
+//Online mode can read from any MidasEventSource without blocking (RegisterEventSource)
+//Oct. 2026: the file is read through a RawDataStream, which inflates it ahead in a thread (SetReadAhead)
+//Oct. 2026: selectable decompression backend (SetInflateBackend)
+//Oct. 2026: decode selection, pulse records of unselected detectors are skipped by their length
+//           (SetDetectorSelection) and the ADC values can be unpacked lazily (SetLazyPulseUnpacking)
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifndef RAWDATAREADER_H
 #define RAWDATAREADER_H
 
+#include <set>
 #include "zlib.h"
 
 #include "BatRootTypes.h"
+#include "RawDataStream.h"
 #include "DetectorConfigData.h"
 #include "AdminData.h"
 #include "HistoryData.h"
@@ -31,6 +38,7 @@
 
 // MIDAS
 #include "MidasEventData.h"
+#include "MidasEventSource.h"
 #include "TSystem.h"
 
 // MIDAS online
@@ -50,6 +58,9 @@ class RawDataReader
       RawDataReader(); //constructor
       ~RawDataReader(); //destructor
 
+      //returned by ReadRawDataRecord in online mode when no event arrived within the poll timeout
+      enum { kNoEventAvailable = -2 };
+
       //Register which data types are to be read from raw file
       void RegisterDetectorConfigData(DetectorConfigData* dataPtr);
       void RegisterAdminData(AdminData* dataPtr);
@@ -72,6 +83,23 @@ class RawDataReader
       void Clear();
       void ModifyRawData(const map<int,string>& modificationMap);
 
+      //decompression ahead of the reader: nBuffers of bufferMB, 0 buffers reads synchronously
+      //(default 4 x 4 MB); call before OpenRawDataFile
+      void SetReadAhead(int nBuffers, int bufferMB) { fRawData.SetReadAhead(nBuffers, bufferMB*1024*1024); }
+
+      //"zlib" (default) or "libdeflate" (see RawInflater.h); call before OpenRawDataFile
+      void SetInflateBackend(const string& backend, int nThreads) { fRawData.SetInflateBackend(backend, nThreads); }
+
+      //decode selection: only the zip pulses of these detector numbers are read, the pulse records
+      //of the other zips are skipped after their header (empty list = all, the default).  Record
+      //types which are not registered are skipped as before.  Selection is by the detector number
+      //in the raw file, so do not combine it with a ModifyRawData remapping of detectors
+      void SetDetectorSelection(const vector<int>& detNums) { fSelectedDetectors = set<int>(detNums.begin(), detNums.end()); }
+
+      //keep the packed ADC words of the pulse records and unpack them when the trace is first
+      //used (PulseData::GetRawPulse), instead of when the record is read (default false)
+      void SetLazyPulseUnpacking(bool lazy) { fLazyPulseUnpacking = lazy; }
+
       //configure verbosity and diagnostic printing
       bool GetDiagnosticPrints(){return fdiagnosticPrints;}
       void SetDiagnosticPrints(bool value){fdiagnosticPrints=value;}
@@ -88,13 +116,14 @@ class RawDataReader
       
       //Read raw data online (Midas)
       void RegisterGUITSystem(TSystem* gSystem);
+      void RegisterEventSource(MidasEventSource* source, int pollTimeoutMs); //non-blocking online mode, source not owned
 #ifdef HAVE_MIDAS
       void RegisterMidasInstance(TMidasControl* midas);
       void RegisterMidasInstanceOffline(TMidasControl* midas);
 #endif
   
       //Access to the underlying file pointer for mapping purposes
-      z_off_t GetCurrentFilePosition() { return gztell(fgzRawDataPtr); }
+      z_off_t GetCurrentFilePosition() { return fRawData.Tell(); }
      
    private:
 
@@ -125,10 +154,15 @@ class RawDataReader
       
       // flag for raw data modification
       bool fIsZipPulsesModified;
+
+      //decode selection
+      set<int> fSelectedDetectors;     //empty = all zips
+      bool fLazyPulseUnpacking;
+      vector<uint32_t> fRecordBuffer;  //pulse record being read, reused
   
 
       //for i/o manipulation
-      gzFile  fgzRawDataPtr;
+      RawDataStream fRawData;
       string  fRawDataPath;
       bool    fByteCheckDone; //initialized to false
       bool    fFlipBytes;     //initialized to false
@@ -159,6 +193,11 @@ class RawDataReader
      
       //  GUI 
       TSystem *fgSystem;
+
+      // online event source
+      MidasEventSource* fEventSource;
+      int               fSourceTimeoutMs;
+      vector<char>      fOnlineEventBuffer;
     
       // Midas online
 #ifdef HAVE_MIDAS
@@ -180,10 +219,11 @@ class RawDataReader
       uint32_t GetEventLength(){ return fEventLength; }
       uint32_t GetCurrentRecordPosition(){ return fCurrentRecordPosition; }   //after record header read 
       uint32_t GetNextRecordHeaderPosition(){ return fNextRecordHeaderPosition; }//before record header read
-      gzFile&  GetRawDataPtr(){ return fgzRawDataPtr; }
+      RawDataStream&  GetRawDataPtr(){ return fRawData; }
 
  private:
       void StorePulsesByDetCode(PulseData& tempPulseData, int& zipEndCode, int &vetoEndCode);
+      bool ReadPulseRecord(PulseData& tempPulseData, uint32_t recordLength, uint32_t recordID, bool dispflag);
       void FillMapOfZipPulses();
 
       void SetEndianParam(); //sets flipBytes parameter for all readers
@@ -0,0 +1,306 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RawDataStream
+//Description:  Raw data file with read-ahead decompression (see header file).
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//Oct. 2026: reads through RawInflater instead of gzread
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include "RawDataStream.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////
+
+RawDataStream::RawDataStream() :
+   fSource(NULL),
+   fBackend("zlib"),
+   fNInflateThreads(0),
+   fNBuffers(4),
+   fBufferBytes(4*1024*1024),
+   fNFilled(0),
+   fFillIndex(0),
+   fReadIndex(0),
+   fStop(false),
+   fProducerDone(false),
+   fThreadRunning(false),
+   fProducerPosition(0),
+   fHaveBuffer(false),
+   fReadPos(0),
+   fPosition(0)
+{
+   pthread_mutex_init(&fLock, NULL);
+   pthread_cond_init(&fFilledCond, NULL);
+   pthread_cond_init(&fFreeCond, NULL);
+}
+
+RawDataStream::~RawDataStream()
+{
+   Close();
+   pthread_cond_destroy(&fFreeCond);
+   pthread_cond_destroy(&fFilledCond);
+   pthread_mutex_destroy(&fLock);
+}
+
+void RawDataStream::SetReadAhead(int nBuffers, int bufferBytes)
+{
+   //the reader holds one buffer, so read-ahead needs at least two
+   if(nBuffers == 1) nBuffers = 2;
+   fNBuffers = (nBuffers > 0 ? nBuffers : 0);
+   fBufferBytes = (bufferBytes > 0 ? bufferBytes : 4*1024*1024);
+}
+
+void RawDataStream::SetInflateBackend(const string& backend, int nThreads)
+{
+   fBackend = backend;
+   fNInflateThreads = nThreads;
+}
+
+bool RawDataStream::Open(const string& path)
+{
+   Close();
+
+   fSource = RawInflater::Create(fBackend, fNInflateThreads);
+   if(!fSource->Open(path))
+   {
+      delete fSource;
+      fSource = NULL;
+      return false;
+   }
+
+   if(fNBuffers > 0 && !fSource->IsInMemory())
+   {
+      fRing.assign(fNBuffers, Buffer());
+      for(uint bufferItr = 0; bufferItr < fRing.size(); bufferItr++)
+	 fRing[bufferItr].data.resize(fBufferBytes);
+      StartProducer(0);
+   }
+
+   return true;
+}
+
+void RawDataStream::Close()
+{
+   if(fSource == NULL) return;
+
+   StopProducer();
+   delete fSource;
+   fSource = NULL;
+   fRing.clear();
+   fPosition = 0;
+}
+
+// ==================== producer ===================================
+
+void* RawDataStream::ProducerMain(void* stream)
+{
+   static_cast<RawDataStream*>(stream)->Produce();
+   return NULL;
+}
+
+void RawDataStream::Produce()
+{
+   while(true)
+   {
+      pthread_mutex_lock(&fLock);
+      while(!fStop && fNFilled == (int)fRing.size())
+	 pthread_cond_wait(&fFreeCond, &fLock);
+      if(fStop)
+      {
+	 pthread_mutex_unlock(&fLock);
+	 break;
+      }
+      int fillIndex = fFillIndex;
+      pthread_mutex_unlock(&fLock);
+
+      //the slot is not visible to the reader until fNFilled is increased
+      Buffer& buffer = fRing[fillIndex];
+      int readCheck = fSource->Read(&buffer.data[0], buffer.data.size());
+      buffer.nBytes = (readCheck > 0 ? readCheck : 0);
+      if(readCheck < 0) buffer.status = kBufferError;
+      else if(readCheck < (int)buffer.data.size()) buffer.status = kBufferEnd;
+      else buffer.status = kBufferOK;
+      if(readCheck >= 0) fProducerPosition = fSource->Tell();   //not the seek position if that was past the end
+      buffer.start = fProducerPosition - buffer.nBytes;
+
+      pthread_mutex_lock(&fLock);
+      fFillIndex = (fillIndex+1) % (int)fRing.size();
+      fNFilled++;
+      pthread_cond_signal(&fFilledCond);
+      pthread_mutex_unlock(&fLock);
+
+      if(buffer.status != kBufferOK) break;
+   }
+
+   pthread_mutex_lock(&fLock);
+   fProducerDone = true;
+   pthread_cond_signal(&fFilledCond);
+   pthread_mutex_unlock(&fLock);
+}
+
+void RawDataStream::StartProducer(z_off_t position)
+{
+   fNFilled = 0;
+   fFillIndex = 0;
+   fReadIndex = 0;
+   fStop = false;
+   fProducerDone = false;
+   fProducerPosition = position;
+   fHaveBuffer = false;
+   fReadPos = 0;
+   fPosition = position;
+
+   if(pthread_create(&fThread, NULL, ProducerMain, this) != 0)
+   {
+      cerr <<"RawDataStream::ERROR cannot start the read-ahead thread!" << endl;
+      exit(1);
+   }
+   fThreadRunning = true;
+}
+
+void RawDataStream::StopProducer()
+{
+   if(!fThreadRunning) return;
+
+   pthread_mutex_lock(&fLock);
+   fStop = true;
+   pthread_cond_signal(&fFreeCond);
+   pthread_mutex_unlock(&fLock);
+
+   pthread_join(fThread, NULL);
+   fThreadRunning = false;
+}
+
+// ==================== reader ===================================
+
+bool RawDataStream::NextBuffer()
+{
+   pthread_mutex_lock(&fLock);
+   if(fHaveBuffer)
+   {
+      fReadIndex = (fReadIndex+1) % (int)fRing.size();
+      fNFilled--;
+      fHaveBuffer = false;
+      pthread_cond_signal(&fFreeCond);
+   }
+   while(fNFilled == 0 && !fProducerDone)
+      pthread_cond_wait(&fFilledCond, &fLock);
+   if(fNFilled > 0)
+   {
+      fHaveBuffer = true;
+      fReadPos = 0;
+   }
+   pthread_mutex_unlock(&fLock);
+
+   return fHaveBuffer;
+}
+
+int RawDataStream::Read(void* buffer, unsigned nBytes)
+{
+   if(fRing.empty()) return fSource->Read(buffer, nBytes);
+   if(nBytes == 0) return 0;
+
+   char* out = static_cast<char*>(buffer);
+   unsigned nCopied = 0;
+   while(nCopied < nBytes)
+   {
+      if(!fHaveBuffer && !NextBuffer()) break;
+
+      const Buffer& current = fRing[fReadIndex];
+      int available = current.nBytes - fReadPos;
+      if(available == 0)
+      {
+	 if(current.status == kBufferError && nCopied == 0) return -1;
+	 if(current.status != kBufferOK) break;
+	 if(!NextBuffer()) break;
+	 continue;
+      }
+
+      unsigned nCopy = (nBytes-nCopied < (unsigned)available ? nBytes-nCopied : available);
+      memcpy(out+nCopied, &current.data[fReadPos], nCopy);
+      fReadPos += nCopy;
+      nCopied += nCopy;
+   }
+
+   //after a seek past the end of file, a read comes back to the end as in zlib
+   if(fHaveBuffer) fPosition = fRing[fReadIndex].start + fReadPos;
+   else fPosition += nCopied;
+   return nCopied;
+}
+
+z_off_t RawDataStream::Seek(z_off_t offset, int whence)
+{
+   if(fRing.empty()) return fSource->Seek(offset, whence);
+
+   z_off_t target = (whence == SEEK_SET ? offset : fPosition + offset);
+   if(whence != SEEK_SET && whence != SEEK_CUR) return -1;
+   if(target < 0) return -1;
+
+   //inside the buffer being read (the usual case for short rewinds)
+   if(fHaveBuffer)
+   {
+      const Buffer& current = fRing[fReadIndex];
+      if(target >= current.start && target <= current.start + current.nBytes)
+      {
+	 fReadPos = target - current.start;
+	 fPosition = target;
+	 return fPosition;
+      }
+   }
+
+   //backwards: inflate again from there
+   if(target < fPosition)
+   {
+      StopProducer();
+      if(fSource->Seek(target, SEEK_SET) < 0) return -1;
+      StartProducer(target);
+      return fPosition;
+   }
+
+   //forwards: skip the buffers in between; like gzseek, a position past the end of file is
+   //accepted and the following reads return 0
+   while(true)
+   {
+      if(!fHaveBuffer && !NextBuffer()) break;
+      const Buffer& current = fRing[fReadIndex];
+      if(target <= current.start + current.nBytes)
+      {
+	 fReadPos = target - current.start;
+	 fPosition = target;
+	 return fPosition;
+      }
+      fReadPos = current.nBytes;
+      fPosition = current.start + current.nBytes;
+      if(current.status != kBufferOK) break;
+      if(!NextBuffer()) break;
+   }
+   fPosition = target;
+   return fPosition;
+}
+
+z_off_t RawDataStream::Tell() const
+{
+   if(fRing.empty()) return fSource->Tell();
+   return fPosition;
+}
+
+void RawDataStream::Rewind()
+{
+   if(fRing.empty())
+   {
+      fSource->Rewind();
+      return;
+   }
+
+   StopProducer();
+   fSource->Rewind();
+   StartProducer(0);
+}
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RawDataStream
+//Description:  Decompressed view of a raw data file, used by RawDataReader and the data classes
+//instead of the bare gzFile.  A producer thread inflates the file into a ring of large buffers
+//ahead of the reader, so decompression and file system latency overlap with the analysis and the
+//many small header and record reads are copies from memory instead of gzread calls.
+//Read/Seek/Tell/Rewind behave as gzread/gzseek/gztell/gzrewind.  Forward seeks skip through the
+//buffers; a backward seek out of the current buffer restarts the producer at the new position
+//(zlib inflates again from the start of the file, as gzseek does).  With no read-ahead buffers
+//every call goes straight to the decompression backend.
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//Oct. 2026: decompression goes through a RawInflater backend (zlib or libdeflate, see
+//RawInflater.h).  A backend which decodes the whole file at Open is read without the ring.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RAWDATASTREAM_H
+#define RAWDATASTREAM_H
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "zlib.h"
+#include "RawInflater.h"
+
+using namespace std;
+
+//!Raw data file with read-ahead decompression (see header file for more info).
+class RawDataStream
+{
+   public:
+
+      RawDataStream();
+      ~RawDataStream();
+
+      //nBuffers of bufferBytes each, 0 buffers reads synchronously; applies from the next Open
+      void SetReadAhead(int nBuffers, int bufferBytes);
+
+      //"zlib" (default) or "libdeflate", see RawInflater; applies from the next Open
+      void SetInflateBackend(const string& backend, int nThreads = 0);
+
+      bool Open(const string& path);   //false if the file cannot be opened
+      void Close();
+      bool IsOpen() const { return fSource != NULL; }
+
+      int     Read(void* buffer, unsigned nBytes);   //bytes read, 0 at end of file, -1 on error
+      z_off_t Seek(z_off_t offset, int whence);      //SEEK_SET or SEEK_CUR, returns the new position or -1
+      z_off_t Tell() const;
+      void    Rewind();
+
+   private:
+
+      enum BufferStatus { kBufferOK, kBufferEnd, kBufferError };
+
+      struct Buffer {
+	 vector<char> data;
+	 z_off_t      start;    //file position of data[0]
+	 int          nBytes;   //less than data.size() only for the last buffer
+	 BufferStatus status;
+      };
+
+      RawInflater* fSource;
+      string   fBackend;
+      int      fNInflateThreads;
+      int      fNBuffers;
+      int      fBufferBytes;
+
+      //ring shared with the producer: it fills fRing[fFillIndex] while fNFilled < fNBuffers,
+      //the reader works on fRing[fReadIndex] (counted in fNFilled until released)
+      vector<Buffer>  fRing;
+      int             fNFilled;
+      int             fFillIndex;
+      int             fReadIndex;
+      bool            fStop;
+      bool            fProducerDone;
+      bool            fThreadRunning;
+      z_off_t         fProducerPosition;
+      pthread_t       fThread;
+      pthread_mutex_t fLock;
+      pthread_cond_t  fFilledCond;
+      pthread_cond_t  fFreeCond;
+
+      //reader side
+      bool     fHaveBuffer;      //fRing[fReadIndex] is held by the reader
+      int      fReadPos;         //in fRing[fReadIndex]
+      z_off_t  fPosition;
+
+      static void* ProducerMain(void* stream);
+      void Produce();
+      void StartProducer(z_off_t position);
+      void StopProducer();
+      bool NextBuffer();         //releases the current buffer, false once the producer is done
+};
+
+#endif /* RAWDATASTREAM_H */
@@ -0,0 +1,487 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RawInflater
+//Description:  Decompression backends of RawDataStream (see header file).
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "RawInflater.h"
+
+#ifdef HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+using namespace std;
+
+// ======================================================================
+
+RawInflater* RawInflater::Create(const string& backend, int nThreads)
+{
+   if(backend == "zlib")
+      return new ZlibInflater();
+
+   if(backend == "libdeflate")
+   {
+      if(!IsAvailable(backend))
+      {
+	 cerr <<"RawInflater: ERROR RAW_INFLATE_BACKEND = libdeflate needs BatCommon built with libdeflate" << endl;
+	 exit(1);
+      }
+      return new LibdeflateInflater(nThreads);
+   }
+
+   cerr <<"RawInflater: ERROR unknown RAW_INFLATE_BACKEND " << backend << " (zlib or libdeflate)" << endl;
+   exit(1);
+}
+
+bool RawInflater::IsAvailable(const string& backend)
+{
+   if(backend == "zlib") return true;
+#ifdef HAVE_LIBDEFLATE
+   if(backend == "libdeflate") return true;
+#endif
+   return false;
+}
+
+// ==================== zlib ===================================
+
+ZlibInflater::ZlibInflater() :
+   fFile(NULL)
+{
+}
+
+ZlibInflater::~ZlibInflater()
+{
+   Close();
+}
+
+bool ZlibInflater::Open(const string& path)
+{
+   Close();
+   fFile = gzopen(path.c_str(), "rb");
+   if(fFile == NULL) return false;
+
+   //a larger input buffer cuts the number of read() calls
+   gzbuffer(fFile, 256*1024);
+   return true;
+}
+
+void ZlibInflater::Close()
+{
+   if(fFile != NULL) gzclose(fFile);
+   fFile = NULL;
+}
+
+// ==================== libdeflate ===================================
+
+LibdeflateInflater::LibdeflateInflater(int nThreads) :
+   fNThreads(nThreads > 0 ? nThreads : sysconf(_SC_NPROCESSORS_ONLN)),
+   fNMembers(0),
+   fSize(0),
+   fPosition(0),
+   fSegment(0)
+{
+   if(fNThreads < 1) fNThreads = 1;
+}
+
+LibdeflateInflater::~LibdeflateInflater()
+{
+   Close();
+}
+
+bool LibdeflateInflater::Open(const string& path)
+{
+   Close();
+
+   FILE* file = fopen(path.c_str(), "rb");
+   if(file == NULL) return false;
+
+   vector<char> compressed;
+   if(fseek(file, 0, SEEK_END) == 0)
+   {
+      long fileSize = ftell(file);
+      if(fileSize > 0)
+      {
+	 compressed.resize(fileSize);
+	 rewind(file);
+	 if(fread(&compressed[0], 1, fileSize, file) != (size_t)fileSize)
+	    compressed.clear();
+      }
+   }
+   fclose(file);
+
+   if(!Decode(compressed))
+   {
+      cerr <<"LibdeflateInflater: ERROR decoding " << path << endl;
+      Close();
+      return false;
+   }
+
+   fSegmentStart.resize(fSegments.size());
+   fSize = 0;
+   for(uint segItr = 0; segItr < fSegments.size(); segItr++)
+   {
+      fSegmentStart[segItr] = fSize;
+      fSize += fSegments[segItr].size();
+   }
+   fPosition = 0;
+   fSegment = 0;
+   return true;
+}
+
+void LibdeflateInflater::Close()
+{
+   fSegments.clear();
+   fSegmentStart.clear();
+   fNMembers = 0;
+   fSize = 0;
+   fPosition = 0;
+   fSegment = 0;
+}
+
+void LibdeflateInflater::Locate()
+{
+   if(fPosition >= fSize) return;
+   if(fSegment >= fSegments.size() || fSegmentStart[fSegment] > fPosition) fSegment = 0;
+   while(fSegmentStart[fSegment] + (z_off_t)fSegments[fSegment].size() <= fPosition) fSegment++;
+}
+
+int LibdeflateInflater::Read(void* buffer, unsigned nBytes)
+{
+   if(nBytes == 0) return 0;
+
+   //past the end (after a seek there) the position comes back to the end, as in zlib
+   if(fPosition >= fSize)
+   {
+      fPosition = fSize;
+      return 0;
+   }
+
+   char* out = static_cast<char*>(buffer);
+   unsigned nCopied = 0;
+   Locate();
+   while(nCopied < nBytes && fSegment < fSegments.size())
+   {
+      const vector<char>& segment = fSegments[fSegment];
+      z_off_t offset = fPosition - fSegmentStart[fSegment];
+      z_off_t available = segment.size() - offset;
+      unsigned nCopy = (nBytes-nCopied < available ? nBytes-nCopied : available);
+      if(nCopy > 0) memcpy(out+nCopied, &segment[offset], nCopy);
+      nCopied += nCopy;
+      fPosition += nCopy;
+      if(fPosition == fSegmentStart[fSegment] + (z_off_t)segment.size()) fSegment++;
+   }
+   return nCopied;
+}
+
+z_off_t LibdeflateInflater::Seek(z_off_t offset, int whence)
+{
+   z_off_t target = (whence == SEEK_SET ? offset : fPosition + offset);
+   if((whence != SEEK_SET && whence != SEEK_CUR) || target < 0) return -1;
+   fPosition = target;
+   return fPosition;
+}
+
+#ifdef HAVE_LIBDEFLATE
+
+namespace {
+
+   //one gzip member candidate [start, end) of the compressed file
+   struct MemberRange {
+      size_t       start;
+      size_t       end;
+      vector<char> output;
+      bool         ok;
+   };
+
+   struct DecodeJob {
+      const vector<char>*   compressed;
+      vector<MemberRange>*  ranges;
+      size_t                next;
+      pthread_mutex_t       lock;
+   };
+
+   uint32_t ReadLE32(const char* bytes)
+   {
+      const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes);
+      return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+   }
+
+   bool IsGzipHeader(const vector<char>& data, size_t pos)
+   {
+      //magic, deflate, no reserved flag bits
+      return pos + 18 <= data.size() && (unsigned char)data[pos] == 0x1f
+	 && (unsigned char)data[pos+1] == 0x8b && data[pos+2] == 8 && (data[pos+3] & 0xe0) == 0;
+   }
+
+   //BGZF (and any writer with a "BC" extra field) stores the size of each member in its header
+   size_t BGZFBlockSize(const vector<char>& data, size_t pos)
+   {
+      if(!IsGzipHeader(data, pos) || !(data[pos+3] & 0x04)) return 0;
+      size_t xlen = (unsigned char)data[pos+10] | ((unsigned char)data[pos+11] << 8);
+      size_t field = pos + 12;
+      while(field + 4 <= pos + 12 + xlen && field + 4 <= data.size())
+      {
+	 size_t fieldLength = (unsigned char)data[field+2] | ((unsigned char)data[field+3] << 8);
+	 if(data[field] == 'B' && data[field+1] == 'C' && fieldLength == 2 && field + 6 <= data.size())
+	    return ((unsigned char)data[field+4] | ((unsigned char)data[field+5] << 8)) + 1;
+	 field += 4 + fieldLength;
+      }
+      return 0;
+   }
+
+   //decodes one range as exactly one member, its size taken from the trailer
+   void DecodeRange(libdeflate_decompressor* decompressor, const vector<char>& compressed, MemberRange& range)
+   {
+      range.ok = false;
+      size_t length = range.end - range.start;
+      if(length < 18) return;
+      size_t outSize = ReadLE32(&compressed[range.end-4]);
+
+      //a false member boundary gives a meaningless trailer; do not allocate for it
+      if(outSize > 64*length + 64*1024*1024) return;
+
+      range.output.resize(outSize);
+      size_t inUsed = 0, outUsed = 0;
+      libdeflate_result result = libdeflate_gzip_decompress_ex(decompressor, &compressed[range.start], length,
+							       outSize ? &range.output[0] : NULL, outSize,
+							       &inUsed, &outUsed);
+      range.ok = (result == LIBDEFLATE_SUCCESS && inUsed == length && outUsed == outSize);
+      if(!range.ok) vector<char>().swap(range.output);
+   }
+
+   void* DecodeWorker(void* jobPtr)
+   {
+      DecodeJob& job = *static_cast<DecodeJob*>(jobPtr);
+      libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
+      while(decompressor != NULL)
+      {
+	 pthread_mutex_lock(&job.lock);
+	 size_t rangeItr = job.next++;
+	 pthread_mutex_unlock(&job.lock);
+	 if(rangeItr >= job.ranges->size()) break;
+	 DecodeRange(decompressor, *job.compressed, (*job.ranges)[rangeItr]);
+      }
+      if(decompressor != NULL) libdeflate_free_decompressor(decompressor);
+      return NULL;
+   }
+
+   //decodes the member at pos into an output of outSize bytes, whatever follows it in the file
+   libdeflate_result TryDecodeMember(libdeflate_decompressor* decompressor, const vector<char>& compressed,
+				     size_t pos, size_t outSize, vector<char>& output, size_t& inUsed)
+   {
+      //the old contents are not needed: no copy when the capacity grows
+      output.clear();
+      output.resize(outSize);
+      size_t outUsed = 0;
+      libdeflate_result result = libdeflate_gzip_decompress_ex(decompressor, &compressed[pos], compressed.size()-pos,
+							       &output[0], outSize, &inUsed, &outUsed);
+      if(result == LIBDEFLATE_SUCCESS)
+      {
+	 output.resize(outUsed);
+	 //a false boundary's trailer can be far too large
+	 if(output.capacity() > 2*outUsed + 1024*1024) vector<char>(output).swap(output);
+      }
+      return result;
+   }
+
+   //one member at pos, decoded straight into output.  It ends at one of the boundaries after
+   //pos, so the output is sized from the ISIZE trailers before them, in file order, until one is
+   //large enough.  ISIZE is the size modulo 4 GB: without a large enough one the output doubles
+   bool DecodeMember(libdeflate_decompressor* decompressor, const vector<char>& compressed, size_t pos,
+		     const vector<size_t>& boundaries, vector<char>& output, size_t& inUsed)
+   {
+      size_t length = compressed.size() - pos;
+      size_t outSize = 0;
+      for(uint endItr = 0; endItr < boundaries.size(); endItr++)
+      {
+	 size_t end = boundaries[endItr];
+	 if(end < pos + 18) continue;
+	 size_t trailerSize = ReadLE32(&compressed[end-4]);
+	 if(trailerSize <= outSize || trailerSize > 64*length + 64*1024*1024) continue;
+
+	 outSize = trailerSize;
+	 libdeflate_result result = TryDecodeMember(decompressor, compressed, pos, outSize, output, inUsed);
+	 if(result != LIBDEFLATE_INSUFFICIENT_SPACE) return (result == LIBDEFLATE_SUCCESS);
+      }
+
+      outSize = (2*outSize > 4*length ? 2*outSize : 4*length + 1024*1024);
+      while(true)
+      {
+	 libdeflate_result result = TryDecodeMember(decompressor, compressed, pos, outSize, output, inUsed);
+	 if(result != LIBDEFLATE_INSUFFICIENT_SPACE) return (result == LIBDEFLATE_SUCCESS);
+	 outSize *= 2;
+      }
+   }
+
+   //a member libdeflate cannot decode (truncated or corrupt file) goes through zlib, which gives
+   //the data up to the problem as gzread does.  Returns 1 if the member was complete after all,
+   //0 for partial data and -1 if not even the gzip header could be read
+   int InflatePartial(const vector<char>& compressed, size_t pos, vector<char>& output, size_t& inUsed)
+   {
+      z_stream stream;
+      memset(&stream, 0, sizeof(stream));
+      if(inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return -1;
+
+      const size_t kChunk = 1 << 30;   //avail_in/avail_out are 32 bit
+      size_t inPos = pos;
+      size_t outUsed = 0;
+      output.resize(4*(compressed.size()-pos) + 1024*1024);
+      int status = Z_OK;
+      while(status == Z_OK)
+      {
+	 if(outUsed == output.size()) output.resize(2*output.size());
+	 size_t inChunk = min(compressed.size() - inPos, kChunk);
+	 size_t outChunk = min(output.size() - outUsed, kChunk);
+	 stream.next_in = (Bytef*)&compressed[inPos];
+	 stream.avail_in = inChunk;
+	 stream.next_out = (Bytef*)&output[outUsed];
+	 stream.avail_out = outChunk;
+	 status = inflate(&stream, Z_NO_FLUSH);
+	 inPos += inChunk - stream.avail_in;
+	 outUsed += outChunk - stream.avail_out;
+	 //no progress for lack of output space only: grow and go on, otherwise the input ended
+	 if(status == Z_BUF_ERROR && stream.avail_out == 0) status = Z_OK;
+      }
+      inflateEnd(&stream);
+      output.resize(outUsed);
+      inUsed = inPos - pos;
+
+      if(status == Z_STREAM_END) return 1;
+      return (inUsed > 10 ? 0 : -1);
+   }
+}
+
+bool LibdeflateInflater::Decode(const vector<char>& compressed)
+{
+   //not gzipped: the file is the data (gzread reads such files transparently too)
+   if(!IsGzipHeader(compressed, 0))
+   {
+      fSegments.assign(1, compressed);
+      return true;
+   }
+
+   //member boundaries: exact from BGZF block sizes, otherwise every gzip header in the file;
+   //a header found inside a member splits it into ranges which fail (or are skipped below)
+   vector<size_t> boundaries;
+   boundaries.push_back(0);
+   size_t blockSize = BGZFBlockSize(compressed, 0);
+   if(blockSize > 0)
+   {
+      size_t pos = 0;
+      while(blockSize > 0 && pos + blockSize < compressed.size())
+      {
+	 pos += blockSize;
+	 boundaries.push_back(pos);
+	 blockSize = BGZFBlockSize(compressed, pos);
+      }
+   }
+   else if(fNThreads > 1)
+   {
+      for(size_t pos = 18; pos + 18 <= compressed.size(); pos++)
+      {
+	 const void* found = memchr(&compressed[pos], 0x1f, compressed.size() - 18 - pos + 1);
+	 if(found == NULL) break;
+	 pos = static_cast<const char*>(found) - &compressed[0];
+	 if(IsGzipHeader(compressed, pos)) boundaries.push_back(pos);
+      }
+   }
+   boundaries.push_back(compressed.size());
+
+   vector<MemberRange> ranges(boundaries.size()-1);
+   for(uint rangeItr = 0; rangeItr < ranges.size(); rangeItr++)
+   {
+      ranges[rangeItr].start = boundaries[rangeItr];
+      ranges[rangeItr].end = boundaries[rangeItr+1];
+      ranges[rangeItr].ok = false;
+   }
+
+   //parallel decode of the ranges (a single range is just decoded here)
+   DecodeJob job;
+   job.compressed = &compressed;
+   job.ranges = &ranges;
+   job.next = 0;
+   pthread_mutex_init(&job.lock, NULL);
+   int nWorkers = (int)ranges.size() < fNThreads ? ranges.size() : fNThreads;
+   vector<pthread_t> workers(nWorkers > 1 ? nWorkers : 0);
+   for(uint workerItr = 0; workerItr < workers.size(); workerItr++)
+      pthread_create(&workers[workerItr], NULL, DecodeWorker, &job);
+   if(workers.empty()) DecodeWorker(&job);
+   for(uint workerItr = 0; workerItr < workers.size(); workerItr++)
+      pthread_join(workers[workerItr], NULL);
+   pthread_mutex_destroy(&job.lock);
+
+   //follow the members through the file: a member starting where a decoded range starts is that
+   //range, any other is decoded here (the ranges found inside it are dropped)
+   libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
+   if(decompressor == NULL) return false;
+   bool ok = true;
+   fNMembers = 0;
+   size_t pos = 0;
+   uint rangeItr = 0;
+   while(pos < compressed.size())
+   {
+      //anything after the last member is ignored, as gzread does
+      if(pos > 0 && !IsGzipHeader(compressed, pos)) break;
+
+      while(rangeItr < ranges.size() && ranges[rangeItr].start < pos) rangeItr++;
+      fSegments.push_back(vector<char>());
+      if(rangeItr < ranges.size() && ranges[rangeItr].start == pos && ranges[rangeItr].ok)
+      {
+	 fSegments.back().swap(ranges[rangeItr].output);
+	 pos = ranges[rangeItr].end;
+      }
+      else
+      {
+	 size_t inUsed = 0;
+	 vector<size_t> ends(upper_bound(boundaries.begin(), boundaries.end(), pos), boundaries.end());
+	 if(!DecodeMember(decompressor, compressed, pos, ends, fSegments.back(), inUsed))
+	 {
+	    //as with gzread, the data up to a truncation (or corruption) are still read
+	    int status = InflatePartial(compressed, pos, fSegments.back(), inUsed);
+	    if(status < 0)
+	    {
+	       //a broken member after good ones ends the data, as in gzread
+	       fSegments.pop_back();
+	       ok = (fNMembers > 0);
+	       if(ok)
+		  cerr <<"LibdeflateInflater: WARNING gzip member " << fNMembers << " cannot be read, only the "
+		       << fNMembers << " members before it are" << endl;
+	       break;
+	    }
+	    if(status == 0)
+	    {
+	       cerr <<"LibdeflateInflater: WARNING gzip member " << fNMembers << " is truncated or corrupt, only its first "
+		    << fSegments.back().size() << " bytes are read" << endl;
+	       fNMembers++;
+	       break;
+	    }
+	 }
+	 pos += inUsed;
+      }
+      fNMembers++;
+   }
+   libdeflate_free_decompressor(decompressor);
+
+   return ok;
+}
+
+#else
+
+bool LibdeflateInflater::Decode(const vector<char>&)
+{
+   return false;
+}
+
+#endif
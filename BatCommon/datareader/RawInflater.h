@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RawInflater
+//Description:  Decompression backend of RawDataStream, chosen with RAW_INFLATE_BACKEND.
+//ZlibInflater streams the file through gzread (the default).  LibdeflateInflater decodes
+//whole gzip members with libdeflate at Open and serves the reads from memory.  The members of a
+//multi-member file are decoded in parallel.  Their boundaries come from the BGZF block sizes
+//when present, otherwise from the gzip headers found in the file, checked by the decode
+//itself.  Each member is decoded straight into its segment, sized from the gzip ISIZE trailer.
+//A truncated or corrupt member is read up to the problem through zlib, as gzread does.
+//Plain (not gzipped) files are read as they are by both backends.
+//LibdeflateInflater needs BatCommon built with libdeflate (HAVE_LIBDEFLATE, see cdmsbats.mk)
+//and memory for the whole decompressed file.
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RAWINFLATER_H
+#define RAWINFLATER_H
+
+#include <string>
+#include <vector>
+
+#include "zlib.h"
+
+using namespace std;
+
+//!Interface of the raw file decompression used by RawDataStream
+class RawInflater
+{
+   public:
+
+      virtual ~RawInflater() {}
+
+      virtual bool    Open(const string& path) = 0;   //false if the file cannot be opened or decoded
+      virtual void    Close() = 0;
+      virtual int     Read(void* buffer, unsigned nBytes) = 0;   //as gzread
+      virtual z_off_t Seek(z_off_t offset, int whence) = 0;      //as gzseek
+      virtual z_off_t Tell() = 0;
+      virtual void    Rewind() = 0;
+
+      //true if Open decompresses the whole file, so reading ahead gains nothing
+      virtual bool    IsInMemory() const { return false; }
+
+      //"zlib" or "libdeflate"; nThreads <= 0 uses all cpus.  Exits for an unknown or unavailable one
+      static RawInflater* Create(const string& backend, int nThreads = 0);
+      static bool IsAvailable(const string& backend);
+};
+
+
+//!gzread/gzseek on the file (stock zlib, or zlib-ng in compat mode if linked instead)
+class ZlibInflater : public RawInflater
+{
+   public:
+
+      ZlibInflater();
+      ~ZlibInflater();
+
+      bool    Open(const string& path);
+      void    Close();
+      int     Read(void* buffer, unsigned nBytes) { return gzread(fFile, buffer, nBytes); }
+      z_off_t Seek(z_off_t offset, int whence)    { return gzseek(fFile, offset, whence); }
+      z_off_t Tell()                              { return gztell(fFile); }
+      void    Rewind()                            { gzrewind(fFile); }
+
+   private:
+
+      gzFile fFile;
+};
+
+
+//!Whole-member decode with libdeflate, parallel over the members of the file
+class LibdeflateInflater : public RawInflater
+{
+   public:
+
+      LibdeflateInflater(int nThreads);
+      ~LibdeflateInflater();
+
+      bool    Open(const string& path);
+      void    Close();
+      int     Read(void* buffer, unsigned nBytes);
+      z_off_t Seek(z_off_t offset, int whence);
+      z_off_t Tell() { return fPosition; }
+      void    Rewind() { fPosition = 0; fSegment = 0; }
+      bool    IsInMemory() const { return true; }
+
+      int     GetNMembers() const { return fNMembers; }
+
+   private:
+
+      int     fNThreads;
+      int     fNMembers;
+      vector< vector<char> > fSegments;   //decompressed data in file order (one per member)
+      vector<z_off_t>        fSegmentStart;
+      z_off_t fSize;
+      z_off_t fPosition;
+      uint    fSegment;                   //segment holding fPosition, when fPosition < fSize
+
+      bool Decode(const vector<char>& compressed);
+      void Locate();                      //sets fSegment for fPosition
+};
+
+#endif /* RAWINFLATER_H */
@@ -15,6 +15,7 @@
 #define TRIGGERDATA_H
 
 #include "zlib.h"
+#include "RawDataStream.h"
 #include <map>
 #include <vector>
 
@@ -39,14 +40,14 @@ class TriggerData
       
       //For reading raw data
       void Reset();             //clears data members for next filling
-      void ReadTrigger(gzFile& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
+      void ReadTrigger(RawDataStream& localRawDataPtr, uint32_t recordLength, bool dispHeader);        
       
       //flipping bytes for opposite endianness
       void SetFlipBytes(bool flipCheck) { fFlipBytes = flipCheck; return; }
 
       //for querying RQ lists - provies read only access!
       void ConstructRQList(const int nTowers);
-      map<string, double> GetRQList() const { return fRQList; }
+      const map<string, double>& GetRQList() const { return fRQList; }
       
       ///Enum defining trigger types (based on HistoryData.h comments)
       enum TRIGGER_BITS{
@@ -61,7 +61,7 @@ class DmmDataManager
 
     // ==== RQ list  ====
     void ConstructZipRQList();
-    map<int, map<string, double> > GetAllZipRQList() const { return fZipRQList; }
+    const map<int, map<string, double> >& GetAllZipRQList() const { return fZipRQList; }
     map<string, double> GetZipRQList(const int&  detNum) const { return (fZipRQList.find(detNum))->second; }
 
     // reset RQ list
@@ -15,10 +15,22 @@
 //Modifications:    April 5, 2012
 //Modified by:      Anthony Villano (villaa@physics.umn.edu)
 //Description:      Added function to get TGraphErrors for NSOF 
+//Modifications:    ReadFile split into ReadRootFile/StoreRecord; optional binary cache of the
+//                  filter file (ReadCacheFile/WriteCacheFile), keyed on the filter tag and on the
+//                  contents (default) or the size and modification time of the filter file
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "FilterDataManager.h"
 
+// C library (filter cache)
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 // ROOT library
 #include "TH1D.h"
 #include "TTree.h"
@@ -38,6 +50,7 @@
      
 // constructor
 FilterDataManager::FilterDataManager(const map< int, int >& detectorMap)  
+  : fCacheKey(kCacheKeyHash)
 {   
 
   //Construct the RQ list
@@ -49,6 +62,7 @@ FilterDataManager::FilterDataManager(const map< int, int >& detectorMap)
 
 // default constructor
 FilterDataManager::FilterDataManager()
+  : fCacheKey(kCacheKeyHash)
 {   
 
 
@@ -876,6 +890,37 @@ return;
 
 
 void  FilterDataManager::ReadFile(string filename)
+{
+
+  // no cache requested: read the ROOT file directly
+  if (fCacheFilename.empty())
+   {
+     ReadRootFile(filename, NULL);
+     return;
+   }
+
+  // cache valid for this filter file?
+  uint64_t sourceSize = 0;
+  uint64_t sourceKey = 0;
+  if (!GetSourceKey(filename, sourceSize, sourceKey))
+   {
+     cerr << "FilterDataManager::ReadFile: ERROR! file '" << filename <<"' not found..." << endl;
+     exit(1);
+   }
+
+  if (ReadCacheFile(filename, sourceSize, sourceKey))
+    return;
+
+  // read ROOT file and (re)write the cache
+  vector<CacheRecord> recordList;
+  ReadRootFile(filename, &recordList);
+  WriteCacheFile(recordList, sourceSize, sourceKey);
+
+}
+
+
+
+void  FilterDataManager::ReadRootFile(const string& filename, vector<CacheRecord>* recordList)
 {
 
 // open file
@@ -946,17 +991,22 @@ while ((aKey = (TKey *) fileKeysItr()))
 	      tree->GetEntry(0);
 
 	  // store info
-          string templateTag = templateTagChar;
-          string filterTag = filterTagChar;
-          string filterProductionDate = filterProductionDateChar;
-          string noiseCodeGitTag_cdmsbats = noiseCodeGitTagChar_cdmsbats;
-          string noiseCodeGitTag_batcommon = noiseCodeGitTagChar_batcommon;
-        
-          SetStringParameter(detNum,"templateTag",templateTag, true); 
-          SetStringParameter(detNum,"filterTag",filterTag, true);
-          SetStringParameter(detNum,"filterProductionDate",filterProductionDate, true);
-          SetStringParameter(detNum,"noiseCodeGitTag_cdmsbats",noiseCodeGitTag_cdmsbats, true);
-          SetStringParameter(detNum,"noiseCodeGitTag_batcommon",noiseCodeGitTag_batcommon, true);
+          CacheRecord aRecord;
+          aRecord.kind = kCacheString;
+          aRecord.detNum = detNum;
+
+          const char* infoNames[5] = {"templateTag", "filterTag", "filterProductionDate",
+                                      "noiseCodeGitTag_cdmsbats", "noiseCodeGitTag_batcommon"};
+          const char* infoVals[5]  = {templateTagChar, filterTagChar, filterProductionDateChar,
+                                      noiseCodeGitTagChar_cdmsbats, noiseCodeGitTagChar_batcommon};
+
+          for (int infoItr=0; infoItr<5; infoItr++)
+           {
+            aRecord.name = infoNames[infoItr];
+            aRecord.strVal = infoVals[infoItr];
+            StoreRecord(aRecord);
+            if (recordList) recordList->push_back(aRecord);
+           }
 	
 	 }
 
@@ -981,42 +1031,37 @@ while ((aKey = (TKey *) fileKeysItr()))
         { 
          // get object  
          TObject* obj = aKey->ReadObj();
+
+         CacheRecord aRecord;
+         aRecord.kind = -1;
+         aRecord.detNum = detNum;
+         aRecord.name = obj->GetName();
          
           // TH1D object
           if(!strcmp(obj->ClassName(),"TH1D"))
             {
               TH1D* histoTemp = (TH1D*) obj;
-              string histoName = histoTemp->GetName();
-              vector<double> vectTemp = PulseTools::TH1D2Vector(*histoTemp);
-              SetVectorDoubleParameter(detNum,histoName,vectTemp,true);
-
-	      //get a copy of the noisePSD in SprseMatrix form here for OptimalFilterPhononNS [ANV]
-              //string keyName = channel+"NoisePSD"; 
-	      if(histoName == "PTNoiseFFTsq"){
-                //DC component removed by NoiseBuilder reinstate as max for invertability [ANV]
-                double max = PulseTools::MaxADC(vectTemp);
-                vectTemp[0] = max;
-
-                //convert to TGraphErrors, convert to matrix and save
-                TGraphErrors *graphTemp = PulseTools::Vector2TGraphErrors(vectTemp,1.0);
-		graphTemp->SetName("PTNoisePSDMat");
-                string graphName = graphTemp->GetName();
-                SprseMatrix smatTemp = SprseMatrix(graphTemp,vectTemp.size(),vectTemp.size(),false);
-                SetSprseMatrixParameter(detNum,graphName,smatTemp,true);
-	        //TGraphErrors gets copied in SprseMatrix, so get rid of it
-		//since it's not explicitly in the filter file. 
-	        delete graphTemp;
-	      }
+              aRecord.kind = kCacheHisto;
+              aRecord.values = PulseTools::TH1D2Vector(*histoTemp);
             }  
-	   // TGraphErrors object [ANV] Save Downcast version here if necessary
+	   // TGraphErrors object [ANV]
           if(!strcmp(obj->ClassName(),"TGraphErrors"))
             {
               TGraphErrors* graphTemp = (TGraphErrors*) obj;
-              string graphName = graphTemp->GetName();
-	      //FIXME being explicit here about matrix size is a problem should find a way to fix [ANV]
-              SprseMatrix smatTemp = SprseMatrix(graphTemp,4096,4096,false);
-              SetSprseMatrixParameter(detNum,graphName,smatTemp,true);
+              int nPoints = graphTemp->GetN();
+              aRecord.kind = kCacheGraph;
+              aRecord.values.reserve(4*nPoints);
+              aRecord.values.insert(aRecord.values.end(), graphTemp->GetX(), graphTemp->GetX() + nPoints);
+              aRecord.values.insert(aRecord.values.end(), graphTemp->GetY(), graphTemp->GetY() + nPoints);
+              aRecord.values.insert(aRecord.values.end(), graphTemp->GetEX(), graphTemp->GetEX() + nPoints);
+              aRecord.values.insert(aRecord.values.end(), graphTemp->GetEY(), graphTemp->GetEY() + nPoints);
             }  
+
+          if (aRecord.kind != -1)
+            {
+              StoreRecord(aRecord);
+              if (recordList) recordList->push_back(aRecord);
+            }
         
         // clean-up
         delete obj;
@@ -1039,6 +1084,358 @@ while ((aKey = (TKey *) fileKeysItr()))
 
 }
 
+
+
+// store one filter file object in the data containers (same path for ROOT file and cache)
+void  FilterDataManager::StoreRecord(const CacheRecord& aRecord)
+{
+
+  if (aRecord.kind == kCacheString)
+   {
+     SetStringParameter(aRecord.detNum, aRecord.name, aRecord.strVal, true);
+     return;
+   }
+
+  size_t nVals = (aRecord.kind == kCacheGraph) ? aRecord.values.size()/4 : aRecord.values.size();
+  StoreValues(aRecord.kind, aRecord.detNum, aRecord.name, aRecord.values.empty() ? NULL : &aRecord.values[0], nVals);
+
+}
+
+
+
+void  FilterDataManager::StoreValues(int kind, int detNum, const string& name, const double* vals, size_t nVals)
+{
+
+  if (kind == kCacheHisto)
+   {
+     vector<double> vectTemp(vals, vals + nVals);
+     SetVectorDoubleParameter(detNum, name, vectTemp, true);
+
+     //get a copy of the noisePSD in SprseMatrix form here for OptimalFilterPhononNS [ANV]
+     if(name == "PTNoiseFFTsq"){
+       //DC component removed by NoiseBuilder reinstate as max for invertability [ANV]
+       double max = PulseTools::MaxADC(vectTemp);
+       vectTemp[0] = max;
+
+       //convert to TGraphErrors, convert to matrix and save
+       TGraphErrors *graphTemp = PulseTools::Vector2TGraphErrors(vectTemp,1.0);
+       graphTemp->SetName("PTNoisePSDMat");
+       string graphName = graphTemp->GetName();
+       SprseMatrix smatTemp = SprseMatrix(graphTemp,vectTemp.size(),vectTemp.size(),false);
+       SetSprseMatrixParameter(detNum,graphName,smatTemp,true);
+       //TGraphErrors gets copied in SprseMatrix, so get rid of it
+       //since it's not explicitly in the filter file. 
+       delete graphTemp;
+     }
+     return;
+   }
+
+  if (kind == kCacheGraph)
+   {
+     int nPoints = nVals;
+     TGraphErrors graphTemp(nPoints, vals, vals + nPoints, vals + 2*nPoints, vals + 3*nPoints);
+     graphTemp.SetName(name.c_str());
+     //FIXME being explicit here about matrix size is a problem should find a way to fix [ANV]
+     SprseMatrix smatTemp = SprseMatrix(&graphTemp,4096,4096,false);
+     SetSprseMatrixParameter(detNum,name,smatTemp,true);
+     return;
+   }
+
+}
+
+
+
+//  ================= binary cache  =================
+//
+//  Layout (native byte order, version kCacheVersion):
+//    header:  magic[8], version, nRecords (uint32), key type (uint32, CacheKey), source size (uint64),
+//             source key (uint64: content hash, or mtime in ns), filterTag (uint32 len + chars)
+//    records: kind, detNum, name (uint32 len + chars), then
+//             string  -> uint32 len + chars
+//             histo   -> uint32 n, padding to 8 bytes, n doubles
+//             graph   -> uint32 n, padding to 8 bytes, 4n doubles (x, y, ex, ey)
+//  The doubles are aligned in the file, so the values are stored straight from the mapping.
+//  The sparse matrices (PTNoisePSDMat, the NSOF graphs) are still built from the values: the
+//  ublas matrix keeps its own copy of the graph and has no layout that could be stored.
+//  The file is written to a temporary name and renamed so that concurrent jobs never see a partial cache.
+
+namespace {
+
+  const char     kCacheMagic[8] = {'B','A','T','F','L','T','C','\0'};
+  const uint32_t kCacheVersion  = 3;
+
+  // bounds-checked reader over the mapped cache; nothing is copied but the header values
+  struct CacheCursor {
+    const char* begin;
+    const char* pos;
+    const char* end;
+
+    bool Read(void* dest, size_t nBytes) {
+      if ((size_t)(end - pos) < nBytes) return false;
+      memcpy(dest, pos, nBytes);
+      pos += nBytes;
+      return true;
+    }
+
+    bool SkipString(const char*& str, uint32_t& len) {
+      if (!Read(&len, sizeof(len)) || (size_t)(end - pos) < len) return false;
+      str = pos;
+      pos += len;
+      return true;
+    }
+
+    bool SkipDoubles(const double*& vals, size_t nVals) {
+      size_t padding = (sizeof(double) - (pos - begin) % sizeof(double)) % sizeof(double);
+      if ((size_t)(end - pos) < padding) return false;
+      pos += padding;
+      if ((size_t)(end - pos) / sizeof(double) < nVals) return false;
+      vals = (const double*) pos;
+      pos += nVals*sizeof(double);
+      return true;
+    }
+  };
+
+  void WriteString(ofstream& out, const string& str)
+  {
+    uint32_t len = str.size();
+    out.write((const char*)&len, sizeof(len));
+    out.write(str.data(), len);
+  }
+
+}
+
+
+
+bool  FilterDataManager::GetSourceKey(const string& filename, uint64_t& fileSize, uint64_t& sourceKey) const
+{
+
+  if (fCacheKey == kCacheKeyStat)
+    return StatFile(filename, fileSize, sourceKey);
+
+  return HashFile(filename, fileSize, sourceKey);
+
+}
+
+
+
+// 64-bit FNV-1a over the file contents, taken 8 bytes at a time (then the remaining bytes)
+bool  FilterDataManager::HashFile(const string& filename, uint64_t& fileSize, uint64_t& hash)
+{
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) { close(fd); return false; }
+  fileSize = fileStat.st_size;
+
+  hash = 14695981039346656037ULL;
+  if (fileSize > 0)
+   {
+     void* mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+     if (mapped == MAP_FAILED) { close(fd); return false; }
+     madvise(mapped, fileSize, MADV_SEQUENTIAL);
+
+     const unsigned char* data = (const unsigned char*) mapped;
+     uint64_t nWords = fileSize / sizeof(uint64_t);
+     for (uint64_t wordItr=0; wordItr<nWords; wordItr++)
+      {
+        uint64_t word;
+        memcpy(&word, data + wordItr*sizeof(uint64_t), sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+      }
+     for (uint64_t byteItr=nWords*sizeof(uint64_t); byteItr<fileSize; byteItr++)
+      {
+        hash ^= data[byteItr];
+        hash *= 1099511628211ULL;
+      }
+     munmap(mapped, fileSize);
+   }
+
+  close(fd);
+  return true;
+
+}
+
+
+
+// cheaper key for large filter files: same size and modification time (ns)
+bool  FilterDataManager::StatFile(const string& filename, uint64_t& fileSize, uint64_t& mTime)
+{
+
+  struct stat fileStat;
+  if (stat(filename.c_str(), &fileStat) != 0) return false;
+
+  fileSize = fileStat.st_size;
+  mTime = uint64_t(fileStat.st_mtim.tv_sec)*1000000000 + fileStat.st_mtim.tv_nsec;
+  return true;
+
+}
+
+
+
+bool  FilterDataManager::ReadCacheFile(const string& filename, uint64_t sourceSize, uint64_t sourceKey)
+{
+
+  int fd = open(fCacheFilename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) { close(fd); return false; }
+  size_t cacheSize = fileStat.st_size;
+
+  // read-only mapping, the values are stored from it directly and it is unmapped afterwards
+  void* mapped = mmap(NULL, cacheSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return false;
+
+  CacheCursor cursor;
+  cursor.begin = cursor.pos = (const char*) mapped;
+  cursor.end = cursor.pos + cacheSize;
+
+  // --- header ---
+  char magic[8];
+  uint32_t version = 0, nRecords = 0, keyType = 0, tagLen = 0;
+  uint64_t cachedSize = 0, cachedKey = 0;
+  const char* headerFilterTag = NULL;
+
+  bool isValid = cursor.Read(magic, sizeof(magic)) && memcmp(magic, kCacheMagic, sizeof(magic)) == 0 &&
+                 cursor.Read(&version, sizeof(version)) && version == kCacheVersion &&
+                 cursor.Read(&nRecords, sizeof(nRecords)) &&
+                 cursor.Read(&keyType, sizeof(keyType)) && keyType == (uint32_t) fCacheKey &&
+                 cursor.Read(&cachedSize, sizeof(cachedSize)) &&
+                 cursor.Read(&cachedKey, sizeof(cachedKey)) &&
+                 cursor.SkipString(headerFilterTag, tagLen) &&
+                 sourceSize == cachedSize && sourceKey == cachedKey;
+
+  // --- records: checked completely in the first pass, so that a truncated cache stores nothing,
+  //     and stored in the second ---
+  const char* recordsBegin = cursor.pos;
+  for (int pass=0; isValid && pass<2; pass++)
+   {
+     cursor.pos = recordsBegin;
+     for (uint32_t recItr=0; isValid && recItr<nRecords; recItr++)
+      {
+        int32_t kind = 0, detNum = 0;
+        const char* namePtr = NULL;
+        const char* str = NULL;
+        uint32_t nameLen = 0, len = 0, nVals = 0;
+        const double* vals = NULL;
+
+        isValid = cursor.Read(&kind, sizeof(kind)) && cursor.Read(&detNum, sizeof(detNum)) &&
+                  cursor.SkipString(namePtr, nameLen);
+        if (!isValid) break;
+
+        if (kind == kCacheString)
+          isValid = cursor.SkipString(str, len);
+        else if (kind == kCacheHisto)
+          isValid = cursor.Read(&nVals, sizeof(nVals)) && cursor.SkipDoubles(vals, nVals);
+        else if (kind == kCacheGraph)
+          isValid = cursor.Read(&nVals, sizeof(nVals)) && cursor.SkipDoubles(vals, 4*(size_t)nVals);
+        else
+          isValid = false;
+
+        // filter tag of every detector must be the one the cache was written for
+        if (isValid && pass == 0 && kind == kCacheString && string(namePtr, nameLen) == "filterTag")
+          isValid = (string(str, len) == string(headerFilterTag, tagLen));
+
+        if (!isValid || pass == 0) continue;
+
+        if (kind == kCacheString)
+          SetStringParameter(detNum, string(namePtr, nameLen), string(str, len), true);
+        else
+          StoreValues(kind, detNum, string(namePtr, nameLen), vals, nVals);
+      }
+
+     if (pass == 0 && isValid)
+      {
+        isValid = (cursor.pos == cursor.end);
+        if (isValid)
+          cout << "\n**** Reading Filter file: " << filename << " (from cache " << fCacheFilename << ")" << endl;
+      }
+   }
+
+  munmap(mapped, cacheSize);
+
+  if (!isValid)
+   {
+     cout << "FilterDataManager::ReadFile: cache '" << fCacheFilename << "' is stale or invalid, rebuilding it" << endl;
+     return false;
+   }
+
+  return true;
+
+}
+
+
+
+void  FilterDataManager::WriteCacheFile(const vector<CacheRecord>& recordList, uint64_t sourceSize, uint64_t sourceKey)
+{
+
+  string filterTag = "";
+  for (uint recItr=0; recItr<recordList.size(); recItr++)
+    if (recordList[recItr].kind == kCacheString && recordList[recItr].name == "filterTag")
+     {
+       filterTag = recordList[recItr].strVal;
+       break;
+     }
+
+  ostringstream tmpName;
+  tmpName << fCacheFilename << ".tmp." << getpid();
+
+  ofstream out(tmpName.str().c_str(), ios::out | ios::binary | ios::trunc);
+  if (!out.is_open())
+   {
+     cerr << "FilterDataManager::WriteCacheFile: WARNING! cannot open '" << tmpName.str() << "', cache not written" << endl;
+     return;
+   }
+
+  uint32_t nRecords = recordList.size();
+  out.write(kCacheMagic, sizeof(kCacheMagic));
+  out.write((const char*)&kCacheVersion, sizeof(kCacheVersion));
+  uint32_t keyType = fCacheKey;
+  out.write((const char*)&nRecords, sizeof(nRecords));
+  out.write((const char*)&keyType, sizeof(keyType));
+  out.write((const char*)&sourceSize, sizeof(sourceSize));
+  out.write((const char*)&sourceKey, sizeof(sourceKey));
+  WriteString(out, filterTag);
+
+  const char padding[sizeof(double)] = {0};
+  for (uint recItr=0; recItr<recordList.size(); recItr++)
+   {
+     const CacheRecord& aRecord = recordList[recItr];
+     int32_t kind = aRecord.kind;
+     int32_t detNum = aRecord.detNum;
+     out.write((const char*)&kind, sizeof(kind));
+     out.write((const char*)&detNum, sizeof(detNum));
+     WriteString(out, aRecord.name);
+
+     if (kind == kCacheString)
+       WriteString(out, aRecord.strVal);
+     else
+      {
+        uint32_t nVals = (kind == kCacheGraph) ? aRecord.values.size()/4 : aRecord.values.size();
+        out.write((const char*)&nVals, sizeof(nVals));
+        out.write(padding, (sizeof(double) - streamoff(out.tellp()) % sizeof(double)) % sizeof(double));
+        if (!aRecord.values.empty())
+          out.write((const char*)&aRecord.values[0], aRecord.values.size()*sizeof(double));
+      }
+   }
+
+  out.close();
+
+  if (out.fail() || rename(tmpName.str().c_str(), fCacheFilename.c_str()) != 0)
+   {
+     cerr << "FilterDataManager::WriteCacheFile: WARNING! failed to write '" << fCacheFilename << "'" << endl;
+     remove(tmpName.str().c_str());
+     return;
+   }
+
+  cout << "**** Filter cache written: " << fCacheFilename << endl;
+
+}
+
 //  ================= Set functions  ==================
 
 
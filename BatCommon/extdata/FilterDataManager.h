@@ -15,6 +15,9 @@
 //Modifications:    April 5, 2012
 //Modified by:      Anthony Villano (villaa@physics.umn.edu)
 //Description:      Added function to get TGraphErrors for NSOF 
+//Modifications:    Added optional binary cache of the filter file (SetCacheFile), written on first
+//                  read and loaded by later jobs of the same series; keyed on the contents of the
+//                  filter file or on its size and modification time (CacheKey)
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -28,6 +31,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <stdint.h>
 
 
 // ROOT library
@@ -60,6 +64,14 @@ class FilterDataManager
    //  =====  Read file ====
 
        void     ReadFile(string filename);
+
+       //  optional binary cache: ReadFile loads it instead of the ROOT file if it was written
+       //  for the same ROOT file and filter tag, otherwise the ROOT file is read and the cache
+       //  rewritten.  The ROOT file is recognized by its contents (kCacheKeyHash, reads the whole
+       //  file) or only by its size and modification time (kCacheKeyStat)
+       enum CacheKey { kCacheKeyHash = 0, kCacheKeyStat = 1 };
+       void     SetCacheFile(const string& cacheFilename, CacheKey cacheKey = kCacheKeyHash)
+                   { fCacheFilename = cacheFilename; fCacheKey = cacheKey; }
      
 
    //  ===== Get functions =====
@@ -138,6 +150,30 @@ class FilterDataManager
         template<class Type> void SetTypeParameter(map<int, map<string,Type> > &aMapOfMapT, int detNum, const string& varName, Type val, bool overwriteFlag);
 
 
+      // one object read from the filter file, in the form stored in the cache
+      enum CacheRecordKind { kCacheString = 0, kCacheHisto = 1, kCacheGraph = 2 };
+
+      struct CacheRecord {
+        int            kind;
+        int            detNum;
+        string         name;
+        string         strVal;   // kCacheString
+        vector<double> values;   // kCacheHisto: bin contents; kCacheGraph: x, y, ex, ey blocks
+      };
+
+      void    ReadRootFile(const string& filename, vector<CacheRecord>* recordList);
+      bool    ReadCacheFile(const string& filename, uint64_t sourceSize, uint64_t sourceKey);
+      void    WriteCacheFile(const vector<CacheRecord>& recordList, uint64_t sourceSize, uint64_t sourceKey);
+      void    StoreRecord(const CacheRecord& aRecord);
+      // histo: nVals bin contents; graph: nVals points, as x, y, ex, ey blocks
+      void    StoreValues(int kind, int detNum, const string& name, const double* vals, size_t nVals);
+
+      // key of the filter file the cache is written for, according to fCacheKey
+      bool    GetSourceKey(const string& filename, uint64_t& fileSize, uint64_t& sourceKey) const;
+      static bool HashFile(const string& filename, uint64_t& fileSize, uint64_t& hash);
+      static bool StatFile(const string& filename, uint64_t& fileSize, uint64_t& mTime);
+
+
 
       // data containers
 
@@ -156,6 +192,10 @@ class FilterDataManager
      
       // detector list
       map< int, int >       fDetectorMap;
+
+      // binary cache
+      string                fCacheFilename;
+      CacheKey              fCacheKey;
   
     
 
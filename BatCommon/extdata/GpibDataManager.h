@@ -72,7 +72,7 @@ class GpibDataManager
     // ==== RQ list ====  
     void ConstructRQList();
     void ResetRQList();
-    map<string, double> GetRQList() const { return fRQList; }
+    const map<string, double>& GetRQList() const { return fRQList; }
  
    private:
  
@@ -70,12 +70,12 @@ class IsrDataManager
 
     // Event RQs
     void ConstructEventRQList();
-    map<string, double> GetEventRQList() const { return fEventRQList; }
+    const map<string, double>& GetEventRQList() const { return fEventRQList; }
  
 
     // ZIP RQs
     void ConstructZipRQList(const int& maxZIPs);
-    map<int, map<string, double> > GetAllZipRQList() const { return fZipRQList; }
+    const map<int, map<string, double> >& GetAllZipRQList() const { return fZipRQList; }
     map<string, double> GetZipRQList(const int& detNum) const { return (fZipRQList.find(detNum))->second; }
 
     // reset RQ list
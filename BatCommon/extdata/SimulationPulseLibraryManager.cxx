@@ -12,6 +12,7 @@
 //                 The tree vector now supports a detector map not starting in zip1
 //                 (the vector is filled with a 0 to preserve vector size, and keep
 //                 the other functions calling with the detNum compatible)
+//      Optional preloading of the library trees into memory, integer file numbers
 // 
 ////////////////////////////////////////////////////////////////////////////////////
 
@@ -21,7 +22,8 @@
 #include <algorithm>
 #include <iostream>
 
-SimulationPulseLibraryManager::SimulationPulseLibraryManager()
+SimulationPulseLibraryManager::SimulationPulseLibraryManager() :
+    preloaded(false)
 { }
 
 
@@ -40,13 +42,17 @@ SimulationPulseLibraryManager::~SimulationPulseLibraryManager()
 }
 
 
-void SimulationPulseLibraryManager::setLibraryFile(vector<string> filename, map<int, int> detectorMap)
+void SimulationPulseLibraryManager::setLibraryFile(vector<string> filename, map<int, int> detectorMap, bool preload)
 {
     int nfiles = filename.size();
     
     // reset and resize the vector of trees
     treeVector.clear();
     treeVector.resize(nfiles);
+    preloadedTrees.clear();
+    preloadedTrees.resize(nfiles);
+    libraryFileNums.clear();
+    preloaded = preload;
 
     // loop over vector of trees
     for(int jfile = 0; jfile < nfiles; jfile++)
@@ -63,6 +69,7 @@ void SimulationPulseLibraryManager::setLibraryFile(vector<string> filename, map<
 		      << filename[jfile] << "! May be corrupted or nonexistent." << std::endl;
 	    exit(EXIT_FAILURE);
 	}
+	libraryFileNums[filename[jfile]] = jfile;
 
 	chanAmps = 0;
 	chanNames = 0;
@@ -91,6 +98,7 @@ void SimulationPulseLibraryManager::setLibraryFile(vector<string> filename, map<
 	    treeVector[jfile].push_back(0);
 	  }
 	}
+	preloadedTrees[jfile].resize(detectorMap.rbegin()->first);
         // setup file and trees for fake pulses
 	map<int, int>::iterator it;
 	for(it = detectorMap.begin(); it!=detectorMap.end(); it++)
@@ -162,53 +170,200 @@ void SimulationPulseLibraryManager::setLibraryFile(vector<string> filename, map<
 		    treeVector[jfile][detNum-1]->SetBranchAddress("SIMRecoilEnergy", &DMCRecoilEnergy);
 		else
 		    DMCRecoilEnergy = -999999.;
+
+		if(preloaded)
+		    preloadTree(jfile, detNum);
 	    }
 	}
     }
+
+    // from now on traces are copied out of memory into buffers owned by this class
+    if(preloaded)
+    {
+	map<int, map<string, vector<double>* > >::iterator detItr;
+	for(detItr = templatePulseMap.begin(); detItr != templatePulseMap.end(); detItr++)
+	{
+	    map<string, vector<double>* >::iterator chanItr;
+	    for(chanItr = detItr->second.begin(); chanItr != detItr->second.end(); chanItr++)
+		chanItr->second = &(preloadedTraceBuffers[detItr->first][chanItr->first]);
+	}
+    }
 }
 
 
-void SimulationPulseLibraryManager::readEvent(int jevt, int detNum, string filename)
+void SimulationPulseLibraryManager::preloadTree(int jfile, int detNum)
 {
-    // check that some files have been initialized
-    if(libraryFiles.size() == 0)
+    TTree* tree = treeVector[jfile][detNum-1];
+    PreloadedTree& preloadedTree = preloadedTrees[jfile][detNum-1];
+    map<string, vector<double>* >& traceMap = templatePulseMap[detNum];
+
+    int nentries = tree->GetEntries();
+    preloadedTree.nEntries = nentries;
+    if(nentries == 0)
+	return;
+
+    // trace lengths from the first entry, all entries must match
+    tree->GetEntry(0);
+    size_t blockSize = 0;
+    map<string, vector<double>* >::const_iterator chanItr;
+    for(chanItr = traceMap.begin(); chanItr != traceMap.end(); chanItr++)
     {
-	std::cout << "SimulationPulseLibraryManager::readEvent: ERROR! You are trying to read an event but no files have been declared." << std::endl;
-	exit(EXIT_FAILURE);
+	int traceLength = chanItr->second ? chanItr->second->size() : 0;
+	preloadedTree.traceNames.push_back(chanItr->first);
+	preloadedTree.traceLengths.push_back(traceLength);
+	preloadedTree.traceOffsets.push_back(blockSize);
+	blockSize += (size_t)traceLength * nentries;
     }
-
-    // loop over files to figure out which corresponds to the specified filename
-    int nfiles = libraryFiles.size();
-    int jfile = 0;
-    ss.str(libraryFiles[jfile]->GetName());
-    while(jfile < nfiles && filename != ss.str())
+    preloadedTree.traces.resize(blockSize);
+
+    preloadedTree.eventNums.resize(nentries);
+    preloadedTree.seriesNums.resize(nentries);
+    preloadedTree.xPositions.resize(nentries);
+    preloadedTree.yPositions.resize(nentries);
+    preloadedTree.zPositions.resize(nentries);
+    preloadedTree.recoilEnergies.resize(nentries);
+    preloadedTree.ampOffsets.resize(nentries+1, 0);
+
+    map<string, int> ampNameIds;
+    int nchan = preloadedTree.traceNames.size();
+    for(int jevt = 0; jevt < nentries; jevt++)
     {
-	jfile++;
-	ss.str(libraryFiles[jfile]->GetName());
+	tree->GetEntry(jevt);
+
+	for(int jchan = 0; jchan < nchan; jchan++)
+	{
+	    const vector<double>* trace = traceMap[preloadedTree.traceNames[jchan]];
+	    int traceLength = preloadedTree.traceLengths[jchan];
+	    if(traceLength > 0 && (!trace || (int)trace->size() != traceLength))
+	    {
+		std::cout << "SimulationPulseLibraryManager::preloadTree: ERROR! Trace length of "
+			  << preloadedTree.traceNames[jchan] << " changes within zip" << detNum
+			  << " of " << libraryFiles[jfile]->GetName() << std::endl;
+		exit(EXIT_FAILURE);
+	    }
+	    float* dest = preloadedTree.traces.data() + preloadedTree.traceOffsets[jchan] + (size_t)jevt*traceLength;
+	    for(int jbin = 0; jbin < traceLength; jbin++)
+		dest[jbin] = (*trace)[jbin];
+	}
+
+	preloadedTree.eventNums[jevt] = eventNum;
+	preloadedTree.seriesNums[jevt] = seriesNum;
+	preloadedTree.xPositions[jevt] = DMCXPosition;
+	preloadedTree.yPositions[jevt] = DMCYPosition;
+	preloadedTree.zPositions[jevt] = DMCZPosition;
+	preloadedTree.recoilEnergies[jevt] = DMCRecoilEnergy;
+
+	int namp = chanNames->size();
+	if(namp != (int)chanAmps->size())
+	    std::cout << "ERROR in SimulationPulseLibraryManager::preloadTree: chanAmps is a different size than chanNames in input ROOT file" << std::endl;
+	for(int jamp = 0; jamp < namp && jamp < (int)chanAmps->size(); jamp++)
+	{
+	    map<string, int>::iterator nameItr = ampNameIds.find((*chanNames)[jamp]);
+	    if(nameItr == ampNameIds.end())
+	    {
+		nameItr = ampNameIds.insert(std::pair<string, int>((*chanNames)[jamp], preloadedTree.ampNames.size())).first;
+		preloadedTree.ampNames.push_back((*chanNames)[jamp]);
+	    }
+	    preloadedTree.ampNameIds.push_back(nameItr->second);
+	    preloadedTree.ampValues.push_back((*chanAmps)[jamp]);
+	}
+	preloadedTree.ampOffsets[jevt+1] = preloadedTree.ampValues.size();
     }
 
+    // the tree is not read again
+    tree->ResetBranchAddresses();
+
+    cout << "     preloaded " << nentries << " entries of zip" << detNum 
+	 << " (" << blockSize*sizeof(float)/(1024*1024) << " MB of traces)" << endl;
+}
+
+
+int SimulationPulseLibraryManager::getLibraryFileNum(string filename)
+{
+    map<string, int>::const_iterator fileItr = libraryFileNums.find(filename);
+
     // check that we actually found the filename
-    if(filename != ss.str())
+    if(fileItr == libraryFileNums.end())
     {
 	std::cout << "SimulationPulseLibraryManager::readEvent: ERROR! The file selected to read from was never initialized." << std::endl;
 	exit(EXIT_FAILURE);
     }
 
-    // get a random event index (uniform)
-    int nentries = treeVector[jfile][detNum-1]->GetEntries();
+    return fileItr->second;
+}
+
 
-    // actually get the event if this tree has nonzero entries
-    if(nentries > 0){
-      jevt = jevt % nentries;
-      treeVector[jfile][detNum-1]->GetEntry(jevt);
-    }else
+int SimulationPulseLibraryManager::checkEntries(int fileNum, int detNum)
+{
+    // check that some files have been initialized
+    if(libraryFiles.size() == 0)
+    {
+	std::cout << "SimulationPulseLibraryManager::readEvent: ERROR! You are trying to read an event but no files have been declared." << std::endl;
+	exit(EXIT_FAILURE);
+    }
+
+    if(fileNum < 0 || fileNum >= (int)treeVector.size() || detNum < 1 || 
+       detNum > (int)treeVector[fileNum].size() || !treeVector[fileNum][detNum-1])
+    {
+	std::cout << "SimulationPulseLibraryManager::readEvent: ERROR! No library tree for zip" << detNum
+		  << " in library file number " << fileNum << std::endl;
+	exit(EXIT_FAILURE);
+    }
+
+    int nentries = preloaded ? preloadedTrees[fileNum][detNum-1].nEntries : treeVector[fileNum][detNum-1]->GetEntries();
+    if(nentries <= 0)
     {   
 	std::cout <<"SimulationPulseLibraryManager::readEvent: ERROR! Requested tree has no entries."<< std::endl;
 	std::exit(EXIT_FAILURE);
     }
 
-    // fill the amp map
+    return nentries;
+}
+
+
+void SimulationPulseLibraryManager::readEvent(int jevt, int detNum, string filename)
+{
+    readEvent(jevt, detNum, getLibraryFileNum(filename));
+}
+
+
+void SimulationPulseLibraryManager::readEvent(int jevt, int detNum, int fileNum)
+{
+    int nentries = checkEntries(fileNum, detNum);
+    jevt = jevt % nentries;
+
     ampMap.clear();
+
+    if(preloaded)
+    {
+	const PreloadedTree& preloadedTree = preloadedTrees[fileNum][detNum-1];
+	map<string, vector<double> >& traceBuffers = preloadedTraceBuffers[detNum];
+
+	int nchan = preloadedTree.traceNames.size();
+	for(int jchan = 0; jchan < nchan; jchan++)
+	{
+	    int traceLength = preloadedTree.traceLengths[jchan];
+	    const float* src = preloadedTree.traces.data() + preloadedTree.traceOffsets[jchan] + (size_t)jevt*traceLength;
+	    traceBuffers[preloadedTree.traceNames[jchan]].assign(src, src + traceLength);
+	}
+
+	eventNum = preloadedTree.eventNums[jevt];
+	seriesNum = preloadedTree.seriesNums[jevt];
+	DMCXPosition = preloadedTree.xPositions[jevt];
+	DMCYPosition = preloadedTree.yPositions[jevt];
+	DMCZPosition = preloadedTree.zPositions[jevt];
+	DMCRecoilEnergy = preloadedTree.recoilEnergies[jevt];
+
+	for(int jamp = preloadedTree.ampOffsets[jevt]; jamp < preloadedTree.ampOffsets[jevt+1]; jamp++)
+	    ampMap[preloadedTree.ampNames[preloadedTree.ampNameIds[jamp]]] = preloadedTree.ampValues[jamp];
+
+	return;
+    }
+
+    // actually get the event
+    treeVector[fileNum][detNum-1]->GetEntry(jevt);
+
+    // fill the amp map
     int nchan = chanNames->size();
     
     // check that vectors are the same size
@@ -219,49 +374,19 @@ void SimulationPulseLibraryManager::readEvent(int jevt, int detNum, string filen
 }
 
 
-void SimulationPulseLibraryManager::readRandomEvent(int detNum, string filename)
+void SimulationPulseLibraryManager::readRandomEvent(int detNum, string filename, CounterRNG& rng)
 {
-    // check that some files have been initialized
-    if(libraryFiles.size() == 0)
-    {
-	std::cout << "SimulationPulseLibraryManager::readEvent: ERROR! You are trying to read an event but no files have been declared." << std::endl;
-        exit(EXIT_FAILURE);
-    }
-
-    // loop over files to figure out which corresponds to the specified filename
-    int nfiles = libraryFiles.size();
-    int jfile = 0;
-    ss.str(libraryFiles[jfile]->GetName());
-    while(jfile < nfiles && filename != ss.str())
-    {
-	jfile++;
-	ss.str(libraryFiles[jfile]->GetName());
-    }
-
-    // check that we actually found the filename
-    if(filename != ss.str())
-    {
-	std::cout << "SimulationPulseLibraryManager::readEvent: ERROR! The file selected to read from was never initialized." << std::endl;
-        exit(EXIT_FAILURE);
-    }
-    
-    // get a random event index (uniform)
-    int nentries = treeVector[jfile][detNum-1]->GetEntries();
+    readRandomEvent(detNum, getLibraryFileNum(filename), rng);
+}
 
-    if(nentries > 0)
-    {
-       int eventToPull = rand() % nentries;
 
-       // get the event
-       readEvent(eventToPull, detNum, filename);
+void SimulationPulseLibraryManager::readRandomEvent(int detNum, int fileNum, CounterRNG& rng)
+{
+    // get a random event index (uniform), independent of the global rand() state
+    int nentries = checkEntries(fileNum, detNum);
+    int eventToPull = rng.Integer(nentries);
 
-       
-    }
-    else
-    {
-	std::cout <<"SimulationPulseLibraryManager::readRandomEvent: ERROR! Requested tree has no entries."<< std::endl;
-	std::exit(EXIT_FAILURE);
-    }
+    readEvent(eventToPull, detNum, fileNum);
 }
 
 
@@ -8,6 +8,11 @@
 // File Import By: A. Anderson
 // Creation Date: 6 October 2013
 //
+// With preloading on (setLibraryFile(..., true)) every library tree is read once into
+// a contiguous in-memory block (float traces, channel-major, plus the per-entry
+// amplitudes and DMC metadata) and readEvent only copies one entry out of it.
+// Library files can be addressed by their integer index (order given to setLibraryFile).
+//
 ////////////////////////////////////////////////////////////////////////////////////                                                                                        
 
 #ifndef SIMULATIONPULSELIBRARYMANAGER_H
@@ -16,6 +21,8 @@
 #include <TFile.h>
 #include <TTree.h>
 
+#include "CounterRNG.h"
+
 #include <string>
 #include <sstream>
 #include <vector>
@@ -29,10 +36,13 @@ public:
     SimulationPulseLibraryManager();
     ~SimulationPulseLibraryManager();
 
-    void setLibraryFile(vector<string> filename, map<int, int> detectorMap);
+    void setLibraryFile(vector<string> filename, map<int, int> detectorMap, bool preload = false);
     int getLibraryFileNum(string filename);
     void readEvent(int jevt, int detNum, string filename);
-    void readRandomEvent(int detNum, string filename);
+    void readEvent(int jevt, int detNum, int fileNum);
+    // reproducible draws, see CounterRNG
+    void readRandomEvent(int detNum, string filename, CounterRNG& rng);
+    void readRandomEvent(int detNum, int fileNum, CounterRNG& rng);
     map<string, vector<double>* > getPulseMap(int detNum);
     map<string, double> getChanAmps();
     double getEventNum();
@@ -43,6 +53,29 @@ public:
     double getDMCRecoilEnergy();
     
 private:
+    // one library tree held in memory
+    struct PreloadedTree {
+	int nEntries;
+	vector<string> traceNames;
+	vector<int> traceLengths;
+	vector<size_t> traceOffsets;      // start of each channel block in traces
+	vector<float> traces;             // [channel][entry][bin]
+	vector<double> eventNums, seriesNums;
+	vector<double> xPositions, yPositions, zPositions, recoilEnergies;
+	vector<int> ampOffsets;           // nEntries+1 offsets into ampNameIds/ampValues
+	vector<int> ampNameIds;           // index into ampNames
+	vector<double> ampValues;
+	vector<string> ampNames;
+    };
+
+    void preloadTree(int jfile, int detNum);
+    int checkEntries(int fileNum, int detNum);
+
+    bool preloaded;
+    map<string, int> libraryFileNums;
+    vector<vector<PreloadedTree> > preloadedTrees;      // same indexing as treeVector
+    map<int, map<string, vector<double> > > preloadedTraceBuffers; // (detnum, (chanName, trace)) handed out by getPulseMap
+
     map<string, double> fEvRQList;
     vector<TFile*> libraryFiles;
     vector<vector<TTree*> > treeVector;     // vector of vectors for trees => outer vector has 1 entry per input file
@@ -54,7 +87,6 @@ private:
     double seriesNum;
     double DMCXPosition, DMCYPosition, DMCZPosition;
     double DMCRecoilEnergy;
-    stringstream ss;
 };
 
 #endif
@@ -390,6 +390,18 @@ double UserDataManager::GetRelativeCalibration(int detNum, int detType,
   
   // get channel index
   uint index = ChannelMapHelper::GetChannelIndexBySide(detType, chanName);
+
+  return GetRelativeCalibrationByIndex(detNum, index);
+}
+
+
+// same, by channel number (per pulse, no channel name lookup)
+double UserDataManager::GetRelativeCalibration(int detNum, int detType, int channelNum) const {
+  return GetRelativeCalibrationByIndex(detNum, ChannelMapHelper::GetChannelIndexBySide(detType, channelNum));
+}
+
+
+double UserDataManager::GetRelativeCalibrationByIndex(int detNum, uint index) const {
   
   // get calibration vector
   vector<double> vect = ListManager::GetParameter(fZipMapOfMapVectDouble.find(detNum)->second,"P_RELATIVE_CALIBRATION");
@@ -465,6 +477,18 @@ double UserDataManager::GetQCalibration(int detNum, int detType,
   
   // get channel index
   uint index = ChannelMapHelper::GetChannelIndexBySide(detType, chanName);
+
+  return GetQCalibrationByIndex(detNum, index);
+}
+
+
+// same, by channel number (per pulse, no channel name lookup)
+double UserDataManager::GetQCalibration(int detNum, int detType, int channelNum) const {
+  return GetQCalibrationByIndex(detNum, ChannelMapHelper::GetChannelIndexBySide(detType, channelNum));
+}
+
+
+double UserDataManager::GetQCalibrationByIndex(int detNum, uint index) const {
   
   // get calibration vector
   vector<double> vect = ListManager::GetParameter(fZipMapOfMapVectDouble.find(detNum)->second,"Q_CALIBRATION_OF");
@@ -534,22 +558,43 @@ bool UserDataManager::UseChannelNoiseSelection(int detNum, int detType,
 
 
 {
- // return true by default
-  bool useChannel = true; 
-    
   // get channel index
   string channelName = channel;
   uint index = ChannelMapHelper::GetChannelIndexBySide(detType, channelName);
+
+  return UseChannelNoiseSelectionByIndex(detNum, channelName[0], index);
+}
+
+
+// same, by channel number (per pulse, no channel name lookup)
+bool UserDataManager::UseChannelNoiseSelection(int detNum, int detType, int channelNum) const
+{
+  if(!ChannelMapHelper::HasChannelTable(detType))
+     return UseChannelNoiseSelection(detNum, detType, ChannelMapHelper::GetChannelName(detType, channelNum));
+
+  uint index = ChannelMapHelper::GetChannelIndexBySide(detType, channelNum);
+  const ChannelInfo& info = ChannelMapHelper::GetChannelInfo(detType, channelNum);
+  char sensor = (info.isPhonon ? 'P' : (info.isCharge ? 'Q' : ' '));
+
+  return UseChannelNoiseSelectionByIndex(detNum, sensor, index);
+}
+
+
+// sensor is the first character of the channel name
+bool UserDataManager::UseChannelNoiseSelectionByIndex(int detNum, char sensor, uint index) const
+{
+ // return true by default
+  bool useChannel = true; 
   
   // get map
-   map<string,vector<int> > zipMap =  fZipMapOfMapVectInt.find(detNum)->second;
+   const map<string,vector<int> >& zipMap =  fZipMapOfMapVectInt.find(detNum)->second;
 
   //  phonon
   string keyName;
 
-  if(channelName[0] == 'P')
+  if(sensor == 'P')
       keyName = "P_CHAN_NOISE_SELECT";
-  else if (channelName[0] == 'Q')
+  else if (sensor == 'Q')
       keyName = "Q_CHAN_NOISE_SELECT";
   else
       return useChannel;
@@ -100,6 +100,7 @@ public:
   
   // relative phonon calibration  for sum of pulses
   double GetRelativeCalibration(int detNum, int detType, const string& channel) const;
+  double GetRelativeCalibration(int detNum, int detType, int channelNum) const;
 
   // Overall phonon calibration (might be multiple parameters in case of dependence with temperature)
   // varName = "psumOF" or "ptNF" or "ptOF"
@@ -109,11 +110,13 @@ public:
   // get calibrations from cdmsbats config file
   double GetOverallPTCalibrationTI(int detNum, int detType) const;
   double GetQCalibration(int detNum, int detType, const string& channel) const;
+  double GetQCalibration(int detNum, int detType, int channelNum) const;
 
 
 
   //  flag to use channel for event selection (through PT, QT), return true by default
   bool UseChannelNoiseSelection(int detNum, int detType, const string& channel) const;
+  bool UseChannelNoiseSelection(int detNum, int detType, int channelNum) const;
 
   // Detector status, channel can be also LEDs
   int GetDetectorStatus(int detNum, const string& channel, const string&  inputSeries);
@@ -231,6 +234,11 @@ public:
   list<int> ReadDetectorList(string detector,int lineNumber);
   string trim(string str);
   vector<string> Tokenize(string aStr);
+
+  // per-channel parameters by channel index (GetChannelIndexBySide)
+  double GetRelativeCalibrationByIndex(int detNum, uint index) const;
+  double GetQCalibrationByIndex(int detNum, uint index) const;
+  bool UseChannelNoiseSelectionByIndex(int detNum, char sensor, uint index) const;
   
   // data container
   map<string,string>  fMapString;
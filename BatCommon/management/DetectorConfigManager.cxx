@@ -62,8 +62,9 @@ DetectorConfigManager::DetectorConfigManager(UserDataManager& myUserData, string
    // register with RawDataReader so that detector config will be read
    rawReader.RegisterDetectorConfigData(&fDetectorConfigData);
 
-   // open the raw data file
+   // open the raw data file (only the header is read, no decompression ahead)
 
+   rawReader.SetReadAhead(0, 0);
    rawReader.OpenRawDataFile(fUserData.GetPath("RAW_DATA"), inputRawDataFile);
    
    // reads the file header AND the detector configuration 
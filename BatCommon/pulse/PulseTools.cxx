@@ -11,17 +11,44 @@
 //
 //Modifications:
 //  N. Mast, Nov 14, 2017:  Add sloped baseline subtraction function: SlopedBaselineSub
+//  Oct. 2026:  Add batched RealToComplexFFT, one FFTW plan per trace length
+//  Oct. 2026:  FFT plans made and deleted under a lock, so the FFTs can be called from threads
 //////////////////////////////////////////////////////////////////////// 
 ///////////////////////////////
 #include <iomanip>
+#include <pthread.h>
 
-#include "TRandom3.h"
 #include "TFile.h"
 
 #include "PulseTools.h"
+#include "ProcessingTimer.h"
  
 using namespace std;
 
+namespace {
+
+   //FFTW planning and the current transform of TVirtualFFT (which the next FFT() call reuses or
+   //deletes) are not thread-safe: plans are made and deleted under this lock and detached from
+   //TVirtualFFT, the transforms themselves run without it
+   pthread_mutex_t gFFTPlanLock = PTHREAD_MUTEX_INITIALIZER;
+
+   TVirtualFFT* NewFFTPlan(int& n, const char* option)
+   {
+      pthread_mutex_lock(&gFFTPlanLock);
+      TVirtualFFT* fft = TVirtualFFT::FFT(1, &n, option);
+      TVirtualFFT::SetTransform(NULL);
+      pthread_mutex_unlock(&gFFTPlanLock);
+      return fft;
+   }
+
+   void DeleteFFTPlan(TVirtualFFT* fft)
+   {
+      pthread_mutex_lock(&gFFTPlanLock);
+      delete fft;
+      pthread_mutex_unlock(&gFFTPlanLock);
+   }
+}
+
 //======================================================================================
 
 bool PulseTools::IsSaturated(const vector<double> &pulsevector,double satvalue)
@@ -909,6 +936,8 @@ double PulseTools::PipeFitterWalk(const vector<double> &pulsevector,double testv
 //using darkpipe symmetric convention for normalization
 void PulseTools::RealToComplexFFT(const vector<double>& pulsevector, vector<TComplex>& outComp)
 {
+    PROCESSING_TIMER("RealToComplexFFT", 0);
+
     int n = pulsevector.size();
     if(n == 0)
     {
@@ -925,7 +954,7 @@ void PulseTools::RealToComplexFFT(const vector<double>& pulsevector, vector<TCom
       pvector[i] = pulsevector[i];  
    }
 
-   TVirtualFFT *fftr2c = TVirtualFFT::FFT(1,&n,"R2C ES");
+   TVirtualFFT *fftr2c = NewFFTPlan(n,"R2C ES");
    fftr2c->SetPoints(pvector);
    fftr2c->Transform();
    fftr2c->GetPointComplex(0,re,im);
@@ -941,16 +970,72 @@ void PulseTools::RealToComplexFFT(const vector<double>& pulsevector, vector<TCom
 
    //done! so delete new'd objects
    delete[] pvector;
-   delete fftr2c;
+   DeleteFFTPlan(fftr2c);
 
    return;
 
 }
 
+//============================================================================================
+//batched version: the plan (the expensive part for our trace lengths) and the input buffer
+//are made once per trace length instead of once per pulse
+void PulseTools::RealToComplexFFT(const vector<const vector<double>*>& pulsevectors, vector< vector<TComplex> >& outComps)
+{
+    PROCESSING_TIMER("RealToComplexFFTBatch", 0);
+
+    outComps.assign(pulsevectors.size(), vector<TComplex>());
+
+    //pulse indices by length
+    map<int, vector<int> > pulsesByLength;
+    for(uint pulseItr = 0; pulseItr < pulsevectors.size(); pulseItr++)
+    {
+      int n = pulsevectors[pulseItr]->size();
+      if(n == 0)
+      {
+        cerr <<"PulseTools::RealToComplexFFT - ERROR! empty pulse passed into this function" << endl;
+        exit(1);
+      }
+      pulsesByLength[n].push_back(pulseItr);
+    }
+
+    map<int, vector<int> >::const_iterator lengthItr;
+    for(lengthItr = pulsesByLength.begin(); lengthItr != pulsesByLength.end(); ++lengthItr)
+    {
+      int n = lengthItr->first;
+      double sqrtN = sqrt((double)n);
+      double re,im;
+
+      TVirtualFFT *fftr2c = NewFFTPlan(n,"R2C ES");
+
+      const vector<int>& pulseIndices = lengthItr->second;
+      for(uint idxItr = 0; idxItr < pulseIndices.size(); idxItr++)
+      {
+        const vector<double>& pulsevector = *pulsevectors[pulseIndices[idxItr]];
+        vector<TComplex>& outComp = outComps[pulseIndices[idxItr]];
+
+        fftr2c->SetPoints(&pulsevector[0]);
+        fftr2c->Transform();
+
+        outComp.reserve(n);
+        for(int i=0; i<n; i++)
+        {
+          fftr2c->GetPointComplex(i,re,im);
+          outComp.push_back(TComplex(re/sqrtN, im/sqrtN));
+        }
+      }
+
+      DeleteFFTPlan(fftr2c);
+    }
+
+    return;
+}
+
 //============================================================================================
 
 void PulseTools::ComplexToRealIFFT(const vector<TComplex>& inComp, vector<double>& outRe)
 {
+    PROCESSING_TIMER("ComplexToRealIFFT", 0);
+
     int n = inComp.size(); 
     if(n == 0)
     {
@@ -970,7 +1055,7 @@ void PulseTools::ComplexToRealIFFT(const vector<TComplex>& inComp, vector<double
        im_pvector[i] = inComp[i].Im();  
     }
    
-    TVirtualFFT *ifftc2r = TVirtualFFT::FFT(1,&n,"C2R ES"); //this should be the opposite of FFT
+    TVirtualFFT *ifftc2r = NewFFTPlan(n,"C2R ES"); //this should be the opposite of FFT
     ifftc2r->SetPointsComplex(re_pvector, im_pvector);
     ifftc2r->Transform();
     ifftc2r->GetPointComplex(0,re,im);
@@ -984,7 +1069,7 @@ void PulseTools::ComplexToRealIFFT(const vector<TComplex>& inComp, vector<double
 
    delete[] re_pvector;
    delete[] im_pvector;
-   delete ifftc2r;
+   DeleteFFTPlan(ifftc2r);
 
    return;
 }
@@ -1609,9 +1694,16 @@ vector<double> PulseTools::ConstructFakePulse(double norm, double delay, const v
 
 vector<double> PulseTools::ConstructPositionDependentFakePulse(double norm, double delay, const vector<double>& aNoisePulse,
 							       const vector<double>& aPulseTemplate, int seed)
+{
+  CounterRNG rng = CounterRNG::FromSeed(seed, CounterRNG::kPositionDependence);
+  return ConstructPositionDependentFakePulse(norm, delay, aNoisePulse, aPulseTemplate, rng);
+}
+
+vector<double> PulseTools::ConstructPositionDependentFakePulse(double norm, double delay, const vector<double>& aNoisePulse,
+							       const vector<double>& aPulseTemplate, CounterRNG& rng)
 {
   //add position dependence to the pulse template
-  vector<double> positionDependentTemplate = AddPositionDependence(aPulseTemplate, seed);
+  vector<double> positionDependentTemplate = AddPositionDependence(aPulseTemplate, rng);
 
   //create fake pulse
   return (ConstructFakePulse(norm, delay, aNoisePulse, positionDependentTemplate));
@@ -1625,15 +1717,21 @@ vector<double> PulseTools::ConstructPositionDependentFakePulse(double norm, doub
 //Parameters are determined empiraclly (somewhat AD HOC model), seems to match ok though
 //This routine assumes the pulse template is normalized to 1
 //Note that the random number generator gives the same sequence of values for the same seed
+//(or the same CounterRNG key)
 vector<double> PulseTools::AddPositionDependence(const vector<double>& aPulseTemplate, int seed)
+{
+  CounterRNG rng = CounterRNG::FromSeed(seed, CounterRNG::kPositionDependence);
+  return AddPositionDependence(aPulseTemplate, rng);
+}
+
+vector<double> PulseTools::AddPositionDependence(const vector<double>& aPulseTemplate, CounterRNG& rng)
 {
 
   vector<double> aPositionDependentPulse;
   aPositionDependentPulse = aPulseTemplate;
 
   //Choose a random amplitude for the position dependence
-  TRandom3 rand(seed);
-  double relativeAmp = rand.Uniform(-1, 1);
+  double relativeAmp = rng.Uniform(-1, 1);
   double fractionalAmp = relativeAmp*0.15; 
 
   //define the position dependence template
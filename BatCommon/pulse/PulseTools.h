@@ -16,6 +16,7 @@
 //                       vector multiplcations with no sum, and pulse
 //                       scaling
 //  N. Mast, Nov 14, 2017:  Add sloped baseline subtraction function: SlopedBaselineSub
+//  Oct. 2026:  Add batched RealToComplexFFT, one FFTW plan per trace length
 //////////////////////////////////////////////////////////////////////// 
 ///////////////////////////////
 
@@ -35,6 +36,8 @@
 #include "TGraph.h"
 #include "TGraphErrors.h"
 
+#include "CounterRNG.h"
+
 
 using namespace std;
 typedef unsigned int uint;
@@ -146,6 +149,10 @@ namespace PulseTools
 
   void RealToComplexFFT(const vector<double>& pulsevector, vector<TComplex>& outComp);
 
+  //same as above for several pulses (e.g. all channels of a detector): pulses of the same
+  //length share one FFTW plan; outComps[i] is the FFT of *pulsevectors[i]
+  void RealToComplexFFT(const vector<const vector<double>*>& pulsevectors, vector< vector<TComplex> >& outComps);
+
   void ComplexToRealIFFT(const vector<TComplex>& inComp, vector<double>& outRe);
 
   void Time2PSD(const vector<double>& pulseVector, const double& fs, vector<double>& outPSD); 
@@ -187,8 +194,13 @@ namespace PulseTools
 						     const vector<double>& aNoisePulse,
 						     const vector<double>& aPulseTemplate,
 						     int seed); // recommended for study of phonon fitters
+  vector<double> ConstructPositionDependentFakePulse(double norm, double delay, 
+						     const vector<double>& aNoisePulse,
+						     const vector<double>& aPulseTemplate,
+						     CounterRNG& rng); // draws keyed by event (parallel safe)
   
   vector<double> AddPositionDependence(const vector<double>& aPulseTemplate, int seed); //mostly just supporting routine
+  vector<double> AddPositionDependence(const vector<double>& aPulseTemplate, CounterRNG& rng);
 
 };
 
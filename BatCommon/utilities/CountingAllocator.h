@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Description:  Replacement of the global operator new/delete which counts the heap allocations with
+//ProcessingTimer::CountAllocation (a no-op unless the counting is enabled).
+//
+//The replacement functions are defined here, not declared: include this file in exactly one source
+//file of an executable, the one with main().  It cannot go into a library, since an archive member
+//which defines nothing else would not be linked.
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COUNTINGALLOCATOR_H
+#define COUNTINGALLOCATOR_H
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+#include "ProcessingTimer.h"
+
+
+void* operator new(std::size_t size)
+{
+   ProcessingTimer::CountAllocation();
+   void* ptr = malloc(size == 0 ? 1 : size);
+   if(ptr == NULL) throw std::bad_alloc();
+   return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+   return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+   free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+   free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+   free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+   free(ptr);
+}
+
+#endif
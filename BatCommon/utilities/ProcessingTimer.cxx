@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: ProcessingTimer
+//Description:  Low-overhead instrumentation of the processing chain (see header file)
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ProcessingTimer.h"
+
+#include <time.h>
+#include <pthread.h>
+
+
+bool     ProcessingTimer::fEnabled       = false;
+bool     ProcessingTimer::fCountAllocations = false;
+int      ProcessingTimer::fSampleEvery   = 0;
+bool     ProcessingTimer::fSamplingEvent = false;
+uint64_t ProcessingTimer::fEventCtr      = 0;
+uint64_t ProcessingTimer::fFirstEventNs  = 0;
+uint64_t ProcessingTimer::fLastEventNs   = 0;
+volatile uint64_t ProcessingTimer::fNAllocations = 0;
+
+
+namespace {
+
+   //name registries and the list of per-thread tables are shared, hence the lock;
+   //the tables themselves are only written by their own thread
+   pthread_mutex_t gRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+
+   vector<string>& StageNames()
+   {
+      static vector<string> stageNames;
+      return stageNames;
+   }
+
+   vector<string>& CounterNames()
+   {
+      static vector<string> counterNames;
+      return counterNames;
+   }
+
+   int FindOrAdd(vector<string>& names, const string& name)
+   {
+      pthread_mutex_lock(&gRegistryLock);
+      int nameId = -1;
+      for(uint nameItr = 0; nameItr < names.size(); nameItr++)
+	 if(names[nameItr] == name) { nameId = nameItr; break; }
+      if(nameId < 0)
+      {
+	 names.push_back(name);
+	 nameId = names.size()-1;
+      }
+      pthread_mutex_unlock(&gRegistryLock);
+      return nameId;
+   }
+
+}
+
+
+// ================  Scope  ==============================
+
+ProcessingTimer::Scope::Scope(int stageId, int detNum) :
+   fStageId(stageId),
+   fDetNum(detNum),
+   fStartNs(0)
+{
+   if(fEnabled) fStartNs = NowNs();
+}
+
+ProcessingTimer::Scope::~Scope()
+{
+   if(!fEnabled || fStartNs == 0) return;
+
+   uint64_t elapsedNs = NowNs() - fStartNs;
+
+   ThreadTable& table = GetThreadTable();
+   StageStat& stat = table.stageStats[make_pair(fStageId, fDetNum)];
+   stat.nCalls++;
+   stat.totalNs += elapsedNs;
+   if(elapsedNs > stat.maxNs) stat.maxNs = elapsedNs;
+
+   if(fSamplingEvent)
+   {
+      EventSample sample;
+      sample.eventCtr = fEventCtr;
+      sample.stageId = fStageId;
+      sample.detNum = fDetNum;
+      sample.sec = elapsedNs*1.e-9;
+      table.samples.push_back(sample);
+   }
+}
+
+
+// ================  Registration / counters ==============================
+
+uint64_t ProcessingTimer::NowNs()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+int ProcessingTimer::GetStageId(const string& stageName)
+{
+   return FindOrAdd(StageNames(), stageName);
+}
+
+int ProcessingTimer::GetCounterId(const string& counterName)
+{
+   return FindOrAdd(CounterNames(), counterName);
+}
+
+string ProcessingTimer::GetStageName(int stageId)
+{
+   pthread_mutex_lock(&gRegistryLock);
+   string stageName = (stageId >= 0 && stageId < (int)StageNames().size()) ? StageNames()[stageId] : "unknown";
+   pthread_mutex_unlock(&gRegistryLock);
+   return stageName;
+}
+
+void ProcessingTimer::AddCount(int counterId, double value)
+{
+   if(!fEnabled) return;
+   GetThreadTable().counters[counterId] += value;
+}
+
+vector<ProcessingTimer::ThreadTable*>& ProcessingTimer::AllThreadTables()
+{
+   static vector<ThreadTable*> allTables;
+   return allTables;
+}
+
+ProcessingTimer::ThreadTable& ProcessingTimer::GetThreadTable()
+{
+   static __thread ThreadTable* threadTable = NULL;
+
+   if(threadTable == NULL)
+   {
+      threadTable = new ThreadTable;
+      pthread_mutex_lock(&gRegistryLock);
+      AllThreadTables().push_back(threadTable);
+      pthread_mutex_unlock(&gRegistryLock);
+   }
+
+   return *threadTable;
+}
+
+
+// ================  Events ==============================
+
+void ProcessingTimer::BeginEvent()
+{
+   if(!fEnabled) return;
+
+   if(fFirstEventNs == 0) fFirstEventNs = NowNs();
+   fSamplingEvent = (fSampleEvery > 0 && fEventCtr % fSampleEvery == 0);
+}
+
+void ProcessingTimer::EndEvent()
+{
+   if(!fEnabled) return;
+
+   fEventCtr++;
+   fLastEventNs = NowNs();
+   fSamplingEvent = false;
+}
+
+double ProcessingTimer::GetElapsedSec()
+{
+   if(fFirstEventNs == 0 || fLastEventNs < fFirstEventNs) return 0.;
+   return (fLastEventNs - fFirstEventNs)*1.e-9;
+}
+
+uint64_t ProcessingTimer::GetNEvents()
+{
+   return fEventCtr;
+}
+
+
+// ================  Summary (call once the worker threads are done) ==============================
+
+vector<ProcessingTimer::StageSummary> ProcessingTimer::GetSummary()
+{
+   map<pair<int,int>, StageStat> merged;
+
+   pthread_mutex_lock(&gRegistryLock);
+   vector<ThreadTable*> tables = AllThreadTables();
+   pthread_mutex_unlock(&gRegistryLock);
+
+   for(uint tableItr = 0; tableItr < tables.size(); tableItr++)
+   {
+      map<pair<int,int>, StageStat>::const_iterator statItr = tables[tableItr]->stageStats.begin();
+      for( ; statItr != tables[tableItr]->stageStats.end(); statItr++)
+      {
+	 StageStat& stat = merged[statItr->first];
+	 stat.nCalls += statItr->second.nCalls;
+	 stat.totalNs += statItr->second.totalNs;
+	 if(statItr->second.maxNs > stat.maxNs) stat.maxNs = statItr->second.maxNs;
+      }
+   }
+
+   vector<StageSummary> summaryList;
+   map<pair<int,int>, StageStat>::const_iterator statItr = merged.begin();
+   for( ; statItr != merged.end(); statItr++)
+   {
+      StageSummary summary;
+      summary.stageName = GetStageName(statItr->first.first);
+      summary.detNum = statItr->first.second;
+      summary.nCalls = statItr->second.nCalls;
+      summary.totalSec = statItr->second.totalNs*1.e-9;
+      summary.maxSec = statItr->second.maxNs*1.e-9;
+      summaryList.push_back(summary);
+   }
+
+   return summaryList;
+}
+
+map<string, double> ProcessingTimer::GetCounters()
+{
+   map<string, double> counters;
+
+   pthread_mutex_lock(&gRegistryLock);
+   vector<ThreadTable*> tables = AllThreadTables();
+   vector<string> counterNames = CounterNames();
+   pthread_mutex_unlock(&gRegistryLock);
+
+   for(uint tableItr = 0; tableItr < tables.size(); tableItr++)
+   {
+      map<int, double>::const_iterator countItr = tables[tableItr]->counters.begin();
+      for( ; countItr != tables[tableItr]->counters.end(); countItr++)
+	 counters[counterNames[countItr->first]] += countItr->second;
+   }
+
+   counters["Allocations"] = fNAllocations;
+
+   return counters;
+}
+
+vector<ProcessingTimer::EventSample> ProcessingTimer::GetEventSamples()
+{
+   vector<EventSample> samples;
+
+   pthread_mutex_lock(&gRegistryLock);
+   vector<ThreadTable*> tables = AllThreadTables();
+   pthread_mutex_unlock(&gRegistryLock);
+
+   for(uint tableItr = 0; tableItr < tables.size(); tableItr++)
+      samples.insert(samples.end(), tables[tableItr]->samples.begin(), tables[tableItr]->samples.end());
+
+   return samples;
+}
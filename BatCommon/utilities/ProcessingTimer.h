@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: ProcessingTimer
+//Description:  Low-overhead instrumentation of the processing chain. Code sections are timed with
+//a Scope object (monotonic clock, accumulated per thread without locking) keyed by stage name and
+//detector number; counters (bytes decompressed, events, ...) are accumulated the same way.
+//Heap allocations are counted if the executable includes CountingAllocator.h.
+//Everything is a no-op until SetEnabled(true). GetSummary merges the per-thread tables, and the
+//optional per-event sampling keeps the individual timings of every Nth event.
+//
+//All member functions are static so that this class does not need to be initialized.
+//
+//Usage:
+//   PROCESSING_TIMER("DoOptimalFilterPhonon", detNum);   //times the enclosing block
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROCESSINGTIMER_H
+#define PROCESSINGTIMER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+
+class ProcessingTimer
+{
+   public:
+
+      //one line of the summary
+      struct StageSummary {
+	 string   stageName;
+	 int      detNum;       //0 if not detector specific
+	 uint64_t nCalls;
+	 double   totalSec;
+	 double   maxSec;
+      };
+
+      //timing of one stage in a sampled event
+      struct EventSample {
+	 uint64_t eventCtr;
+	 int      stageId;
+	 int      detNum;
+	 double   sec;
+      };
+
+      //times a block: clock read in constructor and destructor only if enabled
+      class Scope {
+	 public:
+	    Scope(int stageId, int detNum = 0);
+	    ~Scope();
+	 private:
+	    int      fStageId;
+	    int      fDetNum;
+	    uint64_t fStartNs;
+      };
+
+      static void SetEnabled(bool enabled) { fEnabled = fCountAllocations = enabled; }
+      static bool IsEnabled() { return fEnabled; }
+      static void SetSampleEvery(int nEvents) { fSampleEvery = nEvents; } //0 = no per-event sampling
+
+      //names are registered once (call sites keep the id in a static)
+      static int    GetStageId(const string& stageName);
+      static int    GetCounterId(const string& counterName);
+      static string GetStageName(int stageId);
+
+      static void AddCount(int counterId, double value);
+
+      //heap allocation counter, safe to call from operator new (never allocates);
+      //SetCountAllocations counts them without the timing, e.g. around single calls
+      static void CountAllocation() { if(fCountAllocations) __sync_fetch_and_add(&fNAllocations, 1); }
+      static void SetCountAllocations(bool count) { fCountAllocations = count; }
+      static uint64_t GetNAllocations() { return fNAllocations; }
+
+      //event boundaries, used for the event rate and the sampling
+      static void BeginEvent();
+      static void EndEvent();
+
+      //merged over threads
+      static vector<StageSummary> GetSummary();
+      static map<string, double>  GetCounters();      //includes "Allocations"
+      static vector<EventSample>  GetEventSamples();
+      static double               GetElapsedSec();   //since first BeginEvent
+      static uint64_t             GetNEvents();
+
+      static uint64_t NowNs();
+
+   private:
+
+      struct StageStat {
+	 uint64_t nCalls;
+	 uint64_t totalNs;
+	 uint64_t maxNs;
+      };
+
+      struct ThreadTable {
+	 map<pair<int,int>, StageStat> stageStats;   //(stageId, detNum)
+	 map<int, double>              counters;
+	 vector<EventSample>           samples;
+      };
+
+      static ThreadTable& GetThreadTable();
+      static vector<ThreadTable*>& AllThreadTables(); //kept after their threads exit
+
+      static bool     fEnabled;
+      static bool     fCountAllocations;
+      static int      fSampleEvery;
+      static bool     fSamplingEvent;
+      static uint64_t fEventCtr;
+      static uint64_t fFirstEventNs;
+      static uint64_t fLastEventNs;
+      static volatile uint64_t fNAllocations;
+};
+
+
+#define PROCESSING_TIMER(stageName, detNum) \
+   static const int processingTimerStageId = ProcessingTimer::GetStageId(stageName); \
+   ProcessingTimer::Scope processingTimerScope(processingTimerStageId, detNum)
+
+
+#endif /* PROCESSINGTIMER_H */
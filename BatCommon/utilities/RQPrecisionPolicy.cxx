@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RQPrecisionPolicy
+//Description:  Storage type of every RQ in the output trees (see header file).
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <fnmatch.h>
+#include <unistd.h>
+
+#include "RQPrecisionPolicy.h"
+
+using namespace std;
+
+// ======================================================================
+
+const char* RQPrecision::GetTypeName(Type type)
+{
+   switch(type)
+   {
+      case kDouble:    return "double";
+      case kFloat:     return "float";
+      case kInt32:     return "int32";
+      case kInt64:     return "int64";
+      case kUInt64:    return "uint64";
+      case kTruncated: return "trunc";
+      case kRange:     return "range";
+   }
+   return "";
+}
+
+string RQPrecision::GetLeafType() const
+{
+   ostringstream leafType;
+   switch(type)
+   {
+      case kDouble:    leafType << "D"; break;
+      case kFloat:     leafType << "F"; break;
+      case kInt32:     leafType << "I"; break;
+      case kInt64:     leafType << "L"; break;
+      case kUInt64:    leafType << "l"; break;
+      case kTruncated: leafType << "d[0,0," << nBits << "]"; break;
+      case kRange:     leafType << setprecision(17) << "d[" << min << "," << max << "," << nBits << "]"; break;
+   }
+   return leafType.str();
+}
+
+size_t RQPrecision::GetSize() const
+{
+   switch(type)
+   {
+      case kFloat:  return sizeof(Float_t);
+      case kInt32:  return sizeof(Int_t);
+      case kInt64:  return sizeof(Long64_t);
+      case kUInt64: return sizeof(ULong64_t);
+      default:      return sizeof(Double_t);  //Double32_t is a double in memory
+   }
+}
+
+void RQPrecision::Convert(double value, void* destination) const
+{
+   switch(type)
+   {
+      case kDouble:
+      case kTruncated:
+	 *(Double_t*)destination = value;
+	 break;
+
+      case kFloat:
+	 *(Float_t*)destination = value;
+	 break;
+
+      case kInt32:
+	 if(!(value > INT_MIN)) value = INT_MIN;   //also NaN
+	 if(value > INT_MAX) value = INT_MAX;
+	 *(Int_t*)destination = (Int_t)floor(value + 0.5);
+	 break;
+
+      case kInt64:
+	 if(!(value > -9.2e18)) value = -9.2e18;
+	 if(value > 9.2e18) value = 9.2e18;
+	 *(Long64_t*)destination = (Long64_t)floor(value + 0.5);
+	 break;
+
+      case kUInt64:
+	 if(!(value > 0.)) value = 0.;
+	 if(value > 1.8e19) value = 1.8e19;
+	 *(ULong64_t*)destination = (ULong64_t)floor(value + 0.5);
+	 break;
+
+      case kRange:
+	 if(!(value > min)) value = min;
+	 if(value > max) value = max;
+	 *(Double_t*)destination = value;
+	 break;
+   }
+}
+
+// ======================================================================
+
+void RQPrecisionPolicy::ReadFile(const string& fileName)
+{
+   fFileName = fileName;
+   if(fileName.find('/') == string::npos)
+   {
+      string procDir = (getenv("BATROOT_PROC") ? getenv("BATROOT_PROC") : "");
+      string defaultDir = string(getenv("CDMSBATSDIR") ? getenv("CDMSBATSDIR") : ".")
+	 + "/UserSettings/BatRootSettings/processing";
+      if(!procDir.empty() && access((procDir + "/" + fileName).c_str(), R_OK) == 0)
+	 fFileName = procDir + "/" + fileName;
+      else
+	 fFileName = defaultDir + "/" + fileName;
+   }
+
+   ifstream file(fFileName.c_str());
+   if(!file)
+   {
+      cerr <<"RQPrecisionPolicy: ERROR cannot open precision file " << fFileName << endl;
+      exit(1);
+   }
+
+   string line;
+   int lineNumber = 0;
+   while(getline(file, line))
+   {
+      lineNumber++;
+      size_t comment = line.find('#');
+      if(comment != string::npos) line.erase(comment);
+
+      stringstream lineStream(line);
+      string pattern, typeName;
+      if(!(lineStream >> pattern)) continue;
+      lineStream >> typeName;
+
+      RQPrecision precision;
+      bool good = true;
+      if(typeName == "double") precision.type = RQPrecision::kDouble;
+      else if(typeName == "float") precision.type = RQPrecision::kFloat;
+      else if(typeName == "int32") precision.type = RQPrecision::kInt32;
+      else if(typeName == "int64") precision.type = RQPrecision::kInt64;
+      else if(typeName == "uint64") precision.type = RQPrecision::kUInt64;
+      else if(typeName == "trunc")
+      {
+	 precision.type = RQPrecision::kTruncated;
+	 good = (lineStream >> precision.nBits) && precision.nBits >= 2 && precision.nBits <= 14;
+      }
+      else if(typeName == "range")
+      {
+	 precision.type = RQPrecision::kRange;
+	 good = (lineStream >> precision.min >> precision.max >> precision.nBits) &&
+	    precision.max > precision.min && precision.nBits >= 2 && precision.nBits <= 32;
+      }
+      else good = false;
+
+      string extra;
+      if(!good || (lineStream >> extra))
+      {
+	 cerr <<"RQPrecisionPolicy: ERROR " << fFileName << ":" << lineNumber << ": expected <tree/RQ pattern> "
+	      <<"double|float|int32|int64|uint64, trunc <2-14 bits> or range <min> <max> <2-32 bits>" << endl;
+	 exit(1);
+      }
+      fRules.push_back(make_pair(pattern, precision));
+   }
+}
+
+RQPrecision RQPrecisionPolicy::GetPrecision(const string& treeName, const string& rqName) const
+{
+   RQPrecision precision;
+   string name = treeName + "/" + rqName;
+   for(uint ruleItr = 0; ruleItr < fRules.size(); ruleItr++)
+      if(fnmatch(fRules[ruleItr].first.c_str(), name.c_str(), 0) == 0)
+	 precision = fRules[ruleItr].second;
+   return precision;
+}
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RQPrecisionPolicy
+//Description:  Storage type of every RQ in the output trees.  The RQs are computed as doubles; the
+//policy maps "<tree>/<RQ>" patterns (shell wildcards, last matching line wins) to the type they are
+//written with, e.g. int32 for flags, float for most physical quantities, or a Double32_t with a
+//truncated mantissa or a declared range.  RQs matching no line stay double.
+//
+//Policy file lines:
+//   <tree/RQ pattern>  double | float | int32 | int64 | uint64
+//   <tree/RQ pattern>  trunc <mantissa bits 2-14>          Double32_t [0,0,nbits]
+//   <tree/RQ pattern>  range <min> <max> <bits 2-32>       Double32_t [min,max,nbits]
+//
+//Integers are rounded to the nearest value (NaN to the lowest one), uint64 stores negative
+//values (e.g. the -999999 default) as 0, and range clamps to [min,max] (non-finite values to
+//min), as ROOT does.
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RQPRECISIONPOLICY_H
+#define RQPRECISIONPOLICY_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "Rtypes.h"
+
+using namespace std;
+
+//!Output type of one RQ
+struct RQPrecision
+{
+   enum Type { kDouble, kFloat, kInt32, kInt64, kUInt64, kTruncated, kRange };
+
+   Type   type;
+   int    nBits;   //mantissa bits (kTruncated) or bits of the range (kRange)
+   double min;
+   double max;
+
+   RQPrecision() : type(kDouble), nBits(0), min(0.), max(0.) {}
+
+   //TTree leaf type after the "/", e.g. "F" or "d[0,100,16]"
+   string GetLeafType() const;
+
+   //size of the value in memory
+   size_t GetSize() const;
+
+   //writes value in this type to destination (GetSize() bytes)
+   void Convert(double value, void* destination) const;
+
+   static const char* GetTypeName(Type type);
+};
+
+//!Memory for one converted RQ value, large enough for every RQPrecision type
+union RQValue
+{
+   Double_t  d;
+   Float_t   f;
+   Int_t     i;
+   Long64_t  L;
+   ULong64_t l;
+};
+
+//!Maps RQ names to their output type
+class RQPrecisionPolicy
+{
+   public:
+
+      RQPrecisionPolicy() {}
+
+      //a name without "/" is looked up in $BATROOT_PROC, then
+      //$CDMSBATSDIR/UserSettings/BatRootSettings/processing; exits on errors
+      void ReadFile(const string& fileName);
+
+      //last matching line, double if none
+      RQPrecision GetPrecision(const string& treeName, const string& rqName) const;
+
+      bool IsEmpty() const { return fRules.empty(); }
+      const string& GetFileName() const { return fFileName; }
+
+   private:
+
+      vector< pair<string, RQPrecision> > fRules;
+      string fFileName;
+};
+
+#endif /* RQPRECISIONPOLICY_H */
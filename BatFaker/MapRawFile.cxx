@@ -85,9 +85,9 @@ int main(int argc, const char** argv)
 	      recordID == BatRootTypes::kPulseRecordExpandedCodeID){
 	//read the detector code from the pulse header
 	static int detcodeword=4;
-	gzseek(reader.GetRawDataPtr(), detcodeword*sizeof(uint32_t), SEEK_CUR);
-	gzread(reader.GetRawDataPtr(),(char*)(&detectorcode),
-	       sizeof(detectorcode));
+	reader.GetRawDataPtr().Seek(detcodeword*sizeof(uint32_t), SEEK_CUR);
+	reader.GetRawDataPtr().Read((char*)(&detectorcode),
+				    sizeof(detectorcode));
 	//this is ignorning endianness conversion!!	
       }
       
@@ -77,8 +77,11 @@ PulseData RawDataSeeker::LoadPulse(const std::string& series, long event,
     RawDataBlock recordblock = SeekToRecord(series, event, 
 					    0, detectorcode);
     if(recordblock.eventid > 0){
-      tempPulseData.ReadRawPulseRecord(_fin, recordblock.length, 
-				       recordblock.recordtype, false);
+      //random access, so read the record itself rather than through a RawDataStream
+      std::vector<uint32_t> record(recordblock.length/sizeof(uint32_t) + 1);
+      if(gzread(_fin, &record[0], recordblock.length) == recordblock.length)
+	tempPulseData.ReadRawPulseBuffer(&record[0], recordblock.length,
+					 recordblock.recordtype, false);
     }
   }
   //not sure what this will look like on error...
@@ -0,0 +1,660 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Merges BatRoot / BatCalib output files (dumps of a series, or
+//             merged series into a supermerge) into one file. The per-event
+//             trees of the first input (rqDir, rrqDir) are concatenated over
+//             all inputs, in input order; the other trees (infoDir,
+//             detectorConfigDir, ...) are copied from the first input only, as
+//             merge_all.C did, unless --concat is given. Trees whose
+//             branches and leaf types are the same in every input are fast
+//             cloned, i.e. the compressed baskets are copied without
+//             decompressing them; the others are copied entry by entry.
+//             The trees are spread over forked worker processes, which merge
+//             into part files that are fast cloned into the output. Before
+//             merging, the per-event trees (rqDir, rrqDir) of every input must
+//             have the same number of entries; after merging, every merged tree
+//             must have the sum of the entries of the inputs. The output gets a
+//             mergeIndexTree with the entry range of every source dump.
+//             With --baskets the trees are copied entry by entry into few
+//             large baskets, as the monobasket / polybasket modes of
+//             merge_filelist.C did. Replaces merge_all.C / merge_filelist.C.
+//
+//Usage: ./BatMerge [options] output.root input1.root [input2.root ...]
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <limits>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+
+//ROOT Libraries
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TClass.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include "TError.h"
+
+//CDMS Libraries
+#include "CommandLineHelper.h"
+
+using namespace std;
+
+
+namespace {
+
+   const char* kIndexTreeName = "mergeIndexTree";
+
+   //largest basket --baskets asks for, ROOT's buffers are limited to 2 GB
+   const Long64_t kMaxBasketSize = 1 << 30;
+
+   //one tree of the first input, merged over all inputs by one worker
+   struct TreeTask {
+      string           dir;         //path in the file, "" at the top
+      string           name;
+      bool             perEvent;    //rqDir, rrqDir: one entry per event
+      bool             firstOnly;   //not per event: copied from the first input (unless --concat)
+      bool             fast;        //same branches and leaf types in every input
+      vector<Long64_t> entries;     //per input, only the first one if firstOnly
+      Long64_t         zipBytes;
+      string           note;        //why it is not fast cloned
+
+      string GetPath() const { return (dir.empty() ? name : dir + "/" + name); }
+   };
+
+   //one source dump of the merged file
+   struct IndexEntry {
+      string   fileName;
+      string   series;
+      Int_t    dump;
+      Long64_t firstEntry;
+      Long64_t nEntries;
+   };
+
+   double NowSec()
+   {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec*1.e-9;
+   }
+
+   string BaseName(const string& path)
+   {
+      size_t slash = path.find_last_of('/');
+      return (slash == string::npos ? path : path.substr(slash+1));
+   }
+
+   //<prefix>_<series>_F<dump>.root as written by BatRoot and BatCalib; dump -1 otherwise
+   void ParseFileName(const string& fileName, string& series, Int_t& dump)
+   {
+      series = "";
+      dump = -1;
+      string name = BaseName(fileName);
+      size_t dumpPos = name.rfind("_F");
+      if(dumpPos == string::npos) return;
+      dump = atoi(name.c_str() + dumpPos + 2);
+      size_t seriesPos = name.rfind('_', dumpPos - 1);
+      series = name.substr(seriesPos == string::npos ? 0 : seriesPos + 1,
+			   dumpPos - (seriesPos == string::npos ? 0 : seriesPos + 1));
+   }
+
+   TFile* OpenInput(const string& fileName)
+   {
+      TFile* file = TFile::Open(fileName.c_str(), "READ");
+      if(!file || file->IsZombie())
+      {
+	 cerr <<"BatMerge: ERROR cannot open " << fileName << endl;
+	 exit(1);
+      }
+      return file;
+   }
+
+   vector<string> ReadFileList(const string& listName)
+   {
+      vector<string> fileNames;
+      ifstream list(listName.c_str());
+      if(!list)
+      {
+	 cerr <<"BatMerge: ERROR cannot open file list " << listName << endl;
+	 exit(1);
+      }
+      string line;
+      while(getline(list, line))
+      {
+	 size_t comment = line.find('#');
+	 if(comment != string::npos) line.erase(comment);
+	 stringstream lineStream(line);
+	 string fileName;
+	 if(lineStream >> fileName) fileNames.push_back(fileName);
+      }
+      return fileNames;
+   }
+
+   //branch and leaf names and types, equal for trees that can be fast cloned into each other
+   string GetSchema(TTree* tree)
+   {
+      ostringstream schema;
+      TObjArray* leaves = tree->GetListOfLeaves();
+      for(int leafItr = 0; leafItr < leaves->GetEntriesFast(); leafItr++)
+      {
+	 TLeaf* leaf = (TLeaf*)leaves->At(leafItr);
+	 schema << leaf->GetBranch()->GetName() << "/" << leaf->GetName() << ":" << leaf->GetTypeName()
+		<< "[" << leaf->GetLenStatic() << "];";
+      }
+      return schema.str();
+   }
+
+   //the trees and directories of the first input
+   void ScanDirectory(TDirectory* dir, const string& path, bool concat, vector<TreeTask>& tasks,
+		      vector< pair<string,string> >& dirs)
+   {
+      set<string> seen;   //older cycles have the same name
+      TIter next(dir->GetListOfKeys());
+      TKey* key;
+      while((key = (TKey*)next()))
+      {
+	 string name = key->GetName();
+	 if(!seen.insert(name).second) continue;
+
+	 string subPath = (path.empty() ? name : path + "/" + name);
+	 TClass* keyClass = TClass::GetClass(key->GetClassName());
+	 if(keyClass && keyClass->InheritsFrom("TDirectory"))
+	 {
+	    dirs.push_back(make_pair(subPath, string(key->GetTitle())));
+	    ScanDirectory(dir->GetDirectory(name.c_str()), subPath, concat, tasks, dirs);
+	 }
+	 else if(keyClass && keyClass->InheritsFrom("TTree"))
+	 {
+	    if(path.empty() && name == kIndexTreeName) continue;   //rebuilt from the inputs' indices
+	    TreeTask task;
+	    task.dir = path;
+	    task.name = name;
+	    string topDir = path.substr(0, path.find('/'));
+	    task.perEvent = (topDir == "rqDir" || topDir == "rrqDir");
+	    task.firstOnly = (!task.perEvent && !concat);
+	    task.fast = true;
+	    task.zipBytes = 0;
+	    tasks.push_back(task);
+	 }
+	 else
+	    cout <<"BatMerge: skipping " << subPath << " (" << key->GetClassName() << ")" << endl;
+      }
+   }
+
+   //entries, sizes and schemas of the trees in every input
+   void ScanInputs(const vector<string>& inputs, bool concat, vector<TreeTask>& tasks,
+		   vector< pair<string,string> >& dirs)
+   {
+      vector<string> schemas;
+      for(uint fileItr = 0; fileItr < inputs.size(); fileItr++)
+      {
+	 TFile* file = OpenInput(inputs[fileItr]);
+	 if(fileItr == 0)
+	 {
+	    ScanDirectory(file, "", concat, tasks, dirs);
+	    schemas.resize(tasks.size());
+	 }
+
+	 for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+	 {
+	    TreeTask& task = tasks[taskItr];
+	    if(task.firstOnly && fileItr > 0) continue;
+
+	    TTree* tree = dynamic_cast<TTree*>(file->Get(task.GetPath().c_str()));
+	    if(!tree)
+	    {
+	       cerr <<"BatMerge: ERROR " << inputs[fileItr] << " has no tree " << task.GetPath() << endl;
+	       exit(1);
+	    }
+	    task.entries.push_back(tree->GetEntries());
+	    task.zipBytes += tree->GetZipBytes();
+
+	    string schema = GetSchema(tree);
+	    if(fileItr == 0)
+	       schemas[taskItr] = schema;
+	    else if(task.fast && schema != schemas[taskItr])
+	    {
+	       task.fast = false;
+	       task.note = "branches differ in " + inputs[fileItr];
+	    }
+	    delete tree;
+	 }
+	 delete file;
+      }
+   }
+
+   //every per-event tree of a dump has one entry per event
+   bool CheckPerEventEntries(const vector<string>& inputs, const vector<TreeTask>& tasks)
+   {
+      bool good = true;
+      for(uint fileItr = 0; fileItr < inputs.size(); fileItr++)
+      {
+	 int reference = -1;
+	 for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+	 {
+	    if(!tasks[taskItr].perEvent) continue;
+	    if(reference < 0) { reference = taskItr; continue; }
+	    if(tasks[taskItr].entries[fileItr] != tasks[reference].entries[fileItr])
+	    {
+	       cerr <<"BatMerge: ERROR " << inputs[fileItr] << ": " << tasks[taskItr].GetPath() << " has "
+		    << tasks[taskItr].entries[fileItr] << " entries, " << tasks[reference].GetPath() << " "
+		    << tasks[reference].entries[fileItr] << endl;
+	       good = false;
+	    }
+	 }
+      }
+      return good;
+   }
+
+   void MakeDirectories(TFile* file, const vector< pair<string,string> >& dirs)
+   {
+      for(uint dirItr = 0; dirItr < dirs.size(); dirItr++)
+      {
+	 const string& path = dirs[dirItr].first;
+	 size_t slash = path.find_last_of('/');
+	 TDirectory* parent = (slash == string::npos ? file : file->GetDirectory(path.substr(0, slash).c_str()));
+	 parent->mkdir(path.substr(slash == string::npos ? 0 : slash+1).c_str(), dirs[dirItr].second.c_str());
+      }
+   }
+
+   //basket size of every branch for --baskets, in bytes: "mono" is one basket per branch for
+   //the merged series (9 bytes per entry), "poly" a few baskets for supermerges (9/11 bytes
+   //per entry), as in merge_filelist.C; 0 keeps the sizes of the first input
+   Int_t GetBasketSize(const TreeTask& task, const string& baskets)
+   {
+      Long64_t nEntries = 0;
+      for(uint fileItr = 0; fileItr < task.entries.size(); fileItr++)
+	 nEntries += task.entries[fileItr];
+
+      Long64_t basketSize = 0;
+      if(baskets == "mono")
+	 basketSize = nEntries*9;
+      else if(baskets == "poly")
+	 basketSize = Long64_t(nEntries*(9.0/11.0));
+      return Int_t(min(basketSize, kMaxBasketSize));
+   }
+
+   //concatenates one tree of all inputs into outFile, or copies the one of the first input
+   void MergeTree(const TreeTask& task, const vector<string>& inputs, TFile* outFile, bool recompress,
+		  const string& baskets)
+   {
+      TDirectory* outDir = (task.dir.empty() ? (TDirectory*)outFile : outFile->GetDirectory(task.dir.c_str()));
+      const char* option = (task.fast && !recompress ? "fast SortBasketsByBranch" : "");
+      Int_t basketSize = GetBasketSize(task, baskets);
+
+      TTree* outTree = 0;
+      uint nInputs = (task.firstOnly ? 1 : inputs.size());
+      for(uint fileItr = 0; fileItr < nInputs; fileItr++)
+      {
+	 TFile* file = OpenInput(inputs[fileItr]);
+	 TTree* tree = (TTree*)file->Get(task.GetPath().c_str());
+
+	 if(outTree == 0)
+	 {
+	    //structure (and with fast, the baskets) of the first input
+	    outDir->cd();
+	    outTree = tree->CloneTree(task.fast && !recompress ? -1 : 0, option);
+	    if(!outTree)
+	    {
+	       cerr <<"BatMerge: ERROR cannot clone " << task.GetPath() << " of " << inputs[fileItr] << endl;
+	       exit(1);
+	    }
+	    outTree->SetDirectory(outDir);
+	    if(basketSize > 0)
+	    {
+	       //the defaults, in case the input was written with other (optimized) settings
+	       outTree->SetAutoFlush(-30000000);
+	       outTree->SetAutoSave(300000000);
+	       outTree->SetBasketSize("*", basketSize);
+	    }
+	 }
+
+	 if(fileItr > 0 || !task.fast || recompress)
+	 {
+	    outTree->CopyAddresses(tree);
+	    if(tree->GetEntries() > 0 && outTree->CopyEntries(tree, -1, option) <= 0)
+	    {
+	       cerr <<"BatMerge: ERROR cannot copy the entries of " << task.GetPath() << " of "
+		    << inputs[fileItr] << endl;
+	       exit(1);
+	    }
+	    outTree->CopyAddresses(tree, kTRUE);
+	 }
+	 delete file;   //disconnects the clone from the input
+      }
+
+      outDir->cd();
+      outTree->Write("", TObject::kOverwrite);
+      delete outTree;
+   }
+
+   //the tasks go to the worker with the fewest compressed bytes so far, largest first
+   vector<int> AssignWorkers(const vector<TreeTask>& tasks, int nWorkers)
+   {
+      multimap<Long64_t, int> bySize;
+      for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+	 bySize.insert(make_pair(-tasks[taskItr].zipBytes, (int)taskItr));
+
+      vector<int> workerOfTask(tasks.size(), 0);
+      vector<Long64_t> load(nWorkers, 0);
+      for(multimap<Long64_t, int>::const_iterator itr = bySize.begin(); itr != bySize.end(); ++itr)
+      {
+	 int worker = min_element(load.begin(), load.end()) - load.begin();
+	 workerOfTask[itr->second] = worker;
+	 load[worker] -= itr->first;
+      }
+      return workerOfTask;
+   }
+
+   TFile* CreateOutput(const string& fileName, int compression, const vector< pair<string,string> >& dirs)
+   {
+      TFile* file = TFile::Open(fileName.c_str(), "RECREATE");
+      if(!file || file->IsZombie())
+      {
+	 cerr <<"BatMerge: ERROR cannot create " << fileName << endl;
+	 exit(1);
+      }
+      file->SetCompressionSettings(compression);
+      MakeDirectories(file, dirs);
+      return file;
+   }
+
+   //entry ranges of the source dumps; a merged input contributes the dumps of its own index
+   vector<IndexEntry> BuildIndex(const vector<string>& inputs, const vector<TreeTask>& tasks)
+   {
+      int reference = -1;
+      for(uint taskItr = 0; taskItr < tasks.size() && reference < 0; taskItr++)
+	 if(tasks[taskItr].perEvent) reference = taskItr;
+
+      vector<IndexEntry> index;
+      Long64_t firstEntry = 0;
+      for(uint fileItr = 0; fileItr < inputs.size(); fileItr++)
+      {
+	 Long64_t nEntries = (reference >= 0 ? tasks[reference].entries[fileItr] : 0);
+
+	 TFile* file = OpenInput(inputs[fileItr]);
+	 TTree* inputIndex = dynamic_cast<TTree*>(file->Get(kIndexTreeName));
+	 if(inputIndex)
+	 {
+	    char fileName[4096], series[256];
+	    Int_t dump;
+	    Long64_t subFirst, subEntries;
+	    inputIndex->SetBranchAddress("FileName", fileName);
+	    inputIndex->SetBranchAddress("Series", series);
+	    inputIndex->SetBranchAddress("DumpNumber", &dump);
+	    inputIndex->SetBranchAddress("FirstEntry", &subFirst);
+	    inputIndex->SetBranchAddress("NEntries", &subEntries);
+	    for(Long64_t entry = 0; entry < inputIndex->GetEntries(); entry++)
+	    {
+	       inputIndex->GetEntry(entry);
+	       IndexEntry indexEntry = { fileName, series, dump, firstEntry + subFirst, subEntries };
+	       index.push_back(indexEntry);
+	    }
+	    delete inputIndex;
+	 }
+	 else
+	 {
+	    IndexEntry indexEntry;
+	    indexEntry.fileName = BaseName(inputs[fileItr]);
+	    ParseFileName(inputs[fileItr], indexEntry.series, indexEntry.dump);
+	    indexEntry.firstEntry = firstEntry;
+	    indexEntry.nEntries = nEntries;
+	    index.push_back(indexEntry);
+	 }
+	 delete file;
+	 firstEntry += nEntries;
+      }
+      return index;
+   }
+
+   void WriteIndex(TFile* outFile, const vector<IndexEntry>& index)
+   {
+      outFile->cd();
+      TTree* indexTree = new TTree(kIndexTreeName, "Entry range of every source dump in the per-event trees");
+      char fileName[4096], series[256];
+      Int_t dump;
+      Long64_t firstEntry, nEntries;
+      indexTree->Branch("FileName", fileName, "FileName/C");
+      indexTree->Branch("Series", series, "Series/C");
+      indexTree->Branch("DumpNumber", &dump, "DumpNumber/I");
+      indexTree->Branch("FirstEntry", &firstEntry, "FirstEntry/L");
+      indexTree->Branch("NEntries", &nEntries, "NEntries/L");
+      for(uint indexItr = 0; indexItr < index.size(); indexItr++)
+      {
+	 strncpy(fileName, index[indexItr].fileName.c_str(), sizeof(fileName)-1);
+	 fileName[sizeof(fileName)-1] = 0;
+	 strncpy(series, index[indexItr].series.c_str(), sizeof(series)-1);
+	 series[sizeof(series)-1] = 0;
+	 dump = index[indexItr].dump;
+	 firstEntry = index[indexItr].firstEntry;
+	 nEntries = index[indexItr].nEntries;
+	 indexTree->Fill();
+      }
+      indexTree->Write("", TObject::kOverwrite);
+      delete indexTree;
+   }
+
+   //every merged tree has the entries of all inputs (of the first for the first-only trees)
+   bool CheckOutputEntries(const string& outputName, const vector<TreeTask>& tasks)
+   {
+      bool good = true;
+      TFile* file = OpenInput(outputName);
+      for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+      {
+	 const TreeTask& task = tasks[taskItr];
+	 Long64_t expected = 0;
+	 for(uint fileItr = 0; fileItr < task.entries.size(); fileItr++)
+	    expected += task.entries[fileItr];
+
+	 TTree* tree = dynamic_cast<TTree*>(file->Get(task.GetPath().c_str()));
+	 Long64_t found = (tree ? tree->GetEntries() : -1);
+	 if(found != expected)
+	 {
+	    cerr <<"BatMerge: ERROR " << task.GetPath() << " has " << found << " entries, expected "
+		 << expected << " (expected - found = " << expected - found << ")" << endl;
+	    good = false;
+	 }
+	 delete tree;
+      }
+      delete file;
+      return good;
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   CommandLineHelper cmd("BatMerge [<options>] <output.root> [<input.root> ...]");
+   cmd.AddCommandSwitch('l',"list","File with the input files, one per line (in addition to the arguments)","file");
+   cmd.AddCommandSwitch('j',"jobs","Number of worker processes (default: number of cpus)","n");
+   cmd.AddCommandSwitch('z',"compression","ROOT compression settings of the output (default: as the first input)","n");
+   cmd.AddCommandSwitch('r',"recompress","Copy all trees entry by entry, recompressing the baskets");
+   cmd.AddCommandSwitch('f',"force","Merge even if the per-event trees of an input differ in length");
+   cmd.AddCommandSwitch('c',"concat","Concatenate all trees, not only the per-event ones in rqDir and rrqDir");
+   cmd.AddCommandSwitch('b',"baskets","Copy entry by entry into one basket per branch (mono) or a few (poly)","mono|poly");
+   if(cmd.ProcessCommandLine(argc, argv) < 1)
+      cmd.PrintSwitches();
+
+   string outputName = cmd.GetCommandArg(0);
+   vector<string> inputs;
+   if(cmd.GetNCallsToOption("list") > 0)
+      inputs = ReadFileList(cmd.GetArgumentCall("list"));
+   for(int argItr = 1; argItr < cmd.GetNCommandArgs(); argItr++)
+      inputs.push_back(cmd.GetCommandArg(argItr));
+   if(inputs.empty())
+   {
+      cerr <<"BatMerge: ERROR no input files" << endl;
+      exit(1);
+   }
+
+   int nWorkers = (cmd.GetNCallsToOption("jobs") > 0 ? atoi(cmd.GetArgumentCall("jobs")) : sysconf(_SC_NPROCESSORS_ONLN));
+   bool recompress = (cmd.GetNCallsToOption("recompress") > 0);
+   bool force = (cmd.GetNCallsToOption("force") > 0);
+   bool concat = (cmd.GetNCallsToOption("concat") > 0);
+   string baskets = (cmd.GetNCallsToOption("baskets") > 0 ? cmd.GetArgumentCall("baskets") : "");
+   if(nWorkers < 1) nWorkers = 1;
+   if(!baskets.empty() && baskets != "mono" && baskets != "poly")
+   {
+      cerr <<"BatMerge: ERROR --baskets must be mono or poly, not " << baskets << endl;
+      exit(1);
+   }
+   //fast cloning keeps the baskets of the inputs
+   if(!baskets.empty()) recompress = true;
+
+   //no splitting of large trees into several files
+   TTree::SetMaxTreeSize(numeric_limits<Long64_t>::max());
+   gErrorIgnoreLevel = kError;
+
+   double startSec = NowSec();
+   vector<TreeTask> tasks;
+   vector< pair<string,string> > dirs;
+   ScanInputs(inputs, concat, tasks, dirs);
+
+   if(!CheckPerEventEntries(inputs, tasks) && !force)
+   {
+      cerr <<"BatMerge: ERROR inputs with inconsistent per-event trees, nothing merged (use --force)" << endl;
+      exit(1);
+   }
+
+   int compression;
+   if(cmd.GetNCallsToOption("compression") > 0)
+      compression = atoi(cmd.GetArgumentCall("compression"));
+   else
+   {
+      TFile* first = OpenInput(inputs[0]);
+      compression = first->GetCompressionSettings();
+      delete first;
+   }
+
+   for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+      if(!tasks[taskItr].fast)
+	 cout <<"BatMerge: " << tasks[taskItr].GetPath() << " copied entry by entry, "
+	      << tasks[taskItr].note << endl;
+
+   if(nWorkers > (int)tasks.size()) nWorkers = max((int)tasks.size(), 1);
+
+   TFile* outFile;
+   if(nWorkers == 1)
+   {
+      outFile = CreateOutput(outputName, compression, dirs);
+      for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+	 MergeTree(tasks[taskItr], inputs, outFile, recompress, baskets);
+   }
+   else
+   {
+      //ROOT I/O is not thread safe per file: every worker is a process merging its trees
+      //into a part file, whose baskets are then copied into the output in the original order
+      vector<int> workerOfTask = AssignWorkers(tasks, nWorkers);
+      vector<string> partNames(nWorkers);
+      vector<pid_t> pids(nWorkers);
+      cout.flush();
+      for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+      {
+	 ostringstream partName;
+	 partName << outputName << ".part" << workerItr;
+	 partNames[workerItr] = partName.str();
+
+	 pids[workerItr] = fork();
+	 if(pids[workerItr] < 0)
+	 {
+	    cerr <<"BatMerge: ERROR could not fork worker " << workerItr << endl;
+	    exit(1);
+	 }
+	 if(pids[workerItr] == 0)
+	 {
+	    TFile* partFile = CreateOutput(partNames[workerItr], compression, dirs);
+	    for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+	       if(workerOfTask[taskItr] == workerItr)
+		  MergeTree(tasks[taskItr], inputs, partFile, recompress, baskets);
+	    partFile->Close();
+	    _exit(0);
+	 }
+      }
+
+      bool workersGood = true;
+      for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+      {
+	 int status = 0;
+	 if(waitpid(pids[workerItr], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	 {
+	    cerr <<"BatMerge: ERROR worker " << workerItr << " failed" << endl;
+	    workersGood = false;
+	 }
+      }
+      if(!workersGood)
+      {
+	 for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+	    unlink(partNames[workerItr].c_str());
+	 exit(1);
+      }
+
+      vector<TFile*> partFiles(nWorkers);
+      for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+	 partFiles[workerItr] = OpenInput(partNames[workerItr]);
+
+      outFile = CreateOutput(outputName, compression, dirs);
+      for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+      {
+	 const TreeTask& task = tasks[taskItr];
+	 TTree* partTree = (TTree*)partFiles[workerOfTask[taskItr]]->Get(task.GetPath().c_str());
+	 TDirectory* outDir = (task.dir.empty() ? (TDirectory*)outFile : outFile->GetDirectory(task.dir.c_str()));
+	 outDir->cd();
+	 TTree* outTree = partTree->CloneTree(-1, "fast SortBasketsByBranch");
+	 outTree->SetDirectory(outDir);
+	 outTree->Write("", TObject::kOverwrite);
+	 delete outTree;
+	 delete partTree;
+      }
+
+      for(int workerItr = 0; workerItr < nWorkers; workerItr++)
+      {
+	 delete partFiles[workerItr];
+	 unlink(partNames[workerItr].c_str());
+      }
+   }
+
+   vector<IndexEntry> index = BuildIndex(inputs, tasks);
+   WriteIndex(outFile, index);
+   outFile->Close();
+   delete outFile;
+
+   bool good = CheckOutputEntries(outputName, tasks);
+   double wallSec = NowSec() - startSec;
+
+   int nFast = 0;
+   for(uint taskItr = 0; taskItr < tasks.size(); taskItr++)
+      if(tasks[taskItr].fast && !recompress) nFast++;
+
+   struct stat outStat;
+   double outputMB = (stat(outputName.c_str(), &outStat) == 0 ? outStat.st_size/1.e6 : 0.);
+   Long64_t nEvents = (index.empty() ? 0 : index.back().firstEntry + index.back().nEntries);
+
+   cout <<"BatMerge: " << inputs.size() << " files, " << index.size() << " dumps, " << nEvents
+	<<" events, " << tasks.size() << " trees (" << nFast << " fast cloned) into " << outputName
+	<<" (" << fixed << setprecision(2) << outputMB << " MB, " << wallSec << " s, " << nWorkers
+	<<" workers)" << endl;
+
+   return (good ? 0 : 1);
+}
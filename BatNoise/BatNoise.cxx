@@ -9,12 +9,14 @@
 //Modifications:
 //
 //   20171229  N. Mast  --  Add baseline slope noise selection
+//   Oct. 2026  --  second pass runs the detectors of an event in NOISE_THREADS threads
+//   Oct. 2026  --  setup moved to BatNoiseSetup; NOISE_PARTIAL writes partial files for BatNoiseMerge
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //Standard Libaries
 #include <iostream>
-#include <sys/dir.h>
-#include <regex.h>
+#include <pthread.h>
+#include <unistd.h>
 
 //ROOT Libraries
 #include "TFile.h"
@@ -33,341 +35,212 @@
 #include "PulseData.h"
 #include "NoiseBuilder.h"
 #include "PulseTools.h"
+#include "BatNoiseSetup.h"
 
 using namespace std;
 
-/////////////////// BEGIN MAIN //////////////////////////////
-
-int main(int argc, char* argv[]){
-
-   //print versions explicitly, in lieu of a -V or --version option 
-   cout << "cdmsbats version: " << __CB_GIT_VERSION << endl;
-   cout << "BatCommon version: " << __BC_GIT_VERSION << endl;
 
-   // ===============
-   // assignments
-   // ===============
+namespace {
 
-   //reading inputs to main
-   if(argc < 3)  
+   //second pass for one detector: noise selection cuts, then the pulses that pass are added to the
+   //average PSD's.  Returns true if they passed (the traces are stored afterwards, see main)
+   bool SelectAndAddNoise(NoiseBuilder& noiseBuilder, UserDataManager& myUserData, int detNum, bool isTFData)
    {
-      cout <<"ERROR running BatNoise!"
-	   <<"\nThe command line is: /BatNoise series# dump# nevents#(optional) processingOptions(optional) analysisConfig(optional)"
-	   << endl;
-      exit(1);
-   }
+      noiseBuilder.CalcSumOfPulses(detNum); //sum all pulses (for each sensor type for minmax calculation)
 
-   string inputSeries = argv[1]; 
-   string dumpNum = argv[2]; 
+      // === noise selection cuts ===
 
-   //converting dumpNum to "F000#" format
-   int nZeros = 4 - dumpNum.length();
-   string dumpName("F");
-   for(int zCtr=0; zCtr < nZeros; zCtr++) dumpName += "0";
-   dumpName += dumpNum;
+      //skip all pulses in this event if its not a random trigger - don't apply this cut to TF data
+      if(!isTFData && !noiseBuilder.PassRandomTriggerCut()) { return false; }
 
-   // construct filename from series and dumpNum
-   string rawDataFilename = Form("%s_%s", inputSeries.c_str(), dumpName.c_str());
+      // Apply a saturation cut (in place of old "No Joerger's Railed" cut from DarkPipe)
+      if(!noiseBuilder.PassSaturationCut(detNum)) { return false; }
 
-   cout <<"RawDataFilename = " << rawDataFilename << endl;
-
-   //cdmsbats directory
-   string cdmsbatsdir =
-     getenv("CDMSBATSDIR") ? getenv("CDMSBATSDIR") : "./";
- 
-
-   //batroot directory
-   string batnoisedir = cdmsbatsdir + "/BatNoise";
-    
-   // processing/analysis root directory 
-   string batroot_settings = cdmsbatsdir + "/UserSettings/BatRootSettings";
-  
-
-   //processing files directory
-   string batroot_proc_default = batroot_settings + "/processing";
-   string batroot_proc =
-     getenv("BATROOT_PROC") ? getenv("BATROOT_PROC")
-     : batroot_proc_default;
-
-
-   //analysis files directory
-   string batroot_const_default = batroot_settings + "/analysis";
-   string batroot_const =
-     getenv("BATROOT_CONST") ? getenv("BATROOT_CONST")
-     : batroot_const_default;
-
-
-
-   //detector status files directory
-   string batroot_detstatus_default = batroot_settings + "/detector_status";
-   string batroot_detstatus =
-     getenv("BATROOT_DETSTATUS") ? getenv("BATROOT_DETSTATUS")
-     : batroot_detstatus_default;
+      // Apply MinMax cut
+      if(myUserData.GetIntParameter(detNum, "DO_MINMAX") && !noiseBuilder.PassMinMaxCut(detNum)) 
+	{ return false; }
 
+      // Apply Pileup cut
+      if(myUserData.GetIntParameter(detNum, "DO_PILEUP_CUT") && !noiseBuilder.PassPileupCut(detNum)) 
+	{ return false; }
 
+      // Apply OF chisq cut (phonon)
+      if(myUserData.GetIntParameter(detNum, "DO_PHONON_CHISQ_CUT") && !noiseBuilder.PassPOFchisqCut(detNum)) 
+	{ return false; }
 
+      // Apply PTBSslope cut
+      if( myUserData.HasIntParameter(detNum, "DO_PTBSslope_CUT") )
+      {
+	if(myUserData.GetIntParameter(detNum, "DO_PTBSslope_CUT") && !noiseBuilder.PassPTBSslopeCut(detNum)) 
+	  { return false; }
+      }
 
+      // ==== build average PSD ===
 
-   // ===============================================
-   // Read Configuration file and auxillary files
-   // ===============================================
-  
-   UserDataManager myUserData;
+      // if the event on this detector made it to here, add it to the average PSD
+      noiseBuilder.BuildAveragePSD(detNum); 
 
-   // -- analysis and processing configurations --
-   
-   // autodetect the location based on series number and then set the default configuration file
-   bool   isTFData = false;
-   
-   string defaultUserOptionsFile = "processingSoudanData.SuperCDMS";
-   string defaultAnalysisConfigFile = "configSoudanData.SuperCDMS";
-   string defaultDetectorStatusFile = "detectorStatus.SuperCDMS";
+      // calculate the average covariance (for special studies only) 
+      if( myUserData.DoAlgorithm(detNum, "charge", "ChargeNoiseCovariance") )
+	noiseBuilder.BuildQIQOCov(detNum);
 
-   int seriesLength = inputSeries.length(); //series length = 11 for old series format, 13 for new
-   int seriesCheck = ( seriesLength > 12 ? atoi(inputSeries.substr(0, (seriesLength-11)).c_str())*10 : 
-		       atoi(inputSeries.substr(0, (seriesLength-10)).c_str()) ); 
-   int seriesDateAndPrefix = atoi(inputSeries.substr(0, (seriesLength-5)).c_str());
+      return true;
+   }
 
-   switch (seriesCheck) 
+   //the detectors of an event only touch their own pulses and NoiseData, so they are shared out
+   //to the threads; each detector still adds its events in file order, which keeps the output
+   //identical to the serial loop.  The threads are started once for the second pass and wait
+   //for each event on the start condition
+   struct DetectorJob {
+      NoiseBuilder*     noiseBuilder;
+      UserDataManager*  userData;
+      bool              isTFData;
+      vector<int>       detNums;
+      vector<int>       passed;     //per entry of detNums
+      size_t            next;
+      int               generation; //events started so far
+      int               nBusy;      //threads not yet done with the current event
+      bool              stop;
+      vector<pthread_t> workers;    //none: the detectors are run in the calling thread
+      pthread_mutex_t   lock;
+      pthread_cond_t    start;
+      pthread_cond_t    done;
+   };
+
+   void* DetectorWorker(void* jobPtr)
    {
-      case 0:
-	 defaultUserOptionsFile = "processingSUFData.Default";
-	 defaultAnalysisConfigFile = "configSUFData.Default";
-	 break;
-	 
-      case 1: 
-	 defaultUserOptionsFile = "processingSoudanData.Default";
-	 defaultAnalysisConfigFile = "configSoudanData.c58";
-	 break;
+      DetectorJob& job = *static_cast<DetectorJob*>(jobPtr);
+      int generation = 0;
+      pthread_mutex_lock(&job.lock);
+      while(true)
+      {
+	 while(job.generation == generation && !job.stop)
+	    pthread_cond_wait(&job.start, &job.lock);
+	 if(job.stop) break;
+	 generation = job.generation;
 
-      case 10: 
+	 while(job.next < job.detNums.size())
 	 {
-	   if(seriesDateAndPrefix > 1111100)
-	   {
-	     defaultUserOptionsFile = "processingSoudanData.SuperCDMS.Default";
-	     defaultAnalysisConfigFile = "configSoudanData.SuperCDMS.Default";
-             defaultDetectorStatusFile = "detectorStatus.SuperCDMS";
-	   }
-	   else
-	   {
-	     if(seriesDateAndPrefix > 1101200)
-	     {
-	       defaultUserOptionsFile = "processingSoudanData.ITHybrid";
-	       defaultAnalysisConfigFile = "configSoudanData.ITHybrid";
-	     }
-	     else
-	     {
-	       defaultUserOptionsFile = "processingSoudanData.STHybrid";
-	       defaultAnalysisConfigFile = "configSoudanData.STHybrid";
-	     }
-	   }
+	    size_t detItr = job.next++;
+	    pthread_mutex_unlock(&job.lock);
+	    job.passed[detItr] = SelectAndAddNoise(*job.noiseBuilder, *job.userData, job.detNums[detItr], job.isTFData);
+	    pthread_mutex_lock(&job.lock);
 	 }
-	 break;
-	 
-      case 2: 
-	 defaultUserOptionsFile = "processingUCBData.Default";
-	 defaultAnalysisConfigFile = "configUCBData.Default";
-         isTFData = true;
-	 break;
-
-      case 3: 
-	 defaultUserOptionsFile = "processingCWRUData.Default";
-	 defaultAnalysisConfigFile = "configCWRUData.Default"; 
-         isTFData = true;
-	 break;
-
-      case 4:
-	 defaultUserOptionsFile = "processingUFData.Default";
-	 defaultAnalysisConfigFile = "configUFData.Default";
-         isTFData = true;
-	 break;
-	 
-      case 60:
-         defaultUserOptionsFile = "processingQueensData.Default";
-	 defaultAnalysisConfigFile = "configQueensData.Default";
-         isTFData = true;
-	 break;
-
-      case 70:
-	 defaultUserOptionsFile = "processingUMNData.iZIP100mm";
-	 defaultAnalysisConfigFile = "configUMNData.iZIP100mm";
-	 isTFData = true;
-	 break;
-
-      case 90:
-	 defaultUserOptionsFile = "processingSLACData.iZIP100mm.midas";
-	 defaultAnalysisConfigFile = "configSLACData.iZIP100mm.midas";
-         isTFData = true;
-	 break;
-	 
-      case 510:
-	 defaultUserOptionsFile = "processingDMC.iZIPDefault";
-	 defaultAnalysisConfigFile = "configDMC.iZIPDefault";
-	 break;
-
-      default:
-	 cout <<"BatNoise::main() ERROR! series prefix is unrecognized" << endl;
-	 exit(1);
+	 if(--job.nBusy == 0) pthread_cond_signal(&job.done);
+      }
+      pthread_mutex_unlock(&job.lock);
+      return NULL;
    }
 
-   // if desired, overwrite default processing options with fourth argument
-   string userOptionsFile = (argc > 4 ? argv[4] : defaultUserOptionsFile);
-   // now read the processing file
-   myUserData.ReadFile(batroot_proc + "/" + userOptionsFile); 
-
-   // if desired, overwrite default analysis config with fifth argument
-   string configFile = (argc > 5 ? argv[5] : defaultAnalysisConfigFile);
-   // now read the analysis configuration file
-   myUserData.ReadFile(batroot_const + "/" + configFile);
-
-   // set max events to process
-   int maxEventsDefault = myUserData.GetMaxEvents();
-   int maxEvents = (argc > 3 ? atoi(argv[3]) : maxEventsDefault);
-  
-   //
-   // ===== INFO file =====
-   //
-
-   InfoDataManager myInfoData;
-
-   string infoFile = myUserData.GetPath("AUX_FILES") + inputSeries + ".info"; 
-   
-   if (myUserData.DoRead("INFO_FILE")) 
-        myInfoData.ReadFile(infoFile);
-   else
-       cout <<"\nNOTE:  INFO is not being read.  Values will derive from either raw data or user settings file."<< endl;
-   
-
-   //
-   // ===== ISR file =====
-   //
+   void StartDetectorWorkers(DetectorJob& job, int nThreads)
+   {
+      job.next = 0;
+      job.generation = 0;
+      job.nBusy = 0;
+      job.stop = false;
+      pthread_mutex_init(&job.lock, NULL);
+      pthread_cond_init(&job.start, NULL);
+      pthread_cond_init(&job.done, NULL);
+
+      int nWorkers = (int)job.detNums.size() < nThreads ? job.detNums.size() : nThreads;
+      job.workers.resize(nWorkers > 1 ? nWorkers : 0);
+      for(uint workerItr = 0; workerItr < job.workers.size(); workerItr++)
+	 if(pthread_create(&job.workers[workerItr], NULL, DetectorWorker, &job) != 0)
+	 {
+	    cerr <<"BatNoise: ERROR cannot start the detector threads!" << endl;
+	    exit(1);
+	 }
+   }
 
-   IsrDataManager myIsrData(myUserData.GetMaxZIPs());
+   void RunDetectorJob(DetectorJob& job)
+   {
+      job.passed.assign(job.detNums.size(), 0);
+      if(job.workers.empty())
+      {
+	 for(uint detItr = 0; detItr < job.detNums.size(); detItr++)
+	    job.passed[detItr] = SelectAndAddNoise(*job.noiseBuilder, *job.userData, job.detNums[detItr], job.isTFData);
+	 return;
+      }
 
-   string isrFile = myUserData.GetPath("AUX_FILES") + inputSeries + ".isr"; 
-   if (myUserData.DoRead("ISR_FILE")) 
-          myIsrData.ReadFile(isrFile);
-    else
-       cout <<"\nNOTE:  ISR file is not being read. Values will derive from either raw data or user settings file." << endl;
-    
-   //=================================================
-   // Check the directory for the file and get the right extension [ANV] 
-   //=================================================
-   
-   //do some regex matching to parse out series and dump
-   regex_t regex;
-   string matchfile="("+rawDataFilename+")(\\.mid|\\.mid\\.gz|\\.gz)?$";
-   int reti = regcomp(&regex,matchfile.c_str(),REG_EXTENDED);
-
-   //browse the directory for the correct file
-   //so we can learn about the filenames in terms of extension [ANV]
-   cout << myUserData.GetPath("RAW_DATA") << endl;
-   DIR *dir;
-   struct dirent *ent;
-   string fullRawDataFilename="";
-   if ((dir = opendir (myUserData.GetPath("RAW_DATA").c_str())) != NULL) {
-     while ((ent = readdir (dir)) != NULL) {
-       string filename(ent->d_name);
-       regmatch_t matchptr[4];
-       reti = regexec(&regex,filename.c_str(),4,matchptr,0);
-       if(!reti){
-         fullRawDataFilename = filename;
-       }
-     }
-     closedir (dir);
-   }
-   else{
-     cerr << "BatNoise: ERROR! could not open raw directory" << endl;
-     exit(1); 
+      pthread_mutex_lock(&job.lock);
+      job.next = 0;
+      job.nBusy = job.workers.size();
+      job.generation++;
+      pthread_cond_broadcast(&job.start);
+      while(job.nBusy > 0)
+	 pthread_cond_wait(&job.done, &job.lock);
+      pthread_mutex_unlock(&job.lock);
    }
 
-   if(fullRawDataFilename==""){
-     cerr << "BatNoise: ERROR! requested raw file does not exist" << endl;
-     exit(1); 
+   void StopDetectorWorkers(DetectorJob& job)
+   {
+      pthread_mutex_lock(&job.lock);
+      job.stop = true;
+      pthread_cond_broadcast(&job.start);
+      pthread_mutex_unlock(&job.lock);
+      for(uint workerItr = 0; workerItr < job.workers.size(); workerItr++)
+	 pthread_join(job.workers[workerItr], NULL);
+      job.workers.clear();
+
+      pthread_cond_destroy(&job.done);
+      pthread_cond_destroy(&job.start);
+      pthread_mutex_destroy(&job.lock);
    }
+}
 
-   //=================================================
-   // Initialize DetectorConfigManager
-   //=================================================
-
-   // opens raw file and, if it exists, reads the detector config record
-   DetectorConfigManager detConfigManager(myUserData, fullRawDataFilename);
-   
-   // register external data classes if available
-   if( myUserData.DoRead("INFO_FILE") ) 
-     detConfigManager.RegisterInfo(myInfoData);
-   
-   if( myUserData.DoRead("ISR_FILE") ) 
-      detConfigManager.RegisterIsr(myIsrData);
-
+/////////////////// BEGIN MAIN //////////////////////////////
 
+int main(int argc, char* argv[]){
 
-   //=================================================
-   // Construct list of ZIP detectors 
-   //=================================================
+   //print versions explicitly, in lieu of a -V or --version option 
+   cout << "cdmsbats version: " << __CB_GIT_VERSION << endl;
+   cout << "BatCommon version: " << __BC_GIT_VERSION << endl;
 
-   // detectors to be processed:
-   //    detectors set by the DO_PROCESSING flag in configuration file
-   //            AND
-   //    available information in the ISR file (if file is read)
+   // ===============
+   // assignments
+   // ===============
 
+   //reading inputs to main
+   if(argc < 3)  
+   {
+      cout <<"ERROR running BatNoise!"
+	   <<"\nThe command line is: /BatNoise series# dump# nevents#(optional) processingOptions(optional) analysisConfig(optional)"
+	   << endl;
+      exit(1);
+   }
 
-   // get the detector map from the detector config manager
-   map<int, int> detectorMap = detConfigManager.GetDetectorMap();
+   string inputSeries = argv[1]; 
+   string dumpNum = argv[2]; 
 
 
-   // get the charge polarity type  map from the detector config manager
-   map<int, string> detectorChargePolarityMap = detConfigManager.GetDetectorChargePolarityMap();
+   // ===============================================
+   // Read Configuration file and auxillary files
+   // ===============================================
 
-   
-   //=================================================
-   // Detector status RQ (from UserSetting file)
-   //=================================================
-   
-   //  The detector status RQs depend only on the SeriesNumber so
-   //  calculation can be done outside the event loop.
-   //  However, the RQs will be stored event by event in ZIP
-   //  trees
+   // settings (processing options and analysis config from the fourth and fifth arguments if
+   // given), INFO/ISR files, detector configuration, detector status and pulse templates
+   BatNoiseSetup setup(inputSeries, dumpNum, (argc > 4 ? argv[4] : ""), (argc > 5 ? argv[5] : ""));
 
-   if (myUserData.DoRead("DET_STATUS_FILE")) {
+   UserDataManager& myUserData = setup.GetUserData();
+   map<int, int> detectorMap = setup.GetDetectorMap();
+   bool isTFData = setup.IsTFData();
 
-     // read detector status 
-     myUserData.ReadFile(batroot_detstatus + "/" + defaultDetectorStatusFile);
-   
-     // construct RQ list
-     myUserData.ConstructZipRQList(detectorMap);
-     
-     // Fill RQs 
-     myUserData.DoCalcDetectorStatus(inputSeries);
-
-
-     // Fill broken channel and charge side list
-     // (using RQs, which thus need to be calculated)
-     //
-     // Considered "broken"
-     //     Phonon: status = 2  (=> not included in pt)
-     //     charge: status>0    (=> single pulse fitting, no 2X2 or Z constraint)
-     //        (if either QI or QO broken: charge side = broken 
-    
-     myUserData.FillBrokenChannelLists();
+   // set max events to process
+   int maxEventsDefault = myUserData.GetMaxEvents();
+   int maxEvents = (argc > 3 ? atoi(argv[3]) : maxEventsDefault);
 
-      
+   // partial noise files of this dump, merged by BatNoiseMerge (0 = the noise file of this dump)
+   //    1: first pass only, the selection values and histograms -> <series>_F000#.selection.root
+   //    2: second pass with the cuts of <series>.cuts.root      -> <series>_F000#.noise.root
+   int noisePartial = 0;
+   if(myUserData.HasIntParameter("NOISE_PARTIAL"))
+      noisePartial = myUserData.GetIntParameter("NOISE_PARTIAL");
+   if(noisePartial < 0 || noisePartial > 2)
+   {
+      cerr <<"BatNoise: ERROR! NOISE_PARTIAL must be 0, 1 or 2" << endl;
+      exit(1);
    }
-
-
-   //=================================================
-   // Pulse Template
-   //=================================================
-   
-   string templateDir = 
-     getenv("BATNOISE_TEMPLATES") ? getenv("BATNOISE_TEMPLATES")
-     : "PulseTemplates";	// Under "cdmsbats"
-
-   // reads only if the detectors are configured 
-   //     AND 
-   // if CALC_PHONON_TEMPLATE or CALC_CHARGE_TEMPLATE are false in processing settings
-   TemplateDataManager myTemplateData;
-   myTemplateData.ReadAllFiles(templateDir, inputSeries, detectorMap, detectorChargePolarityMap, myUserData);
+   string partialName = inputSeries + "_" + setup.GetDumpName();
 
 
    //=================================================
@@ -375,11 +248,12 @@ int main(int argc, char* argv[]){
    //=================================================
   
    //opens file and reads file header
-   NoiseBuilder noiseBuilder(myUserData, detConfigManager,
-			     myTemplateData); 
+   NoiseBuilder noiseBuilder(myUserData, setup.GetDetConfigManager(),
+			     setup.GetTemplateData()); 
 
    // Initialize Output Variables Lists/Trees   
-   noiseBuilder.ConfigureOutputFile(Form("%s.root", inputSeries.c_str())); 
+   if(noisePartial == 0)
+      noiseBuilder.ConfigureOutputFile(Form("%s.root", inputSeries.c_str())); 
 
    
    //=======================================================
@@ -387,9 +261,9 @@ int main(int argc, char* argv[]){
    // to establish the noise cuts.
    //=======================================================
 
-   noiseBuilder.OpenRawFile(fullRawDataFilename);
+   noiseBuilder.OpenRawFile(setup.GetRawDataFilename());
    int firstPassEvtCtr = 0;
-   while(firstPassEvtCtr < maxEvents && noiseBuilder.ReadNextEvent() != 0)
+   while(noisePartial != 2 && firstPassEvtCtr < maxEvents && noiseBuilder.ReadNextEvent() != 0)
    {
       int event = noiseBuilder.GetAdmin().GetEvent(); 
 
@@ -441,12 +315,21 @@ int main(int argc, char* argv[]){
 
    }  //Done with first pass through events!
 
+   if(noisePartial == 1)
+   {
+      noiseBuilder.WritePartialFile(setup.GetNoiseFilePath(partialName + ".selection.root"), firstPassEvtCtr);
+      return 0;
+   }
+
    //=======================================================
-   // Compute cuts based on stored data
+   // Compute cuts based on stored data (or those of the series)
    //=======================================================
 
+   if(noisePartial == 2)
+      noiseBuilder.ReadPartialCuts(setup.GetNoiseFilePath(inputSeries + ".cuts.root"));
+
    map<int, int>::iterator it;
-   for(it = detectorMap.begin(); it!=detectorMap.end(); it++)
+   for(it = detectorMap.begin(); noisePartial == 0 && it!=detectorMap.end(); it++)
    {   
       int detNum = it->first;
 
@@ -466,6 +349,21 @@ int main(int argc, char* argv[]){
    // cuts and compute the average PSD.
    //=======================================================
 
+   //detectors of an event processed in parallel (0 = all cpus)
+   int nNoiseThreads = 0;
+   if(myUserData.HasIntParameter("NOISE_THREADS"))
+      nNoiseThreads = myUserData.GetIntParameter("NOISE_THREADS");
+   if(nNoiseThreads <= 0)
+      nNoiseThreads = sysconf(_SC_NPROCESSORS_ONLN);
+
+   DetectorJob detectorJob;
+   detectorJob.noiseBuilder = &noiseBuilder;
+   detectorJob.userData = &myUserData;
+   detectorJob.isTFData = isTFData;
+   for(it = detectorMap.begin(); it!=detectorMap.end(); it++)
+      detectorJob.detNums.push_back(it->first);
+   StartDetectorWorkers(detectorJob, nNoiseThreads);
+
    noiseBuilder.ResetRawFile();
    int secondPassEvtCtr = 0;
    while(secondPassEvtCtr < maxEvents && noiseBuilder.ReadNextEvent() != 0)
@@ -475,61 +373,29 @@ int main(int argc, char* argv[]){
       cout <<"\nMCF TEST Selecting noise pulses, event number = " << event
 	   << endl;
 
-      // ==== Loop over Zips and build average PSD's ====
-
-      map<int, int>::iterator it;
-      for(it = detectorMap.begin(); it!=detectorMap.end(); it++)
-      {
-	 int detNum = it->first;
-
-	 noiseBuilder.CalcSumOfPulses(detNum); //sum all pulses (for each sensor type for minmax calculation)
-
-	 // === noise selection cuts ===
-
-	 //skip all pulses in this event if its not a random trigger - don't apply this cut to TF data
-	 if(!isTFData && !noiseBuilder.PassRandomTriggerCut()) { continue; }
-
-	 // Apply a saturation cut (in place of old "No Joerger's Railed" cut from DarkPipe)
-	 if(!noiseBuilder.PassSaturationCut(detNum)) { continue; }
-
-	 // Apply MinMax cut
-	 if(myUserData.GetIntParameter(detNum, "DO_MINMAX") && !noiseBuilder.PassMinMaxCut(detNum)) 
-	   { continue; }
-
-	 // Apply Pileup cut
-	 if(myUserData.GetIntParameter(detNum, "DO_PILEUP_CUT") && !noiseBuilder.PassPileupCut(detNum)) 
-	   { continue; }
-
-         // Apply OF chisq cut (phonon)
-	 if(myUserData.GetIntParameter(detNum, "DO_PHONON_CHISQ_CUT") && !noiseBuilder.PassPOFchisqCut(detNum)) 
-	   { continue; }
-
-         // Apply PTBSslope cut
-	 if( myUserData.HasIntParameter(detNum, "DO_PTBSslope_CUT") )
-	 {
-	   if(myUserData.GetIntParameter(detNum, "DO_PTBSslope_CUT") && !noiseBuilder.PassPTBSslopeCut(detNum)) 
-	     { continue; }
-	 }
+      // ==== Loop over Zips: noise selection and average PSD's ====
 
-	 // ==== option to store the traces ====
-	 if( myUserData.GetIntParameter("WRITE_NOISE_PULSES") ) { noiseBuilder.StorePulses(detNum); }
-
-
-	 // ==== build average PSD ===
-
-	 // if the event on this detector made it to here, add it to the average PSD
-	 noiseBuilder.BuildAveragePSD(detNum); 
-
-	 // calculate the average covariance (for special studies only) 
-	 if( myUserData.DoAlgorithm(detNum, "charge", "ChargeNoiseCovariance") )
-	     noiseBuilder.BuildQIQOCov(detNum);
+      RunDetectorJob(detectorJob);
 
+      // ==== option to store the traces (output file, so in detector order here) ====
+      if( noisePartial == 0 && myUserData.GetIntParameter("WRITE_NOISE_PULSES") )
+      {
+	 for(uint detItr = 0; detItr < detectorJob.detNums.size(); detItr++)
+	    if(detectorJob.passed[detItr]) { noiseBuilder.StorePulses(detectorJob.detNums[detItr]); }
       }
 
       secondPassEvtCtr++;
 
    }  //Done with second pass through events!
 
+   StopDetectorWorkers(detectorJob);
+
+   if(noisePartial == 2)
+   {
+      noiseBuilder.WritePartialFile(setup.GetNoiseFilePath(partialName + ".noise.root"), secondPassEvtCtr);
+      return 0;
+   }
+
    //Calculate noise quantities from average psd's
       
    //==================================================================== 
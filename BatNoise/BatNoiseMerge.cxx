@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: BatNoiseMerge
+//Description:  Merges the partial noise files which BatNoise writes for single dumps of a series
+//(NOISE_PARTIAL = 1 or 2) in two steps, so that the dumps can be processed as separate jobs:
+//
+//   cuts:   <series>_F*.selection.root -> <series>.cuts.root
+//           the noise selection values of all dumps, and the cuts calculated from them
+//   noise:  <series>.cuts.root and <series>_F*.noise.root -> <series>.root
+//           the average PSD's of all dumps, and the filter file calculated from them
+//
+//The detector configuration is read from the raw file of the given dump, as in BatNoise.
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <sys/dir.h>
+#include <regex.h>
+
+//CDMS Libraries
+#include "UserDataManager.h"
+#include "NoiseBuilder.h"
+#include "BatNoiseSetup.h"
+
+using namespace std;
+
+
+namespace {
+
+   //the partial files <series>_F<dump>.<kind>.root in the noise file directory, in dump order
+   vector<string> FindPartialFiles(UserDataManager& myUserData, const string& inputSeries, const string& kind)
+   {
+      string noisePath = myUserData.GetPath("NOISE_FILES");
+      string noisePrefix = myUserData.GetPrefix("NOISE_PREFIX");
+
+      regex_t regex;
+      string matchfile = "^" + noisePrefix + inputSeries + "_F[0-9]+\\." + kind + "\\.root$";
+      regcomp(&regex, matchfile.c_str(), REG_EXTENDED|REG_NOSUB);
+
+      vector<string> partialFiles;
+      DIR *dir;
+      struct dirent *ent;
+      if ((dir = opendir (noisePath.c_str())) != NULL) {
+	 while ((ent = readdir (dir)) != NULL) {
+	    string filename(ent->d_name);
+	    if(!regexec(&regex, filename.c_str(), 0, NULL, 0))
+	       partialFiles.push_back(noisePath + filename);
+	 }
+	 closedir (dir);
+      }
+      else{
+	 cerr << "BatNoiseMerge: ERROR! could not open noise file directory " << noisePath << endl;
+	 exit(1);
+      }
+      regfree(&regex);
+
+      if(partialFiles.empty()){
+	 cerr << "BatNoiseMerge: ERROR! no " << kind << " files of series " << inputSeries << " in " << noisePath << endl;
+	 exit(1);
+      }
+
+      //the dump numbers have the same number of digits
+      sort(partialFiles.begin(), partialFiles.end());
+      return partialFiles;
+   }
+
+}
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   //print versions explicitly, in lieu of a -V or --version option
+   cout << "cdmsbats version: " << __CB_GIT_VERSION << endl;
+   cout << "BatCommon version: " << __BC_GIT_VERSION << endl;
+
+   //reading inputs to main
+   string stage = (argc > 1 ? argv[1] : "");
+   if(argc < 4 || (stage != "cuts" && stage != "noise"))
+   {
+      cout <<"ERROR running BatNoiseMerge!"
+	   <<"\nThe command line is: /BatNoiseMerge cuts|noise series# dump# processingOptions(optional) analysisConfig(optional)"
+	   << endl;
+      exit(1);
+   }
+
+   string inputSeries = argv[2];
+   string dumpNum = argv[3];
+
+   // the same settings, detector configuration and templates as the BatNoise jobs of the dumps
+   BatNoiseSetup setup(inputSeries, dumpNum, (argc > 4 ? argv[4] : ""), (argc > 5 ? argv[5] : ""));
+
+   UserDataManager& myUserData = setup.GetUserData();
+   map<int, int> detectorMap = setup.GetDetectorMap();
+   bool isTFData = setup.IsTFData();
+
+   NoiseBuilder noiseBuilder(myUserData, setup.GetDetConfigManager(),
+			     setup.GetTemplateData());
+
+   map<int, int>::iterator it;
+
+   if(stage == "cuts")
+   {
+      //=======================================================
+      // Noise selection values of all dumps, then the cuts
+      //=======================================================
+
+      vector<string> partialFiles = FindPartialFiles(myUserData, inputSeries, "selection");
+
+      int totEvtCtr = 0;
+      for(uint fileItr = 0; fileItr < partialFiles.size(); fileItr++)
+      {
+	 cout <<"\nAdding " << partialFiles[fileItr] << endl;
+	 totEvtCtr += noiseBuilder.AddPartialFile(partialFiles[fileItr]);
+      }
+
+      for(it = detectorMap.begin(); it!=detectorMap.end(); it++)
+      {
+	 int detNum = it->first;
+
+	 if( myUserData.GetIntParameter(detNum, "DO_MINMAX") )
+	    noiseBuilder.CalcMinMaxCut(detNum);
+
+	 if( myUserData.GetIntParameter(detNum, "DO_PILEUP_CUT") )
+	    noiseBuilder.CalcPileupCut(detNum, isTFData);
+
+	 if( myUserData.GetIntParameter(detNum, "DO_PHONON_CHISQ_CUT") )
+	    noiseBuilder.CalcPOFchisqCut(detNum);
+      }
+
+      noiseBuilder.WritePartialFile(setup.GetNoiseFilePath(inputSeries + ".cuts.root"), totEvtCtr);
+   }
+   else
+   {
+      //=======================================================
+      // Selection histograms and cuts of the series, average
+      // PSD's of all dumps, then the noise quantities
+      //=======================================================
+
+      noiseBuilder.AddPartialFile(setup.GetNoiseFilePath(inputSeries + ".cuts.root"));
+
+      vector<string> partialFiles = FindPartialFiles(myUserData, inputSeries, "noise");
+
+      int totEvtCtr = 0;
+      for(uint fileItr = 0; fileItr < partialFiles.size(); fileItr++)
+      {
+	 cout <<"\nAdding " << partialFiles[fileItr] << endl;
+	 totEvtCtr += noiseBuilder.AddPartialFile(partialFiles[fileItr]);
+      }
+
+      for(it = detectorMap.begin(); it!=detectorMap.end(); it++)
+	 noiseBuilder.CalcNoiseQuantities(it->first, totEvtCtr);
+
+      noiseBuilder.ConfigureOutputFile(Form("%s.root", inputSeries.c_str()));
+      noiseBuilder.WriteOutputFile();
+   }
+
+   return 0;
+
+} //end main()   DONE!!!
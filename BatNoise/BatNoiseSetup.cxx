@@ -0,0 +1,342 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: BatNoiseSetup
+//Description:  Configuration of a noise job for one series (see header file), moved out of
+//BatNoise main().
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <cstdlib>
+#include <sys/dir.h>
+#include <regex.h>
+
+//ROOT Libraries
+#include "TString.h"
+
+#include "BatNoiseSetup.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////
+
+BatNoiseSetup::BatNoiseSetup(const string& inputSeries, const string& dumpNum,
+			     const string& userOptionsFileIn, const string& configFileIn) :
+   fInputSeries(inputSeries),
+   fIsTFData(false)
+{
+   //converting dumpNum to "F000#" format
+   int nZeros = 4 - dumpNum.length();
+   fDumpName = "F";
+   for(int zCtr=0; zCtr < nZeros; zCtr++) fDumpName += "0";
+   fDumpName += dumpNum;
+
+   // construct filename from series and dumpNum
+   string rawDataFilename = Form("%s_%s", inputSeries.c_str(), fDumpName.c_str());
+
+   cout <<"RawDataFilename = " << rawDataFilename << endl;
+
+   //cdmsbats directory
+   string cdmsbatsdir =
+     getenv("CDMSBATSDIR") ? getenv("CDMSBATSDIR") : "./";
+ 
+
+   //batroot directory
+   string batnoisedir = cdmsbatsdir + "/BatNoise";
+    
+   // processing/analysis root directory 
+   string batroot_settings = cdmsbatsdir + "/UserSettings/BatRootSettings";
+  
+
+   //processing files directory
+   string batroot_proc_default = batroot_settings + "/processing";
+   string batroot_proc =
+     getenv("BATROOT_PROC") ? getenv("BATROOT_PROC")
+     : batroot_proc_default;
+
+
+   //analysis files directory
+   string batroot_const_default = batroot_settings + "/analysis";
+   string batroot_const =
+     getenv("BATROOT_CONST") ? getenv("BATROOT_CONST")
+     : batroot_const_default;
+
+
+
+   //detector status files directory
+   string batroot_detstatus_default = batroot_settings + "/detector_status";
+   string batroot_detstatus =
+     getenv("BATROOT_DETSTATUS") ? getenv("BATROOT_DETSTATUS")
+     : batroot_detstatus_default;
+
+
+
+
+
+   // ===============================================
+   // Read Configuration file and auxillary files
+   // ===============================================
+  
+   // -- analysis and processing configurations --
+   
+   // autodetect the location based on series number and then set the default configuration file
+   fIsTFData = false;
+   
+   string defaultUserOptionsFile = "processingSoudanData.SuperCDMS";
+   string defaultAnalysisConfigFile = "configSoudanData.SuperCDMS";
+   string defaultDetectorStatusFile = "detectorStatus.SuperCDMS";
+
+   int seriesLength = inputSeries.length(); //series length = 11 for old series format, 13 for new
+   int seriesCheck = ( seriesLength > 12 ? atoi(inputSeries.substr(0, (seriesLength-11)).c_str())*10 : 
+		       atoi(inputSeries.substr(0, (seriesLength-10)).c_str()) ); 
+   int seriesDateAndPrefix = atoi(inputSeries.substr(0, (seriesLength-5)).c_str());
+
+   switch (seriesCheck) 
+   {
+      case 0:
+	 defaultUserOptionsFile = "processingSUFData.Default";
+	 defaultAnalysisConfigFile = "configSUFData.Default";
+	 break;
+	 
+      case 1: 
+	 defaultUserOptionsFile = "processingSoudanData.Default";
+	 defaultAnalysisConfigFile = "configSoudanData.c58";
+	 break;
+
+      case 10: 
+	 {
+	   if(seriesDateAndPrefix > 1111100)
+	   {
+	     defaultUserOptionsFile = "processingSoudanData.SuperCDMS.Default";
+	     defaultAnalysisConfigFile = "configSoudanData.SuperCDMS.Default";
+             defaultDetectorStatusFile = "detectorStatus.SuperCDMS";
+	   }
+	   else
+	   {
+	     if(seriesDateAndPrefix > 1101200)
+	     {
+	       defaultUserOptionsFile = "processingSoudanData.ITHybrid";
+	       defaultAnalysisConfigFile = "configSoudanData.ITHybrid";
+	     }
+	     else
+	     {
+	       defaultUserOptionsFile = "processingSoudanData.STHybrid";
+	       defaultAnalysisConfigFile = "configSoudanData.STHybrid";
+	     }
+	   }
+	 }
+	 break;
+	 
+      case 2: 
+	 defaultUserOptionsFile = "processingUCBData.Default";
+	 defaultAnalysisConfigFile = "configUCBData.Default";
+         fIsTFData = true;
+	 break;
+
+      case 3: 
+	 defaultUserOptionsFile = "processingCWRUData.Default";
+	 defaultAnalysisConfigFile = "configCWRUData.Default"; 
+         fIsTFData = true;
+	 break;
+
+      case 4:
+	 defaultUserOptionsFile = "processingUFData.Default";
+	 defaultAnalysisConfigFile = "configUFData.Default";
+         fIsTFData = true;
+	 break;
+	 
+      case 60:
+         defaultUserOptionsFile = "processingQueensData.Default";
+	 defaultAnalysisConfigFile = "configQueensData.Default";
+         fIsTFData = true;
+	 break;
+
+      case 70:
+	 defaultUserOptionsFile = "processingUMNData.iZIP100mm";
+	 defaultAnalysisConfigFile = "configUMNData.iZIP100mm";
+	 fIsTFData = true;
+	 break;
+
+      case 90:
+	 defaultUserOptionsFile = "processingSLACData.iZIP100mm.midas";
+	 defaultAnalysisConfigFile = "configSLACData.iZIP100mm.midas";
+         fIsTFData = true;
+	 break;
+	 
+      case 510:
+	 defaultUserOptionsFile = "processingDMC.iZIPDefault";
+	 defaultAnalysisConfigFile = "configDMC.iZIPDefault";
+	 break;
+
+      default:
+	 cout <<"BatNoiseSetup ERROR! series prefix is unrecognized" << endl;
+	 exit(1);
+   }
+
+   // if desired, overwrite default processing options
+   string userOptionsFile = (userOptionsFileIn != "" ? userOptionsFileIn : defaultUserOptionsFile);
+   // now read the processing file
+   fUserData.ReadFile(batroot_proc + "/" + userOptionsFile); 
+
+   // if desired, overwrite default analysis config
+   string configFile = (configFileIn != "" ? configFileIn : defaultAnalysisConfigFile);
+   // now read the analysis configuration file
+   fUserData.ReadFile(batroot_const + "/" + configFile);
+
+   //
+   // ===== INFO file =====
+   //
+
+   string infoFile = fUserData.GetPath("AUX_FILES") + inputSeries + ".info"; 
+   
+   if (fUserData.DoRead("INFO_FILE")) 
+        fInfoData.ReadFile(infoFile);
+   else
+       cout <<"\nNOTE:  INFO is not being read.  Values will derive from either raw data or user settings file."<< endl;
+   
+
+   //
+   // ===== ISR file =====
+   //
+
+   fIsrData = IsrDataManager(fUserData.GetMaxZIPs());
+
+   string isrFile = fUserData.GetPath("AUX_FILES") + inputSeries + ".isr"; 
+   if (fUserData.DoRead("ISR_FILE")) 
+          fIsrData.ReadFile(isrFile);
+    else
+       cout <<"\nNOTE:  ISR file is not being read. Values will derive from either raw data or user settings file." << endl;
+    
+   //=================================================
+   // Check the directory for the file and get the right extension [ANV] 
+   //=================================================
+   
+   //do some regex matching to parse out series and dump
+   regex_t regex;
+   string matchfile="("+rawDataFilename+")(\\.mid|\\.mid\\.gz|\\.gz)?$";
+   int reti = regcomp(&regex,matchfile.c_str(),REG_EXTENDED);
+
+   //browse the directory for the correct file
+   //so we can learn about the filenames in terms of extension [ANV]
+   cout << fUserData.GetPath("RAW_DATA") << endl;
+   DIR *dir;
+   struct dirent *ent;
+   fRawDataFilename="";
+   if ((dir = opendir (fUserData.GetPath("RAW_DATA").c_str())) != NULL) {
+     while ((ent = readdir (dir)) != NULL) {
+       string filename(ent->d_name);
+       regmatch_t matchptr[4];
+       reti = regexec(&regex,filename.c_str(),4,matchptr,0);
+       if(!reti){
+         fRawDataFilename = filename;
+       }
+     }
+     closedir (dir);
+   }
+   else{
+     cerr << "BatNoiseSetup: ERROR! could not open raw directory" << endl;
+     exit(1); 
+   }
+
+   if(fRawDataFilename==""){
+     cerr << "BatNoiseSetup: ERROR! requested raw file does not exist" << endl;
+     exit(1); 
+   }
+
+   //=================================================
+   // Initialize DetectorConfigManager
+   //=================================================
+
+   // opens raw file and, if it exists, reads the detector config record
+   fDetConfigManager = DetectorConfigManager(fUserData, fRawDataFilename);
+   
+   // register external data classes if available
+   if( fUserData.DoRead("INFO_FILE") ) 
+     fDetConfigManager.RegisterInfo(fInfoData);
+   
+   if( fUserData.DoRead("ISR_FILE") ) 
+      fDetConfigManager.RegisterIsr(fIsrData);
+
+
+
+   //=================================================
+   // Construct list of ZIP detectors 
+   //=================================================
+
+   // detectors to be processed:
+   //    detectors set by the DO_PROCESSING flag in configuration file
+   //            AND
+   //    available information in the ISR file (if file is read)
+
+
+   // get the detector map from the detector config manager
+   fDetectorMap = fDetConfigManager.GetDetectorMap();
+
+
+   // get the charge polarity type  map from the detector config manager
+   map<int, string> detectorChargePolarityMap = fDetConfigManager.GetDetectorChargePolarityMap();
+
+   
+   //=================================================
+   // Detector status RQ (from UserSetting file)
+   //=================================================
+   
+   //  The detector status RQs depend only on the SeriesNumber so
+   //  calculation can be done outside the event loop.
+   //  However, the RQs will be stored event by event in ZIP
+   //  trees
+
+   if (fUserData.DoRead("DET_STATUS_FILE")) {
+
+     // read detector status 
+     fUserData.ReadFile(batroot_detstatus + "/" + defaultDetectorStatusFile);
+   
+     // construct RQ list
+     fUserData.ConstructZipRQList(fDetectorMap);
+     
+     // Fill RQs 
+     fUserData.DoCalcDetectorStatus(inputSeries);
+
+
+     // Fill broken channel and charge side list
+     // (using RQs, which thus need to be calculated)
+     //
+     // Considered "broken"
+     //     Phonon: status = 2  (=> not included in pt)
+     //     charge: status>0    (=> single pulse fitting, no 2X2 or Z constraint)
+     //        (if either QI or QO broken: charge side = broken 
+    
+     fUserData.FillBrokenChannelLists();
+
+      
+   }
+
+
+   //=================================================
+   // Pulse Template
+   //=================================================
+   
+   string templateDir = 
+     getenv("BATNOISE_TEMPLATES") ? getenv("BATNOISE_TEMPLATES")
+     : "PulseTemplates";	// Under "cdmsbats"
+
+   // reads only if the detectors are configured 
+   //     AND 
+   // if CALC_PHONON_TEMPLATE or CALC_CHARGE_TEMPLATE are false in processing settings
+   fTemplateData.ReadAllFiles(templateDir, inputSeries, fDetectorMap, detectorChargePolarityMap, fUserData);
+
+}
+
+BatNoiseSetup::~BatNoiseSetup()
+{
+
+}
+
+string BatNoiseSetup::GetNoiseFilePath(const string& fileName) const
+{
+   return fUserData.GetPath("NOISE_FILES") + fUserData.GetPrefix("NOISE_PREFIX") + fileName;
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: BatNoiseSetup
+//Description:  Configuration of a noise job for one series: reads the processing and analysis
+//settings (chosen from the series number unless given), the INFO/ISR files, the detector
+//configuration of the raw file of the given dump, the detector status and the pulse templates.
+//Shared by BatNoise and BatNoiseMerge, which must configure the NoiseBuilder the same way.
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BATNOISESETUP_H
+#define BATNOISESETUP_H
+
+#include <string>
+#include <map>
+
+#include "UserDataManager.h"
+#include "IsrDataManager.h"
+#include "InfoDataManager.h"
+#include "TemplateDataManager.h"
+#include "DetectorConfigManager.h"
+
+using namespace std;
+
+//!Settings, external files, detector configuration and templates of a BatNoise job
+class BatNoiseSetup
+{
+   public:
+
+      //empty file names select the default processing and analysis configurations of the series
+      BatNoiseSetup(const string& inputSeries, const string& dumpNum,
+		    const string& userOptionsFile = "", const string& configFile = "");
+      ~BatNoiseSetup();
+
+      UserDataManager&       GetUserData()       { return fUserData; }
+      DetectorConfigManager& GetDetConfigManager() { return fDetConfigManager; }
+      TemplateDataManager&   GetTemplateData()   { return fTemplateData; }
+
+      const map<int, int>& GetDetectorMap() const  { return fDetectorMap; }  //key = detector number, val = detector type
+      bool   IsTFData()               const { return fIsTFData; }
+      string GetInputSeries()         const { return fInputSeries; }
+      string GetDumpName()            const { return fDumpName; }        //"F000#"
+      string GetRawDataFilename()     const { return fRawDataFilename; } //with its extension, in the RAW_DATA path
+
+      //fileName in the NOISE_FILES path, with the NOISE_PREFIX
+      string GetNoiseFilePath(const string& fileName) const;
+
+   private:
+
+      BatNoiseSetup();
+
+      string fInputSeries;
+      string fDumpName;
+      string fRawDataFilename;
+      bool   fIsTFData;
+
+      UserDataManager       fUserData;
+      InfoDataManager       fInfoData;
+      IsrDataManager        fIsrData;
+      DetectorConfigManager fDetConfigManager;
+      TemplateDataManager   fTemplateData;
+
+      map<int, int>    fDetectorMap;
+};
+
+#endif /* BATNOISESETUP_H */
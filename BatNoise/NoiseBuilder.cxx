@@ -11,6 +11,10 @@
 //   20111118  M. Kelsey / B. Serfass -- Use CDMSBATSDIR/BatNoise instead of BATROOTDIR/noise
 //   20141210  B. Serfass -- Add 2D OF template calculationb
 //   20171229  N. Mast  --  Add baseline slope noise selection
+//   Oct. 2026  --  RAW_INFLATE_BACKEND/RAW_INFLATE_THREADS select the raw file decompression
+//   Oct. 2026  --  RAW_LAZY_UNPACKING/RAW_SKIP_UNPROCESSED raw pulse decoding
+//   Oct. 2026  --  partial noise files of single dumps (WritePartialFile/AddPartialFile) for BatNoiseMerge
+//   Oct. 2026  --  BuildDerivedTraces: normalized pulses and phonon/charge sums built once per event
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
@@ -18,12 +22,14 @@
 #include "time.h"
 #include <iomanip> //for debugging
 #include <regex.h>
+#include <cstring>
 
 #include "TComplex.h"
 #include "TMatrixD.h"
 #include "TTree.h"
 #include "TString.h"
 #include "TGraphErrors.h"
+#include "TKey.h"
 
 
 #include "ChannelMapHelper.h"
@@ -50,6 +56,11 @@ NoiseBuilder::NoiseBuilder(UserDataManager& myUserData, DetectorConfigManager& m
    //Configure Correlation Data
    ConfigureCorrelationData();
 
+   //buffers of the derived traces, made here so that the detector threads only look them up
+   map<int, int> detMap = fDetConfigManager.GetDetectorMap();  
+   for(map<int, int>::iterator detMapItr = detMap.begin(); detMapItr != detMap.end(); detMapItr++)
+      fMapOfDerivedTraces[detMapItr->first].valid = false;
+
    //Register the data classes so that they will be read
    fRawReader.RegisterAdminData(&fAdminData);
 
@@ -571,6 +582,27 @@ void NoiseBuilder::ConfigureCorrelationData()
 
 void NoiseBuilder::OpenRawFile(const string& inputRawDataFile)
 {
+  //decompression backend (see RawInflater.h)
+  string inflateBackend = "zlib";
+  int inflateThreads = 0;
+  if(fUserData.HasStringParameter("RAW_INFLATE_BACKEND"))
+    inflateBackend = fUserData.GetStringParameter("RAW_INFLATE_BACKEND");
+  if(fUserData.HasIntParameter("RAW_INFLATE_THREADS"))
+    inflateThreads = fUserData.GetIntParameter("RAW_INFLATE_THREADS");
+  fRawReader.SetInflateBackend(inflateBackend, inflateThreads);
+
+  //pulse decoding (see EventBuilder): lazy ADC unpacking, skipping of the unprocessed zips
+  fRawReader.SetLazyPulseUnpacking(!fUserData.HasIntParameter("RAW_LAZY_UNPACKING") ||
+				   fUserData.GetIntParameter("RAW_LAZY_UNPACKING") == 1);
+  if(fUserData.HasIntParameter("RAW_SKIP_UNPROCESSED") && fUserData.GetIntParameter("RAW_SKIP_UNPROCESSED") == 1 &&
+     !fUserData.DoModifyRawData())
+  {
+    vector<int> processedZips;
+    for(int detNum = 1; detNum <= fUserData.GetMaxZIPs(); detNum++)
+      if(fUserData.DoZipProcessing(detNum)) processedZips.push_back(detNum);
+    fRawReader.SetDetectorSelection(processedZips);
+  }
+
   //open the file
   fRawReader.OpenRawDataFile(fUserData.GetPath("RAW_DATA"), inputRawDataFile);
    
@@ -628,6 +660,10 @@ int NoiseBuilder::ReadNextEvent()
    //First clear data containers of previous event's data
    fRawReader.Clear();
 
+   map< int, DerivedTraces >::iterator tracesItr = fMapOfDerivedTraces.begin();
+   for( ; tracesItr != fMapOfDerivedTraces.end(); tracesItr++)
+      tracesItr->second.valid = false;
+
    //Read the event!
    int checkStatus = fRawReader.ReadRawDataRecord();
 
@@ -1077,6 +1113,326 @@ void NoiseBuilder::WriteOutputFile()
 }
 
 
+// ======================== partial noise files ====================================
+
+namespace {
+
+   //a TH1D with no bins cannot be written, so empty vectors are left out
+   void WritePartialVector(const vector<double>& aVector, const string& aName)
+   {
+      if(aVector.size() == 0) return;
+      PulseTools::Vector2TH1D(aVector, aName).Write();
+   }
+
+   //empty if the vector was not written
+   vector<double> ReadPartialVector(TDirectory* aDir, const string& aName)
+   {
+      vector<double> aVector;
+      TH1D* aHisto = dynamic_cast<TH1D*>(aDir->Get(aName.c_str()));
+      if(aHisto == NULL) return aVector;
+      aVector = PulseTools::TH1D2Vector(*aHisto);
+      delete aHisto;
+      return aVector;
+   }
+
+   void AppendPartialVector(vector<double>& aVector, const vector<double>& partialVector)
+   {
+      aVector.insert(aVector.end(), partialVector.begin(), partialVector.end());
+   }
+
+}
+
+TFile* NoiseBuilder::OpenPartialFile(const string& fileName)
+{
+   TFile* partialFile = TFile::Open(fileName.c_str(), "read");
+   if(partialFile == NULL || partialFile->IsZombie())
+   {
+      cerr <<"NoiseBuilder::OpenPartialFile ERROR! cannot read " << fileName << endl;
+      exit(1);
+   }
+   return partialFile;
+}
+
+//Stores everything which is needed to continue the noise calculation after the NoiseData of
+//several dumps are merged: the noise selection values, histograms and cuts, and the average
+//PSD's and covariances with the number of events in them.  The noise quantities themselves
+//(CalcNoiseQuantities) are only calculated on the merged data.
+void NoiseBuilder::WritePartialFile(const string& fileName, int nEvents)
+{
+   cout <<"\nWriting partial noise file: " << fileName << endl;
+
+   TFile* partialFile = TFile::Open(fileName.c_str(), "recreate");
+   if(partialFile == NULL || partialFile->IsZombie())
+   {
+      cerr <<"NoiseBuilder::WritePartialFile ERROR! cannot create " << fileName << endl;
+      exit(1);
+   }
+
+   partialFile->cd();
+   WritePartialVector(vector<double>(1, nEvents), "NEvents");
+
+   map<int, int> detMap = fDetConfigManager.GetDetectorMap();  
+   map<int, int>::iterator detMapItr = detMap.begin();
+
+   for( ; detMapItr != detMap.end(); detMapItr++)
+   {
+      int detNum = detMapItr->first;
+
+      partialFile->mkdir(Form("zip%d", detNum), Form("zip%d", detNum)); 
+      partialFile->cd(Form("zip%d", detNum));
+
+      map< int, vector<NoiseData> >::iterator noiseMapItr = fMapOfNoiseData.find(detNum);
+      if(noiseMapItr != fMapOfNoiseData.end())
+      {
+	 vector<NoiseData>* noiseDataList = &(noiseMapItr->second);
+
+	 //the cross talk and template channels get copies of the average PSD's without counting
+	 //events, so the weight of the PSD's of a detector is the largest count
+	 double psdWeight = 0.0;
+	 for(uint noiseItr = 0; noiseItr < noiseDataList->size(); noiseItr++)
+	    psdWeight = max(psdWeight, (*noiseDataList)[noiseItr].fPSDCount);
+	 WritePartialVector(vector<double>(1, psdWeight), "PSDWeight");
+
+	 for(uint noiseItr = 0; noiseItr < noiseDataList->size(); noiseItr++)
+	 {
+	    NoiseData* aNoiseData = &((*noiseDataList)[noiseItr]);
+	    string channelName = aNoiseData->GetChannelName();
+
+	    for(uint histItr=0; histItr < aNoiseData->fNoiseSelectionHistograms.size(); histItr++)
+	       (aNoiseData->fNoiseSelectionHistograms)[histItr]->Write();
+
+	    WritePartialVector(aNoiseData->fMinMaxValues, channelName+"MinMaxValues");
+	    WritePartialVector(aNoiseData->fPileupValues, channelName+"PileupValues");
+	    WritePartialVector(aNoiseData->fPOFchisqValues, channelName+"POFchisqValues");
+	    WritePartialVector(aNoiseData->fPTBSslopeValues, channelName+"PTBSslopeValues");
+
+	    vector<double> cuts;
+	    cuts.push_back(aNoiseData->fMinMaxCut);
+	    cuts.push_back(aNoiseData->fPileupCut);
+	    cuts.push_back(aNoiseData->fPOFchisqCut);
+	    WritePartialVector(cuts, channelName+"Cuts");
+
+	    WritePartialVector(aNoiseData->fAveragePSD, channelName+"AveragePSD");
+	    WritePartialVector(vector<double>(1, aNoiseData->fPSDCount), channelName+"PSDCount");
+	    WritePartialVector(aNoiseData->fEventList, channelName+"EventList");
+	 }
+      }
+
+      map< int, vector<CorrelationData> >::iterator corrMapItr = fMapOfCorrelationData.find(detNum);
+      if(corrMapItr != fMapOfCorrelationData.end())
+      {
+	 vector<CorrelationData>* corrDataList = &(corrMapItr->second);
+	 for(uint corrItr = 0; corrItr < corrDataList->size(); corrItr++)
+	 {
+	    CorrelationData* aCorrData = &((*corrDataList)[corrItr]);
+	    string channelNames = aCorrData->GetChannelNames();
+
+	    WritePartialVector(aCorrData->fAverageCov_Re, channelNames+"AverageCovRe");
+	    WritePartialVector(aCorrData->fAverageCov_Im, channelNames+"AverageCovIm");
+	    WritePartialVector(vector<double>(1, aCorrData->fCovCount), channelNames+"CovCount");
+	 }
+      }
+   } //end loop over zips
+
+   partialFile->Close();
+   delete partialFile;
+
+   return;
+}
+
+//Merges a partial noise file into the NoiseData and CorrelationData: the selection values and
+//event lists are appended, the selection histograms added, the cuts taken from the file and
+//the average PSD's (rms over the events) and covariances (mean over the events) combined with
+//the number of events on both sides
+int NoiseBuilder::AddPartialFile(const string& fileName)
+{
+   TFile* partialFile = OpenPartialFile(fileName);
+
+   vector<double> nEvents = ReadPartialVector(partialFile, "NEvents");
+   if(nEvents.size() != 1)
+   {
+      cerr <<"NoiseBuilder::AddPartialFile ERROR! " << fileName << " is not a partial noise file" << endl;
+      exit(1);
+   }
+
+   map<int, int> detMap = fDetConfigManager.GetDetectorMap();  
+   map<int, int>::iterator detMapItr = detMap.begin();
+
+   for( ; detMapItr != detMap.end(); detMapItr++)
+   {
+      int detNum = detMapItr->first;
+
+      TDirectory* zipDir = partialFile->GetDirectory(Form("zip%d", detNum));
+      if(zipDir == NULL)
+      {
+	 cerr <<"NoiseBuilder::AddPartialFile ERROR! " << fileName << " has no zip" << detNum 
+	      <<" directory.  Were the dumps processed with different detector configurations?" << endl;
+	 exit(1);
+      }
+
+      map< int, vector<NoiseData> >::iterator noiseMapItr = fMapOfNoiseData.find(detNum);
+      if(noiseMapItr != fMapOfNoiseData.end())
+      {
+	 vector<NoiseData>* noiseDataList = &(noiseMapItr->second);
+
+	 vector<double> psdWeight = ReadPartialVector(zipDir, "PSDWeight");
+	 double partialWeight = (psdWeight.size() == 1 ? psdWeight[0] : 0.0);
+	 double mergedWeight = fMapOfPartialPSDWeight[detNum];
+
+	 //selection histograms are named <histo>.zip<N>.<channel>
+	 TKey* aKey;
+	 TIter keysItr(zipDir->GetListOfKeys()); 
+	 while ((aKey = (TKey *) keysItr()))
+	 { 
+	    string keyName = aKey->GetName();
+	    size_t dotPos = keyName.rfind('.');
+	    if(dotPos == string::npos || strcmp(aKey->GetClassName(),"TH1D")) continue;
+
+	    string channelName = keyName.substr(dotPos+1);
+	    for(uint noiseItr = 0; noiseItr < noiseDataList->size(); noiseItr++)
+	    {
+	       if((*noiseDataList)[noiseItr].GetChannelName() != channelName) continue;
+	       TH1D* aHisto = (TH1D*) aKey->ReadObj();
+	       (*noiseDataList)[noiseItr].AddNoiseSelectionHistogram(*aHisto);
+	       delete aHisto;
+	       break;
+	    }
+	 }
+
+	 for(uint noiseItr = 0; noiseItr < noiseDataList->size(); noiseItr++)
+	 {
+	    NoiseData* aNoiseData = &((*noiseDataList)[noiseItr]);
+	    string channelName = aNoiseData->GetChannelName();
+
+	    AppendPartialVector(aNoiseData->fMinMaxValues, ReadPartialVector(zipDir, channelName+"MinMaxValues"));
+	    AppendPartialVector(aNoiseData->fPileupValues, ReadPartialVector(zipDir, channelName+"PileupValues"));
+	    AppendPartialVector(aNoiseData->fPOFchisqValues, ReadPartialVector(zipDir, channelName+"POFchisqValues"));
+	    AppendPartialVector(aNoiseData->fPTBSslopeValues, ReadPartialVector(zipDir, channelName+"PTBSslopeValues"));
+	    AppendPartialVector(aNoiseData->fEventList, ReadPartialVector(zipDir, channelName+"EventList"));
+
+	    vector<double> cuts = ReadPartialVector(zipDir, channelName+"Cuts");
+	    if(cuts.size() == 3)
+	    {
+	       aNoiseData->fMinMaxCut = cuts[0];
+	       aNoiseData->fPileupCut = cuts[1];
+	       aNoiseData->fPOFchisqCut = cuts[2];
+	    }
+
+	    vector<double> partialPSD = ReadPartialVector(zipDir, channelName+"AveragePSD");
+	    vector<double> partialCount = ReadPartialVector(zipDir, channelName+"PSDCount");
+	    if(partialCount.size() == 1) aNoiseData->fPSDCount += partialCount[0];
+	    if(partialPSD.size() == 0 || partialWeight == 0.0) continue;
+
+	    if(mergedWeight == 0.0 || aNoiseData->fAveragePSD.size() == 0)
+	    {
+	       aNoiseData->fAveragePSD = partialPSD;
+	       continue;
+	    }
+
+	    if(partialPSD.size() != aNoiseData->fAveragePSD.size())
+	    {
+	       cerr <<"NoiseBuilder::AddPartialFile ERROR! the " << channelName << " PSD of zip" << detNum 
+		    <<" in " << fileName << " has a different length than the merged average." << endl;
+	       exit(1);
+	    }
+
+	    //fAveragePSD = sqrt(sum_over_i(noisePSD_i^2)/nEvents), as in NoiseData::AddToAveragePSD
+	    for(uint binCtr=1; binCtr < partialPSD.size(); binCtr++)
+	    {
+	       double avePSDsq = aNoiseData->fAveragePSD[binCtr]*aNoiseData->fAveragePSD[binCtr]*mergedWeight;
+	       avePSDsq += partialPSD[binCtr]*partialPSD[binCtr]*partialWeight;
+	       aNoiseData->fAveragePSD[binCtr] = sqrt(avePSDsq/(mergedWeight + partialWeight));
+	    }
+	    aNoiseData->fAveragePSD[0] = 0.0;
+	 }
+
+	 fMapOfPartialPSDWeight[detNum] = mergedWeight + partialWeight;
+      }
+
+      map< int, vector<CorrelationData> >::iterator corrMapItr = fMapOfCorrelationData.find(detNum);
+      if(corrMapItr != fMapOfCorrelationData.end())
+      {
+	 vector<CorrelationData>* corrDataList = &(corrMapItr->second);
+	 for(uint corrItr = 0; corrItr < corrDataList->size(); corrItr++)
+	 {
+	    CorrelationData* aCorrData = &((*corrDataList)[corrItr]);
+	    string channelNames = aCorrData->GetChannelNames();
+
+	    vector<double> partialCov_Re = ReadPartialVector(zipDir, channelNames+"AverageCovRe");
+	    vector<double> partialCov_Im = ReadPartialVector(zipDir, channelNames+"AverageCovIm");
+	    vector<double> partialCount = ReadPartialVector(zipDir, channelNames+"CovCount");
+	    if(partialCount.size() != 1 || partialCount[0] == 0.0) continue;
+
+	    if(aCorrData->fCovCount == 0.0)
+	    {
+	       aCorrData->fAverageCov_Re = partialCov_Re;
+	       aCorrData->fAverageCov_Im = partialCov_Im;
+	       aCorrData->fCovCount = partialCount[0];
+	       continue;
+	    }
+
+	    if(partialCov_Re.size() != aCorrData->fAverageCov_Re.size() || partialCov_Im.size() != aCorrData->fAverageCov_Im.size())
+	    {
+	       cerr <<"NoiseBuilder::AddPartialFile ERROR! the " << channelNames << " covariance of zip" << detNum 
+		    <<" in " << fileName << " has a different length than the merged average." << endl;
+	       exit(1);
+	    }
+
+	    //fAverageCov = sum_over_i(cov_i)/nEvents, as in CorrelationData::AddToAverageCov
+	    double mergedCount = aCorrData->fCovCount + partialCount[0];
+	    for(uint binCtr=1; binCtr < partialCov_Re.size(); binCtr++)
+	    {
+	       aCorrData->fAverageCov_Re[binCtr] = (aCorrData->fAverageCov_Re[binCtr]*aCorrData->fCovCount 
+						    + partialCov_Re[binCtr]*partialCount[0])/mergedCount;
+	       aCorrData->fAverageCov_Im[binCtr] = (aCorrData->fAverageCov_Im[binCtr]*aCorrData->fCovCount 
+						    + partialCov_Im[binCtr]*partialCount[0])/mergedCount;
+	    }
+	    aCorrData->fCovCount = mergedCount;
+	 }
+      }
+   } //end loop over zips
+
+   partialFile->Close();
+   delete partialFile;
+
+   return (int)nEvents[0];
+}
+
+//Only the cuts, for the second pass of a dump with the cuts of the whole series
+void NoiseBuilder::ReadPartialCuts(const string& fileName)
+{
+   TFile* partialFile = OpenPartialFile(fileName);
+
+   map< int, vector<NoiseData> >::iterator noiseMapItr = fMapOfNoiseData.begin();
+   for( ; noiseMapItr != fMapOfNoiseData.end(); noiseMapItr++)
+   {
+      int detNum = noiseMapItr->first;
+      TDirectory* zipDir = partialFile->GetDirectory(Form("zip%d", detNum));
+      if(zipDir == NULL)
+      {
+	 cerr <<"NoiseBuilder::ReadPartialCuts ERROR! " << fileName << " has no zip" << detNum <<" directory." << endl;
+	 exit(1);
+      }
+
+      vector<NoiseData>* noiseDataList = &(noiseMapItr->second);
+      for(uint noiseItr = 0; noiseItr < noiseDataList->size(); noiseItr++)
+      {
+	 NoiseData* aNoiseData = &((*noiseDataList)[noiseItr]);
+	 vector<double> cuts = ReadPartialVector(zipDir, aNoiseData->GetChannelName()+"Cuts");
+	 if(cuts.size() != 3) continue;
+	 aNoiseData->fMinMaxCut = cuts[0];
+	 aNoiseData->fPileupCut = cuts[1];
+	 aNoiseData->fPOFchisqCut = cuts[2];
+      }
+   }
+
+   partialFile->Close();
+   delete partialFile;
+
+   return;
+}
+
+
 void NoiseBuilder::StorePulses(int detNum)
 {
 
@@ -1121,100 +1477,189 @@ void NoiseBuilder::StorePulses(int detNum)
 
 // ================== Pulse Calculations  ========================
 
-//normalized to take out driver gains, this is used by the minmax cut
-//Note:  this code expects to be run on zips (i.e. 2 charge and 4 phonon channels)
-void NoiseBuilder::CalcSumOfPulses(int detNum)
+namespace {
+
+   //sum += (pulse/norm)*scale, bin by bin.  An empty sum starts from zeros, which adds the first
+   //pulse exactly, so the sum is the same as Normalize/Scale/SumPulses channel after channel
+   void AddToTraceSum(vector<double>& sum, const vector<double>& pulse, double norm, double scale)
+   {
+      if(sum.size() == 0) sum.assign(pulse.size(), 0.0);
+
+      if(sum.size() != pulse.size())
+      {
+	 cout <<"NoiseBuilder::BuildDerivedTraces ERROR!  Attempting to add two pulses of different length!" << endl;
+	 exit(1);
+      }
+
+      for(uint binCtr=0; binCtr < pulse.size(); binCtr++)
+	 sum[binCtr] += (pulse[binCtr]/norm)*scale;
+   }
+
+}
+
+//Builds the traces of a detector which are derived from its raw pulses, once per event, into
+//buffers which are kept from event to event.  Each raw pulse is read once for
+//   - the channel pulse normalized to amps or volts (channel PSD's and QI/QO covariance)
+//   - the phonon and charge sums of the minmax cut: calib*ADC/driverGain (calib = 1 for charge)
+//     over the noise selection channels which are not broken, divided by the sum of
+//     1/(nChannels*driverGain) when they are stored as PT and QT (CalcSumOfPulses)
+//   - the PT, PS1 and PS2 sums of the PSD's: calib*ADC/PNormADCToAmps over the phonon channels
+//     which are not broken phonon channels, not divided
+//The two phonon sums are kept apart on purpose: PNormADCToAmps = driverGain*P_FBgain*P_DigitizerBinsPerVolt,
+//so they differ by that constant and the division by the weights, besides the channel lists.  The
+//minmax sums stay in the units of the MINMAX_* settings and the PSD sums in amps, like the filters.
+//The operations and their order are the same as in the separate loops of CalcSumOfPulses and
+//BuildAveragePSD before, so the cuts and the filters are unchanged (BatBench/noisediff).
+const NoiseBuilder::DerivedTraces& NoiseBuilder::BuildDerivedTraces(int detNum)
 {
-    int detType = 0; //for calculating sum of pulses
+   map< int, DerivedTraces >::iterator tracesItr = fMapOfDerivedTraces.find(detNum);
+   if(tracesItr == fMapOfDerivedTraces.end())
+   {
+      cerr <<"NoiseBuilder::BuildDerivedTraces ERROR! zip" << detNum << " is not in the detector map" << endl;
+      exit(1);
+   }
 
-    //retrieve the vector of pulses for this zip 
-    vector<PulseData>* zipPulseList;
-    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
-    if(mapItr != fMapOfZipPulses.end())
-    {
-       //Get the pulse list for this zip
-       zipPulseList = &(mapItr->second);
+   DerivedTraces& traces = tracesItr->second;
+   if(traces.valid) return traces;
 
-       //Construct sum of phonon pulses and store as a special PulseData object
-       
-       vector<double> phononSumPulse;
-       double phononSumNorm = 0.;
+   //clear() keeps the memory of the previous event
+   traces.minmaxPhononSum.clear();
+   traces.minmaxChargeSum.clear();
+   traces.minmaxPhononNorm = 0.;
+   traces.minmaxChargeNorm = 0.;
+   traces.phononSum.clear();
+   traces.phononSumS1.clear();
+   traces.phononSumS2.clear();
+   traces.phononSampleRate = 0.;
 
-       vector<double> chargeSumPulse;
-       double chargeSumNorm = 0.;
+   map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
+   if(mapItr == fMapOfZipPulses.end())
+   {
+      traces.channelPulses.clear();
+      traces.valid = true;
+      return traces;
+   }
 
-       // get status RQ (if available)
-       // Do not use channel if broken
-       
-       vector<string>  brokenChannels;
-       if (fUserData.DoRead("DET_STATUS_FILE"))
-            brokenChannels = fUserData.GetBrokenChannelList(detNum);  
+   //Get the pulse list for this zip
+   vector<PulseData>* zipPulseList = &(mapItr->second);
+   traces.channelPulses.resize(zipPulseList->size());
 
+   // get status RQ (if available)
+   // Do not use channel if broken (all broken channels for minmax, broken phonon channels for the PSD's)
+   vector<string>  brokenChannels;
+   vector<string>  brokenPhononChannels;
+   if (fUserData.DoRead("DET_STATUS_FILE"))
+   {
+      brokenChannels = fUserData.GetBrokenChannelList(detNum);
+      brokenPhononChannels = fUserData.GetBrokenPhononChannelList(detNum);
+   }
 
-       // ===== loop ZIP pulse collection =======
+   // ===== loop ZIP pulse collection =======
 
-	  cout << "Zip pulse list size: (MF was here)" << zipPulseList->size() <<endl;
-       for(uint pulseItr = 0; pulseItr < zipPulseList->size(); pulseItr++)
-       {
+   for(uint pulseItr = 0; pulseItr < zipPulseList->size(); pulseItr++)
+   {
+      const PulseData* aPulseData = &((*zipPulseList)[pulseItr]);
+      vector<double>& pulse = traces.channelPulses[pulseItr];
+      pulse.clear();
 
-	  PulseData* aPulseData = &((*zipPulseList)[pulseItr]); 
-	  int    detCode = aPulseData->GetDetectorCode();
-	  //string sensorType = aPulseData->GetChannelType(); 
-	  string channelName = aPulseData->GetChannelName();
-	  detType = aPulseData->GetDetectorType();
+      string channelName = aPulseData->GetChannelName();
+      int    detCode     = aPulseData->GetDetectorCode();
+      int    detType     = aPulseData->GetDetectorType();
+      string sensorType  = aPulseData->GetChannelType();
 
-	  cout << "Curr chan: (MF was here)" << channelName <<endl;
+      //PT and QT of CalcSumOfPulses are derived themselves
+      if( !ChannelMapHelper::IsPhysicalChannel(channelName) )
+      { continue; }
 
-          // skip channel if not use for noise selection  (set in config file)  
-          if (!fUserData.UseChannelNoiseSelection(detNum, detType,channelName)) continue;
-        
-                   
-          // skip channel if broken
-           if (find(brokenChannels.begin(), brokenChannels.end(), channelName) != brokenChannels.end()) continue;
+      const vector<double>& rawPulse = aPulseData->GetRawPulse();
+      if(rawPulse.size() == 0)
+      {
+	 cerr <<"NoiseBuilder::BuildDerivedTraces ERROR! empty " << channelName << " pulse on zip" << detNum << endl;
+	 exit(1);
+      }
 
+      // ---------- normalized pulse (amps, volts) ---------
 
+      double normalization = 1;
+      if(sensorType == "phonon")
+	 normalization = fDetConfigManager.GetPNormADCToAmps(detCode, fAdminData.GetEventTime());
+      if(sensorType == "charge")
+	 normalization = fDetConfigManager.GetQNormADCToVolts(detCode, fAdminData.GetEventTime());
 
-          // ---------- construct sum of pulses ---------
-	  
-          //Now construct a pulse that is the sum of all (normalized) charge pulses
-	  if(aPulseData->IsChargePulse()) 
-	  { 
-	     double pulseNorm = fDetConfigManager.GetDriverGain(detCode, fAdminData.GetEventTime());
-	     chargeSumNorm += 1.0/(ChannelMapHelper::GetNChargeChannels(detType)*pulseNorm);
-
-	     if(chargeSumPulse.size() == 0)
-	     {
-		chargeSumPulse = PulseTools::Normalize(aPulseData->fPulseVector, pulseNorm); 		
-	     } 
-	     else 
-	     {	
-		vector<double> tempPulse = PulseTools::Normalize(aPulseData->fPulseVector, pulseNorm); 
-		chargeSumPulse = PulseTools::SumPulses(chargeSumPulse, tempPulse);     			    
-	     }
-	  }
-	  
-          //Now construct a pulse that is the sum of all (normalized) phonon pulses
-	  if(aPulseData->IsPhononPulse())
-	  {
-
-             double pulseCalib = fUserData.GetRelativeCalibration(detNum, detType, channelName);
-	     double pulseNorm = fDetConfigManager.GetDriverGain(detCode, fAdminData.GetEventTime());
-	     phononSumNorm +=  1.0/(ChannelMapHelper::GetNPhononChannels(detType)*pulseNorm);
-
-	     if(phononSumPulse.size() == 0)
-	     {
-		phononSumPulse = PulseTools::Normalize(aPulseData->fPulseVector, pulseNorm);
-                phononSumPulse = PulseTools::Scale(phononSumPulse, pulseCalib); 
-	     } 
-	     else 
-	     {
-		vector<double> tempPulse = PulseTools::Normalize(aPulseData->fPulseVector, pulseNorm); 
-	        tempPulse = PulseTools::Scale(tempPulse, pulseCalib); 
-        	phononSumPulse = PulseTools::SumPulses(phononSumPulse, tempPulse); 				    
-	     }
-	  }
-	  
-       } // ======= end loop ZIP pulses  =======
+      pulse.resize(rawPulse.size());
+      for(uint binCtr=0; binCtr < rawPulse.size(); binCtr++)
+	 pulse[binCtr] = rawPulse[binCtr]/normalization;
+
+      //include relative phonon scale factors (these are scaled relative to channel A)
+      double pulseCalib = 1.0;
+      if(aPulseData->IsPhononPulse())
+	 pulseCalib = fUserData.GetRelativeCalibration(detNum, detType, aPulseData->GetDetectorChannel());
+
+      // ---------- sums of the minmax cut ---------
+
+      bool useForMinMax = fUserData.UseChannelNoiseSelection(detNum, detType, aPulseData->GetDetectorChannel()) &&
+	 find(brokenChannels.begin(), brokenChannels.end(), channelName) == brokenChannels.end();
+
+      if(useForMinMax && aPulseData->IsChargePulse())
+      {
+	 double pulseNorm = fDetConfigManager.GetDriverGain(detCode, fAdminData.GetEventTime());
+	 traces.minmaxChargeNorm += 1.0/(ChannelMapHelper::GetNChargeChannels(detType)*pulseNorm);
+	 AddToTraceSum(traces.minmaxChargeSum, rawPulse, pulseNorm, 1.0);
+      }
+
+      if(useForMinMax && aPulseData->IsPhononPulse())
+      {
+	 double pulseNorm = fDetConfigManager.GetDriverGain(detCode, fAdminData.GetEventTime());
+	 traces.minmaxPhononNorm += 1.0/(ChannelMapHelper::GetNPhononChannels(detType)*pulseNorm);
+	 AddToTraceSum(traces.minmaxPhononSum, rawPulse, pulseNorm, pulseCalib);
+      }
+
+      // ---------- sums of the PSD's ---------
+
+      if(aPulseData->IsPhononPulse())
+      {
+	 traces.phononSampleRate = fDetConfigManager.GetSampleRate(detCode); //storing this for PT
+
+	 // skip broken channels
+	 if (find(brokenPhononChannels.begin(), brokenPhononChannels.end(), channelName) != brokenPhononChannels.end()) continue;
+
+	 // total phonon (sum of all channels)
+	 AddToTraceSum(traces.phononSum, pulse, 1.0, pulseCalib);
+
+	 // sum phonon channels on side 1 and side 2
+	 if (channelName.find("S1")!=string::npos)
+	    AddToTraceSum(traces.phononSumS1, pulse, 1.0, pulseCalib);
+
+	 if (channelName.find("S2")!=string::npos)
+	    AddToTraceSum(traces.phononSumS2, pulse, 1.0, pulseCalib);
+      }
+
+   } // ======= end loop ZIP pulses  =======
+
+   traces.valid = true;
+   return traces;
+}
+
+//Adds the minmax sums of BuildDerivedTraces to the pulse list, as PT and QT
+void NoiseBuilder::CalcSumOfPulses(int detNum)
+{
+    int detType = 0; //for calculating sum of pulses
+
+    //retrieve the vector of pulses for this zip 
+    vector<PulseData>* zipPulseList;
+    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
+    if(mapItr != fMapOfZipPulses.end())
+    {
+       //Get the pulse list for this zip
+       zipPulseList = &(mapItr->second);
+
+       //the sums are built with the other derived traces, once per event
+       const DerivedTraces& traces = BuildDerivedTraces(detNum);
+
+       if(zipPulseList->size() > 0) detType = zipPulseList->back().GetDetectorType();
+
+       double chargeSumNorm = traces.minmaxChargeNorm;
+       double phononSumNorm = traces.minmaxPhononNorm;
 
        //Add special sum of charge pulses as an additional PulseData object in the PulseData list
        PulseData chargeSumPulseData;
@@ -1223,7 +1668,7 @@ void NoiseBuilder::CalcSumOfPulses(int detNum)
        chargeSumPulseData.fDetChannel = ChannelMapHelper::GetQTIndex(detType); //depends on number of physical channels in the det
        chargeSumPulseData.fDetCode = ChannelMapHelper::CalcDetCodeBase(detType, detNum) + chargeSumPulseData.fDetChannel; 
        chargeSumPulseData.fChannelName = ChannelMapHelper::GetChannelName(detType, chargeSumPulseData.fDetChannel);
-       chargeSumPulseData.fNADCBins = chargeSumPulse.size();
+       chargeSumPulseData.fNADCBins = traces.minmaxChargeSum.size();
 
        chargeSumPulseData.fIsCharge = true;
        chargeSumPulseData.fIsZip = true;
@@ -1233,7 +1678,7 @@ void NoiseBuilder::CalcSumOfPulses(int detNum)
        if(chargeSumNorm == 0.0) chargeSumNorm = 1.0;  //no normalization if isr not read
 
        if(ChannelMapHelper::GetNChargeChannels(detType) > 0)  //**********************ATTEMPTED FIX FOR HV DETECTOR**********************
-	  chargeSumPulseData.fPulseVector = PulseTools::Normalize(chargeSumPulse, chargeSumNorm); //this is normalized!
+	  chargeSumPulseData.fPulseVector = PulseTools::Normalize(traces.minmaxChargeSum, chargeSumNorm); //this is normalized!
 
        zipPulseList->push_back(chargeSumPulseData);
 
@@ -1246,7 +1691,7 @@ void NoiseBuilder::CalcSumOfPulses(int detNum)
 	       phononSumPulseData.fDetChannel = ChannelMapHelper::GetPTIndex(detType); //depends on number of physical channels in the det
 	       phononSumPulseData.fDetCode = ChannelMapHelper::CalcDetCodeBase(detType, detNum) + phononSumPulseData.fDetChannel; 
 	       phononSumPulseData.fChannelName = ChannelMapHelper::GetChannelName(detType, phononSumPulseData.fDetChannel);
-	       phononSumPulseData.fNADCBins = phononSumPulse.size();
+	       phononSumPulseData.fNADCBins = traces.minmaxPhononSum.size();
 	       
 	       phononSumPulseData.fIsPhonon = true;
 	       phononSumPulseData.fIsZip = true;
@@ -1256,7 +1701,7 @@ void NoiseBuilder::CalcSumOfPulses(int detNum)
 	       if(phononSumNorm == 0.0) phononSumNorm = 1.0;  //no normalization if isr not read
 
 	       // this is the weighted sum...the sign of the gain cancels! 
-	       phononSumPulseData.fPulseVector = PulseTools::Normalize(phononSumPulse, phononSumNorm);  
+	       phononSumPulseData.fPulseVector = PulseTools::Normalize(traces.minmaxPhononSum, phononSumNorm);  
 
 	       zipPulseList->push_back(phononSumPulseData);
 
@@ -1509,10 +1954,9 @@ void NoiseBuilder::ConstructPileUpDistribution(int detNum)
       {
 	 PulseData* aPulseData = &((*zipPulseList)[pulseItr]);
 	 NoiseData* aNoiseData = &((*noiseDataList)[pulseItr]);
-	 string     chanName = aPulseData->GetChannelName();
 
 	 //do not construct pileup from non-physical channels (i.e. summed pulses or cross-talk)
-	 if( !ChannelMapHelper::IsPhysicalChannel(chanName) )
+	 if( !ChannelMapHelper::IsPhysicalChannel(aPulseData->GetDetectorType(), aPulseData->GetDetectorChannel()) )
 	 { continue; }
 
 
@@ -1671,10 +2115,9 @@ int NoiseBuilder::PassPileupCut(int detNum)
       {
 	 PulseData* aPulseData = &((*zipPulseList)[pulseItr]);
 	 NoiseData* aNoiseData = &((*noiseDataList)[pulseItr]);
-	 string     chanName = aPulseData->GetChannelName();
 
 	 //do not construct pileup from non-physical channels (i.e. summed pulses or cross-talk)
-	 if( !ChannelMapHelper::IsPhysicalChannel(chanName) )
+	 if( !ChannelMapHelper::IsPhysicalChannel(aPulseData->GetDetectorType(), aPulseData->GetDetectorChannel()) )
 	 { continue; }
 
 
@@ -1915,7 +2358,7 @@ int NoiseBuilder::PassSaturationCut(int detNum)
 	 double satVal = fUserData.GetIntParameter(detNum, ChannelMapHelper::GetChannelNameBase(channelName) + "_SATURATION");
 
 	 //do not check this for PT and QT
-	 if( !ChannelMapHelper::IsPhysicalChannel(channelName) ) { continue; }
+	 if( !ChannelMapHelper::IsPhysicalChannel(aPulseData->GetDetectorType(), aPulseData->GetDetectorChannel()) ) { continue; }
 
 	 if(PulseTools::IsSaturated(aPulseData->GetRawPulse(), satVal)) pass = 0;
 
@@ -2209,18 +2652,10 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
       //store the detector type
       int detType = 0;  //will get stored multiple times, but better be the same for all pulses on this det
 
-      //Construct sum of phonon pulses (again) with proper normalizations now.  
-      //FIXME - someday we should only do this once, so we need to 
-      //fix CalcSumOfPulses and carefully recheck the minmax routine - LLH 2/09
-      vector<double> phononSumPulse;
-      vector<double> phononSumS1Pulse;
-      vector<double> phononSumS2Pulse;
-      double phononSampleRate = 0.0;
-
-      // Get list broken channels
-      vector<string>  brokenPhononChannels;
-      if (fUserData.DoRead("DET_STATUS_FILE"))
-            brokenPhononChannels = fUserData.GetBrokenPhononChannelList(detNum);  
+      //normalized pulses and the PT/PS1/PS2 sums in amps, built once per event (the sums of the
+      //minmax cut are normalized differently, see BuildDerivedTraces)
+      const DerivedTraces& traces = BuildDerivedTraces(detNum);
+      double phononSampleRate = traces.phononSampleRate;
 
 
       // === loop over pulses, make use of ordering of NoiseData objects (should correpond to PulseData list) ===
@@ -2231,9 +2666,8 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
 	 NoiseData* aNoiseData = &((*noiseDataList)[pulseItr]);
 
 	 //we compute an average psd for the channels (QI, QO, PA, PB, PC, PD, and PT) 
-	 //no need to compute QT and we need to recalculate PT with correct normalization (different from minmax)
+	 //no need to compute QT, and PT is the sum in amps of BuildDerivedTraces (not the minmax one)
          //add PS1 and PS2 for iZIP only 
-	 //FIXME - make the minmax normalization agree with this one someday when we have time to debug it carefully
 	 //for QIX and QOX we store copies of the QI and QO average psd (this happens later)
 
 	 string channelName = aNoiseData->GetChannelName();
@@ -2255,30 +2689,12 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
 	    exit(1);
 	 }
 
-	 //get normalization for the pulse
-         
-	 double normalization = 1;	 
-         string sensorType = aPulseData->GetChannelType(); 
-
-	 if(sensorType == "phonon")
-	 {
-	   normalization = fDetConfigManager.GetPNormADCToAmps(detCode, fAdminData.GetEventTime());
-	 }
-
-	 if(sensorType == "charge")
-	 {
-	   normalization = fDetConfigManager.GetQNormADCToVolts(detCode, fAdminData.GetEventTime());
-	 }
-	 
          // get sampleRate
 	 double sampleRate = fDetConfigManager.GetSampleRate(detCode);
-	
-  	 if(aPulseData->IsPhononPulse()) phononSampleRate = sampleRate; //storing this for PT
 
-	 //construct normalized pulse and get PSD
-	 vector<double> pulse = PulseTools::Normalize(aPulseData->GetRawPulse(), normalization);
+	 //PSD of the normalized pulse
 	 vector<double> pulsePSD;
-	 PulseTools::Time2PSD(pulse, sampleRate, pulsePSD);
+	 PulseTools::Time2PSD(traces.channelPulses[pulseItr], sampleRate, pulsePSD);
 
 	 //add this PSD to the average PSD
 	 aNoiseData->AddToAveragePSD(pulsePSD);
@@ -2286,47 +2702,6 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
 	 //store the event number
 	 (aNoiseData->fEventList).push_back(fAdminData.GetEvent());
 
-	 //if its a phonon pulse, add it to PT so that we can later compute the averagePSD
-	 if(aPulseData->IsPhononPulse())
-	 {
-            // skip broken channels
-            if (find(brokenPhononChannels.begin(), brokenPhononChannels.end(), channelName) != brokenPhononChannels.end()) continue;
-
-              
-	    //include relative phonon scale factors (these are scaled relative to channel A)
-            int detType = aPulseData->GetDetectorType();
-	    double pulseCalib = fUserData.GetRelativeCalibration(detNum, detType, aPulseData->GetChannelName());
-
-            // total phonon (sum of all channels)
-	    if(phononSumPulse.size() == 0)
-	       phononSumPulse = PulseTools::Scale(pulse, pulseCalib);   
-	    else 
-	       phononSumPulse = PulseTools::SumPulses(phononSumPulse, PulseTools::Scale(pulse, pulseCalib)); 	        
-
-	
-            
-            // sum phonon channels on side 1 
-            if (channelName.find("S1")!=string::npos) {
-          
-              if(phononSumS1Pulse.size() == 0)
-	        phononSumS1Pulse = PulseTools::Scale(pulse, pulseCalib); //applying rough calibration factor
-	      else 
-	        phononSumS1Pulse = PulseTools::SumPulses(phononSumS1Pulse, PulseTools::Scale(pulse, pulseCalib)); 
-
-	     }
-	  
-            // sum phonon channels on side 2
-            if (channelName.find("S2")!=string::npos) {
-          
-             if(phononSumS2Pulse.size() == 0)
-	        phononSumS2Pulse = PulseTools::Scale(pulse, pulseCalib); //applying rough calibration factor
-	      else 
-	       phononSumS2Pulse = PulseTools::SumPulses(phononSumS2Pulse, PulseTools::Scale(pulse, pulseCalib)); 
-
-	     }
-	    
-         } // end phonon pulse
-
       } //end loop over pulses on this zip
       
 
@@ -2348,7 +2723,7 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
 
 	    //use phononSumPulse to get PSD
 	    vector<double> pulsePSD;
-	    PulseTools::Time2PSD(phononSumPulse, phononSampleRate, pulsePSD);
+	    PulseTools::Time2PSD(traces.phononSum, phononSampleRate, pulsePSD);
 	    
 	    //add this PSD to the average PSD
 	    aNoiseData->AddToAveragePSD(pulsePSD);
@@ -2367,7 +2742,7 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
 
 	    //use phononSumPulse to get PSD
 	    vector<double> pulsePSD;
-	    PulseTools::Time2PSD(phononSumS1Pulse, phononSampleRate, pulsePSD);
+	    PulseTools::Time2PSD(traces.phononSumS1, phononSampleRate, pulsePSD);
 	    
 	    //add this PSD to the average PSD
 	    aNoiseData->AddToAveragePSD(pulsePSD);
@@ -2386,7 +2761,7 @@ void NoiseBuilder::BuildAveragePSD(int detNum)
 
 	    //use phononSumPulse to get PSD
 	    vector<double> pulsePSD;
-	    PulseTools::Time2PSD(phononSumS2Pulse, phononSampleRate, pulsePSD);
+	    PulseTools::Time2PSD(traces.phononSumS2, phononSampleRate, pulsePSD);
 	    
 	    //add this PSD to the average PSD
 	    aNoiseData->AddToAveragePSD(pulsePSD);
@@ -2790,6 +3165,9 @@ void NoiseBuilder::BuildQIQOCov(int detNum)
    vector<double> aQIPulse;
    vector<double> aQOPulse;
 
+   //normalized pulses, built once per event
+   const DerivedTraces& traces = BuildDerivedTraces(detNum);
+
 
    // --- retrive the vector of pulses for this zip ---
    vector<PulseData>* zipPulseList;
@@ -2822,26 +3200,18 @@ void NoiseBuilder::BuildQIQOCov(int detNum)
 	 if(aPulseData->GetChannelName() != "QI" && aPulseData->GetChannelName() != "QO")
 	 {  continue; }
 
-	 //get normalization for the pulse
-         
-	 //	 double normalization = 1;	 
-
-         string sensorType  = aPulseData->GetChannelType(); 
-	 string channelName = aPulseData->GetChannelName();
 	 int    detCode     = aPulseData->GetDetectorCode();
 	 sampleRate         = fDetConfigManager.GetSampleRate(detCode); //assumes sample rate is same for all charge chan
-	 	 
-	 double normalization = fDetConfigManager.GetQNormADCToVolts(detCode, fAdminData.GetEventTime());
 	
-	 //construct normalized pulse and get PSD
+	 //normalized pulse (ADC/QNormADCToVolts)
 	 if(aPulseData->GetChannelName() == "QI")
 	 {
-	    aQIPulse = PulseTools::Normalize(aPulseData->GetRawPulse(), normalization);
+	    aQIPulse = traces.channelPulses[pulseItr];
 	 }
 
 	 if(aPulseData->GetChannelName() == "QO")
 	 {
-	    aQOPulse = PulseTools::Normalize(aPulseData->GetRawPulse(), normalization);
+	    aQOPulse = traces.channelPulses[pulseItr];
 	 }	 
 
 
@@ -3312,18 +3682,21 @@ void NoiseBuilder::CalcNoiseNoCrossTalk(vector<NoiseData>* noiseDataList, const
 void NoiseBuilder::FillSingleZipPulseCollection(vector<PulseData>& pulseCollection,
 						const int& detNum) const
 {
-   vector<PulseData> tempCollection;
+   pulseCollection = GetSingleZipPulses(detNum);
+   return;
+}
+
+//This function gives read-only access to the pulse values!
+const vector<PulseData>& NoiseBuilder::GetSingleZipPulses(int detNum) const
+{
+   static const vector<PulseData> noPulses;
 
    //retrive the vector of pulses for this zip
    map< int, vector<PulseData> >::const_iterator mapItr = fMapOfZipPulses.find(detNum);
    if(mapItr != fMapOfZipPulses.end())
-   {
-      tempCollection = mapItr->second;
-   }  
- 
-   pulseCollection = tempCollection;
+      return mapItr->second;
 
-   return;
+   return noPulses;
 }
 
 
@@ -8,6 +8,9 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: GetAdmin and GetSingleZipPulses return const references
+//Oct. 2026: partial noise files of single dumps, merged by BatNoiseMerge
+//Oct. 2026: per event derived traces (normalized channels, phonon/charge sums) built once
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -54,10 +57,17 @@ class NoiseBuilder
       void WriteOutputFile();
       void StorePulses(int detNum);
 
+      //Partial products of one dump (noise selection values and histograms, cuts,
+      //average PSD's with their event counts, event lists and covariances), see BatNoiseMerge
+      void WritePartialFile(const string& fileName, int nEvents);
+      int  AddPartialFile(const string& fileName);   //merges into the NoiseData, returns the events of the dump
+      void ReadPartialCuts(const string& fileName);  //only the cut values
+
       //getting data objects (all const functions)
-      AdminData   GetAdmin() const    { return fAdminData; }
+      const AdminData& GetAdmin() const    { return fAdminData; }
 
       //getting pulse collections - FIXME are these needed?
+      const vector<PulseData>& GetSingleZipPulses(int detNum) const;   //read-only, empty if no pulses
       void FillSingleZipPulseCollection(vector<PulseData>& pulseCollection, const int& detNum) const; 
 
       //getting general info about the event
@@ -107,8 +117,26 @@ class NoiseBuilder
       //default constructor
       NoiseBuilder();
 
+      //traces derived from the raw pulses of one detector in one event, built once and shared by
+      //the noise selection (CalcSumOfPulses) and the noise calculations (BuildAveragePSD, BuildQIQOCov).
+      //The two kinds of sums have different normalizations on purpose, see BuildDerivedTraces
+      struct DerivedTraces {
+	 bool   valid;                         //built from the pulses of the current event
+	 vector< vector<double> > channelPulses; //per entry of the pulse list: ADC/GetPorQNorm, empty for sums
+	 vector<double> minmaxPhononSum;       //sum of calib*ADC/driverGain over the noise selection channels
+	 vector<double> minmaxChargeSum;       //sum of ADC/driverGain over the noise selection channels
+	 double minmaxPhononNorm;              //sum of 1/(nChannels*driverGain)
+	 double minmaxChargeNorm;
+	 vector<double> phononSum;             //sum of calib*ADC/PNormADCToAmps (PT, PS1, PS2 PSD's)
+	 vector<double> phononSumS1;
+	 vector<double> phononSumS2;
+	 double phononSampleRate;
+      };
+
       //utility
       bool IsChosenType(const PulseData& aPulseData, const string& whichPulses) const;
+      TFile* OpenPartialFile(const string& fileName);
+      const DerivedTraces& BuildDerivedTraces(int detNum);  //does nothing if already built for this event
       
       //Raw Data Reader
       RawDataReader fRawReader;
@@ -129,6 +157,8 @@ class NoiseBuilder
       map< int, vector<PulseData> > fMapOfZipPulses;    //key is zip#
       map< int, vector<NoiseData> > fMapOfNoiseData;    //key is zip#
       map< int, vector<CorrelationData> > fMapOfCorrelationData; //key is zip#
+      map< int, DerivedTraces > fMapOfDerivedTraces;     //key is zip#, entries made at construction (threads only look up)
+      map< int, double > fMapOfPartialPSDWeight;  //key is zip#, events in the merged average PSD's
       
       //External data
       bool     fReadIsr; //true by default
@@ -8,6 +8,7 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: AddNoiseSelectionHistogram for merging the partial noise files
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -178,6 +179,32 @@ TH1D NoiseData::RetrieveNoiseSelectionHistogram(const string& histo)
 }
 
 
+void NoiseData::AddNoiseSelectionHistogram(const TH1D& aHisto)
+{
+   string aName = aHisto.GetName();
+
+   //loop through list of histograms and see if we find a matching name
+   for(uint histItr=0; histItr < fNoiseSelectionHistograms.size(); histItr++)
+   {
+      string checkName = fNoiseSelectionHistograms[histItr]->GetName();
+      
+      //if found, than add the entries and return
+      if(aName == checkName) 
+      {
+	 fNoiseSelectionHistograms[histItr]->Add(&aHisto);
+	 return;
+      }
+   }   
+
+   //if we made it this far, then no matching name was found, so store a copy
+   TH1D* aCopy = (TH1D*)aHisto.Clone(aName.c_str());
+   aCopy->SetDirectory(0);
+   fNoiseSelectionHistograms.push_back(aCopy);
+
+   return;
+}
+
+
 //==========================================================================
 
 //computes a running average
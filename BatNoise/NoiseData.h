@@ -8,6 +8,7 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: AddNoiseSelectionHistogram for merging the partial noise files
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -46,6 +47,7 @@ class NoiseData
 					     int nBins, double minBin, double maxBin); //creates histo if it doesn't yet exist
       void HistogramValue(const string& histoName, double val);
       TH1D RetrieveNoiseSelectionHistogram(const string& histo);  //read only access
+      void AddNoiseSelectionHistogram(const TH1D& aHisto);  //adds to the histogram of that name, or stores a copy (merging of partial files)
 
       // access noise quantities as histograms - READ only access
 
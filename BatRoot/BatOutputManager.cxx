@@ -8,16 +8,21 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: the RQ tables are stored through an RQOutputBackend (TTree by default, or RNTuple)
+//Oct. 2026: per-RQ storage types from OUTPUT_PRECISION_FILE (RQPrecisionPolicy)
+//Oct. 2026: OUTPUT_COMPRESSION for the output file
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <cmath>
 
 #include "TTree.h"
 
 #include "BatOutputManager.h"
 #include "PulseData.h"
 #include "ChannelMapHelper.h"
+#include "ProcessingTimer.h"
 
 //User Analysis Classes - DO NOT modify or copy this comment (for auto_analysis)
 #include "SimulateFromRandoms.h"
@@ -50,9 +55,10 @@ using namespace std;
 BatOutputManager::BatOutputManager(UserDataManager& myUserData, DetectorConfigManager& myDetectorConfigManager,
 				   const string& rawDataFilename)  :
    fUserData(myUserData),
-   fEventTree(0),
-   fVetoTree(0),
-   fNoiseMonitorTree(0),
+   fBackend(0),
+   fEventTable(-1),
+   fVetoTable(-1),
+   fNoiseMonitorTable(-1),
    fEventListLocked(true),
    fZipListLocked(true),
    fVetoListLocked(true),
@@ -66,6 +72,10 @@ BatOutputManager::BatOutputManager(UserDataManager& myUserData, DetectorConfigMa
    string rqPath = fUserData.GetPath("RQ_DATA");
    string rqFilePrefix = myUserData.GetPrefix("RQ_DATA_PREFIX");
    fOutputFile = TFile::Open(Form("%s%s.root", rqPath.c_str(), (rqFilePrefix+rawDataFilename).c_str()), "recreate");
+
+   //algorithm*100 + level, e.g. 101 zlib 1, 404 lz4 4, 505 zstd 5
+   if(fUserData.HasIntParameter("OUTPUT_COMPRESSION"))
+      fOutputFile->SetCompressionSettings(fUserData.GetIntParameter("OUTPUT_COMPRESSION"));
   
    // create directories
    fOutputFile->mkdir("infoDir","Info directory");   
@@ -74,16 +84,22 @@ BatOutputManager::BatOutputManager(UserDataManager& myUserData, DetectorConfigMa
   
    // RQ structure
    fOutputFile->cd("rqDir");
+   fBackend = RQOutputBackend::Create(fUserData, fOutputFile->GetDirectory("rqDir"));
+   if(fUserData.HasStringParameter("OUTPUT_PRECISION_FILE"))
+   {
+      fPrecisionPolicy.ReadFile(fUserData.GetStringParameter("OUTPUT_PRECISION_FILE"));
+      cout <<"BatOutputManager: RQ storage types from " << fPrecisionPolicy.GetFileName() << endl;
+   }
 
    // Event tree
-   fEventTree = new TTree("eventTree","eventTree");
+   fEventTable = fBackend->CreateTable("eventTree","eventTree");
 
    // Veto tree
-   if(fUserData.DoVetoProcessing() && fUserData.WriteVetoRQ()) fVetoTree = new TTree("vetoTree","vetoTree");
+   if(fUserData.DoVetoProcessing() && fUserData.WriteVetoRQ()) fVetoTable = fBackend->CreateTable("vetoTree","vetoTree");
 
    //Noise monitor tree
    if(fUserData.DoNoiseMonitorProcessing() && fUserData.WriteNoiseMonitorRQ())
-     fNoiseMonitorTree = new TTree("noiseMonitorTree","noiseMonitorTree");
+     fNoiseMonitorTable = fBackend->CreateTable("noiseMonitorTree","noiseMonitorTree");
    
    // Zip tree
    fDetectorMap = fDetectorConfigManager.GetDetectorMap();
@@ -99,9 +115,10 @@ BatOutputManager::BatOutputManager(UserDataManager& myUserData, DetectorConfigMa
 	 if(fDebugOn) cout <<"making a new tree!" << detNum << endl;
 
 	 //Important! tree name = "zip#", tree title = "#"
-	 //the tree title is used by BatOutputMan to match the tree with the rq's of the corresponding zip, 
+	 //fZipTableDetNum is used by BatOutputMan to match the tree with the rq's of the corresponding zip, 
 	 //so don't modify this unless you know what you are doing!!
-	 fZipTreeVector.push_back(new TTree(Form("zip%d",detNum), Form("%d", detNum))); 
+	 fZipTableVector.push_back(fBackend->CreateTable(Form("zip%d",detNum), Form("%d", detNum))); 
+	 fZipTableDetNum.push_back(detNum);
 	 
 	 //next, reserve a slot for a zip RQ map
 	 map<string, double> dummyMap;
@@ -114,6 +131,7 @@ BatOutputManager::BatOutputManager(UserDataManager& myUserData, DetectorConfigMa
 BatOutputManager::~BatOutputManager() 
 { 
    //cout <<"Goodbye from BatOutputManager()" << endl; // destructor
+   delete fBackend;
 }
 
 //Reinitialize lists to default values
@@ -165,15 +183,113 @@ void BatOutputManager::ConstructOutputLists()
 
    ConstructEventOutputList();
    ConstructZipOutputList();
-   if(fVetoTree != 0) ConstructVetoOutputList();  //don't construct this list if tree is not initialized
-   if(fNoiseMonitorTree) ConstructNoiseMonitorOutputList();
+   if(fVetoTable >= 0) ConstructVetoOutputList();  //don't construct this list if tree is not initialized
+   if(fNoiseMonitorTable >= 0) ConstructNoiseMonitorOutputList();
 
    //Call when you are finished making the lists!
    ConfigureOutputTrees();
+
+   if(fUserData.HasStringParameter("ONLINE_SUMMARY_RQS"))
+      ConfigureRQSummaries(fUserData.GetVectStringParameter("ONLINE_SUMMARY_RQS"));
    
    return;
 }
 
+//RQs given as "<tree>/<RQ>" (eventTree, vetoTree, noiseMonitorTree, zip#), as in OUTPUT_PRECISION_FILE
+void BatOutputManager::ConfigureRQSummaries(const vector<string>& rqPaths)
+{
+   for(uint pathItr = 0; pathItr < rqPaths.size(); pathItr++)
+   {
+      const string& path = rqPaths[pathItr];
+      if(path == "none") continue;
+
+      size_t slash = path.find('/');
+      string tree = path.substr(0, slash);
+      string rqName = (slash == string::npos ? "" : path.substr(slash+1));
+
+      map<string,double>* rqMap = NULL;
+      string key = rqName;
+      if(tree == "eventTree")
+	 rqMap = &fEventListMap;
+      else if(tree == "vetoTree")
+	 rqMap = &fVetoListMap;
+      else if(tree == "noiseMonitorTree")
+	 rqMap = &fNoiseMonitorListMap;
+      else if(tree.compare(0, 3, "zip") == 0 && fMapOfZipMaps.count(atoi(tree.c_str()+3)) > 0)
+      {
+	 rqMap = &(fMapOfZipMaps[atoi(tree.c_str()+3)]);
+	 key = tree.substr(3) + "_" + rqName;
+      }
+
+      if(rqMap == NULL || rqMap->count(key) == 0)
+      {
+	 cerr <<"BatOutputManager::ConfigureRQSummaries ERROR! ONLINE_SUMMARY_RQS: " << path
+	      <<" is not an RQ of the output" << endl;
+	 exit(1);
+      }
+
+      RQSummary summary;
+      summary.path = path;
+      summary.value = &((*rqMap)[key]);   //map entries stay in place once the lists are constructed
+      fRQSummaries.push_back(summary);
+   }
+   ResetRQSummaries();
+
+   return;
+}
+
+void BatOutputManager::AccumulateRQSummaries()
+{
+   for(uint sumItr = 0; sumItr < fRQSummaries.size(); sumItr++)
+   {
+      RQSummary& summary = fRQSummaries[sumItr];
+      double value = *(summary.value);
+      if(value == -999999.) continue;   //not set in this event, see ResetLists
+
+      if(summary.n == 0 || value < summary.min) summary.min = value;
+      if(summary.n == 0 || value > summary.max) summary.max = value;
+      summary.n++;
+      summary.sum += value;
+      summary.sumSq += value*value;
+   }
+
+   return;
+}
+
+void BatOutputManager::ResetRQSummaries()
+{
+   for(uint sumItr = 0; sumItr < fRQSummaries.size(); sumItr++)
+   {
+      RQSummary& summary = fRQSummaries[sumItr];
+      summary.n = 0;
+      summary.sum = summary.sumSq = 0.;
+      summary.min = summary.max = 0.;
+   }
+
+   return;
+}
+
+//one line per RQ with the events of the window in which it was set, then a new window starts
+void BatOutputManager::PrintRQSummaries()
+{
+   for(uint sumItr = 0; sumItr < fRQSummaries.size(); sumItr++)
+   {
+      const RQSummary& summary = fRQSummaries[sumItr];
+      cout <<"BatRoot online:    " << summary.path << ": " << summary.n << " events";
+      if(summary.n > 0)
+      {
+	 double mean = summary.sum/summary.n;
+	 double variance = summary.sumSq/summary.n - mean*mean;
+	 cout <<", mean " << mean << ", rms " << (variance > 0. ? sqrt(variance) : 0.)
+	      <<", min " << summary.min << ", max " << summary.max;
+      }
+      cout << endl;
+   }
+   ResetRQSummaries();
+
+   return;
+}
+
 void BatOutputManager::ConstructEventOutputList()
 {
    //unlock list
@@ -323,6 +439,10 @@ void BatOutputManager::ConstructZipOutputList()
      //store these RQs only once per zip
      AddZipListVar("Empty", detNum);  //special RQ to flag selectively read zips
      AddZipListVar("DetType",detNum); //special RQ to store detector type
+     //same condition as EventBuilder::fDoLazyAnalysis: lazy analysis is dropped without trigger processing
+     if(fUserData.HasIntParameter("DO_LAZY_ANALYSIS") && fUserData.GetIntParameter("DO_LAZY_ANALYSIS") == 1 &&
+	fUserData.DoTriggerProcessing())
+       AddZipListVar("LazySkipped", detNum); //special RQ to flag zips that only got the reduced analysis
 
      //Get the list of analyses for this zip from ExtData
 
@@ -454,21 +574,18 @@ void BatOutputManager::ConstructZipOutputList()
 
 void BatOutputManager::StoreOutput(const EventBuilder& eventBuilder) 
 {
+   PROCESSING_TIMER("StoreOutput", 0);
+
    StoreEventOutput(eventBuilder);
    StoreZipOutput(eventBuilder);
-   if(fVetoTree != 0) StoreVetoOutput(eventBuilder); //only store if veto tree has been initialized
-   if(fNoiseMonitorTree) StoreNoiseMonitorOutput(eventBuilder);
+   if(fVetoTable >= 0) StoreVetoOutput(eventBuilder); //only store if veto tree has been initialized
+   if(fNoiseMonitorTable >= 0) StoreNoiseMonitorOutput(eventBuilder);
 
    //Fill the trees & reset values in the list!
    FillTrees();
+   if(!fRQSummaries.empty()) AccumulateRQSummaries();
    ResetLists();
 
-   // Reset RQ list inside external files managers
-    eventBuilder.GetGpibData().ResetRQList();
-    eventBuilder.GetDmmData().ResetRQList();
-    eventBuilder.GetIsrData().ResetRQList();
-
-
    return;
 }
 
@@ -483,34 +600,28 @@ void BatOutputManager::StoreEventOutput(const EventBuilder& eventBuilder)
 
    //from the Admin Record
    //this is another (more automated) way to store RQs in the output
-   map<string, double> adminRQList = eventBuilder.GetAdmin().GetRQList();
-   SetEventListVal(adminRQList);
+   SetEventListVal(eventBuilder.GetAdmin().GetRQList());
 
    //from the External Record
-   map<string, double> externalRQList = eventBuilder.GetGPS().GetRQList();
-   SetEventListVal(externalRQList);
+   SetEventListVal(eventBuilder.GetGPS().GetRQList());
 
    if(fUserData.DoTriggerProcessing() && fUserData.WriteTriggerRQ())
    {
       //from the History Record
-      map<string, double> historyRQList = eventBuilder.GetHistory().GetRQList();
-      SetEventListVal(historyRQList);
+      SetEventListVal(eventBuilder.GetHistory().GetRQList());
       
       //from the Trigger Record
-      map<string, double> triggerRQList = eventBuilder.GetTrigger().GetRQList();
-      SetEventListVal(triggerRQList);
+      SetEventListVal(eventBuilder.GetTrigger().GetRQList());
    }
 
    //from GPIB file 
    if (fUserData.DoRead("GPIB_FILE")) {
-      map<string, double> gpibRQList = eventBuilder.GetGpibData().GetRQList();
-      SetEventListVal(gpibRQList);
+      SetEventListVal(eventBuilder.GetGpibData().GetRQList());
    }
 
    //from ISR file 
    if (fUserData.DoRead("ISR_FILE")) {
-      map<string, double> isrRQList = eventBuilder.GetIsrData().GetEventRQList();
-      SetEventListVal(isrRQList);
+      SetEventListVal(eventBuilder.GetIsrData().GetEventRQList());
    }
 
 
@@ -526,22 +637,20 @@ void BatOutputManager::StoreVetoOutput(const EventBuilder& eventBuilder)
 {
    //====== Store veto tree variables =======
 
-   vector<PulseData> pulseCollection;
-   eventBuilder.FillVetoPulseCollection(pulseCollection);
+   const vector<PulseData>& pulseCollection = eventBuilder.GetVetoPulses();
 
    for(uint pulseItr=0; pulseItr < pulseCollection.size(); pulseItr++)
    {
-      PulseData aPulseData = pulseCollection[pulseItr]; 
+      const PulseData& aPulseData = pulseCollection[pulseItr]; 
       int panelNum = aPulseData.GetDetectorNum();
       
       // ======== Iterate over list of analysis classes and store the RQs  ================
       
-      vector<TCDMSAnalysis> analysisCollection = aPulseData.GetAnalysisCollection(); //only one VetoAnalysis right now!
+      const vector<TCDMSAnalysis>& analysisCollection = aPulseData.GetAnalysisCollection(); //only one VetoAnalysis right now!
       
       for(uint anaItr=0; anaItr < analysisCollection.size(); anaItr++)
       {
-	 map<string,double> rqList = analysisCollection[anaItr].GetRQList(); 
-	 SetVetoListVal(rqList, panelNum);
+	 SetVetoListVal(analysisCollection[anaItr].GetRQList(), panelNum);
 	 
 	 if(fDebugOn) 
 	    cout <<"Storing rq's for veto analysis class: " << analysisCollection[anaItr].GetClassName() << endl;
@@ -559,22 +668,20 @@ void BatOutputManager::StoreNoiseMonitorOutput(const EventBuilder& eventBuilder)
 {
    //====== Store veto tree variables =======
 
-   vector<PulseData> pulseCollection;
-   eventBuilder.FillNoiseMonitorPulseCollection(pulseCollection);
+   const vector<PulseData>& pulseCollection = eventBuilder.GetNoiseMonitorPulses();
 
    for(uint pulseItr=0; pulseItr < pulseCollection.size(); pulseItr++)
    {
-      PulseData aPulseData = pulseCollection[pulseItr]; 
+      const PulseData& aPulseData = pulseCollection[pulseItr]; 
       string chName = aPulseData.GetChannelName();
       if(!fUserData.WriteNoiseMonitorRQ(chName))
 	continue;
       // ======== Iterate over list of analysis classes and store the RQs  ================
-      vector<TCDMSAnalysis> analysisCollection = aPulseData.GetAnalysisCollection(); //only one NoiseMonitorAnalysis right now!
+      const vector<TCDMSAnalysis>& analysisCollection = aPulseData.GetAnalysisCollection(); //only one NoiseMonitorAnalysis right now!
       
       for(uint anaItr=0; anaItr < analysisCollection.size(); anaItr++)
       {
-	 map<string,double> rqList = analysisCollection[anaItr].GetRQList(); 
-	 SetNoiseMonitorListVal(rqList, chName);
+	 SetNoiseMonitorListVal(analysisCollection[anaItr].GetRQList(), chName);
 	 
 	 if(fDebugOn) 
 	    cout <<"Storing rq's for noise monitor analysis class: " << analysisCollection[anaItr].GetClassName() << endl;
@@ -594,9 +701,7 @@ void BatOutputManager::StoreZipOutput(const EventBuilder& eventBuilder)
    //====== Store zip tree variables =======
 
    //Get DMM RQ lists
-    map<int, map<string,double> > dmmRQList;
-    if (fUserData.DoRead("DMM_FILE"))
-      dmmRQList = eventBuilder.GetDmmData().GetAllZipRQList();
+    const map<int, map<string,double> >& dmmRQList = eventBuilder.GetDmmData().GetAllZipRQList();
 
     //Get Detector RQ lists
     map<int, map<string,double> > detstatusRQList;
@@ -605,30 +710,29 @@ void BatOutputManager::StoreZipOutput(const EventBuilder& eventBuilder)
 
    //loop over zips w/ trees and get the pulse collection for each zip
  
-   for(uint zipItr = 0; zipItr < fZipTreeVector.size(); zipItr++)
+   for(uint zipItr = 0; zipItr < fZipTableVector.size(); zipItr++)
    {
-     vector<PulseData> pulseCollection;
-     int zipNum = atoi(fZipTreeVector[zipItr]->GetTitle());
-     eventBuilder.FillSingleZipPulseCollection(pulseCollection, zipNum);
+     int zipNum = fZipTableDetNum[zipItr];
+     const vector<PulseData>& pulseCollection = eventBuilder.GetSingleZipPulses(zipNum);
 
      //save these variables once per zip
      if(pulseCollection.size() != 0) SetZipListVal("Empty", "", 0, zipNum); //special RQ to flag selectively read zips
+     if(eventBuilder.DoLazyAnalysis()) SetZipListVal("LazySkipped", "", eventBuilder.IsLazySkipped(zipNum) ? 1 : 0, zipNum);
      
      //loop over pulses for this zip and store the values, if no pulses than move to next zip
      for(uint pulseItr=0; pulseItr < pulseCollection.size(); pulseItr++)
      {
-       PulseData aPulseData = pulseCollection[pulseItr]; 
+       const PulseData& aPulseData = pulseCollection[pulseItr]; 
        int detNum = aPulseData.GetDetectorNum();
        string chanName = aPulseData.GetChannelName();
      	
        // ======== Iterate over list of analysis classes and store the RQs  ================
 
-       vector<TCDMSAnalysis> analysisCollection = aPulseData.GetAnalysisCollection(); //probably very slow!
+       const vector<TCDMSAnalysis>& analysisCollection = aPulseData.GetAnalysisCollection();
        
        for(uint anaItr=0; anaItr < analysisCollection.size(); anaItr++)
        {
-	  map<string,double> rqList = analysisCollection[anaItr].GetRQList(); 
-	  SetZipListVal(rqList, chanName, detNum);
+	  SetZipListVal(analysisCollection[anaItr].GetRQList(), chanName, detNum);
 
 	  if(fDebugOn) cout <<"Storing rq's for analysis class: " << analysisCollection[anaItr].GetClassName() << endl;
        }
@@ -647,8 +751,7 @@ void BatOutputManager::StoreZipOutput(const EventBuilder& eventBuilder)
      // Store list from DMM/ISR file
       if (fUserData.DoRead("DMM_FILE"))
         {  
-           map<string,double> rqList = (dmmRQList.find(zipNum))->second;
-           SetZipListVal(rqList, "", zipNum);
+           SetZipListVal((dmmRQList.find(zipNum))->second, "", zipNum);
         }
 
       // Store detector status RQs
@@ -686,13 +789,13 @@ void BatOutputManager::ConfigureOutputTrees()
    {
       string name = eventListItr->first;
       if(fDebugOn) cout <<"Adding Branch: " << name+"/D" <<", w/ initial value= " << eventListItr->second << endl;
-      fEventTree->Branch(name.c_str(), &(eventListItr->second), (name+"/D").c_str());
+      fBackend->AddColumn(fEventTable, name, &(eventListItr->second), fPrecisionPolicy.GetPrecision("eventTree", name));
    }
 
    // ==== formatting veto tree ====
 
    //only format if tree is initialized
-   if(fVetoTree != 0)
+   if(fVetoTable >= 0)
    {
       map<string,double>::iterator vetoListItr = fVetoListMap.begin();
       for( ; vetoListItr!=fVetoListMap.end(); vetoListItr++)
@@ -700,14 +803,14 @@ void BatOutputManager::ConfigureOutputTrees()
 	 string name = vetoListItr->first;
 	 if(fDebugOn) 
 	    cout <<"Adding Branch: " << name+"/D" <<", w/ initial value= " << vetoListItr->second << endl;
-	 fVetoTree->Branch(name.c_str(), &(vetoListItr->second), (name+"/D").c_str());
+	 fBackend->AddColumn(fVetoTable, name, &(vetoListItr->second), fPrecisionPolicy.GetPrecision("vetoTree", name));
       }
    }
 
    // ==== formatting noise monitor tree ====
 
    //only format if tree is initialized
-   if(fNoiseMonitorTree != 0)
+   if(fNoiseMonitorTable >= 0)
    {
       map<string,double>::iterator nmListItr = fNoiseMonitorListMap.begin();
       for( ; nmListItr!=fNoiseMonitorListMap.end(); nmListItr++)
@@ -715,7 +818,8 @@ void BatOutputManager::ConfigureOutputTrees()
 	 string name = nmListItr->first;
 	 if(fDebugOn) 
 	    cout <<"Adding Branch: " << name+"/D" <<", w/ initial value= " << nmListItr->second << endl;
-	 fNoiseMonitorTree->Branch(name.c_str(), &(nmListItr->second), (name+"/D").c_str());
+	 fBackend->AddColumn(fNoiseMonitorTable, name, &(nmListItr->second),
+			     fPrecisionPolicy.GetPrecision("noiseMonitorTree", name));
       }
    }
 
@@ -737,14 +841,15 @@ void BatOutputManager::ConfigureOutputTrees()
        string subname = name.substr(breakPoint+1, name.size());
        
        //loop over the zipTreeVector to find the tree that matches the zip number
-       for(uint vitr = 0; vitr < fZipTreeVector.size(); vitr++)
+       for(uint vitr = 0; vitr < fZipTableVector.size(); vitr++)
        {   
-	 int treeZipNum = atoi(fZipTreeVector[vitr]->GetTitle());
+	 int treeZipNum = fZipTableDetNum[vitr];
 	   
 	 //found the corresponding tree
 	 if(rqZipNum == treeZipNum)
 	 {
-	   fZipTreeVector[vitr]->Branch(subname.c_str(), &(zipMapItr->second), (subname+"/D").c_str());
+	   fBackend->AddColumn(fZipTableVector[vitr], subname, &(zipMapItr->second),
+			       fPrecisionPolicy.GetPrecision(Form("zip%d", treeZipNum), subname));
 
 	   if(fDebugOn)
 	      cout <<"Testing string manipulations! " 
@@ -761,19 +866,21 @@ void BatOutputManager::ConfigureOutputTrees()
 
 void BatOutputManager::FillTrees()
 {
+   PROCESSING_TIMER("FillTrees", 0);
+
    // fill event tree
-   fEventTree->Fill();
+   fBackend->Fill(fEventTable);
 
    // fill the veto tree
-   if(fVetoTree != 0) fVetoTree->Fill();  //don't fill if not initialized
+   if(fVetoTable >= 0) fBackend->Fill(fVetoTable);  //don't fill if not initialized
 
    // fill the noise monitor tree
-   if(fNoiseMonitorTree != 0) fNoiseMonitorTree->Fill();  //don't fill if not initialized
+   if(fNoiseMonitorTable >= 0) fBackend->Fill(fNoiseMonitorTable);  //don't fill if not initialized
 
    // fill zip trees
-   for(uint zipItr = 0; zipItr < fZipTreeVector.size(); zipItr++)
+   for(uint zipItr = 0; zipItr < fZipTableVector.size(); zipItr++)
    {
-     fZipTreeVector[zipItr]->Fill();
+     fBackend->Fill(fZipTableVector[zipItr]);
    }
 
    return;
@@ -781,29 +888,8 @@ void BatOutputManager::FillTrees()
 
 void BatOutputManager::WriteTrees()
 {
-   // RQ structure
-   fOutputFile->cd("rqDir");
-
-   // event tree
-   fEventTree->Write();
-   
-   // veto tree
-   if(fVetoTree != 0) 
-   {
-      fVetoTree->Write();
-   }
-
-   // noise monitor tree
-   if(fNoiseMonitorTree != 0) 
-   {
-      fNoiseMonitorTree->Write();
-   }
-
-   // zip tree
-   for(uint zipItr = 0; zipItr < fZipTreeVector.size(); zipItr++)
-   {
-     fZipTreeVector[zipItr]->Write();
-   }
+   // RQ structure: event, veto, noise monitor and zip trees
+   fBackend->Write();
 
 
    //Done writing!
@@ -991,12 +1077,92 @@ void  BatOutputManager::CreateAndWriteProcessingInfoTree(string date, string git
   processingTree->Branch("date", &dateChar, "date/C");
   processingTree->Branch("BatRootGitTag_cdmsbats", &BatRootGitTag_cdmsbats, "BatRootGitTag_cdmsbats/C");
   processingTree->Branch("BatRootGitTag_batcommon", &BatRootGitTag_batcommon, "BatRootGitTag_batcommon/C");
+
+  // === profiling summary (only when written after the event loop, see BatRoot DO_PROFILING) ===
+  bool doProfiling = ProcessingTimer::IsEnabled();
+  double nEvents = 0., wallTime = 0., eventsPerSec = 0., bytesDecompressed = 0., allocations = 0.;
+  if(doProfiling)
+  {
+    map<string, double> counters = ProcessingTimer::GetCounters();
+    nEvents = ProcessingTimer::GetNEvents();
+    wallTime = ProcessingTimer::GetElapsedSec();
+    eventsPerSec = (wallTime > 0.) ? nEvents/wallTime : 0.;
+    bytesDecompressed = counters["BytesDecompressed"];
+    allocations = counters["Allocations"];
+
+    processingTree->Branch("nEvents", &nEvents, "nEvents/D");
+    processingTree->Branch("wallTime", &wallTime, "wallTime/D");
+    processingTree->Branch("eventsPerSec", &eventsPerSec, "eventsPerSec/D");
+    processingTree->Branch("bytesDecompressed", &bytesDecompressed, "bytesDecompressed/D");
+    processingTree->Branch("allocations", &allocations, "allocations/D");
+  }
+
   processingTree->Fill();
   processingTree->Write(); 
+
+  if(doProfiling)
+    CreateAndWriteProcessingTimingTrees();
   
 }
 
 
+void  BatOutputManager::CreateAndWriteProcessingTimingTrees()
+{
+  fOutputFile->cd("infoDir");
+
+  // ==== one entry per (stage, detector) ====
+  TTree *timingTree = new TTree("processingTimingTree","Processing time per stage and detector");
+
+  char stageName[256];
+  int detNum = 0;
+  double nCalls = 0., totalTime = 0., meanTime = 0., maxTime = 0.;
+  timingTree->Branch("stage", &stageName, "stage/C");
+  timingTree->Branch("detNum", &detNum, "detNum/I");
+  timingTree->Branch("nCalls", &nCalls, "nCalls/D");
+  timingTree->Branch("totalTime", &totalTime, "totalTime/D");
+  timingTree->Branch("meanTime", &meanTime, "meanTime/D");
+  timingTree->Branch("maxTime", &maxTime, "maxTime/D");
+
+  vector<ProcessingTimer::StageSummary> summaryList = ProcessingTimer::GetSummary();
+  for(uint stageItr = 0; stageItr < summaryList.size(); stageItr++)
+  {
+    strncpy(stageName, summaryList[stageItr].stageName.c_str(), sizeof(stageName)-1);
+    stageName[sizeof(stageName)-1] = '\0';
+    detNum = summaryList[stageItr].detNum;
+    nCalls = summaryList[stageItr].nCalls;
+    totalTime = summaryList[stageItr].totalSec;
+    meanTime = (nCalls > 0.) ? totalTime/nCalls : 0.;
+    maxTime = summaryList[stageItr].maxSec;
+    timingTree->Fill();
+  }
+  timingTree->Write();
+
+  // ==== per-event timings of the sampled events (PROFILING_SAMPLE_EVERY) ====
+  vector<ProcessingTimer::EventSample> sampleList = ProcessingTimer::GetEventSamples();
+  if(sampleList.empty()) return;
+
+  TTree *sampleTree = new TTree("processingSampleTree","Processing time per stage for sampled events");
+
+  int eventCtr = 0;
+  double time = 0.;
+  sampleTree->Branch("eventCtr", &eventCtr, "eventCtr/I");
+  sampleTree->Branch("stage", &stageName, "stage/C");
+  sampleTree->Branch("detNum", &detNum, "detNum/I");
+  sampleTree->Branch("time", &time, "time/D");
+
+  for(uint sampleItr = 0; sampleItr < sampleList.size(); sampleItr++)
+  {
+    strncpy(stageName, ProcessingTimer::GetStageName(sampleList[sampleItr].stageId).c_str(), sizeof(stageName)-1);
+    stageName[sizeof(stageName)-1] = '\0';
+    eventCtr = sampleList[sampleItr].eventCtr;
+    detNum = sampleList[sampleItr].detNum;
+    time = sampleList[sampleItr].sec;
+    sampleTree->Fill();
+  }
+  sampleTree->Write();
+}
+
+
 
 
 
@@ -8,6 +8,9 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: the RQ tables are stored through an RQOutputBackend (TTree by default, or RNTuple)
+//Oct. 2026: per-RQ storage types from OUTPUT_PRECISION_FILE (RQPrecisionPolicy)
+//Oct. 2026: rolling summaries of the RQs in ONLINE_SUMMARY_RQS for the online mode
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -23,6 +26,7 @@
 
 #include "EventBuilder.h"
 #include "DetectorConfigManager.h"
+#include "RQOutputBackend.h"
 
 using namespace std;
 
@@ -60,6 +64,10 @@ class BatOutputManager
       
       //Processing Info Tree  management
       void CreateAndWriteProcessingInfoTree(string date, string gitTag_cdmsbats,string gitTag_batcommon);
+      void CreateAndWriteProcessingTimingTrees(); //ProcessingTimer summary, called by the above when profiling
+
+      //Online mode: mean, rms, min and max of the ONLINE_SUMMARY_RQS since the last call
+      void PrintRQSummaries();
 
     private:
       
@@ -78,11 +86,28 @@ class BatOutputManager
       // list of detectors
       map< int,int > fDetectorMap;
    
-      //Output RQ Trees
-      TTree* fEventTree;
-      TTree* fVetoTree;
-      TTree* fNoiseMonitorTree;
-      vector<TTree*> fZipTreeVector; 
+      //Output RQ tables (trees), as indices into the backend; -1 if not written
+      RQOutputBackend* fBackend;
+      int fEventTable;
+      int fVetoTable;
+      int fNoiseMonitorTable;
+      vector<int> fZipTableVector;
+      vector<int> fZipTableDetNum;  //detector number of each zip table
+
+      //storage type of each RQ, all double without OUTPUT_PRECISION_FILE
+      RQPrecisionPolicy fPrecisionPolicy;
+
+      //rolling summary of one RQ (ONLINE_SUMMARY_RQS), over the events in which it was set
+      struct RQSummary {
+	 string        path;    //<tree>/<RQ>
+	 const double* value;   //entry of the RQ map
+	 long          n;
+	 double        sum;
+	 double        sumSq;
+	 double        min;
+	 double        max;
+      };
+      vector<RQSummary> fRQSummaries;
       
       //To prevent user from adding entries to the list
       //after the branches are set
@@ -138,6 +163,11 @@ class BatOutputManager
       vector<string> GetChanList(const string& multID, int detType);
       void ResetLists();
 
+      //online RQ summaries
+      void ConfigureRQSummaries(const vector<string>& rqPaths);
+      void AccumulateRQSummaries();
+      void ResetRQSummaries();
+
 
       //other
       DetectorConfigManager fDetectorConfigManager;  
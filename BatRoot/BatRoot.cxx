@@ -16,6 +16,7 @@
 #include <list>
 #include "time.h"
 #include <regex.h>
+#include <sys/time.h>
 
 
 //ROOT Libraries
@@ -43,9 +44,61 @@
 #include "DetectorConfigManager.h"
 #include "BatOutputManager.h"
 #include "PulseTools.h"
+#include "ProcessingTimer.h"
+#include "CountingAllocator.h"   //heap allocations for the DO_PROFILING summary
+#include "CounterRNG.h"
 
 using namespace std;
 
+
+// rolling summary printed every ONLINE_SUMMARY_PERIOD seconds in online mode, followed by the
+// one of the ONLINE_SUMMARY_RQS (BatOutputManager::PrintRQSummaries)
+struct OnlineSummary
+{
+   double windowStartMs;
+   int    nEvents;
+   int    nRandoms;
+   int    nIdlePolls;
+   double sumLatencyMs;
+   double maxLatencyMs;
+   long   nTotalEvents;
+
+   static double NowMs()
+   {
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      return tv.tv_sec*1000. + tv.tv_usec/1000.;
+   }
+
+   void Reset(double nowMs)
+   {
+      windowStartMs = nowMs;
+      nEvents = 0;
+      nRandoms = 0;
+      nIdlePolls = 0;
+      sumLatencyMs = 0.;
+      maxLatencyMs = 0.;
+   }
+
+   //true if the summary was printed and a new window started
+   bool PrintIfDue(double periodSec)
+   {
+      double nowMs = NowMs();
+      double windowSec = (nowMs - windowStartMs)/1000.;
+      if(windowSec < periodSec) return false;
+
+      cout <<"BatRoot online: " << nTotalEvents << " events total, " << nEvents << " in last " << windowSec << " s"
+	   <<" (" << nEvents/windowSec << " Hz, " << nRandoms << " randoms, " << nIdlePolls << " idle polls)";
+      if(nEvents > 0)
+	 cout <<", processing latency mean " << sumLatencyMs/nEvents << " ms, max " << maxLatencyMs << " ms";
+      cout << endl;
+
+      Reset(nowMs);
+      return true;
+   }
+};
+
+
 /////////////////// BEGIN MAIN //////////////////////////////
 
 int main(int argc, char* argv[]){
@@ -547,7 +600,30 @@ int main(int argc, char* argv[]){
    string noisePrefix = myUserData.GetPrefix("NOISE_PREFIX");
    string noiseFile = myUserData.GetPath("NOISE_FILES") + noisePrefix + inputSeries + ".root"; 
    if(myUserData.DoRead("FILTER_FILE"))
+   {
+      // optional binary cache of the filter file, shared by all dumps of the series
+      if(myUserData.HasIntParameter("USE_FILTER_CACHE") && myUserData.GetIntParameter("USE_FILTER_CACHE") == 1)
+      {
+         string cachePath = myUserData.GetPath("NOISE_FILES");
+         if(myUserData.HasStringParameter("FILTER_CACHE_PATH"))
+            cachePath = myUserData.GetStringParameter("FILTER_CACHE_PATH");
+         //the cache is recognized by the contents of the filter file (hash) or, cheaper, by its size and date (stat)
+         FilterDataManager::CacheKey cacheKey = FilterDataManager::kCacheKeyHash;
+         if(myUserData.HasStringParameter("FILTER_CACHE_KEY"))
+         {
+            string cacheKeyName = myUserData.GetStringParameter("FILTER_CACHE_KEY");
+            if(cacheKeyName == "stat")
+               cacheKey = FilterDataManager::kCacheKeyStat;
+            else if(cacheKeyName != "hash")
+            {
+               cerr <<"BatRoot: ERROR! FILTER_CACHE_KEY must be hash or stat, not "<< cacheKeyName << endl;
+               exit(1);
+            }
+         }
+         myFilterData.SetCacheFile(cachePath + noisePrefix + inputSeries + ".filtercache", cacheKey);
+      }
       myFilterData.ReadFile(noiseFile);
+   }
    
    
    //
@@ -649,7 +725,16 @@ int main(int argc, char* argv[]){
    gitTagStream_cdmsbats << cbversion;
    gitTagStream_batcommon << bcversion;
 	
-   if(myUserData.GetIntParameter("WRITE_PROCESS_INFO")) 
+   // with profiling on, the processing info is written after the event loop so it holds the timing summary
+   bool doProfiling = myUserData.HasIntParameter("DO_PROFILING") && myUserData.GetIntParameter("DO_PROFILING") == 1;
+   if(doProfiling)
+   {
+      ProcessingTimer::SetEnabled(true);
+      if(myUserData.HasIntParameter("PROFILING_SAMPLE_EVERY"))
+	 ProcessingTimer::SetSampleEvery(myUserData.GetIntParameter("PROFILING_SAMPLE_EVERY"));
+   }
+
+   if(myUserData.GetIntParameter("WRITE_PROCESS_INFO") && !doProfiling) 
       outputManager.CreateAndWriteProcessingInfoTree(date,gitTagStream_cdmsbats.str(),gitTagStream_batcommon.str());
 
    // store user settings
@@ -710,6 +795,19 @@ int main(int argc, char* argv[]){
        std::string energyInputPath = getenv("BATROOT_ENERGYINPUTDIR");
        eventBuilder.SetSimDataManager(energyInputPath + "/pulseSim_input_" + inputSeries + "_" + dumpNum + ".dat");
        nSimPerEvt = myUserData.GetIntParameter("SIM_N_TIMES_USE_RANDOM");
+
+       // random draws are keyed by (series, event, detector, overlay) and this seed
+       if(myUserData.HasIntParameter("SIM_RANDOM_SEED"))
+	  CounterRNG::SetGlobalSeed(myUserData.GetIntParameter("SIM_RANDOM_SEED"));
+   }
+
+   // SIM_SINGLE_PASS: decode each random once and run all its overlays back to back
+   // (output is then ordered random by random instead of pass by pass)
+   int nOverlaysPerRandom = 1;
+   if(nSimPerEvt > 1 && myUserData.HasIntParameter("SIM_SINGLE_PASS") && myUserData.GetIntParameter("SIM_SINGLE_PASS") == 1)
+   {
+       nOverlaysPerRandom = nSimPerEvt;
+       nSimPerEvt = 1;
    }
 
 
@@ -717,6 +815,16 @@ int main(int argc, char* argv[]){
    // out of a single random. Default value of nSimPerEvt is 1, so this
    // loop is only run more than once if pulse simulation is activated. [AJA]
    int simEvtCtr = 0;
+
+   // online mode: ReadNextEvent returns kNoEventAvailable instead of blocking on the source
+   bool isOnline = eventBuilder.IsOnline();
+   double onlineSummaryPeriod = 10.; //seconds
+   if(myUserData.HasIntParameter("ONLINE_SUMMARY_PERIOD"))
+      onlineSummaryPeriod = myUserData.GetIntParameter("ONLINE_SUMMARY_PERIOD");
+   OnlineSummary onlineSummary;
+   onlineSummary.nTotalEvents = 0;
+   onlineSummary.Reset(OnlineSummary::NowMs());
+
    for(int jEvtSim = 0; jEvtSim < nSimPerEvt; jEvtSim++)
    {
    cout << "Iterating data events for " << jEvtSim << " time\n" ; 
@@ -725,8 +833,21 @@ int main(int argc, char* argv[]){
    //all raw data records are read with call to ReadNextEvent
    //at this time history and trigger record analysis is done
    int evtCtr = 0;
-   while(evtCtr < maxEvents && eventBuilder.ReadNextEvent() != 0)
+   int readStatus = 0;
+   int overlayCtr = 0; //overlays already made from the current random (SIM_SINGLE_PASS), no new read while > 0
+   //maxEvents counts the events read, so the overlays of the last random are all made
+   while(overlayCtr > 0 || (evtCtr < maxEvents && (readStatus = eventBuilder.ReadNextEvent()) != 0))
    {
+      if(readStatus == RawDataReader::kNoEventAvailable)
+      {
+	 onlineSummary.nIdlePolls++;
+	 if(onlineSummary.PrintIfDue(onlineSummaryPeriod))
+	    outputManager.PrintRQSummaries();
+	 continue;
+      }
+      double evtStartMs = isOnline ? OnlineSummary::NowMs() : 0.;
+      ProcessingTimer::BeginEvent();
+
       //
       // ======= Getting Admin Info  ========
       //
@@ -739,6 +860,12 @@ int main(int argc, char* argv[]){
 	if(eventBuilder.GetEventCategory() != 0x1){
 	      continue;
 	} else{
+	      if(nOverlaysPerRandom > 1)
+	      {
+		 if(overlayCtr == 0) eventBuilder.KeepRandomForOverlays();
+		 else eventBuilder.RestoreRandomForOverlay();
+	      }
+	      eventBuilder.SetSimOverlayIndex(nOverlaysPerRandom > 1 ? overlayCtr : jEvtSim);
 	      eventBuilder.ReadSimEvent();
         }
 	  cout <<"\nSIM Event Number = " << simEvtCtr ;
@@ -855,6 +982,18 @@ int main(int argc, char* argv[]){
 	      
 
 
+	 // DO_LAZY_ANALYSIS mode
+	 // Untriggered detectors (and not adjacent to a triggered one if 
+	 // LAZY_ANALYSIS_NEIGHBORS) only get the basic pulse calc and the
+	 // standard optimal filters; the other RQs keep their default value
+	 bool doFullAnalysis = eventBuilder.DoFullAnalysis(detNum);
+
+
+	 // FFT of all the pulses of the detector at once, used by the optimal filters
+	 // (after the simulations, which rewrite the pulses); skipped if none of them runs
+	 eventBuilder.DoPulseFFTs(detNum, doFullAnalysis);
+
+
 	 //
 	 //  --------- Phonon Pulse Algorithms ---------
          //
@@ -864,7 +1003,7 @@ int main(int argc, char* argv[]){
 
          // All channels
 
-         if( myUserData.DoAlgorithm(detNum,"phonon", "InflectionTime") ) 
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum,"phonon", "InflectionTime") ) 
            eventBuilder.DoInflectionTime(detNum, "phonon");
 
     	 
@@ -872,54 +1011,54 @@ int main(int argc, char* argv[]){
   	   eventBuilder.DoOptimalFilterPhonon(detNum, "phonon");
 
 
-	 if(myUserData.DoAlgorithm(detNum, "phonon","OptimalFilterPhononDMC"))
+	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon","OptimalFilterPhononDMC") )
 	   eventBuilder.DoOptimalFilterPhononDMC(detNum, "phonon");
 
 	 
-	 if( myUserData.DoAlgorithm(detNum, "phonon", "OptimalFilterPhonon1X2") ) 
+	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "OptimalFilterPhonon1X2") ) 
 	   eventBuilder.DoOptimalFilterPhonon1X2(detNum, "phonon");
 
 
- 	 if( myUserData.DoAlgorithm(detNum, "phonon", "ConstFreqRTFTWalkPhonon") ) 
+ 	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "ConstFreqRTFTWalkPhonon") ) 
 	   eventBuilder.DoConstFreqRTFTWalkPhonon(detNum, "phonon", "filtered");
 	 
 
-  	 if( myUserData.DoAlgorithm(detNum, "phonon", "VarFreqRTFTWalkPhonon") )
+  	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "VarFreqRTFTWalkPhonon") )
   	   eventBuilder.DoVarFreqRTFTWalkPhonon(detNum, "phonon", "filtered"); 
 
 
-         if( myUserData.DoAlgorithm(detNum, "phonon", "PulseIntegral") )
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "PulseIntegral") )
            eventBuilder.DoPulseIntegral(detNum, "phonon", "filtered");  
 	 
 
-  	 if( myUserData.DoAlgorithm(detNum,  "phonon", "NoiseSelector") )
+  	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum,  "phonon", "NoiseSelector") )
  	   eventBuilder.DoNoiseSelector(detNum, "phonon"); 
 
 
-  	 if( myUserData.DoAlgorithm(detNum, "phonon", "PipeFitPhonon") )
+  	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "PipeFitPhonon") )
   	   eventBuilder.DoPipeFitPhonon(detNum, "phonon");  
 	 
 
-	 if( myUserData.DoAlgorithm(detNum, "phonon", "WedgeFitPhonon") )
+	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "WedgeFitPhonon") )
 	   eventBuilder.DoWedgeFitPhonon(detNum, "phonon"); 
 
 
      
          // PT only
          
-         if( myUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononGlitch1")) 
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononGlitch1") ) 
   	   eventBuilder.DoOptimalFilterPhononGlitch1(detNum, "phonon");
             
 
-         if( myUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononLFnoise1")) 
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononLFnoise1") ) 
   	   eventBuilder.DoOptimalFilterPhononLFnoise1(detNum, "phonon");
                         
   
-         if( myUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononNS") ) 
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononNS") ) 
             eventBuilder.DoOptimalFilterPhononNS(detNum, "phonon");
 
          
-         if( myUserData.DoAlgorithm(detNum, "PT", "PSDIntegralPhonon") ) 
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "PT", "PSDIntegralPhonon") ) 
            eventBuilder.DoPSDIntegralPhonon(detNum, "phonon");
 	 
  
@@ -930,7 +1069,7 @@ int main(int argc, char* argv[]){
  	 //  --------  Charge Algorithms ---------------
          //
 
-  	 if( myUserData.DoAlgorithm(detNum, "charge", "RTFTWalkCharge") ) 
+  	 if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "charge", "RTFTWalkCharge") ) 
   	   eventBuilder.DoRTFTWalkCharge(detNum, "charge", "filtered");
 
 
@@ -950,11 +1089,11 @@ int main(int argc, char* argv[]){
 
 
 
-         if( myUserData.DoAlgorithm(detNum, "charge", "OptimalFilterCharge2X2") )
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "charge", "OptimalFilterCharge2X2") )
            eventBuilder.DoOptimalFilterCharge2X2(detNum);
      	 
  
-         if( myUserData.DoAlgorithm(detNum, "charge", "F5ChargeX") ) 
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "charge", "F5ChargeX") ) 
          {
            if (detType==BatRootTypes::kiZIPSoudan) {
               eventBuilder.DoF5ChargeX(detNum,"S1");
@@ -970,7 +1109,7 @@ int main(int argc, char* argv[]){
          //  ----- Phonon algorithms that might need charge informations -----
 
          // TailfitPhonon: need charge OF delay
-         if( myUserData.DoAlgorithm(detNum, "phonon", "TailFitPhonon") )
+         if( doFullAnalysis && myUserData.DoAlgorithm(detNum, "phonon", "TailFitPhonon") )
 	   eventBuilder.DoTailFitPhonon(detNum, "phonon"); 
 
 
@@ -987,7 +1126,23 @@ int main(int argc, char* argv[]){
 	      simEvtCtr++;
 
       outputManager.StoreOutput(eventBuilder);
-      evtCtr++;
+      ProcessingTimer::EndEvent();
+
+      if(nOverlaysPerRandom > 1)
+	 overlayCtr = (overlayCtr+1 < nOverlaysPerRandom) ? overlayCtr+1 : 0;
+      if(overlayCtr == 0) evtCtr++;
+
+      if(isOnline)
+      {
+	 double latencyMs = OnlineSummary::NowMs() - evtStartMs;
+	 onlineSummary.nEvents++;
+	 onlineSummary.nTotalEvents++;
+	 if(eventBuilder.GetEventCategory() == 0x1) onlineSummary.nRandoms++;
+	 onlineSummary.sumLatencyMs += latencyMs;
+	 if(latencyMs > onlineSummary.maxLatencyMs) onlineSummary.maxLatencyMs = latencyMs;
+	 if(onlineSummary.PrintIfDue(onlineSummaryPeriod))
+	    outputManager.PrintRQSummaries();
+      }
 
    }
    // Rewind to the first event if in pulse simulation mode and using
@@ -1002,6 +1157,14 @@ int main(int argc, char* argv[]){
 
   cout <<"\nDone looping over events, now storing data!" << endl;
 
+  if(doProfiling)
+  {
+     cout <<"BatRoot: processed " << ProcessingTimer::GetNEvents() << " events in "
+	  << ProcessingTimer::GetElapsedSec() << " s" << endl;
+     if(myUserData.GetIntParameter("WRITE_PROCESS_INFO"))
+	outputManager.CreateAndWriteProcessingInfoTree(date,gitTagStream_cdmsbats.str(),gitTagStream_batcommon.str());
+  }
+
   outputManager.WriteTrees();
 
   cout <<"Goodbye from BatRoot!" << endl;
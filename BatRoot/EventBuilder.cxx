@@ -8,6 +8,8 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: lazy ADC unpacking and skipping of unprocessed zips in the raw reader
+//           (RAW_LAZY_UNPACKING, RAW_SKIP_UNPROCESSED)
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -20,6 +22,7 @@
 
 #include "PulseTools.h"
 #include "ChannelMapHelper.h"
+#include "ProcessingTimer.h"
 #include "EventBuilder.h"
 
 //User Analysis Classes - DO NOT modify or copy this comment (for auto_analysis)
@@ -57,7 +60,9 @@ EventBuilder::EventBuilder(UserDataManager& myUserData, DetectorConfigManager& m
    fUserData(myUserData),
    fReadIsr(true),
    fReadInfo(true),
-   fDetectorConfigManager(myDetectorConfigManager)
+   fDetectorConfigManager(myDetectorConfigManager),
+   fEventSource(NULL),
+   fSimOverlayIndex(0)
 {
    //cout <<"Constructing EventBuilder" << endl;
 
@@ -83,9 +88,79 @@ EventBuilder::EventBuilder(UserDataManager& myUserData, DetectorConfigManager& m
    fReadIsr = fUserData.DoRead("ISR_FILE");
    fReadInfo = fUserData.DoRead("INFO_FILE");
 
+   // trigger-aware analysis needs the trigger/history records to make its decision
+   fDoLazyAnalysis = (fUserData.HasIntParameter("DO_LAZY_ANALYSIS") && 
+		      fUserData.GetIntParameter("DO_LAZY_ANALYSIS") == 1);
+   fLazyAnalysisNeighbors = (fUserData.HasIntParameter("LAZY_ANALYSIS_NEIGHBORS") && 
+			     fUserData.GetIntParameter("LAZY_ANALYSIS_NEIGHBORS") == 1);
+
+   if(fDoLazyAnalysis && !fUserData.DoTriggerProcessing())
+   {
+      cout <<"EventBuilder::WARNING!  DO_LAZY_ANALYSIS requested without trigger processing,"
+	   <<" all detectors will be fully analyzed." << endl;
+      fDoLazyAnalysis = false;
+   }
+
+   // --- online mode: events come from a MidasEventSource instead of the raw file ---
+
+   if(fUserData.HasStringParameter("ONLINE_SOURCE") && fUserData.GetStringParameter("ONLINE_SOURCE") != "none")
+   {
+      string sourceSpec = fUserData.GetStringParameter("ONLINE_SOURCE");
+      fEventSource = MidasEventSource::Create(sourceSpec);
+      if(fEventSource == NULL)
+      {
+	 cerr <<"EventBuilder::ERROR!  Unknown ONLINE_SOURCE " << sourceSpec 
+	      <<" (expected shm:<ring name>, tail:<file> or midas:<buffer>)" << endl;
+	 exit(1);
+      }
+
+      int pollTimeoutMs = 10;
+      if(fUserData.HasIntParameter("ONLINE_POLL_MS"))
+	 pollTimeoutMs = fUserData.GetIntParameter("ONLINE_POLL_MS");
+
+      fRawReader.RegisterEventSource(fEventSource, pollTimeoutMs);
+      cout <<"EventBuilder: online mode, reading events from " << fEventSource->GetName() << endl;
+   }
+
 
    // --- open the file ---
 
+   // decompression thread ahead of the event loop (RAW_READAHEAD_BUFFERS = 0 reads synchronously)
+   int readAheadBuffers = 4;
+   int readAheadMB = 4;
+   if(fUserData.HasIntParameter("RAW_READAHEAD_BUFFERS"))
+      readAheadBuffers = fUserData.GetIntParameter("RAW_READAHEAD_BUFFERS");
+   if(fUserData.HasIntParameter("RAW_READAHEAD_MB"))
+      readAheadMB = fUserData.GetIntParameter("RAW_READAHEAD_MB");
+   fRawReader.SetReadAhead(readAheadBuffers, readAheadMB);
+
+   // decompression backend, zlib or libdeflate (RAW_INFLATE_THREADS = 0 uses all cpus)
+   string inflateBackend = "zlib";
+   int inflateThreads = 0;
+   if(fUserData.HasStringParameter("RAW_INFLATE_BACKEND"))
+      inflateBackend = fUserData.GetStringParameter("RAW_INFLATE_BACKEND");
+   if(fUserData.HasIntParameter("RAW_INFLATE_THREADS"))
+      inflateThreads = fUserData.GetIntParameter("RAW_INFLATE_THREADS");
+   fRawReader.SetInflateBackend(inflateBackend, inflateThreads);
+
+   // pulse decoding: the ADC values are unpacked when the trace is first used (RAW_LAZY_UNPACKING = 0
+   // unpacks them as the records are read), RAW_SKIP_UNPROCESSED = 1 skips the pulse records of the
+   // zips not selected by DO_PROCESSING
+   fRawReader.SetLazyPulseUnpacking(!fUserData.HasIntParameter("RAW_LAZY_UNPACKING") ||
+				    fUserData.GetIntParameter("RAW_LAZY_UNPACKING") == 1);
+   if(fUserData.HasIntParameter("RAW_SKIP_UNPROCESSED") && fUserData.GetIntParameter("RAW_SKIP_UNPROCESSED") == 1)
+   {
+      if(fUserData.DoModifyRawData())
+	 cout <<"EventBuilder::WARNING!  RAW_SKIP_UNPROCESSED ignored, raw data modification may remap detectors." << endl;
+      else
+      {
+	 vector<int> processedZips;
+	 for(int detNum = 1; detNum <= fUserData.GetMaxZIPs(); detNum++)
+	    if(fUserData.DoZipProcessing(detNum)) processedZips.push_back(detNum);
+	 fRawReader.SetDetectorSelection(processedZips);
+      }
+   }
+
    fRawReader.OpenRawDataFile(fUserData.GetPath("RAW_DATA"), inputRawDataFile);
    
    // reads the file header
@@ -111,6 +186,7 @@ EventBuilder::EventBuilder(UserDataManager& myUserData, DetectorConfigManager& m
 
 EventBuilder::~EventBuilder()
 {
+   delete fEventSource;
 }
 
 uint32_t EventBuilder::GetEventCategory()
@@ -122,12 +198,13 @@ int EventBuilder::ReadNextEvent()
 {
    //First clear data containers of previous event's data
    fRawReader.Clear();
+   fLazySkipMap.clear();
 
    //Read the event!
    int checkStatus = fRawReader.ReadRawDataRecord();
 
    // Modify pulse data if needed
-   if (checkStatus && fUserData.DoModifyRawData()) {
+   if (checkStatus > 0 && fUserData.DoModifyRawData()) {
      
       map<int, string> modificationMap = fUserData.GetRawDataModificationMap();
   
@@ -150,12 +227,13 @@ int EventBuilder::ReadEventN(int eventN)
 {
    //First clear data containers of previous event's data
    fRawReader.Clear();
+   fLazySkipMap.clear();
 
    //Read the event!
    int checkStatus = fRawReader.ReadRawDataRecord(eventN);
 
    // Modify pulse data if needed
-   if (checkStatus && fUserData.DoModifyRawData()) {
+   if (checkStatus > 0 && fUserData.DoModifyRawData()) {
      
       map<int, string> modificationMap = fUserData.GetRawDataModificationMap();
    
@@ -200,6 +278,42 @@ void EventBuilder::ReadSimEvent()
 }
 
 
+void EventBuilder::KeepRandomForOverlays()
+{
+    //before any analysis has touched the pulses (simulation overwrites the BSN traces)
+    fOverlayRandomNZipPulses.clear();
+    map< int, vector<PulseData> >::iterator mapItr;
+    for(mapItr = fMapOfZipPulses.begin(); mapItr != fMapOfZipPulses.end(); mapItr++)
+    {
+	fOverlayRandomNZipPulses[mapItr->first] = mapItr->second.size();
+	for(uint pulseItr = 0; pulseItr < mapItr->second.size(); pulseItr++)
+	    mapItr->second[pulseItr].KeepForOverlays();
+    }
+    for(uint pulseItr = 0; pulseItr < fVectorOfVetoPulses.size(); pulseItr++)
+	fVectorOfVetoPulses[pulseItr].KeepForOverlays();
+    for(uint pulseItr = 0; pulseItr < fVectorOfNoiseMonitorPulses.size(); pulseItr++)
+	fVectorOfNoiseMonitorPulses[pulseItr].KeepForOverlays();
+}
+
+
+void EventBuilder::RestoreRandomForOverlay()
+{
+    map< int, vector<PulseData> >::iterator mapItr;
+    for(mapItr = fMapOfZipPulses.begin(); mapItr != fMapOfZipPulses.end(); mapItr++)
+    {
+	vector<PulseData>& zipPulseList = mapItr->second;
+	zipPulseList.resize(fOverlayRandomNZipPulses[mapItr->first]);   //drops the sum pulses
+	for(uint pulseItr = 0; pulseItr < zipPulseList.size(); pulseItr++)
+	    zipPulseList[pulseItr].RestoreForOverlay();
+    }
+    for(uint pulseItr = 0; pulseItr < fVectorOfVetoPulses.size(); pulseItr++)
+	fVectorOfVetoPulses[pulseItr].RestoreForOverlay();
+    for(uint pulseItr = 0; pulseItr < fVectorOfNoiseMonitorPulses.size(); pulseItr++)
+	fVectorOfNoiseMonitorPulses[pulseItr].RestoreForOverlay();
+    fLazySkipMap.clear();
+}
+
+
 void EventBuilder::SetPulseLibManager(vector<string> filename)
 {
     map<int, int> detectorMap = fDetectorConfigManager.GetDetectorMap();
@@ -210,7 +324,8 @@ void EventBuilder::SetPulseLibManager(vector<string> filename)
 	std::cout << "\t" << it->first << " " << it->second << "\n";
       }
     cout << "  EndMap" << endl;
-    fSimLibManager.setLibraryFile(filename, detectorMap);
+    bool preload = fUserData.HasIntParameter("SIM_PRELOAD_LIBRARY") && fUserData.GetIntParameter("SIM_PRELOAD_LIBRARY") == 1;
+    fSimLibManager.setLibraryFile(filename, detectorMap, preload);
 }
 
 
@@ -219,6 +334,8 @@ void EventBuilder::SetPulseLibManager(vector<string> filename)
 //This class calculates RMS, MaxADC, Baseline, BaselineSubtraction and checks if pulse is Saturated
 void EventBuilder::DoBasicPulseCalc(int detNum)
 {
+   PROCESSING_TIMER("DoBasicPulseCalc", detNum);
+
     int detType = 0; //for calculating sum of pulses
     //retrieve the vector of pulses for this zip 
     vector<PulseData>* zipPulseList;
@@ -318,7 +435,7 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
 	  //store these for convenient access in PulseData for additional pulse analysis calls
 
 	  aPulseData->fBSPulseVector  = tempBasicPulseCalc.GetBaselineSubPulse(); //save baseline subtracted pulse
-	  aPulseData->fBSNPulseVector = tempBasicPulseCalc.GetBaselineSubNormPulse(); //save baseline subtracted AND normalized pulse (same as BaselineSub if ISR is not read)
+	  aPulseData->SetBaselineSubNormPulse(tempBasicPulseCalc.GetBaselineSubNormPulse()); //save baseline subtracted AND normalized pulse (same as BaselineSub if ISR is not read)
 	  
 	  //store instance of this class so RQs can be read out later
 	  aPulseData->StorePulseAnalysis(tempBasicPulseCalc);
@@ -334,20 +451,20 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
 
 
           // relative calibration          
-	  double pulseCalib = fUserData.GetRelativeCalibration(detNum, detType, chanName);
+	  double pulseCalib = fUserData.GetRelativeCalibration(detNum, detType, aPulseData->GetDetectorChannel());
 
 
           // TOTAL phonon pulse  (sum of all phonon channels)
 
 	  if(phononSumPulse.size() == 0)
 	  {
-	     phononSumPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	     phononSumPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	     phononSumBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	     phononSumBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 	  
 	  } else {
 	  
-	     vector<double> tempPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	     vector<double> tempPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	     vector<double> tempBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	     vector<double> tempBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 
@@ -364,13 +481,13 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
           
            if(phononSumS1Pulse.size() == 0)
 	     {
-	       phononSumS1Pulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       phononSumS1Pulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       phononSumS1BSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       phononSumS1BSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 	  
 	     } else {
 	  
-	       vector<double> tempPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       vector<double> tempPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 
@@ -387,13 +504,13 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
           
            if(phononSumS2Pulse.size() == 0)
 	     {
-	       phononSumS2Pulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       phononSumS2Pulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       phononSumS2BSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       phononSumS2BSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 	  
 	     } else {
 	  
-	       vector<double> tempPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       vector<double> tempPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 
@@ -427,7 +544,7 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
 
        phononSumPulseData.fPulseVector = phononSumPulse;
        phononSumPulseData.fBSPulseVector = phononSumBSPulse;
-       phononSumPulseData.fBSNPulseVector = phononSumBSNPulse;
+       phononSumPulseData.SetBaselineSubNormPulse(phononSumBSNPulse);
 
        //store the PT PulseData object
        zipPulseList->push_back(phononSumPulseData);
@@ -456,7 +573,7 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
 
          phononSumS1PulseData.fPulseVector = phononSumS1Pulse;
          phononSumS1PulseData.fBSPulseVector = phononSumS1BSPulse;
-         phononSumS1PulseData.fBSNPulseVector = phononSumS1BSNPulse;
+         phononSumS1PulseData.SetBaselineSubNormPulse(phononSumS1BSNPulse);
 
          //store the S1 PulseData object
          zipPulseList->push_back(phononSumS1PulseData);
@@ -479,7 +596,7 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
 
          phononSumS2PulseData.fPulseVector = phononSumS2Pulse;
          phononSumS2PulseData.fBSPulseVector = phononSumS2BSPulse;
-         phononSumS2PulseData.fBSNPulseVector = phononSumS2BSNPulse;
+         phononSumS2PulseData.SetBaselineSubNormPulse(phononSumS2BSNPulse);
 
          //store the S2 PulseData object
          zipPulseList->push_back(phononSumS2PulseData);
@@ -494,9 +611,43 @@ void EventBuilder::DoBasicPulseCalc(int detNum)
 
 
 
+// The optimal filters of all channels (sums included) transform the same pulses; doing them
+// here in one batch shares the FFTW plan between the channels.  Must come after anything
+// which rewrites the pulses (DoBasicPulseCalc, the simulations).
+void EventBuilder::DoPulseFFTs(int detNum, bool doFullAnalysis)
+{
+   //only the optimal filters use the cached FFTs, as called from BatRoot
+   bool useFFTs = (fUserData.DoAlgorithm(detNum, "phonon", "OptimalFilterPhonon") ||
+		   fUserData.DoAlgorithm(detNum, "charge", "OptimalFilterCharge") ||
+		   fUserData.DoAlgorithm(detNum, "charge", "OptimalFilterChargeX"));
+
+   if(!useFFTs && doFullAnalysis)
+      useFFTs = (fUserData.DoAlgorithm(detNum, "phonon", "OptimalFilterPhononDMC") ||
+		 fUserData.DoAlgorithm(detNum, "phonon", "OptimalFilterPhonon1X2") ||
+		 fUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononGlitch1") ||
+		 fUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononLFnoise1") ||
+		 fUserData.DoAlgorithm(detNum, "PT", "OptimalFilterPhononNS") ||
+		 fUserData.DoAlgorithm(detNum, "charge", "OptimalFilterCharge2X2"));
+
+   if(!useFFTs)
+      return;
+
+   PROCESSING_TIMER("DoPulseFFTs", detNum);
+
+   map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
+   if(mapItr != fMapOfZipPulses.end())
+      PulseData::CalcBaselineSubNormPulseFFTs(mapItr->second);
+
+   return;
+}
+
+
+
 
 void EventBuilder::DoNoiseSelector(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoNoiseSelector", detNum);
+
    
     //retrieve the vector of pulses for this zip
     vector<PulseData>* zipPulseList;
@@ -568,6 +719,8 @@ void EventBuilder::DoNoiseSelector(int detNum, const string& sensorType)
 
 void EventBuilder::DoVarFreqRTFTWalkPhonon(int detNum, const string& sensorType, const string& pulseType)
 {
+   PROCESSING_TIMER("DoVarFreqRTFTWalkPhonon", detNum);
+
     //retreive the vector of pulses for this zip
     vector<PulseData>* zipPulseList;
     map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -690,6 +843,8 @@ void EventBuilder::DoVarFreqRTFTWalkPhonon(int detNum, const string& sensorType,
 
 void EventBuilder::DoRTFTWalkCharge(int detNum, const string& sensorType, const string& pulseType)
 {
+   PROCESSING_TIMER("DoRTFTWalkCharge", detNum);
+
    //retrieve the vector of pulses for this zip
    vector<PulseData>* zipPulseList;
    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -768,6 +923,8 @@ void EventBuilder::DoRTFTWalkCharge(int detNum, const string& sensorType, const
 //This is the original algorithm ported from DarkPipe
 void EventBuilder::DoConstFreqRTFTWalkPhonon(int detNum, const string& sensorType,  const string& pulseType)
 {
+   PROCESSING_TIMER("DoConstFreqRTFTWalkPhonon", detNum);
+
     //retreive the vector of pulses for this zip
     vector<PulseData>* zipPulseList;
     map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -856,6 +1013,8 @@ void EventBuilder::DoConstFreqRTFTWalkPhonon(int detNum, const string& sensorTyp
 
 void EventBuilder::DoPulseIntegral(int detNum, const string& sensorType, const string& pulseType)
 {
+   PROCESSING_TIMER("DoPulseIntegral", detNum);
+
    //retrive the vector of pulses for this zip
    vector<PulseData>* zipPulseList;
    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -943,6 +1102,8 @@ void EventBuilder::DoPulseIntegral(int detNum, const string& sensorType, const s
 
 void EventBuilder::DoTailFitPhonon(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoTailFitPhonon", detNum);
+
      
 
     // get pulses for detector detNum
@@ -1155,6 +1316,8 @@ void EventBuilder::DoTailFitPhonon(int detNum, const string& sensorType)
 //will run on the fake pulse.  The class is meant to only run on randoms
 void EventBuilder::DoSimulatePhononFromRandoms(int detNum)
 {
+   PROCESSING_TIMER("DoSimulatePhononFromRandoms", detNum);
+
     //skip if not a random triggered event
     //BatRoot main should take care of this check, 
     //repeating here just in case
@@ -1211,7 +1374,7 @@ void EventBuilder::DoSimulatePhononFromRandoms(int detNum)
 		if(chanName == "PT" || chanName == "PS1" || chanName == "PS2")
 		    pRelCal = 1.0;
 		else
-		    pRelCal = fUserData.GetRelativeCalibration(detNum, detType, chanName);
+		    pRelCal = fUserData.GetRelativeCalibration(detNum, detType, aPulseData->GetDetectorChannel());
 
 		// inject the pulse
 		tempSimulateFromRandoms.SimPMonoenergetic(aPulse, eventEnergies[chanName], ptCal * pRelCal); 	   
@@ -1219,7 +1382,7 @@ void EventBuilder::DoSimulatePhononFromRandoms(int detNum)
 		//Overwrite the baseline subtracted, normalized pulse 
 		//with the modified trace.  All fitting routines run 
 		//after this point will run on the modified trace.
-		aPulseData->fBSNPulseVector = aPulse;
+		aPulseData->SetBaselineSubNormPulse(aPulse);
 		
 		//store instance of this class so RQs can be read out a little later
 		aPulseData->StorePulseAnalysis(tempSimulateFromRandoms);    
@@ -1233,6 +1396,8 @@ void EventBuilder::DoSimulatePhononFromRandoms(int detNum)
 
 void EventBuilder::DoSimulateFromPulse(int detNum, vector<string> filename, int thEvt)
 {
+   PROCESSING_TIMER("DoSimulateFromPulse", detNum);
+
     //skip if not a random triggered event
     //BatRoot main should take care of this check, 
     //repeating here just in case
@@ -1254,11 +1419,14 @@ void EventBuilder::DoSimulateFromPulse(int detNum, vector<string> filename, int
     if(eventEnergies.size() == 0)
         return;
 
-    // get pulse from the library
+    // get pulse from the library (library files are numbered in the order given to SetPulseLibManager)
     if(thEvt<0)
-      fSimLibManager.readRandomEvent(detNum, filename[libNum]);
+    {
+      CounterRNG rng(fAdminData.GetSeries(), fAdminData.GetEvent(), detNum, fSimOverlayIndex, CounterRNG::kLibraryDraw);
+      fSimLibManager.readRandomEvent(detNum, libNum, rng);
+    }
     else
-      fSimLibManager.readEvent(thEvt, detNum, filename[libNum]);
+      fSimLibManager.readEvent(thEvt, detNum, libNum);
     map<string, vector<double>* > pulseMap = fSimLibManager.getPulseMap(detNum);
     map<string, double> chanAmp = fSimLibManager.getChanAmps();
     double eventNum = fSimLibManager.getEventNum();
@@ -1323,7 +1491,7 @@ void EventBuilder::DoSimulateFromPulse(int detNum, vector<string> filename, int
 	    if(chanName[0] == 'P')
 		chanCal = fUserData.GetOverallPTCalibrationTI(detNum, detType);
 	    else if(chanName[0] == 'Q')
-		chanCal = fUserData.GetQCalibration(detNum, detType, chanName);
+		chanCal = fUserData.GetQCalibration(detNum, detType, aPulseData->GetDetectorChannel());
 	    else
 		std::cout << "ERROR in EventBuilder::DoSimulateFromPulse: channel name is neither phonon nor charge!!" << std::endl;
 	    
@@ -1335,7 +1503,7 @@ void EventBuilder::DoSimulateFromPulse(int detNum, vector<string> filename, int
 	    //Overwrite the baseline subtracted, normalized pulse 
 	    //with the modified trace.  All fitting routines run 
 	    //after this point will run on the modified trace.
-	    aPulseData->fBSNPulseVector = aPulse;
+	    aPulseData->SetBaselineSubNormPulse(aPulse);
 		
 	    //store instance of this class so RQs can be read out a little later
 	    aPulseData->StorePulseAnalysis(tempSimulateFromRandoms);
@@ -1353,6 +1521,8 @@ void EventBuilder::DoSimulateFromPulse(int detNum, vector<string> filename, int
 //the noise. The class is meant to only run on randoms
 void EventBuilder::DoSimulateChargeFromRandoms(int detNum)
 {
+   PROCESSING_TIMER("DoSimulateChargeFromRandoms", detNum);
+
   //skip if not a random triggered event
   //BatRoot main should take care of this check, 
   //repeating here just in case
@@ -1396,7 +1566,7 @@ void EventBuilder::DoSimulateChargeFromRandoms(int detNum)
 
         // get the calibration for this channel
         int detType = aPulseData->GetDetectorType();
-        double pulseCalib = fUserData.GetQCalibration(detNum, detType, chanName);
+        double pulseCalib = fUserData.GetQCalibration(detNum, detType, aPulseData->GetDetectorChannel());
         
         // inject pulse into charge template
         tempSimulateFromRandoms.SimQMonoenergetic(aPulse, eventEnergies, pulseCalib, chanName);
@@ -1404,7 +1574,7 @@ void EventBuilder::DoSimulateChargeFromRandoms(int detNum)
         //Overwrite the baseline subtracted, normalized pulse 
         //with the modified trace.  All fitting routines run 
         //after this point will run on the modified trace.
-        aPulseData->fBSNPulseVector = aPulse;
+        aPulseData->SetBaselineSubNormPulse(aPulse);
 
         //store instance of this class so RQs can be read out a little later
         aPulseData->StorePulseAnalysis(tempSimulateFromRandoms);
@@ -1423,6 +1593,8 @@ void EventBuilder::DoSimulateChargeFromRandoms(int detNum)
 //Modify this as needed to correctly call your class
 void EventBuilder::DoOptimalFilterPhonon1X2(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoOptimalFilterPhonon1X2", detNum);
+
 
     //retrive the vector of pulses for this zip
     vector<PulseData>* zipPulseList;
@@ -1509,7 +1681,7 @@ void EventBuilder::DoOptimalFilterPhonon1X2(int detNum, const string& sensorType
            vector<double> aPulse = aPulseData->GetBaselineSubNormPulse();//(norm = 1 when isr is not read)
            
            
-           tempOptimalFilterPhonon1X2.DoCalc(aPulse);
+           tempOptimalFilterPhonon1X2.DoCalc(aPulse, aPulseData->GetBaselineSubNormPulseFFT());
            
            //store instance of this class so RQs can be read out a little later
            aPulseData->StorePulseAnalysis(tempOptimalFilterPhonon1X2);
@@ -1524,6 +1696,8 @@ void EventBuilder::DoOptimalFilterPhonon1X2(int detNum, const string& sensorType
 //Modify this as needed to correctly call your class
 void EventBuilder::DoOptimalFilterPhononNS(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoOptimalFilterPhononNS", detNum);
+
      
     //retrive the vector of pulses for this zip
     vector<PulseData>* zipPulseList;
@@ -1639,7 +1813,7 @@ void EventBuilder::DoOptimalFilterPhononNS(int detNum, const string& sensorType)
 
 	
           if(PTOFAmps*1e8>ptThresh || isRandom){
-            tempOptimalFilterPhononNS.DoCalc(aBSNPulse);
+            tempOptimalFilterPhononNS.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
           }
 	  
 	  //store instance of this class so RQs can be read out a little later
@@ -1669,6 +1843,8 @@ void EventBuilder::DoOptimalFilterPhononNS(int detNum, const string& sensorType)
 
 void EventBuilder::DoOptimalFilterCharge2X2(int detNum)
 {
+   PROCESSING_TIMER("DoOptimalFilterCharge2X2", detNum);
+
 
     ////////////////////////////////////////////////
     // Calculate OptimalFilterCharge 2X2 
@@ -1752,6 +1928,7 @@ void EventBuilder::DoOptimalFilterCharge2X2(int detNum)
     // Define pulse maps (channel name -> pulse vector)
     map<string, vector<double> > aPulseMap2x2; // for 2X2 fitting
     map<string, vector<double> > aPulseMap1x1; // for single pulse fitting 
+    map<string, vector<TComplex> > aPulseFFTMap; // FFTs cached in PulseData, for both
   
            
     // get broken charge side list
@@ -1808,6 +1985,7 @@ void EventBuilder::DoOptimalFilterCharge2X2(int detNum)
 	  aPulseMap1x1[chanName] = aPulseData->GetBaselineSubNormPulse();
         else
 	  aPulseMap2x2[chanName] = aPulseData->GetBaselineSubNormPulse();
+	aPulseFFTMap[chanName] = aPulseData->GetBaselineSubNormPulseFFT();
 	
 	
 	
@@ -1940,7 +2118,7 @@ void EventBuilder::DoOptimalFilterCharge2X2(int detNum)
      
      // ---- Do Optimal Filter ----
       
-     myOptimalFilterCharge2x2.DoCalc(aPulseMap2x2); 
+     myOptimalFilterCharge2x2.DoCalc(aPulseMap2x2, aPulseFFTMap); 
     
      // store RQ in pulse data
      for(uint ipulse = 0; ipulse < zipPulseList->size(); ipulse++)
@@ -2003,7 +2181,9 @@ void EventBuilder::DoOptimalFilterCharge2X2(int detNum)
 
 
          // do Optimal Filter
-         myOptimalFilterCharge1x1.DoCalc(pulse, chanName); 
+         map<string, vector<double> > aPulseMap;
+         aPulseMap[chanName] = pulse;
+         myOptimalFilterCharge1x1.DoCalc(aPulseMap, aPulseFFTMap); 
 	 
          // store RQ in pulse data
          for(uint ipulse = 0; ipulse < zipPulseList->size(); ipulse++)
@@ -2033,6 +2213,8 @@ void EventBuilder::DoOptimalFilterCharge2X2(int detNum)
 //Modify this as needed to correctly call your class
 void EventBuilder::DoPSDIntegralPhonon(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoPSDIntegralPhonon", detNum);
+
 
     //retrive the vector of pulses for this zip
     vector<PulseData>* zipPulseList;
@@ -2086,6 +2268,8 @@ void EventBuilder::DoPSDIntegralPhonon(int detNum, const string& sensorType)
 
 void EventBuilder::DoWedgeFitPhonon(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoWedgeFitPhonon", detNum);
+
 
     // === retrieve pulse list for this zip ==  
     vector<PulseData>* zipPulseList;
@@ -2172,6 +2356,8 @@ void EventBuilder::DoWedgeFitPhonon(int detNum, const string& sensorType)
 //Modify this as needed to correctly call your class
 void EventBuilder::DoVetoAnalysis()
 {
+   PROCESSING_TIMER("DoVetoAnalysis", 0);
+
     //some quantities need history information, so check if trigger processsing activated
     if(!fUserData.DoTriggerProcessing())
     {
@@ -2215,6 +2401,8 @@ void EventBuilder::DoVetoAnalysis()
 //Modify this as needed to correctly call your class
 void EventBuilder::DoNoiseMonitorAnalysis()
 {
+   PROCESSING_TIMER("DoNoiseMonitorAnalysis", 0);
+
   //loop over entire pulse collection
     for(uint pulseItr = 0; pulseItr < fVectorOfNoiseMonitorPulses.size(); pulseItr++)
     {
@@ -2242,6 +2430,8 @@ void EventBuilder::DoNoiseMonitorAnalysis()
 
 void EventBuilder::DoInflectionTime(int detNum, const string& sensorType)
 { 
+   PROCESSING_TIMER("DoInflectionTime", detNum);
+
    //retrive the vector of pulses for this zip
    vector<PulseData>* zipPulseList;
    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -2283,6 +2473,8 @@ void EventBuilder::DoInflectionTime(int detNum, const string& sensorType)
 
 void EventBuilder::DoPipeFitPhonon(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoPipeFitPhonon", detNum);
+
    //retrive the vector of pulses for this zip
    vector<PulseData>* zipPulseList;
    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -2379,6 +2571,8 @@ void EventBuilder::DoPipeFitPhonon(int detNum, const string& sensorType)
 
 void EventBuilder::DoOptimalFilterPhonon(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoOptimalFilterPhonon", detNum);
+
    //retrive the vector of pulses for this zip
    vector<PulseData>* zipPulseList;
    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -2465,7 +2659,7 @@ void EventBuilder::DoOptimalFilterPhonon(int detNum, const string& sensorType)
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2482,6 +2676,8 @@ void EventBuilder::DoOptimalFilterPhonon(int detNum, const string& sensorType)
 
 void EventBuilder::DoOptimalFilterPhononDMC(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoOptimalFilterPhononDMC", detNum);
+
    //retrive the vector of pulses for this zip
    vector<PulseData>* zipPulseList;
    map< int, vector<PulseData> >::iterator mapItr = fMapOfZipPulses.find(detNum);
@@ -2567,7 +2763,7 @@ void EventBuilder::DoOptimalFilterPhononDMC(int detNum, const string& sensorType
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2586,6 +2782,8 @@ void EventBuilder::DoOptimalFilterPhononDMC(int detNum, const string& sensorType
 
 void EventBuilder::DoOptimalFilterPhononGlitch1(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoOptimalFilterPhononGlitch1", detNum);
+
    string glitchChanName = "PTglitch1";
 
    //retrive the vector of pulses for this zip
@@ -2658,7 +2856,7 @@ void EventBuilder::DoOptimalFilterPhononGlitch1(int detNum, const string& sensor
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2678,6 +2876,8 @@ void EventBuilder::DoOptimalFilterPhononGlitch1(int detNum, const string& sensor
 
 void EventBuilder::DoOptimalFilterPhononLFnoise1(int detNum, const string& sensorType)
 {
+   PROCESSING_TIMER("DoOptimalFilterPhononLFnoise1", detNum);
+
    string lfnoiseChanName = "PTlfnoise1";
 
    //retrive the vector of pulses for this zip
@@ -2750,7 +2950,7 @@ void EventBuilder::DoOptimalFilterPhononLFnoise1(int detNum, const string& senso
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2772,6 +2972,8 @@ void EventBuilder::DoOptimalFilterPhononLFnoise1(int detNum, const string& senso
 
 void EventBuilder::DoOptimalFilterCharge(int detNum)
 {
+   PROCESSING_TIMER("DoOptimalFilterCharge", detNum);
+
 
    //pulses in the pulse collection are expected to be ordered by the raw data reader 
    //according to zip and channel number.
@@ -2870,7 +3072,11 @@ void EventBuilder::DoOptimalFilterCharge(int detNum)
          myOptimalFilterCharge.SetDelayInterpolateFlag(fUserData.GetIntParameter(detNum, "Q_DELAY_INTERPOLATE"));
 	 
 	 // --------- Do Optimal Filter ---------------
-	 myOptimalFilterCharge.DoCalc(aPulseData->GetBaselineSubNormPulse(),chanName); 
+	 map<string, vector<double> > aPulseMap;
+	 map<string, vector<TComplex> > aPulseFFTMap;
+	 aPulseMap[chanName] = aPulseData->GetBaselineSubNormPulse();
+	 aPulseFFTMap[chanName] = aPulseData->GetBaselineSubNormPulseFFT();
+	 myOptimalFilterCharge.DoCalc(aPulseMap, aPulseFFTMap); 
 	 
 	 
 	 // ---------- store results -------------------
@@ -2887,6 +3093,8 @@ void EventBuilder::DoOptimalFilterCharge(int detNum)
 
 void EventBuilder::DoOptimalFilterChargeX(int detNum, const string& side)
 { 
+   PROCESSING_TIMER("DoOptimalFilterChargeX", detNum);
+
    
    // channels names
    string chanNameQI = "QI";
@@ -3065,7 +3273,8 @@ void EventBuilder::DoOptimalFilterChargeX(int detNum, const string& side)
 	    
 	    // --------- Do Optimal Filter ---------------
 
-	    tempOptimalFilterChargeX.DoCalc(aBSNPulseQI, aBSNPulseQO);
+	    tempOptimalFilterChargeX.DoCalc(aBSNPulseQI, aBSNPulseQO,
+					    aPulseDataQI->GetBaselineSubNormPulseFFT(), aPulseDataQO->GetBaselineSubNormPulseFFT());
 	    
 
             // ---------- store results -------------------
@@ -3091,6 +3300,8 @@ void EventBuilder::DoOptimalFilterChargeX(int detNum, const string& side)
 
 void EventBuilder::DoF5ChargeX(int detNum, const string& side)
 {
+   PROCESSING_TIMER("DoF5ChargeX", detNum);
+
    //The F5Charge class is structurally modeled after the OptimalFilterChargeX class
 
    // channels names
@@ -3307,6 +3518,8 @@ void EventBuilder::DoF5ChargeX(int detNum, const string& side)
 
 void EventBuilder::DoGpibTimingCalc()
 {
+   PROCESSING_TIMER("DoGpibTimingCalc", 0);
+
   // GPIB (Flash Times)
   fGpibData.DoCalc((double) fAdminData.GetEventTime());
   return;
@@ -3315,6 +3528,8 @@ void EventBuilder::DoGpibTimingCalc()
 
 void EventBuilder::DoIsrTimingCalc()
 {
+   PROCESSING_TIMER("DoIsrTimingCalc", 0);
+
  
   // ISR (LastISRTime)
   fIsrData.DoCalcLastIsrTime((double) fAdminData.GetEventTime());
@@ -3326,6 +3541,8 @@ void EventBuilder::DoIsrTimingCalc()
 //  DMM  analysis
 void EventBuilder::DoDmmCalc(int detNum)
 {
+   PROCESSING_TIMER("DoDmmCalc", detNum);
+
   fDmmData.DoCalc(detNum, (double) fAdminData.GetEventTime());
   return;
 }
@@ -3335,6 +3552,8 @@ void EventBuilder::DoDmmCalc(int detNum)
 //  This is deprecated as of 2011 (starting w/ Soudan R132) - FIXME - remove altogether?
 void EventBuilder::DoIsrCalc(int detNum)
 {
+   PROCESSING_TIMER("DoIsrCalc", detNum);
+
   fIsrData.DoCalcBias(detNum, (double) fAdminData.GetEventTime());
   return;
 }
@@ -3342,11 +3561,15 @@ void EventBuilder::DoIsrCalc(int detNum)
 // Database analysis
 void EventBuilder::DoDatabaseEventCalc()
 {
+   PROCESSING_TIMER("DoDatabaseEventCalc", 0);
+
   fDatabaseManager.StoreEventRQs(fAdminData.GetEventTime());
 }
 
 void EventBuilder::DoDatabasePulseCalc(int detNum)
 {
+   PROCESSING_TIMER("DoDatabasePulseCalc", detNum);
+
   time_t evTime = fAdminData.GetEventTime();
   int detType = fDetectorConfigManager.GetDetectorMap()[detNum];
   fDatabaseManager.StoreDetectorRQs(evTime, detType, detNum);
@@ -3413,23 +3636,94 @@ void EventBuilder::FillNoiseMonitorPulseCollection(vector<PulseData>& pulseColle
 void EventBuilder::FillSingleZipPulseCollection(vector<PulseData>& pulseCollection,
 						const int& detNum) const
 {
+   pulseCollection = GetSingleZipPulses(detNum);
+   return;
+}
 
-   vector<PulseData> tempCollection;
+//This function gives read-only access to the pulse values!
+const vector<PulseData>& EventBuilder::GetSingleZipPulses(int detNum) const
+{
+   static const vector<PulseData> noPulses;
 
    //retrive the vector of pulses for this zip
    map< int, vector<PulseData> >::const_iterator mapItr = fMapOfZipPulses.find(detNum);
    if(mapItr != fMapOfZipPulses.end())
-   {
-      tempCollection = mapItr->second;
-   }  
- 
-   pulseCollection = tempCollection;
+      return mapItr->second;
 
-   return;
+   return noPulses;
 }
 
 // ====================== Utility Functions  =========================
 
+//returns true if the detector must receive the full analysis chain this event 
+//(always true unless DO_LAZY_ANALYSIS is on)
+bool EventBuilder::DoFullAnalysis(int detNum)
+{
+   if(!fDoLazyAnalysis)
+      return true;
+
+   bool doFull = IsDetectorTriggered(detNum);
+
+   if(!doFull && fLazyAnalysisNeighbors)
+   {
+      //neighbours within the same tower only
+      int nZipsPerTower = TriggerData::kMaxDibsPerTower;
+      int towerNum = (int)ceil((double)detNum/(double)nZipsPerTower);
+      for(int neighbor = detNum-1; neighbor <= detNum+1; neighbor += 2)
+      {
+	 if(neighbor < 1 || (int)ceil((double)neighbor/(double)nZipsPerTower) != towerNum)
+	    continue;
+	 if(IsDetectorTriggered(neighbor)) 
+	 {
+	    doFull = true;
+	    break;
+	 }
+      }
+   }
+
+   fLazySkipMap[detNum] = !doFull;
+   return doFull;
+}
+
+bool EventBuilder::IsLazySkipped(int detNum) const
+{
+   map<int, bool>::const_iterator iter = fLazySkipMap.find(detNum);
+   if(iter == fLazySkipMap.end())
+      return false;
+
+   return iter->second;
+}
+
+//checks the t=0 trigger mask and the history buffer for a phonon or charge trigger
+//on this detector. Events without trigger info are treated as triggered.
+bool EventBuilder::IsDetectorTriggered(int detNum)
+{
+   int nZipsPerTower = TriggerData::kMaxDibsPerTower;
+   int towerNum = (int)ceil((double)detNum/(double)nZipsPerTower); 
+   int zipNum = (detNum % nZipsPerTower);
+   if(zipNum == 0) zipNum = nZipsPerTower;
+
+   bool hasTriggerInfo = false;
+
+   if(fTriggerData.GetNTowerMasksInEvent() >= (size_t)towerNum)
+   {
+      hasTriggerInfo = true;
+      //charge high (bit 0, kQhigh is defined as 0), charge low, phonon high, phonon low; kWisper ignored
+      uint64_t zipMask = (fTriggerData.GetTowerMask(towerNum) >> (TriggerData::kNTrigTypeBits*(zipNum-1)));
+      if(zipMask & (1 | TriggerData::kQlow | TriggerData::kPhigh | TriggerData::kPlow))
+	 return true;
+   }
+
+   if(fHistoryData.GetNEventTowerMasks() >= (size_t)towerNum)
+   {
+      hasTriggerInfo = true;
+      if(fHistoryData.GetNTrigP(detNum) > 0 || fHistoryData.GetNTrigQ(detNum) > 0)
+	 return true;
+   }
+
+   return !hasTriggerInfo;
+}
+
 //defunct, not being used right now
 bool EventBuilder::IsChosenType(const PulseData& aPulseData, const string& whichPulses) const
 {
@@ -8,6 +8,7 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: data objects and pulse collections returned by const reference (GetSingleZipPulses...)
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -48,16 +49,18 @@ class EventBuilder
       ~EventBuilder(); //destructor
 
       //use RawDataReader to get event, returns 0 if end of file, <0 if read error
+      //(RawDataReader::kNoEventAvailable in online mode when nothing arrived yet)
       int ReadNextEvent();
+      bool IsOnline() const { return fEventSource != NULL; }
       int ReadEventN(int eventN);
       void ResetDataReader();
 
       //getting data objects (all const functions)
       
-      AdminData    GetAdmin()   const  { return fAdminData;    }
-      HistoryData  GetHistory() const  { return fHistoryData;  }
-      TriggerData  GetTrigger() const  { return fTriggerData;  }
-      GPSData      GetGPS()     const  { return fGPSData; }
+      const AdminData&    GetAdmin()   const  { return fAdminData;    }
+      const HistoryData&  GetHistory() const  { return fHistoryData;  }
+      const TriggerData&  GetTrigger() const  { return fTriggerData;  }
+      const GPSData&      GetGPS()     const  { return fGPSData; }
       
       uint32_t     GetEventCategory();
 
@@ -96,15 +99,20 @@ class EventBuilder
       
       
       //getting external files data (all const functions)
-      InfoDataManager GetInfoData()  const    { return fInfoData;   }
-      IsrDataManager GetIsrData()  const      { return fIsrData;    }
-      DmmDataManager GetDmmData()  const      { return fDmmData;    } 
-      GpibDataManager GetGpibData() const     { return fGpibData;   }
-      FilterDataManager GetFilterData() const { return fFilterData; }
+      const InfoDataManager& GetInfoData()  const    { return fInfoData;   }
+      const IsrDataManager& GetIsrData()  const      { return fIsrData;    }
+      const DmmDataManager& GetDmmData()  const      { return fDmmData;    } 
+      const GpibDataManager& GetGpibData() const     { return fGpibData;   }
+      const FilterDataManager& GetFilterData() const { return fFilterData; }
       const CdmsDB::DatabaseManager& GetDatabaseManager() const 
       { return fDatabaseManager; }
       
-      //getting pulse collections
+      //getting pulse collections, read-only and without copying (empty if the zip has no pulses)
+      const vector<PulseData>& GetSingleZipPulses(int detNum) const;
+      const vector<PulseData>& GetVetoPulses()         const { return fVectorOfVetoPulses; }
+      const vector<PulseData>& GetNoiseMonitorPulses() const { return fVectorOfNoiseMonitorPulses; }
+
+      //same, copied into pulseCollection
       void FillSingleZipPulseCollection(vector<PulseData>& pulseCollection, const int& detNum) const;
       void FillVetoPulseCollection(vector<PulseData>& pulseCollection) const;
       void FillNoiseMonitorPulseCollection(vector<PulseData>& pulseCollection) const;
@@ -116,10 +124,26 @@ class EventBuilder
       uint32_t GetEventCategory() const { return fRawReader.GetEventCategory(); }
       uint32_t GetEventType()     const { return fRawReader.GetEventType(); }
 
+      //trigger-aware (zero-suppression) mode: only triggered detectors, and optionally their
+      //neighbours in the same tower, get the full analysis chain (DO_LAZY_ANALYSIS)
+      bool DoLazyAnalysis()       const { return fDoLazyAnalysis; }
+      bool DoFullAnalysis(int detNum);        //decides and records whether this detector gets the full chain
+      bool IsLazySkipped(int detNum) const;   //true if DoFullAnalysis returned false for this event
+
       // Pulse simulation settings
       void SetSimDataManager(string input_filename);
       void ReadSimEvent();
       void SetPulseLibManager(vector<string> input_filename);
+
+      //single-pass overlays (SIM_SINGLE_PASS): the random is decoded once, kept, and
+      //restored before each further overlay instead of re-reading the raw file; the pulses
+      //are not copied, only the sum pulses and the analysis results are dropped again
+      void KeepRandomForOverlays();
+      void RestoreRandomForOverlay();
+
+      //which use of the current random is being simulated; part of the CounterRNG key
+      //so that random draws do not depend on processing order
+      void SetSimOverlayIndex(int overlayIndex) { fSimOverlayIndex = overlayIndex; }
       
       //Veto
       void DoVetoAnalysis();
@@ -145,6 +169,7 @@ class EventBuilder
       
       //Basic Pulse Analysis
       void DoBasicPulseCalc(int detNum);
+      void DoPulseFFTs(int detNum, bool doFullAnalysis);   //batched FFT of the BSN pulses, cached in PulseData for the OFs
 
       //Phonon Algorithms
       void DoPulseIntegral(int detNum, const string& sensorType, const string& pulseType = "filtered"); //filtered if not specified
@@ -183,9 +208,11 @@ class EventBuilder
 
       //utility
       bool IsChosenType(const PulseData& aPulseData, const string& whichPulses) const;
+      bool IsDetectorTriggered(int detNum);
       
       //Readers
       RawDataReader fRawReader;
+      MidasEventSource* fEventSource; //online mode (ONLINE_SOURCE), owned
       SimulationDataManager fSimDataReader;
       SimulationPulseLibraryManager fSimLibManager;
 
@@ -218,6 +245,17 @@ class EventBuilder
       bool     fGpibIsRegistered;
       bool     fFilterIsRegistered;
       bool     fDatabaseIsRegistered;
+
+      //trigger-aware analysis
+      bool     fDoLazyAnalysis;
+      bool     fLazyAnalysisNeighbors;
+      map<int, bool> fLazySkipMap; //detectors skipped in the current event
+
+      //number of pulses read for the current random, for single-pass simulation overlays
+      //(the sum pulses are appended after them)
+      map<int, uint> fOverlayRandomNZipPulses;
+      int fSimOverlayIndex;
+
       //other
       
       DetectorConfigManager fDetectorConfigManager;  
@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////////
+//main()
+//Description: Test producer for BatRoot online mode. Replays the events of
+//             existing midas files (.mid or .mid.gz) into a local shared-memory
+//             ring that BatRoot reads with ONLINE_SOURCE = shm:<ring name>
+//
+//Usage: ./MidasRingProducer ringName rate(Hz, 0 = no limit) file1 [file2 ...]
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+//Standard Libaries
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include "zlib.h"
+
+//CDMS Libraries
+#include "MidasStructs.h"
+#include "MidasEventSource.h"
+
+using namespace std;
+
+/////////////////// BEGIN MAIN //////////////////////////////
+
+int main(int argc, char* argv[]){
+
+   if(argc < 4)
+   {
+      cout <<"ERROR running MidasRingProducer!"
+	   <<"\nThe command line is: ./MidasRingProducer ringName rate(Hz, 0 = no limit) file1 [file2 ...]"
+	   << endl;
+      exit(1);
+   }
+
+   string ringName = argv[1];
+   double rate = atof(argv[2]);
+
+   const uint64_t ringCapacity = 256*1024*1024; //bytes
+   const int pushTimeoutMs = 1000;
+
+   MidasShmRing ring;
+   if(!ring.Create(ringName, ringCapacity))
+      exit(1);
+
+   cout <<"MidasRingProducer: created ring " << ringName << endl;
+
+   long nEvents = 0;
+   vector<char> eventBuffer;
+
+   for(int fileItr = 3; fileItr < argc; fileItr++)
+   {
+      gzFile midasFile = gzopen(argv[fileItr], "rb");
+      if(midasFile == NULL)
+      {
+	 cerr <<"MidasRingProducer: ERROR opening " << argv[fileItr] << endl;
+	 continue;
+      }
+      cout <<"MidasRingProducer: replaying " << argv[fileItr] << endl;
+
+      TMidas_EVENT_HEADER header;
+      while(gzread(midasFile, (char*)&header, sizeof(header)) == (int)sizeof(header))
+      {
+	 eventBuffer.resize(sizeof(header) + header.fDataSize);
+	 memcpy(&eventBuffer[0], &header, sizeof(header));
+	 if(gzread(midasFile, &eventBuffer[sizeof(header)], header.fDataSize) != (int)header.fDataSize)
+	 {
+	    cerr <<"MidasRingProducer: WARNING truncated event in " << argv[fileItr] << endl;
+	    break;
+	 }
+
+	 // wait for the consumer if the ring is full
+	 while(!ring.Push(&eventBuffer[0], eventBuffer.size(), pushTimeoutMs))
+	    cout <<"MidasRingProducer: ring full, waiting for consumer..." << endl;
+
+	 nEvents++;
+	 if(rate > 0.)
+	    usleep((useconds_t)(1.e6/rate));
+      }
+
+      gzclose(midasFile);
+   }
+
+   // ring stays in /dev/shm so the consumer can drain it after we exit
+   ring.SetProducerDone();
+   cout <<"MidasRingProducer: " << nEvents << " events written, done" << endl;
+
+   return 0;
+}
@@ -0,0 +1,277 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RQOutputBackend
+//Description:  Storage of the RQ tables for BatOutputManager (see header file).
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdlib>
+
+#include "RVersion.h"
+#include "TROOT.h"
+
+#include "RQOutputBackend.h"
+
+//written against the ROOT 6.36 interface, where RField, RNTupleModel, RNTupleWriter and
+//RNTupleWriteOptions are in the ROOT namespace and SetTruncated/SetQuantized exist; older
+//versions only get the TTree backend
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,36,0)
+#define BATROOT_HAVE_RNTUPLE
+#include <memory>
+#include <ROOT/RField.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+#endif
+
+using namespace std;
+
+// ======================================================================
+
+RQOutputBackend* RQOutputBackend::Create(UserDataManager& userData, TDirectory* rqDir)
+{
+   string format = "ttree";
+   if(userData.HasStringParameter("OUTPUT_FORMAT"))
+      format = userData.GetStringParameter("OUTPUT_FORMAT");
+
+   //with implicit MT, TTree::Fill compresses the baskets of a flush in parallel and the
+   //RNTuple writers do the same with the pages of a cluster
+   if(userData.HasIntParameter("OUTPUT_THREADS") && userData.GetIntParameter("OUTPUT_THREADS") > 0
+      && !ROOT::IsImplicitMTEnabled())
+      ROOT::EnableImplicitMT(userData.GetIntParameter("OUTPUT_THREADS"));
+
+   if(format == "ttree")
+      return new TTreeRQBackend(userData, rqDir);
+
+   if(format == "rntuple")
+   {
+      if(!RNTupleRQBackend::IsAvailable())
+      {
+	 cerr <<"RQOutputBackend: ERROR OUTPUT_FORMAT = rntuple needs BatRoot built against ROOT >= 6.36" << endl;
+	 exit(1);
+      }
+      return new RNTupleRQBackend(userData, rqDir);
+   }
+
+   cerr <<"RQOutputBackend: ERROR unknown OUTPUT_FORMAT " << format << " (ttree or rntuple)" << endl;
+   exit(1);
+}
+
+// ==================== TTree backend ===================================
+
+TTreeRQBackend::TTreeRQBackend(UserDataManager& userData, TDirectory* rqDir) :
+   fRQDir(rqDir),
+   fAutoFlush(0),
+   fAutoSave(0)
+{
+   if(userData.HasIntParameter("OUTPUT_AUTOFLUSH"))
+      fAutoFlush = userData.GetIntParameter("OUTPUT_AUTOFLUSH");
+   if(userData.HasIntParameter("OUTPUT_AUTOSAVE"))
+      fAutoSave = userData.GetIntParameter("OUTPUT_AUTOSAVE");
+}
+
+TTreeRQBackend::~TTreeRQBackend()
+{
+   //the trees belong to the output file
+   for(uint tableItr = 0; tableItr < fConversions.size(); tableItr++)
+      for(uint colItr = 0; colItr < fConversions[tableItr].size(); colItr++)
+	 delete fConversions[tableItr][colItr].buffer;
+}
+
+int TTreeRQBackend::CreateTable(const string& name, const string& title)
+{
+   fRQDir->cd();
+   TTree* tree = new TTree(name.c_str(), title.c_str());
+
+   //every table gets one entry per event, so a flush every N entries puts the cluster
+   //boundaries of all trees (and their friends) at the same events
+   if(fAutoFlush != 0) tree->SetAutoFlush(fAutoFlush);
+   if(fAutoSave != 0) tree->SetAutoSave(fAutoSave);
+
+   fTrees.push_back(tree);
+   fConversions.push_back(vector<Conversion>());
+   return fTrees.size()-1;
+}
+
+void TTreeRQBackend::AddColumn(int table, const string& name, const double* address,
+			       const RQPrecision& precision)
+{
+   //doubles are read straight from the RQ map
+   if(precision.type == RQPrecision::kDouble)
+   {
+      fTrees[table]->Branch(name.c_str(), const_cast<double*>(address), (name+"/D").c_str());
+      return;
+   }
+
+   Conversion conversion;
+   conversion.address = address;
+   conversion.precision = precision;
+   conversion.buffer = new RQValue;
+   fConversions[table].push_back(conversion);
+   fTrees[table]->Branch(name.c_str(), conversion.buffer, (name+"/"+precision.GetLeafType()).c_str());
+}
+
+void TTreeRQBackend::Fill(int table)
+{
+   vector<Conversion>& conversions = fConversions[table];
+   for(uint colItr = 0; colItr < conversions.size(); colItr++)
+      conversions[colItr].precision.Convert(*conversions[colItr].address, conversions[colItr].buffer);
+
+   fTrees[table]->Fill();
+}
+
+void TTreeRQBackend::Write()
+{
+   fRQDir->cd();
+   for(uint treeItr = 0; treeItr < fTrees.size(); treeItr++)
+      fTrees[treeItr]->Write();
+}
+
+// ==================== RNTuple backend ===================================
+
+#ifdef BATROOT_HAVE_RNTUPLE
+
+struct RNTupleRQBackend::Table
+{
+   string name;
+   unique_ptr<ROOT::RNTupleModel> model;      //until the first Fill
+   unique_ptr<ROOT::RNTupleWriter> writer;
+   vector<const double*> addresses;
+   vector<RQPrecision> precisions;
+   vector< shared_ptr<void> > values;
+};
+
+RNTupleRQBackend::RNTupleRQBackend(UserDataManager& userData, TDirectory* rqDir) :
+   fRQDir(rqDir),
+   fCompression(505),
+   fClusterBytes(0)
+{
+   if(userData.HasIntParameter("OUTPUT_COMPRESSION"))
+      fCompression = userData.GetIntParameter("OUTPUT_COMPRESSION");
+   if(userData.HasIntParameter("OUTPUT_RNTUPLE_CLUSTER_MB"))
+      fClusterBytes = long(userData.GetIntParameter("OUTPUT_RNTUPLE_CLUSTER_MB"))*1024*1024;
+}
+
+RNTupleRQBackend::~RNTupleRQBackend()
+{
+   for(uint tableItr = 0; tableItr < fTables.size(); tableItr++)
+      delete fTables[tableItr];
+}
+
+bool RNTupleRQBackend::IsAvailable()
+{
+   return true;
+}
+
+int RNTupleRQBackend::CreateTable(const string& name, const string& title)
+{
+   Table* table = new Table;
+   table->name = name;
+   table->model = ROOT::RNTupleModel::Create();
+   table->model->SetDescription(title);
+   fTables.push_back(table);
+   return fTables.size()-1;
+}
+
+void RNTupleRQBackend::AddColumn(int table, const string& name, const double* address,
+				 const RQPrecision& precision)
+{
+   Table& thisTable = *fTables[table];
+   if(!thisTable.model)
+   {
+      cerr <<"RNTupleRQBackend: ERROR column " << name << " added to " << thisTable.name
+	   <<" after the first Fill" << endl;
+      exit(1);
+   }
+   thisTable.addresses.push_back(address);
+   thisTable.precisions.push_back(precision);
+
+   switch(precision.type)
+   {
+      case RQPrecision::kFloat:
+	 thisTable.values.push_back(thisTable.model->MakeField<float>(name));
+	 break;
+      case RQPrecision::kInt32:
+	 thisTable.values.push_back(thisTable.model->MakeField<int32_t>(name));
+	 break;
+      case RQPrecision::kInt64:
+	 thisTable.values.push_back(thisTable.model->MakeField<int64_t>(name));
+	 break;
+      case RQPrecision::kUInt64:
+	 thisTable.values.push_back(thisTable.model->MakeField<uint64_t>(name));
+	 break;
+      case RQPrecision::kTruncated:
+      case RQPrecision::kRange:
+      {
+	 //Real32Trunc counts sign and exponent bits too; Real32Quant needs the values in range,
+	 //which Convert guarantees
+	 unique_ptr< ROOT::RField<double> > field(new ROOT::RField<double>(name));
+	 if(precision.type == RQPrecision::kTruncated) field->SetTruncated(1 + 8 + precision.nBits);
+	 else field->SetQuantized(precision.min, precision.max, precision.nBits);
+	 thisTable.model->AddField(std::move(field));
+	 thisTable.values.push_back(thisTable.model->GetDefaultEntry().GetPtr<double>(name));
+	 break;
+      }
+      default:
+	 thisTable.values.push_back(thisTable.model->MakeField<double>(name));
+	 break;
+   }
+}
+
+//the model is frozen by the writer, so this waits for the first Fill
+void RNTupleRQBackend::OpenWriter(Table& table)
+{
+   ROOT::RNTupleWriteOptions options;
+   options.SetCompression(fCompression);
+   if(fClusterBytes > 0) options.SetApproxZippedClusterSize(fClusterBytes);
+
+   table.writer = ROOT::RNTupleWriter::Append(std::move(table.model), table.name, *fRQDir, options);
+}
+
+void RNTupleRQBackend::Fill(int table)
+{
+   Table& thisTable = *fTables[table];
+   if(!thisTable.writer) OpenWriter(thisTable);
+
+   for(uint colItr = 0; colItr < thisTable.addresses.size(); colItr++)
+      thisTable.precisions[colItr].Convert(*thisTable.addresses[colItr], thisTable.values[colItr].get());
+   thisTable.writer->Fill();
+}
+
+void RNTupleRQBackend::Write()
+{
+   //committing the last cluster and the footer writes the RNTuple anchor into rqDir
+   for(uint tableItr = 0; tableItr < fTables.size(); tableItr++)
+   {
+      Table& table = *fTables[tableItr];
+      if(!table.writer) OpenWriter(table);   //tables without entries are still written
+      table.writer.reset();
+   }
+}
+
+#else
+
+struct RNTupleRQBackend::Table {};
+
+RNTupleRQBackend::RNTupleRQBackend(UserDataManager&, TDirectory* rqDir) :
+   fRQDir(rqDir),
+   fCompression(0),
+   fClusterBytes(0)
+{
+}
+
+RNTupleRQBackend::~RNTupleRQBackend() {}
+
+bool RNTupleRQBackend::IsAvailable() { return false; }
+
+int RNTupleRQBackend::CreateTable(const string&, const string&) { return -1; }
+void RNTupleRQBackend::AddColumn(int, const string&, const double*, const RQPrecision&) {}
+void RNTupleRQBackend::Fill(int) {}
+void RNTupleRQBackend::Write() {}
+void RNTupleRQBackend::OpenWriter(Table&) {}
+
+#endif
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//Class Name: RQOutputBackend
+//Description:  Storage of the RQ tables (eventTree, vetoTree, noiseMonitorTree, zip#) for
+//BatOutputManager.  BatOutputManager keeps the RQ values in its maps and registers the address of
+//every value as a column; the backend reads the values at every Fill and writes the tables into
+//rqDir.  TTreeRQBackend is the original one-TTree-per-table, one-/D-branch-per-RQ layout and the
+//default; RNTupleRQBackend writes one RNTuple per table (needs ROOT >= 6.36).
+//The backend is chosen with PARAMETER_STRING OUTPUT_FORMAT = ttree | rntuple.  OUTPUT_THREADS
+//enables ROOT implicit MT for the compression, OUTPUT_COMPRESSION (in BatOutputManager for the
+//file) and OUTPUT_AUTOFLUSH / OUTPUT_AUTOSAVE set the compression and the tree clustering.
+//Every column is written in the type of its RQPrecision (double unless OUTPUT_PRECISION_FILE
+//says otherwise); the conversion from the RQ double happens at Fill.
+//
+//Creation Date: Oct. 19, 2026
+//
+//Modifications:
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RQOUTPUTBACKEND_H
+#define RQOUTPUTBACKEND_H
+
+#include <string>
+#include <vector>
+
+#include "TDirectory.h"
+#include "TTree.h"
+
+#include "UserDataManager.h"
+#include "RQPrecisionPolicy.h"
+
+using namespace std;
+
+//!Interface of the RQ table storage used by BatOutputManager
+class RQOutputBackend
+{
+   public:
+
+      virtual ~RQOutputBackend() {}
+
+      //one table per RQ tree, returns its index
+      virtual int CreateTable(const string& name, const string& title) = 0;
+
+      //the value is read from address at every Fill of the table and written as precision
+      virtual void AddColumn(int table, const string& name, const double* address,
+			     const RQPrecision& precision = RQPrecision()) = 0;
+
+      virtual void Fill(int table) = 0;
+
+      //writes all tables into the RQ directory
+      virtual void Write() = 0;
+
+      //"ttree" or "rntuple" from OUTPUT_FORMAT, exits on anything else
+      static RQOutputBackend* Create(UserDataManager& userData, TDirectory* rqDir);
+};
+
+
+//!One TTree per table with one /D branch per RQ (the original BatRoot layout)
+class TTreeRQBackend : public RQOutputBackend
+{
+   public:
+
+      TTreeRQBackend(UserDataManager& userData, TDirectory* rqDir);
+      ~TTreeRQBackend();
+
+      int CreateTable(const string& name, const string& title);
+      void AddColumn(int table, const string& name, const double* address,
+		     const RQPrecision& precision = RQPrecision());
+      void Fill(int table);
+      void Write();
+
+   private:
+
+      //a column which is not a plain double gets its own branch buffer
+      struct Conversion {
+	 const double* address;
+	 RQPrecision   precision;
+	 RQValue*      buffer;
+      };
+
+      TDirectory*     fRQDir;
+      Long64_t        fAutoFlush;       //OUTPUT_AUTOFLUSH: > 0 entries, < 0 bytes, 0 ROOT default
+      Long64_t        fAutoSave;        //OUTPUT_AUTOSAVE, same convention
+      vector<TTree*>  fTrees;
+      vector< vector<Conversion> > fConversions;   //per table
+};
+
+
+//!One RNTuple per table with one field per RQ
+class RNTupleRQBackend : public RQOutputBackend
+{
+   public:
+
+      RNTupleRQBackend(UserDataManager& userData, TDirectory* rqDir);
+      ~RNTupleRQBackend();
+
+      int CreateTable(const string& name, const string& title);
+      void AddColumn(int table, const string& name, const double* address,
+		     const RQPrecision& precision = RQPrecision());
+      void Fill(int table);
+      void Write();
+
+      //false if BatRoot was built against a ROOT without RNTuple
+      static bool IsAvailable();
+
+   private:
+
+      struct Table;
+
+      TDirectory*     fRQDir;
+      int             fCompression;     //ROOT compression settings, e.g. 505 = zstd level 5
+      long            fClusterBytes;    //approximate compressed cluster size
+      vector<Table*>  fTables;
+
+      void OpenWriter(Table& table);
+};
+
+#endif /* RQOUTPUTBACKEND_H */
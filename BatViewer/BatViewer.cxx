@@ -7,6 +7,7 @@
 //Creation Date: Dec. 19, 2011
 //
 //Modifications:
+//Oct. 2026: a single detector view (-d) decodes only that detector's pulses, unpacked when drawn
 //
 ////////////////////////////////////////////////////////////////////////////////// 
 
@@ -73,6 +74,14 @@ inline uint64_t GetEventNumberWithinDump(uint64_t eventnum)
 inline uint64_t BuildFullEventNumber(uint64_t dumpnum, uint64_t eventnum)
 { return dumpnum*DUMPMOD + eventnum; }
 
+/// Pulses of one detector, without inserting an empty entry when it has none
+const vector<PulseData>& GetDetectorPulses(const map<int,vector<PulseData> >& zips, int detnum)
+{
+  static const vector<PulseData> nopulses;
+  map<int,vector<PulseData> >::const_iterator it = zips.find(detnum);
+  return (it == zips.end() ? nopulses : it->second);
+}
+
 /// Create a filename from a series and dump number
 std::string BuildFilename(const std::string& seriesname, uint64_t dumpnumber)
 {
@@ -221,6 +230,9 @@ int main(int argc, char** argv){
   reader.RegisterAdminData(&admin);
   TriggerData trigger;
   reader.RegisterTriggerData(&trigger,50/*max towers*/); 
+  reader.SetLazyPulseUnpacking(true);
+  if(detector_num >= 0)
+    reader.SetDetectorSelection(vector<int>(1, detector_num));
   EventPlotter plotter(hardcodeplots);
   if(canvasscale>0 && !nodraw)
     plotter.GetCanvas(canvasscale);
@@ -374,7 +386,7 @@ int main(int argc, char** argv){
       if(detector_num < 0)
 	traceSaver.SaveDetectorMap(zips, &admin);
       else
-	traceSaver.SaveDetector(zips[detector_num], &admin);
+	traceSaver.SaveDetector(GetDetectorPulses(zips, detector_num), &admin);
     }
    
     
@@ -396,7 +408,7 @@ int main(int argc, char** argv){
 	  if(detector_num < 0)
 	    traceSaver.SaveDetectorMap(zips, &admin);
 	  else
-	    traceSaver.SaveDetector(zips[detector_num], &admin);
+	    traceSaver.SaveDetector(GetDetectorPulses(zips, detector_num), &admin);
 	}
 	else{
 	  break;
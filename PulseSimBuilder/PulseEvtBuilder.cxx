@@ -292,7 +292,7 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
 	  //store these for convenient access in PulseData for additional pulse analysis calls
 
 	  aPulseData->fBSPulseVector  = tempBasicPulseCalc.GetBaselineSubPulse(); //save baseline subtracted pulse
-	  aPulseData->fBSNPulseVector = tempBasicPulseCalc.GetBaselineSubNormPulse(); //save baseline subtracted AND normalized pulse (same as BaselineSub if ISR is not read)
+	  aPulseData->SetBaselineSubNormPulse(tempBasicPulseCalc.GetBaselineSubNormPulse()); //save baseline subtracted AND normalized pulse (same as BaselineSub if ISR is not read)
 	  
 	  //store instance of this class so RQs can be read out later
 	  aPulseData->StorePulseAnalysis(tempBasicPulseCalc);
@@ -315,13 +315,13 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
 
 	  if(phononSumPulse.size() == 0)
 	  {
-	     phononSumPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	     phononSumPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	     phononSumBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	     phononSumBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 	  
 	  } else {
 	  
-	     vector<double> tempPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	     vector<double> tempPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	     vector<double> tempBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	     vector<double> tempBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 
@@ -338,13 +338,13 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
           
            if(phononSumS1Pulse.size() == 0)
 	     {
-	       phononSumS1Pulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       phononSumS1Pulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       phononSumS1BSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       phononSumS1BSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 	  
 	     } else {
 	  
-	       vector<double> tempPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       vector<double> tempPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 
@@ -361,13 +361,13 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
           
            if(phononSumS2Pulse.size() == 0)
 	     {
-	       phononSumS2Pulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       phononSumS2Pulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       phononSumS2BSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       phononSumS2BSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 	  
 	     } else {
 	  
-	       vector<double> tempPulse = PulseTools::Scale(aPulseData->fPulseVector, pulseCalib); //applying rough calibration factor
+	       vector<double> tempPulse = PulseTools::Scale(aPulseData->GetRawPulse(), pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSPulse = PulseTools::Scale(aPulseData->fBSPulseVector, pulseCalib); //applying rough calibration factor
 	       vector<double> tempBSNPulse = PulseTools::Scale(aPulseData->fBSNPulseVector, pulseCalib); //applying rough calibration factor
 
@@ -400,7 +400,7 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
 
        phononSumPulseData.fPulseVector = phononSumPulse;
        phononSumPulseData.fBSPulseVector = phononSumBSPulse;
-       phononSumPulseData.fBSNPulseVector = phononSumBSNPulse;
+       phononSumPulseData.SetBaselineSubNormPulse(phononSumBSNPulse);
 
        //store the PT PulseData object
        zipPulseList->push_back(phononSumPulseData);
@@ -428,7 +428,7 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
 
          phononSumS1PulseData.fPulseVector = phononSumS1Pulse;
          phononSumS1PulseData.fBSPulseVector = phononSumS1BSPulse;
-         phononSumS1PulseData.fBSNPulseVector = phononSumS1BSNPulse;
+         phononSumS1PulseData.SetBaselineSubNormPulse(phononSumS1BSNPulse);
 
          //store the S1 PulseData object
          zipPulseList->push_back(phononSumS1PulseData);
@@ -450,7 +450,7 @@ void PulseEvtBuilder::DoBasicPulseCalc(int detNum)
 
          phononSumS2PulseData.fPulseVector = phononSumS2Pulse;
          phononSumS2PulseData.fBSPulseVector = phononSumS2BSPulse;
-         phononSumS2PulseData.fBSNPulseVector = phononSumS2BSNPulse;
+         phononSumS2PulseData.SetBaselineSubNormPulse(phononSumS2BSNPulse);
 
          //store the S2 PulseData object
          zipPulseList->push_back(phononSumS2PulseData);
@@ -1190,7 +1190,7 @@ void PulseEvtBuilder::DoSimulatePhononFromRandoms(int detNum)
 		//Overwrite the baseline subtracted, normalized pulse 
 		//with the modified trace.  All fitting routines run 
 		//after this point will run on the modified trace.
-		aPulseData->fBSNPulseVector = aPulse;
+		aPulseData->SetBaselineSubNormPulse(aPulse);
 		
 		//store instance of this class so RQs can be read out a little later
 		aPulseData->StorePulseAnalysis(tempSimulateFromRandoms);    
@@ -1271,7 +1271,7 @@ void PulseEvtBuilder::DoSimulatePhononFromRandoms(int detNum)
 	    //Overwrite the baseline subtracted, normalized pulse 
 	    //with the modified trace.  All fitting routines run 
 	    //after this point will run on the modified trace.
-	    aPulseData->fBSNPulseVector = aPulse;
+	    aPulseData->SetBaselineSubNormPulse(aPulse);
 		
 	    //store instance of this class so RQs can be read out a little later
 	    aPulseData->StorePulseAnalysis(tempSimulateFromRandoms);
@@ -1340,7 +1340,7 @@ void PulseEvtBuilder::DoSimulateChargeFromRandoms(int detNum)
         //Overwrite the baseline subtracted, normalized pulse 
         //with the modified trace.  All fitting routines run 
         //after this point will run on the modified trace.
-        aPulseData->fBSNPulseVector = aPulse;
+        aPulseData->SetBaselineSubNormPulse(aPulse);
 
         //store instance of this class so RQs can be read out a little later
         aPulseData->StorePulseAnalysis(tempSimulateFromRandoms);
@@ -1474,7 +1474,7 @@ void PulseEvtBuilder::DoOptimalFilterPhononNS(int detNum, const string& sensorTy
 
 	
           if(PTOFAmps*1e8>ptThresh || isRandom){
-            tempOptimalFilterPhononNS.DoCalc(aBSNPulse);
+            tempOptimalFilterPhononNS.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
           }
 	  
 	  //store instance of this class so RQs can be read out a little later
@@ -1532,6 +1532,7 @@ void PulseEvtBuilder::DoOptimalFilterCharge2X2(int detNum)
     // Define pulse maps (channel name -> pulse vector)
     map<string, vector<double> > aPulseMap2x2; // for 2X2 fitting
     map<string, vector<double> > aPulseMap1x1; // for single pulse fitting 
+    map<string, vector<TComplex> > aPulseFFTMap; // FFTs cached in PulseData, for both
   
     // get vector of pulseData for this zip if available
     vector<PulseData>* zipPulseList;
@@ -1605,6 +1606,7 @@ void PulseEvtBuilder::DoOptimalFilterCharge2X2(int detNum)
            aPulseMap1x1[chanName] = aPulseData->GetBaselineSubNormPulse();
         else
            aPulseMap2x2[chanName] = aPulseData->GetBaselineSubNormPulse();
+        aPulseFFTMap[chanName] = aPulseData->GetBaselineSubNormPulseFFT();
       
 
       } 
@@ -1734,7 +1736,7 @@ void PulseEvtBuilder::DoOptimalFilterCharge2X2(int detNum)
      
      // ---- Do Optimal Filter ----
       
-     myOptimalFilterCharge2x2.DoCalc(aPulseMap2x2); 
+     myOptimalFilterCharge2x2.DoCalc(aPulseMap2x2, aPulseFFTMap); 
     
      // store RQ in pulse data
      for(uint ipulse = 0; ipulse < zipPulseList->size(); ipulse++)
@@ -1797,7 +1799,9 @@ void PulseEvtBuilder::DoOptimalFilterCharge2X2(int detNum)
 
 
          // do Optimal Filter
-         myOptimalFilterCharge1x1.DoCalc(pulse, chanName); 
+         map<string, vector<double> > aPulseMap;
+         aPulseMap[chanName] = pulse;
+         myOptimalFilterCharge1x1.DoCalc(aPulseMap, aPulseFFTMap); 
 	 
          // store RQ in pulse data
          for(uint ipulse = 0; ipulse < zipPulseList->size(); ipulse++)
@@ -2233,7 +2237,7 @@ void PulseEvtBuilder::DoOptimalFilterPhonon(int detNum, const string& sensorType
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2325,7 +2329,7 @@ void PulseEvtBuilder::DoOptimalFilterPhononGlitch1(int detNum, const string& sen
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2417,7 +2421,7 @@ void PulseEvtBuilder::DoOptimalFilterPhononLFnoise1(int detNum, const string& se
 	 vector<double> aBSNPulse;	 
 	 aBSNPulse = aPulseData->GetBaselineSubNormPulse();  //when ISR is not read, norm = 1    
 
-	 tempOptimalFilterPhonon.DoCalc(aBSNPulse);
+	 tempOptimalFilterPhonon.DoCalc(aBSNPulse, aPulseData->GetBaselineSubNormPulseFFT());
 	 
 
          // -------  store  information -----------
@@ -2533,7 +2537,7 @@ void PulseEvtBuilder::DoOptimalFilterCharge(int detNum)
 	    
 	 // --------- Do Optimal Filter ---------------
 	 
-	 tempOptimalFilterCharge.DoCalc(aPulseData->GetBaselineSubNormPulse()); //when ISR is not read, norm = 1     
+	 tempOptimalFilterCharge.DoCalc(aPulseData->GetBaselineSubNormPulse(), aPulseData->GetBaselineSubNormPulseFFT()); //when ISR is not read, norm = 1     
 	 
 	 
 	 // ---------- store results -------------------
@@ -2730,7 +2734,8 @@ void PulseEvtBuilder::DoOptimalFilterChargeX(int detNum, const string& side)
 	    
 	    // --------- Do Optimal Filter ---------------
 
-	    tempOptimalFilterChargeX.DoCalc(aBSNPulseQI, aBSNPulseQO);
+	    tempOptimalFilterChargeX.DoCalc(aBSNPulseQI, aBSNPulseQO,
+					    aPulseDataQI->GetBaselineSubNormPulseFFT(), aPulseDataQO->GetBaselineSubNormPulseFFT());
 	    
 
             // ---------- store results -------------------
@@ -3055,19 +3060,21 @@ void PulseEvtBuilder::FillVetoPulseCollection(vector<PulseData>& pulseCollection
 void PulseEvtBuilder::FillSingleZipPulseCollection(vector<PulseData>& pulseCollection,
 						const int& detNum) const
 {
+   pulseCollection = GetSingleZipPulses(detNum);
+   return;
+}
 
-   vector<PulseData> tempCollection;
+//This function gives read-only access to the pulse values!
+const vector<PulseData>& PulseEvtBuilder::GetSingleZipPulses(int detNum) const
+{
+   static const vector<PulseData> noPulses;
 
    //retrive the vector of pulses for this zip
    map< int, vector<PulseData> >::const_iterator mapItr = fMapOfZipPulses.find(detNum);
    if(mapItr != fMapOfZipPulses.end())
-   {
-      tempCollection = mapItr->second;
-   }  
- 
-   pulseCollection = tempCollection;
+      return mapItr->second;
 
-   return;
+   return noPulses;
 }
 
 // ====================== Utility Functions  =========================
@@ -8,6 +8,7 @@
 //Creation Date: Nov. 17, 2008
 //
 //Modifications:
+//Oct. 2026: data objects and pulse collections returned by const reference (GetSingleZipPulses...)
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -53,10 +54,10 @@ class PulseEvtBuilder
 
       //getting data objects (all const functions)
       
-      AdminData    GetAdmin()   const  { return fAdminData;    }
-      HistoryData  GetHistory() const  { return fHistoryData;  }
-      TriggerData  GetTrigger() const  { return fTriggerData;  }
-      GPSData      GetGPS()     const  { return fGPSData; }
+      const AdminData&    GetAdmin()   const  { return fAdminData;    }
+      const HistoryData&  GetHistory() const  { return fHistoryData;  }
+      const TriggerData&  GetTrigger() const  { return fTriggerData;  }
+      const GPSData&      GetGPS()     const  { return fGPSData; }
       
       uint32_t     GetEventCategory();
 
@@ -95,15 +96,19 @@ class PulseEvtBuilder
       
       
       //getting external files data (all const functions)
-      InfoDataManager GetInfoData()  const    { return fInfoData;   }
-      IsrDataManager GetIsrData()  const      { return fIsrData;    }
-      DmmDataManager GetDmmData()  const      { return fDmmData;    } 
-      GpibDataManager GetGpibData() const     { return fGpibData;   }
-      FilterDataManager GetFilterData() const { return fFilterData; }
+      const InfoDataManager& GetInfoData()  const    { return fInfoData;   }
+      const IsrDataManager& GetIsrData()  const      { return fIsrData;    }
+      const DmmDataManager& GetDmmData()  const      { return fDmmData;    } 
+      const GpibDataManager& GetGpibData() const     { return fGpibData;   }
+      const FilterDataManager& GetFilterData() const { return fFilterData; }
       const CdmsDB::DatabaseManager& GetDatabaseManager() const 
       { return fDatabaseManager; }
 
-      //getting pulse collections
+      //getting pulse collections, read-only and without copying (empty if the zip has no pulses)
+      const vector<PulseData>& GetSingleZipPulses(int detNum) const;
+      const vector<PulseData>& GetVetoPulses() const { return fVectorOfVetoPulses; }
+
+      //same, copied into pulseCollection
       void FillSingleZipPulseCollection(vector<PulseData>& pulseCollection, const int& detNum) const;
       void FillVetoPulseCollection(vector<PulseData>& pulseCollection) const;
 
@@ -227,8 +227,7 @@ int main(int argc, char* argv[]){
 	  eventBuilder.DoOptimalFilterCharge2X2(detnum);
 
 
-      vector<PulseData> pulseCollection;
-      eventBuilder.FillSingleZipPulseCollection(pulseCollection, detnum);
+      const vector<PulseData>& pulseCollection = eventBuilder.GetSingleZipPulses(detnum);
 
       // get the PT normalization by looping over the
       // pulses until we find the PT channel
@@ -145,6 +145,7 @@ ifneq (,$(findstring brazos.tamu,$(shell hostname)))
 CPPFLAGS += -I$(shell root-config --incdir)
 CXXFLAGS += $(shell root-config --cflags) 
 LDFLAGS  += $(shell root-config --libs) -lMinuit -lGui 
+ROOTLIBDIR := $(shell root-config --libdir)
 else
 ifndef ROOTSYS
 $(error CDMSBATS requires ROOT.  Please define the ROOTSYS envvar.)
@@ -152,6 +153,12 @@ endif
 CPPFLAGS += -I$(shell $(ROOTSYS)/bin/root-config --incdir)
 CXXFLAGS += $(shell $(ROOTSYS)/bin/root-config --cflags) 
 LDFLAGS  += $(shell $(ROOTSYS)/bin/root-config --libs) -lMinuit -lGui 
+ROOTLIBDIR := $(shell $(ROOTSYS)/bin/root-config --libdir)
+endif
+
+# RNTuple (BatRoot OUTPUT_FORMAT = rntuple) is not in root-config --libs
+ifneq (,$(wildcard $(ROOTLIBDIR)/libROOTNTuple.*))
+LDFLAGS  += -lROOTNTuple
 endif
 
 #explicitly activate necessary c++11 stuff
@@ -163,8 +170,24 @@ CPPFLAGS += -std=c++0x
 #explicitly include libblas
 LDFLAGS += -lblas
 
-# Additional system libraries
-LDFLAGS += -lz
+# Raw file decompression: ZLIB_DIR may point to a zlib-ng install built in zlib compat mode,
+# which then replaces the system zlib.  libdeflate (RAW_INFLATE_BACKEND = libdeflate) is used
+# when its header is found, in LIBDEFLATE_DIR if given
+ifdef ZLIB_DIR
+CPPFLAGS := -I$(ZLIB_DIR)/include $(CPPFLAGS)
+LDFLAGS  += -L$(ZLIB_DIR)/lib
+endif
+ifneq (,$(wildcard /usr/include/libdeflate.h $(LIBDEFLATE_DIR)/include/libdeflate.h))
+CPPFLAGS += -DHAVE_LIBDEFLATE
+ifdef LIBDEFLATE_DIR
+CPPFLAGS += -I$(LIBDEFLATE_DIR)/include
+LDFLAGS  += -L$(LIBDEFLATE_DIR)/lib
+endif
+LDFLAGS  += -ldeflate
+endif
+
+# Additional system libraries (librt for shm_open on older glibc, pthread for the raw data read-ahead)
+LDFLAGS += -lz -lrt -lpthread
 
 # Special: Build BatCommon library from top level if not found
 ifneq (BatCommon,$(PKG))
@@ -51,35 +51,28 @@ for dumpnum in `seq 1 $ndumps` ; do
     rrqfiles="$rrqfiles $SCRATCHDIR/$series/$rrqfile"
 done
 
-#create the merge executable
-#merging requires the merge executable
-if [ "${HOSTNAME: -15}" == "brazos.tamu.edu" ] ; then
-    ROOTCONFIG=root-config
-else
-    ROOTCONFIG=$ROOTSYS/bin/root-config
-fi
-
-MERGE=$SCRATCHDIR/$series/merge_filelist
-g++ -o $MERGE merge_filelist.C `$ROOTCONFIG --cflags --libs`
-if [ $? -ne 0 ] || [ ! -x $MERGE ] ; then 
-    echo "There was an error compiling merge_filelist.C! Exiting" >&2
+#merging requires the BatMerge executable
+MERGE=$CDMSBATSDIR/BUILD/bin/BatMerge
+if [ ! -x $MERGE ] ; then 
+    echo "Cannot find $MERGE, build it with make BatMerge! Exiting" >&2
     exit $FAIL
 fi
 
-#do the merging
+#do the merging: all trees concatenated (-c) into one basket per branch (-b mono),
+#as merge_filelist.C monobasket did
 echo "$(tstamp): Merging RQ files..."
 merge_rqfile=$SCRATCHDIR/$series/$(get_merged_rq_filename $tag $series)
-$MERGE $merge_rqfile monobasket $rqfiles 
+$MERGE -c -b mono $merge_rqfile $rqfiles 
 if [ $? -ne 0 ] || [ ! -f $merge_rqfile ] ; then
-    echo "An error occurred with the root command. See log for errors." >&2
+    echo "An error occurred with BatMerge. See log for errors." >&2
     exit $FAIL
 fi
 
 echo "$(tstamp): Merging RRQ files..."
 merge_rrqfile=$SCRATCHDIR/$series/$(get_merged_rrq_filename $tag $series)
-$MERGE $merge_rrqfile monobasket $rrqfiles 
+$MERGE -c -b mono $merge_rrqfile $rrqfiles 
 if [ $? -ne 0 ] || [ ! -f $merge_rrqfile ] ; then
-    echo "An error occurred with the root command. See log for errors." >&2
+    echo "An error occurred with BatMerge. See log for errors." >&2
     exit $FAIL
 fi
 
@@ -38,17 +38,20 @@ if [ "${rqdir:0:1}" != "/" ] ; then
     rqdir=`pwd -P`/$rqdir
 fi
 
+rqfiles=""
 for dumpnum in `seq 1 $ndumps` ; do
     rqfile=$(get_rq_filename $tag $series $dumpnum)
     while [ ! -f $rqdir/$rqfile ] ; do 
 	sleep 60 
     done
     /bin/ln -s $rqdir/$rqfile $SCRATCHDIR/$series/$rqfile
+    rqfiles="$rqfiles $SCRATCHDIR/$series/$rqfile"
 done
 
 #do the merging
 echo "$(tstamp): Merging series $series..."
-root -b -q "merge_all.C(\"$SCRATCHDIR/$series\",\"$tag\",\"$series\",\"runid\",\"$datatype\",$ndumps)" 
+merge_rqfile=$SCRATCHDIR/$series/$(get_merged_rq_filename $tag $series)
+$CDMSBATSDIR/BUILD/bin/BatMerge $merge_rqfile $rqfiles
 
 #run batcalib on the merged data
 echo "$(tstamp): Done merging series $series. Calibrating..."
@@ -331,7 +331,6 @@ cp $CDMS_STAGE3SCRIPT $WORKDIR/
 #$MKDIR $WORKDIR/stage4
 #cp $CDMS_STAGE4SCRIPT $WORKDIR/
 
-cp merge_filelist.C $WORKDIR/
 
 ########## read the series line by line from the runlist and set up jobs ##########
 while read series ndumps ; do
@@ -277,16 +277,15 @@ if ($do_supermerge == 1) {
     # ----------------
     # Merge
     # ----------------
-    
+
+    # all trees concatenated (-c), into a few baskets per branch (-b poly)
     print "\nMerging $nums_rq RQ files";
     
-    system("$execdir/merge_filelist $rqmergefile_temp  polybasket @rqdata >$execdir/logs/supermerge_rq_$mergefile\_0.log 2>$execdir/logs/supermerge_rq_$mergefile\_0.err;");
-    system("$execdir/merge_filelist $rqmergefile fast  $rqmergefile_temp  >$execdir/logs/supermerge_rq_$mergefile\_1.log 2>$execdir/logs/supermerge_rq_$mergefile\_1.err;");
+    system("$ENV{CDMSBATSDIR}/BUILD/bin/BatMerge -c -b poly $rqmergefile @rqdata >$execdir/logs/supermerge_rq_$mergefile\_0.log 2>$execdir/logs/supermerge_rq_$mergefile\_0.err;");
     
     # merge RRQ files
     print "\nMerging $nums_rrq RRQ files\n";
-    system("$execdir/merge_filelist $rrqmergefile polybasket @rrqdata >$execdir/logs/supermerge_rrq_$mergefile\_0.log >$execdir/logs/supermerge_rrq_$mergefile\_0.err;");
-    system("$execdir/merge_filelist $rrqmergefile fast  $rrqmergefile_temp  >$execdir/logs/supermerge_rq_$mergefile\_1.log 2>$execdir/logs/supermerge_rrq_$mergefile\_1.err;");
+    system("$ENV{CDMSBATSDIR}/BUILD/bin/BatMerge -c -b poly $rrqmergefile @rrqdata >$execdir/logs/supermerge_rrq_$mergefile\_0.log 2>$execdir/logs/supermerge_rrq_$mergefile\_0.err;");
     
     
     print "\nDone!\n";
@@ -347,13 +346,13 @@ if ($do_supermerge == 0) {
 	# Merge
 	# ----------------
 	
-	# merge RQ files
+	# merge RQ files: all trees concatenated (-c), one basket per branch (-b mono)
 	print "\nMerging $nums_rq RQ files for $series \n";
-	system("$execdir/merge_filelist $rqmergefile  monobasket @rqdata >$execdir/logs/merge_rq_$series\_0.log 2>$execdir/logs/merge_rq_$series\_0.err;");
+	system("$ENV{CDMSBATSDIR}/BUILD/bin/BatMerge -c -b mono $rqmergefile @rqdata >$execdir/logs/merge_rq_$series\_0.log 2>$execdir/logs/merge_rq_$series\_0.err;");
 	
 	# merge RRQ files
 	print "\nMerging $nums_rrq RRQ files for $series\n";
-	system("$execdir/merge_filelist $rrqmergefile  monobasket @rrqdata >$execdir/logs/calib_rq_$series\_0.log 2>$execdir/logs/calib_rq_$series\_0.err;");
+	system("$ENV{CDMSBATSDIR}/BUILD/bin/BatMerge -c -b mono $rrqmergefile @rrqdata >$execdir/logs/calib_rq_$series\_0.log 2>$execdir/logs/calib_rq_$series\_0.err;");
 	
 	print "\nDone, moving to next series!\n";
     }